@@ -0,0 +1,152 @@
+#include "nlpBlockCons_ex1.hpp"
+
+#include <cmath>
+#include <cstring> //for memcpy
+#include <cstdio>
+
+BlockEx1::BlockEx1(long long n, long long m)
+  : n_vars(n), n_segs(m), comm(MPI_COMM_WORLD)
+{
+  assert(m>=1 && 2*m<=n);
+  comm_size=1; my_rank=0; 
+#ifdef WITH_MPI
+  int ierr = MPI_Comm_size(comm, &comm_size); assert(MPI_SUCCESS==ierr);
+  ierr = MPI_Comm_rank(comm, &my_rank); assert(MPI_SUCCESS==ierr);
+#endif
+  assert(m>=comm_size && "each rank needs to own at least one segment");
+  //the variables are distributed by segments
+  col_partition = new long long[comm_size+1];
+  for(int r=0; r<=comm_size; r++) col_partition[r] = seg_start(r*n_segs/comm_size);
+  seg_first = my_rank*n_segs/comm_size; seg_last = (my_rank+1)*n_segs/comm_size;
+}
+BlockEx1::~BlockEx1()
+{
+  delete[] col_partition;
+}
+
+bool BlockEx1::get_prob_sizes(long long& n, long long& m)
+  { n=n_vars; m=2; return true; }
+
+bool BlockEx1::get_vars_info(const long long& n, double *xlow, double* xupp, NonlinearityType* type)
+{
+  long long n_local=col_partition[my_rank+1]-col_partition[my_rank];
+  for(long long i=0; i<n_local; i++) {
+    xlow[i]=-1.; xupp[i]=1.; type[i]=hiopNonlinear;
+  }
+  return true;
+}
+bool BlockEx1::get_cons_info(const long long& m, double* clow, double* cupp, NonlinearityType* type)
+{
+  assert(m==2);
+  clow[0]=-1e20; cupp[0]=0.25*n_vars; type[0]=hiopInterfaceBase::hiopLinear;
+  clow[1]=cupp[1]=1.;                 type[1]=hiopInterfaceBase::hiopLinear;
+  return true;
+}
+bool BlockEx1::eval_f(const long long& n, const double* x, bool new_x, double& obj_value)
+{
+  long long n_local=col_partition[my_rank+1]-col_partition[my_rank], i0=col_partition[my_rank];
+  obj_value=0.; 
+  for(long long i=0;i<n_local;i++) obj_value += 0.5*pow(x[i]-cos((double)(i0+i)), 2);
+#ifdef WITH_MPI
+  double obj_global;
+  int ierr=MPI_Allreduce(&obj_value, &obj_global, 1, MPI_DOUBLE, MPI_SUM, comm); assert(ierr==MPI_SUCCESS);
+  obj_value=obj_global;
+#endif
+  return true;
+}
+bool BlockEx1::eval_grad_f(const long long& n, const double* x, bool new_x, double* gradf)
+{
+  long long n_local=col_partition[my_rank+1]-col_partition[my_rank], i0=col_partition[my_rank];
+  for(long long i=0;i<n_local;i++) gradf[i] = x[i]-cos((double)(i0+i));
+  return true;
+}
+
+bool BlockEx1::eval_cons(const long long& n, const long long& m, 
+			 const long long& num_cons, const long long* idx_cons,  
+			 const double* x, bool new_x, double* cons)
+{
+  assert(n==n_vars); assert(m==2);
+  const long long i0=col_partition[my_rank], n_local=col_partition[my_rank+1]-i0;
+  for(long long itcon=0; itcon<num_cons; itcon++) {
+    const long long j=idx_cons[itcon];
+    cons[itcon]=0.;
+    for(long long i=0; i<n_local; i++) 
+      cons[itcon] += (0==j ? cos((double)(i0+i)) : sin((double)(i0+i)))*x[i];
+  }
+#ifdef WITH_MPI
+  double cons_global[2];
+  int ierr=MPI_Allreduce(cons, cons_global, num_cons, MPI_DOUBLE, MPI_SUM, comm); assert(ierr==MPI_SUCCESS);
+  memcpy(cons, cons_global, num_cons*sizeof(double));
+#endif
+  return true;
+}
+bool BlockEx1::eval_Jac_cons(const long long& n, const long long& m,
+			     const long long& num_cons, const long long* idx_cons,  
+			     const double* x, bool new_x, double** Jac) 
+{
+  assert(n==n_vars); assert(m==2); 
+  const long long i0=col_partition[my_rank], n_local=col_partition[my_rank+1]-i0;
+  for(long long itcon=0; itcon<num_cons; itcon++) {
+    const long long j=idx_cons[itcon];
+    for(long long i=0; i<n_local; i++) 
+      Jac[itcon][i] = 0==j ? cos((double)(i0+i)) : sin((double)(i0+i));
+  }
+  return true;
+}
+
+bool BlockEx1::get_local_cons_sizes(long long& m_local)
+{
+  m_local = seg_last-seg_first; return true;
+}
+bool BlockEx1::get_local_cons_info(const long long& m_local, double* clow, double* cupp, NonlinearityType* type)
+{
+  assert(m_local==seg_last-seg_first);
+  for(long long j=seg_first; j<seg_last; j++) {
+    const long long k=j-seg_first;
+    type[k]=hiopInterfaceBase::hiopLinear;
+    if(j%4==1)      { clow[k]=0.6*seg_len(j); cupp[k]=1e20; }
+    else if(j%4==3) { clow[k]=-1e20;          cupp[k]=0.1*seg_len(j); }
+    else            { clow[k]=cupp[k]=0.5*seg_len(j); }
+  }
+  return true;
+}
+bool BlockEx1::eval_local_cons(const long long& n_local, const long long& m_local, 
+			       const double* x, bool new_x, double* cons)
+{
+  const long long i0=col_partition[my_rank];
+  for(long long j=seg_first; j<seg_last; j++) {
+    double& c=cons[j-seg_first];
+    c=0.;
+    for(long long i=seg_start(j); i<seg_start(j)+seg_len(j); i++) c += x[i-i0];
+  }
+  return true;
+}
+bool BlockEx1::eval_local_Jac_cons(const long long& n_local, const long long& m_local, 
+				   const double* x, bool new_x, double** Jac)
+{
+  const long long i0=col_partition[my_rank];
+  for(long long j=seg_first; j<seg_last; j++) {
+    double* row=Jac[j-seg_first];
+    for(long long i=0; i<n_local; i++) row[i]=0.;
+    for(long long i=seg_start(j); i<seg_start(j)+seg_len(j); i++) row[i-i0]=1.;
+  }
+  return true;
+}
+
+bool BlockEx1::get_vecdistrib_info(long long global_n, long long* cols)
+{
+  if(global_n==n_vars)
+    for(int i=0; i<=comm_size; i++) cols[i]=col_partition[i];
+  else 
+    assert(false && "You shouldn't need distrib info for this size.");
+  return true;
+}
+
+bool BlockEx1::get_starting_point(const long long& global_n, double* x0)
+{
+  assert(global_n==n_vars); 
+  long long n_local=col_partition[my_rank+1]-col_partition[my_rank];
+  for(long long i=0; i<n_local; i++)
+    x0[i]=0.0;
+  return true;
+}
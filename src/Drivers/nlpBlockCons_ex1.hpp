@@ -0,0 +1,66 @@
+#ifndef HIOP_EXAMPLE_BLOCK_EX1
+#define  HIOP_EXAMPLE_BLOCK_EX1
+
+#include "hiopInterface.hpp"
+
+#include <cassert>
+
+#ifdef WITH_MPI
+#include "mpi.h"
+#else
+#define MPI_COMM_WORLD 0
+#define MPI_Comm int
+#endif
+
+/* Problem with many local constraints and two global (dense) constraints. The variables are split in m 
+ * consecutive segments S_j, j=0,...,m-1, and the segments are distributed over the ranks (each rank owns 
+ * whole segments, so the problem does not depend on the number of ranks).
+ *  min   sum 1/2*{ (x_i-cos(i))^2 : i=1,...,n}
+ *  s.t.  
+ *        c_j(x) := sum {x_i : i in S_j} = 0.5*|S_j|,  j=0,4,8,...  and j=2,6,10,...   (local)
+ *        c_j(x) >= 0.6*|S_j|,  j=1,5,9,...                                          (local)
+ *        c_j(x) <= 0.1*|S_j|,  j=3,7,11,...                                         (local)
+ *        sum {cos(i)*x_i : i=1,...,n} <= 0.25*n                                      (global)
+ *        sum {sin(i)*x_i : i=1,...,n}  = 1                                           (global)
+ *        -1 <= x_i <= 1, i=1,...,n
+ */
+class BlockEx1 : public hiop::hiopInterfaceBlockConstraints
+{
+public: 
+  BlockEx1(long long n, long long m);
+  virtual ~BlockEx1();
+
+  virtual bool get_prob_sizes(long long& n, long long& m);
+  virtual bool get_vars_info(const long long& n, double *xlow, double* xupp, NonlinearityType* type);
+  virtual bool get_cons_info(const long long& m, double* clow, double* cupp, NonlinearityType* type);
+
+  virtual bool eval_f(const long long& n, const double* x, bool new_x, double& obj_value);
+  virtual bool eval_cons(const long long& n, const long long& m, 
+			 const long long& num_cons, const long long* idx_cons,  
+			 const double* x, bool new_x, double* cons);
+  virtual bool eval_grad_f(const long long& n, const double* x, bool new_x, double* gradf);
+  virtual bool eval_Jac_cons(const long long& n, const long long& m,
+			     const long long& num_cons, const long long* idx_cons,  
+			     const double* x, bool new_x, double** Jac);
+  virtual bool get_vecdistrib_info(long long global_n, long long* cols);
+  virtual bool get_starting_point(const long long&n, double* x0);
+
+  virtual bool get_local_cons_sizes(long long& m_local);
+  virtual bool get_local_cons_info(const long long& m_local, double* clow, double* cupp, NonlinearityType* type);
+  virtual bool eval_local_cons(const long long& n_local, const long long& m_local, 
+			       const double* x, bool new_x, double* cons);
+  virtual bool eval_local_Jac_cons(const long long& n_local, const long long& m_local, 
+				   const double* x, bool new_x, double** Jac);
+private:
+  //first variable and length of the segment j
+  inline long long seg_start(long long j) const { return j*n_vars/n_segs; }
+  inline long long seg_len(long long j) const { return (j+1)*n_vars/n_segs - j*n_vars/n_segs; }
+private:
+  long long n_vars, n_segs;
+  MPI_Comm comm;
+  int my_rank, comm_size;
+  //the segments [seg_first, seg_last) are owned by this rank
+  long long seg_first, seg_last;
+  long long* col_partition;
+};
+#endif
@@ -0,0 +1,112 @@
+#include "nlpBlockCons_ex1.hpp"
+#include "hiopNlpFormulation.hpp"
+#include "hiopAlgFilterIPM.hpp"
+
+#include <cstdlib>
+#include <string>
+
+using namespace hiop;
+
+static bool self_check(long long n, long long m, double obj_value);
+
+static bool parse_arguments(int argc, char **argv, long long& n, long long& m, bool& self_check)
+{
+  n=10000; m=100; self_check=false;
+  int npos=0;
+  for(int i=1; i<argc; i++) {
+    std::string arg(argv[i]);
+    if(arg=="-selfcheck") { self_check=true; continue; }
+    long long val=std::atoll(argv[i]);
+    if(val<=0) return false;
+    if(npos==0) n=val;
+    else if(npos==1) m=val;
+    else return false;
+    npos++;
+  }
+  if(m<1 || 2*m>n) return false;
+  return true;
+};
+
+static void usage(const char* exeName)
+{
+  printf("hiOp driver %s that solves a synthetic problem with many rank-local constraints and two global constraints.\n", exeName);
+  printf("Usage: \n");
+  printf("  '$ %s problem_size num_local_constraints -selfcheck'\n", exeName);
+  printf("Arguments:\n");
+  printf("  'problem_size': number of decision variables [optional, default is 10k]\n");
+  printf("  'num_local_constraints': number of local constraints, at most problem_size/2 and at least the number of ranks [optional, default is 100]\n");
+  printf("  '-selfcheck': compares the optimal objective with a previously saved value for the problem specified by 'problem_size' and 'num_local_constraints'. [optional]\n");
+}
+
+
+int main(int argc, char **argv)
+{
+  int rank=0;
+#ifdef WITH_MPI
+  MPI_Init(&argc, &argv);
+  assert(MPI_SUCCESS==MPI_Comm_rank(MPI_COMM_WORLD,&rank));
+#endif
+  bool selfCheck; long long n, m;
+  if(!parse_arguments(argc, argv, n, m, selfCheck)) { usage(argv[0]); return 1;}
+
+  BlockEx1 nlp_interface(n, m);
+  hiopNlpBlockConstraints nlp(nlp_interface);
+
+  hiopAlgFilterIPM solver(&nlp);
+  hiopSolveStatus status = solver.run();
+
+  double obj_value = solver.getObjective();
+  
+  if(status<0) {
+    if(rank==0) printf("solver returned negative solve status: %d (with objective is %18.12e)\n", status, obj_value);
+    return -1;
+  }
+
+  //this is used for "regression" testing when the driver is called with -selfcheck
+  if(selfCheck) {
+    if(!self_check(n, m, obj_value))
+      return -1;
+  } else {
+    if(rank==0) {
+      printf("Optimal objective: %22.14e. Solver status: %d\n", obj_value, status);
+    }
+  }
+
+#ifdef WITH_MPI
+  MPI_Finalize();
+#endif
+
+  return 0;
+}
+
+
+static bool self_check(long long n, long long m, double objval)
+{
+#define num_n_saved 2 //keep this is sync with n_saved, m_saved, and objval_saved
+  const long long n_saved[] = {1000, 5000};
+  const long long m_saved[] = { 100,  400};
+  const double objval_saved[] = {1.72454223387616e+02, 8.48224757719026e+02};
+
+#define relerr 1e-6
+  bool found=false;
+  for(int it=0; it<num_n_saved; it++) {
+    if(n_saved[it]==n && m_saved[it]==m) {
+      found=true;
+      if(fabs( (objval_saved[it]-objval)/(1+objval_saved[it])) > relerr) {
+	printf("selfcheck failure. Objective (%18.12e) does not agree (%d digits) with the saved value (%18.12e) for n=%lld m=%lld.\n",
+	       objval, -(int)log10(relerr), objval_saved[it], n, m);
+	return false;
+      } else {
+	printf("selfcheck success (%d digits)\n",  -(int)log10(relerr));
+      }
+      break;
+    }
+  }
+
+  if(!found) {
+    printf("selfcheck: driver does not have the objective for n=%lld m=%lld saved. BTW, obj=%18.12e was obtained for this n and m.\n", n, m, objval);
+    return false;
+  }
+
+  return true;
+}
@@ -8,7 +8,7 @@ using namespace hiop;
 
 Ex1Meshing1D::Ex1Meshing1D(double a, double b, 
 			   long long glob_n, double r, 
-			   MPI_Comm comm_)
+			   MPI_Comm comm_, const long long* col_part)
 {
   _a=a; _b=b; _r=r;
   comm=comm_;
@@ -24,6 +24,8 @@ Ex1Meshing1D::Ex1Meshing1D(double a, double b,
   int i=0; col_partition[i]=0; i++;
   while(i<=remainder) { col_partition[i] = col_partition[i-1]+quotient+1; i++; }
   while(i<=comm_size) { col_partition[i] = col_partition[i-1]+quotient;   i++; }
+  if(col_part)
+    for(i=0; i<=comm_size; i++) col_partition[i]=col_part[i];
 
   _mass = new hiopVectorPar(glob_n, col_partition, comm);
 
@@ -196,3 +198,13 @@ void Ex1Interface::set_c()
     //printf("index %d  t=%g value %g\n", n_global, t, cval);
   } 
 }
+
+void Ex1Interface::extra_work()
+{
+  if(0==imbalance || 0!=my_rank) return;
+  double acc=0.;
+  for(int i_local=0; i_local<n_local; i_local++)
+    for(int k=0; k<imbalance; k++)
+      acc += sin(1e-3*(i_local+k));
+  work_sink += acc;
+}
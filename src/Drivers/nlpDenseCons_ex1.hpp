@@ -44,9 +44,10 @@ class DiscretizedFunction;
 class Ex1Meshing1D 
 {
 public:
+  //'col_part' is the columns partitioning of the mesh; by default the elements are evenly split across the ranks
   Ex1Meshing1D(double a, double b, 
 	       long long glob_n, double r=1.0, 
-	       MPI_Comm comm=MPI_COMM_WORLD);
+	       MPI_Comm comm=MPI_COMM_WORLD, const long long* col_part=NULL);
   virtual ~Ex1Meshing1D();
   virtual bool matches(Ex1Meshing1D* other) { return this==other; }
   virtual long long size() const { return _mass->get_size(); }
@@ -109,9 +110,14 @@ protected:
 class Ex1Interface : public hiop::hiopInterfaceDenseConstraints
 {
 public: 
-  Ex1Interface(int n_mesh_elem=100, double mesh_ratio=1.0)
-    : n_vars(n_mesh_elem), n_cons(0), comm(MPI_COMM_WORLD)
+  //with 'imbalance'>0, the evaluations on rank 0 do extra work ('imbalance' transcendental functions per variable)
+  Ex1Interface(int n_mesh_elem=100, double mesh_ratio=1.0, int imbalance_=0)
+    : n_vars(n_mesh_elem), n_cons(0), comm(MPI_COMM_WORLD), 
+      ratio(mesh_ratio), imbalance(imbalance_), my_rank(0), work_sink(0.)
   {
+#ifdef WITH_MPI
+    int ierr = MPI_Comm_rank(comm, &my_rank); assert(MPI_SUCCESS==ierr);
+#endif
     //create the members
     _mesh = new Ex1Meshing1D(0.0,1.0, n_vars, mesh_ratio, comm);
     c =  new DiscretizedFunction(_mesh);
@@ -153,6 +159,7 @@ public:
     double xnrm = x->twonorm();
     //printf("c'x=%g   xnrm_sq=%g\n", obj_value, xnrm*xnrm);
     obj_value += 0.5 * xnrm*xnrm;
+    extra_work();
 
     return true;
   }
@@ -164,6 +171,7 @@ public:
     x->axpy(1.0, *c);
     _mesh->applyM(*x);
     x->copyTo(gradf);
+    extra_work();
 
     //x->copyFrom(x_in);
     //x->print(stdout);
@@ -182,6 +190,7 @@ public:
     assert(num_cons==1);
     x->copyFrom(x_in);
     cons[0] = x->integral();
+    extra_work();
     return true;
   }
 
@@ -196,6 +205,7 @@ public:
     x->setToConstant(1.);
     _mesh->applyM(*x);
     x->copyTo(Jac[0]);
+    extra_work();
     return true;
   }
 
@@ -208,6 +218,23 @@ public:
     return true;
   }
 
+  /* the mesh and the functions defined on it are rebuilt with the new partitioning; the masses of the 
+   * distorted mesh depend on the local indexes (see Ex1Meshing1D), so only the uniform mesh is repartitioned */
+  bool repartition_vecdistrib(long long global_n, const long long* cols)
+  {
+    if(global_n!=n_vars || ratio!=1.0) return false;
+    delete c;
+    delete x;
+    delete _mesh;
+    _mesh = new Ex1Meshing1D(0.0,1.0, n_vars, ratio, comm, cols);
+    c =  new DiscretizedFunction(_mesh);
+    x =  new DiscretizedFunction(_mesh);
+    n_local = _mesh->local_size();
+
+    set_c();
+    return true;
+  }
+
   bool get_starting_point(const long long &global_n, double* x0)
   {
     assert(global_n==n_vars); 
@@ -226,8 +253,14 @@ private:
   DiscretizedFunction* c;
   DiscretizedFunction* x; //proxy for taking hiop's variable in and working with it as a function
 
+  double ratio; //mesh distortion ratio
+  int imbalance, my_rank;
+  double work_sink; //keeps the result of the extra work
+
   //populates the linear term c
   void set_c();
+  //extra work of the imbalanced variant, proportional to the number of local variables
+  void extra_work();
 
 public:
   // inline int idx_local2global(long long global_n, int idx_local) 
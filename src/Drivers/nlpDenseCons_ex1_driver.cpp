@@ -6,14 +6,23 @@
 
 #include <cstdlib>
 #include <string>
+#include <vector>
 
 using namespace hiop;
 
 static bool self_check(long long n, double obj_value);
 
-static bool parse_arguments(int argc, char **argv, long long& n, double& distortion_ratio, bool& self_check)
+static bool parse_arguments(int argc, char **argv, long long& n, double& distortion_ratio, bool& imbalanced, bool& self_check)
 {
-  n = 20000; distortion_ratio=1.; self_check=false; //default options
+  n = 20000; distortion_ratio=1.; imbalanced=false; self_check=false; //default options
+
+  //'-imbalanced' can be anywhere; it is removed before the positional arguments are parsed
+  std::vector<char*> args;
+  for(int i=0; i<argc; i++) {
+    if(std::string(argv[i])=="-imbalanced") imbalanced=true;
+    else args.push_back(argv[i]);
+  }
+  argc=args.size(); argv=&args[0];
 
   switch(argc) {
   case 1:
@@ -49,10 +58,11 @@ static void usage(const char* exeName)
 {
   printf("hiOp driver '%s' that solves a synthetic infinite dimensional problem of variable size. A 1D mesh is created by the example, and the size and the distortion of the mesh can be specified as options to this executable. The distortion of the mesh is the ratio of the smallest element and the largest element in the mesh.\n", exeName);
   printf("Usage: \n");
-  printf("  '$ %s problem_size mesh_distortion_ratio -selfcheck'\n", exeName);
+  printf("  '$ %s problem_size mesh_distortion_ratio -imbalanced -selfcheck'\n", exeName);
   printf("Arguments (specify in the order above): \n");
   printf("  'problem_size': number of decision variables [optional, default is 20k]\n");
   printf("  'dist_ratio': mesh distortion ratio, see above; a number in (0,1)  [optional, default 1.0]\n");
+  printf("  '-imbalanced': rank 0 does extra work in the evaluations and the variables are repartitioned across the ranks (option 'repartition_iter') to balance it [optional]\n");
   printf("  '-selfcheck': compares the optimal objective with a previously saved value for the problem specified by 'problem_size'. [optional]\n");
 }
 
@@ -67,12 +77,14 @@ int main(int argc, char **argv)
   err = MPI_Comm_size(MPI_COMM_WORLD,&numRanks); assert(MPI_SUCCESS==err);
   if(0==rank) printf("Support for MPI is enabled\n");
 #endif
-  bool selfCheck; long long mesh_size; double ratio;
-  if(!parse_arguments(argc, argv, mesh_size, ratio, selfCheck)) { usage(argv[0]); return 1;}
+  bool selfCheck, imbalanced; long long mesh_size; double ratio;
+  if(!parse_arguments(argc, argv, mesh_size, ratio, imbalanced, selfCheck)) { usage(argv[0]); return 1;}
   
-  Ex1Interface problem(mesh_size, ratio);
+  Ex1Interface problem(mesh_size, ratio, imbalanced ? 200 : 0);
   //if(rank==0) printf("interface created\n");
   hiop::hiopNlpDenseConstraints nlp(problem);
+  if(imbalanced) 
+    nlp.options->SetIntegerValue("repartition_iter", 3);
   //if(rank==0) printf("nlp formulation created\n");
   
   hiop::hiopAlgFilterIPM solver(&nlp);
@@ -99,8 +111,8 @@ int main(int argc, char **argv)
 
 static bool self_check(long long n, double objval)
 {
-#define num_n_saved 3 //keep this is sync with n_saved and objval_saved
-  const long long n_saved[] = {5e2, 5e3}; 
+#define num_n_saved 2 //keep this is sync with n_saved and objval_saved
+  const long long n_saved[] = {500, 5000};
   const double objval_saved[] = {8.6156700e-2, 8.6156106e-02};
 
 #define relerr 1e-6
@@ -4,8 +4,8 @@
 #include <cstring> //for memcpy
 #include <cstdio>
 
-Ex2::Ex2(int n)
-  : n_vars(n), n_cons(4), comm(MPI_COMM_WORLD)
+Ex2::Ex2(int n, MPI_Comm comm_)
+  : n_vars(n), n_cons(4), comm(comm_)
 {
   comm_size=1; my_rank=0; 
 #ifdef WITH_MPI
@@ -76,6 +76,28 @@ bool Ex2::eval_grad_f(const long long& n, const double* x, bool new_x, double* g
   for(int i=0;i<n_local;i++) gradf[i] = pow(x[i]-1.,3);
   return true;
 }
+bool Ex2::eval_Hess_diag(const long long& n, const double* x, bool new_x, double* diag)
+{
+  long long n_local=col_partition[my_rank+1]-col_partition[my_rank];
+  for(int i=0;i<n_local;i++) diag[i] = 3*pow(x[i]-1.,2);
+  return true;
+}
+bool Ex2::eval_Hess_f_vec(const long long& n, const double* x, bool new_x, const double* v, double* Hv)
+{
+  long long n_local=col_partition[my_rank+1]-col_partition[my_rank];
+  for(int i=0;i<n_local;i++) Hv[i] = 3*pow(x[i]-1.,2)*v[i];
+  return true;
+}
+bool Ex2::eval_Hess_Lagr(const long long& n, const long long& m, const double* x, bool new_x, 
+			 const double& obj_factor, const double* lambda, bool new_lambda, double** Hess)
+{
+  //the constraints are linear
+  for(long long i=0;i<n;i++) {
+    for(long long j=0;j<n;j++) Hess[i][j]=0.;
+    Hess[i][i] = obj_factor*3*pow(x[i]-1.,2);
+  }
+  return true;
+}
 
 /* Four constraints no matter how large n is */
 bool Ex2::eval_cons(const long long& n, const long long& m, 
@@ -28,7 +28,8 @@
 class Ex2 : public hiop::hiopInterfaceDenseConstraints
 {
 public: 
-  Ex2(int n);
+  /* the problem is solved by the ranks of 'comm' */
+  Ex2(int n, MPI_Comm comm=MPI_COMM_WORLD);
   virtual ~Ex2();
 
   virtual bool get_prob_sizes(long long& n, long long& m);
@@ -44,6 +45,14 @@ public:
 			     const long long& num_cons, const long long* idx_cons,  
 			     const double* x, bool new_x, double** Jac);
   virtual bool get_vecdistrib_info(long long global_n, long long* cols);
+  virtual bool get_MPI_comm(MPI_Comm& comm_out) { comm_out=comm; return true; }
+  /* the objective is separable and the constraints are linear: the Hessian of the Lagrangian is diagonal */
+  virtual bool eval_Hess_diag(const long long& n, const double* x, bool new_x, double* diag);
+  /* the Hessian of the objective times a vector (for the structured Hessian mode) */
+  virtual bool eval_Hess_f_vec(const long long& n, const double* x, bool new_x, const double* v, double* Hv);
+  /* the dense Hessian of the Lagrangian (for the exact Hessian mode, one rank) */
+  virtual bool eval_Hess_Lagr(const long long& n, const long long& m, const double* x, bool new_x, 
+			      const double& obj_factor, const double* lambda, bool new_lambda, double** Hess);
 
   virtual bool get_starting_point(const long long&n, double* x0);
 
@@ -0,0 +1,118 @@
+#include "nlpDenseCons_ex2.hpp"
+#include "hiopBatchSolver.hpp"
+
+#include <cstdlib>
+#include <cmath>
+#include <string>
+
+using namespace hiop;
+
+/* a batch of instances of Ex2 of different sizes */
+class Ex2Batch : public hiopBatchProblems
+{
+public:
+  Ex2Batch(int num_problems_) : num_problems(num_problems_) {};
+  virtual ~Ex2Batch() {};
+
+  virtual int get_num_problems() const { return num_problems; }
+  virtual hiopInterfaceDenseConstraints* create_problem(int idx, MPI_Comm comm)
+  {
+    return new Ex2(get_size(idx), comm);
+  }
+  virtual void set_options(int idx, hiopOptions& options) 
+  {
+    //the groups solve concurrently; only the errors are printed
+    options.SetIntegerValue("verbosity_level", 0);
+  }
+  static long long get_size(int idx) { return idx%2 ? 5000 : 500; }
+private:
+  int num_problems;
+};
+
+static bool parse_arguments(int argc, char **argv, int& num_problems, int& group_size, bool& self_check)
+{
+  num_problems=8; group_size=1; self_check=false;
+  int npos=0;
+  for(int i=1; i<argc; i++) {
+    std::string arg(argv[i]);
+    if(arg=="-selfcheck") { self_check=true; continue; }
+    int val=std::atoi(argv[i]);
+    if(val<=0) return false;
+    if(npos==0) num_problems=val;
+    else if(npos==1) group_size=val;
+    else return false;
+    npos++;
+  }
+  return true;
+};
+
+static void usage(const char* exeName)
+{
+  printf("hiOp driver %s that solves a batch of instances of the problem of nlpDenseCons_ex2 on groups of ranks.\n", exeName);
+  printf("Usage: \n");
+  printf("  '$ %s num_problems group_size -selfcheck'\n", exeName);
+  printf("Arguments:\n");
+  printf("  'num_problems': number of problems, of sizes 500 and 5000 alternatively [optional, default is 8]\n");
+  printf("  'group_size': number of ranks solving each problem [optional, default is 1]\n");
+  printf("  '-selfcheck': compares the optimal objectives with previously saved values and checks the solutions. [optional]\n");
+}
+
+static bool self_check(const hiopBatchSolver& batch, int num_problems, int rank);
+
+int main(int argc, char **argv)
+{
+  int rank=0;
+#ifdef WITH_MPI
+  MPI_Init(&argc, &argv);
+  assert(MPI_SUCCESS==MPI_Comm_rank(MPI_COMM_WORLD,&rank));
+#endif
+  bool selfCheck; int num_problems, group_size;
+  if(!parse_arguments(argc, argv, num_problems, group_size, selfCheck)) { usage(argv[0]); return 1;}
+
+  Ex2Batch problems(num_problems);
+  hiopBatchSolver batch(problems, MPI_COMM_WORLD, group_size);
+  int nsolved = batch.run();
+
+  if(rank==0) {
+    printf("Solved %d of %d problems on %d group(s)\n", nsolved, num_problems, batch.get_num_groups());
+    for(int i=0; i<num_problems; i++)
+      printf("  problem %3d (n=%lld): status %d, objective %22.14e, group %d\n", i, Ex2Batch::get_size(i),
+	     batch.get_status(i), batch.get_objective(i), batch.get_group(i));
+  }
+  if(selfCheck && !self_check(batch, num_problems, rank))
+    return -1;
+
+#ifdef WITH_MPI
+  MPI_Finalize();
+#endif
+  return 0;
+}
+
+static bool self_check(const hiopBatchSolver& batch, int num_problems, int rank)
+{
+  const double objval_saved[] = {1.56251020819349e-02, 1.56251019995139e-02}; //n=500 and n=5000
+#define relerr 1e-6
+  bool ok=true;
+  for(int i=0; i<num_problems; i++) {
+    const long long n=Ex2Batch::get_size(i);
+    const double objval=batch.get_objective(i), saved=objval_saved[i%2];
+    if(batch.get_status(i)<0 || fabs((saved-objval)/(1+saved)) > relerr) {
+      if(rank==0) printf("selfcheck failure. Objective (%18.12e) of problem %d does not agree (%d digits) with the saved "
+			 "value (%18.12e) for n=%lld.\n", objval, i, -(int)log10(relerr), saved, n);
+      ok=false;
+    }
+    if(rank==0) {
+      //the solution satisfies the equality constraint sum x_i = n+1
+      const std::vector<double>& x = batch.get_solution(i);
+      double sum=0.;
+      for(size_t j=0; j<x.size(); j++) sum += x[j];
+      if((long long)x.size()!=n || fabs(sum-(n+1)) > relerr*(n+1)) {
+	printf("selfcheck failure. The solution of problem %d has %d entries and sum %18.12e (expected %lld and %lld).\n", 
+	       i, (int)x.size(), sum, n, n+1);
+	ok=false;
+      }
+    }
+  }
+  if(ok && rank==0) printf("selfcheck success (%d digits)\n",  -(int)log10(relerr));
+  return ok;
+}
@@ -105,7 +105,7 @@ int main(int argc, char **argv)
 static bool self_check(long long n, double objval)
 {
 #define num_n_saved 3 //keep this is sync with n_saved and objval_saved
-  const long long n_saved[] = {5e2, 5e3, 5e4}; 
+  const long long n_saved[] = {500, 5000, 50000};
   const double objval_saved[] = {1.56251020819349e-02, 1.56251019995139e-02, 1.56251028980352e-02};
 
 #define relerr 1e-6
@@ -0,0 +1,158 @@
+#include "nlpDenseCons_ex2.hpp"
+#include "hiopNlpFormulation.hpp"
+#include "hiopAlgFilterIPM.hpp"
+
+#include <cstdlib>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+using namespace hiop;
+
+/* Stress test of the reentrancy of the solver: many instances of the problem of nlpDenseCons_ex2 are solved
+ * concurrently by a pool of threads of the same process and the results are compared with the ones of serial
+ * solves. Each instance has its own communicator (a duplicate of MPI_COMM_SELF created by the main thread) and
+ * MPI needs to provide MPI_THREAD_MULTIPLE; otherwise a single thread is used. */
+
+struct SolveResult
+{
+  SolveResult() : status(UnknownNLPSolveStatus), objective(0.) {};
+  hiopSolveStatus status;
+  double objective;
+  std::vector<double> x;
+};
+
+static long long get_size(int idx) { return idx%2 ? 1000 : 500; }
+
+static void solve_one(int idx, MPI_Comm comm, SolveResult& res)
+{
+  Ex2 problem(get_size(idx), comm);
+  hiopNlpDenseConstraints nlp(problem);
+  //the solves run concurrently; only the errors are printed
+  nlp.options->SetIntegerValue("verbosity_level", 0);
+  nlp.log->set_verbosity(hovVerySilent);
+
+  hiopAlgFilterIPM solver(&nlp);
+  res.status = solver.run();
+  res.objective = solver.getObjective();
+  res.x.resize(get_size(idx));
+  solver.getSolution(&res.x[0]);
+}
+
+struct ThreadPool
+{
+  ThreadPool(int num_problems_, std::vector<SolveResult>& results_)
+    : num_problems(num_problems_), next(0), results(results_) {};
+  void work(MPI_Comm comm)
+  {
+    int idx;
+    while((idx=next.fetch_add(1)) < num_problems)
+      solve_one(idx, comm, results[idx]);
+  }
+  int num_problems;
+  std::atomic<int> next;
+  std::vector<SolveResult>& results;
+};
+
+static void thread_work(ThreadPool* pool, MPI_Comm comm) { pool->work(comm); }
+
+static bool parse_arguments(int argc, char **argv, int& num_problems, int& num_threads, bool& self_check)
+{
+  num_problems=64; num_threads=8; self_check=false;
+  int npos=0;
+  for(int i=1; i<argc; i++) {
+    std::string arg(argv[i]);
+    if(arg=="-selfcheck") { self_check=true; continue; }
+    int val=std::atoi(argv[i]);
+    if(val<=0) return false;
+    if(npos==0) num_problems=val;
+    else if(npos==1) num_threads=val;
+    else return false;
+    npos++;
+  }
+  return true;
+};
+
+static void usage(const char* exeName)
+{
+  printf("hiOp driver %s that solves concurrently, on a pool of threads, instances of the problem of nlpDenseCons_ex2.\n", exeName);
+  printf("Usage: \n");
+  printf("  '$ %s num_problems num_threads -selfcheck'\n", exeName);
+  printf("Arguments:\n");
+  printf("  'num_problems': number of problems, of sizes 500 and 1000 alternatively [optional, default is 64]\n");
+  printf("  'num_threads': number of threads [optional, default is 8]\n");
+  printf("  '-selfcheck': checks that the concurrent solves reproduce the serial solves. [optional]\n");
+}
+
+static bool self_check(const std::vector<SolveResult>& serial, const std::vector<SolveResult>& concurrent);
+
+int main(int argc, char **argv)
+{
+  bool selfCheck; int num_problems, num_threads;
+  if(!parse_arguments(argc, argv, num_problems, num_threads, selfCheck)) { usage(argv[0]); return 1;}
+
+  int rank=0;
+#ifdef WITH_MPI
+  int provided=MPI_THREAD_SINGLE;
+  MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+  int ierr=MPI_Comm_rank(MPI_COMM_WORLD,&rank); assert(MPI_SUCCESS==ierr);
+  if(provided<MPI_THREAD_MULTIPLE && num_threads>1) {
+    if(rank==0) printf("MPI does not provide MPI_THREAD_MULTIPLE; the problems are solved by one thread\n");
+    num_threads=1;
+  }
+#endif
+  //each rank runs the whole test on its own
+  std::vector<SolveResult> serial(num_problems), concurrent(num_problems);
+  for(int i=0; i<num_problems; i++)
+    solve_one(i, MPI_COMM_SELF, serial[i]);
+
+  std::vector<MPI_Comm> comms(num_threads, MPI_COMM_SELF);
+#ifdef WITH_MPI
+  for(int t=0; t<num_threads; t++)
+    MPI_Comm_dup(MPI_COMM_SELF, &comms[t]);
+#endif
+  ThreadPool pool(num_problems, concurrent);
+  std::vector<std::thread> threads;
+  for(int t=0; t<num_threads; t++)
+    threads.push_back(std::thread(thread_work, &pool, comms[t]));
+  for(int t=0; t<num_threads; t++)
+    threads[t].join();
+#ifdef WITH_MPI
+  for(int t=0; t<num_threads; t++)
+    MPI_Comm_free(&comms[t]);
+#endif
+
+  if(rank==0) {
+    printf("Solved %d problems on %d thread(s)\n", num_problems, num_threads);
+    for(int i=0; i<num_problems; i++)
+      printf("  problem %3d (n=%lld): status %d, objective %22.14e\n", i, get_size(i),
+	     concurrent[i].status, concurrent[i].objective);
+  }
+  bool ok = true;
+  if(selfCheck) {
+    ok = self_check(serial, concurrent);
+    if(rank==0) printf("selfcheck %s\n", ok ? "success" : "failure");
+  }
+#ifdef WITH_MPI
+  MPI_Finalize();
+#endif
+  return ok ? 0 : -1;
+}
+
+static bool self_check(const std::vector<SolveResult>& serial, const std::vector<SolveResult>& concurrent)
+{
+  //the instances do not share state, hence the concurrent solves reproduce the serial ones to the last bit
+  bool ok=true;
+  for(size_t i=0; i<serial.size(); i++) {
+    const SolveResult &s=serial[i], &c=concurrent[i];
+    if(s.status<0 || c.status!=s.status || c.objective!=s.objective || c.x!=s.x) {
+      printf("selfcheck failure. Problem %d: status %d and objective %22.14e of the concurrent solve, status %d and "
+	     "objective %22.14e of the serial solve; the solutions %s.\n", (int)i, c.status, c.objective,
+	     s.status, s.objective, c.x==s.x ? "agree" : "differ");
+      ok=false;
+    }
+  }
+  return ok;
+}
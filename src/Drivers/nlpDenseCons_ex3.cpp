@@ -0,0 +1,124 @@
+#include "nlpDenseCons_ex3.hpp"
+
+#include <cmath>
+#include <cstring> //for memcpy
+#include <cstdio>
+
+Ex3::Ex3(long long n, long long m)
+  : n_vars(n), n_cons(m), comm(MPI_COMM_WORLD)
+{
+  assert(m>=1 && 2*m<=n);
+  comm_size=1; my_rank=0; 
+#ifdef WITH_MPI
+  int ierr = MPI_Comm_size(comm, &comm_size); assert(MPI_SUCCESS==ierr);
+  ierr = MPI_Comm_rank(comm, &my_rank); assert(MPI_SUCCESS==ierr);
+#endif
+  col_partition = new long long[comm_size+1];
+  long long quotient=n_vars/comm_size, remainder=n_vars-comm_size*quotient;
+  int i=0; col_partition[i]=0; i++;
+  while(i<=remainder) { col_partition[i] = col_partition[i-1]+quotient+1; i++; }
+  while(i<=comm_size) { col_partition[i] = col_partition[i-1]+quotient;   i++; }
+}
+Ex3::~Ex3()
+{
+  delete[] col_partition;
+}
+
+bool Ex3::get_prob_sizes(long long& n, long long& m)
+  { n=n_vars; m=n_cons; return true; }
+
+bool Ex3::get_vars_info(const long long& n, double *xlow, double* xupp, NonlinearityType* type)
+{
+  long long n_local=col_partition[my_rank+1]-col_partition[my_rank];
+  for(long long i=0; i<n_local; i++) {
+    xlow[i]=-1.; xupp[i]=1.; type[i]=hiopNonlinear;
+  }
+  return true;
+}
+bool Ex3::get_cons_info(const long long& m, double* clow, double* cupp, NonlinearityType* type)
+{
+  assert(m==n_cons);
+  for(long long j=0; j<m; j++) {
+    type[j]=hiopInterfaceBase::hiopLinear;
+    if(j%4==1)      { clow[j]=0.6*seg_len(j); cupp[j]=1e20; }
+    else if(j%4==3) { clow[j]=-1e20;          cupp[j]=0.1*seg_len(j); }
+    else            { clow[j]=cupp[j]=0.5*seg_len(j); }
+  }
+  return true;
+}
+bool Ex3::eval_f(const long long& n, const double* x, bool new_x, double& obj_value)
+{
+  long long n_local=col_partition[my_rank+1]-col_partition[my_rank], i0=col_partition[my_rank];
+  obj_value=0.; 
+  for(long long i=0;i<n_local;i++) obj_value += 0.5*pow(x[i]-cos((double)(i0+i)), 2);
+#ifdef WITH_MPI
+  double obj_global;
+  int ierr=MPI_Allreduce(&obj_value, &obj_global, 1, MPI_DOUBLE, MPI_SUM, comm); assert(ierr==MPI_SUCCESS);
+  obj_value=obj_global;
+#endif
+  return true;
+}
+bool Ex3::eval_grad_f(const long long& n, const double* x, bool new_x, double* gradf)
+{
+  long long n_local=col_partition[my_rank+1]-col_partition[my_rank], i0=col_partition[my_rank];
+  for(long long i=0;i<n_local;i++) gradf[i] = x[i]-cos((double)(i0+i));
+  return true;
+}
+
+bool Ex3::eval_cons(const long long& n, const long long& m, 
+		    const long long& num_cons, const long long* idx_cons,  
+		    const double* x, bool new_x, double* cons)
+{
+  assert(n==n_vars); assert(m==n_cons);
+  const long long i0=col_partition[my_rank], i1=col_partition[my_rank+1];
+  for(long long itcon=0; itcon<num_cons; itcon++) {
+    const long long j=idx_cons[itcon];
+    cons[itcon]=0.;
+    //the local part of the segment j
+    const long long b=seg_start(j)>i0?seg_start(j):i0, e=seg_start(j)+seg_len(j)<i1?seg_start(j)+seg_len(j):i1;
+    for(long long i=b; i<e; i++) cons[itcon] += x[i-i0];
+    const long long inext=seg_start(j+1);
+    if(inext>=i0 && inext<i1) cons[itcon] += 0.5*x[inext-i0];
+  }
+#ifdef WITH_MPI
+  double* cons_global=new double[num_cons];
+  int ierr=MPI_Allreduce(cons, cons_global, num_cons, MPI_DOUBLE, MPI_SUM, comm); assert(ierr==MPI_SUCCESS);
+  memcpy(cons, cons_global, num_cons*sizeof(double));
+  delete[] cons_global;
+#endif
+  return true;
+}
+bool Ex3::eval_Jac_cons(const long long& n, const long long& m,
+			const long long& num_cons, const long long* idx_cons,  
+			const double* x, bool new_x, double** Jac) 
+{
+  assert(n==n_vars); assert(m==n_cons); 
+  const long long i0=col_partition[my_rank], i1=col_partition[my_rank+1];
+  for(long long itcon=0; itcon<num_cons; itcon++) {
+    const long long j=idx_cons[itcon];
+    for(long long i=0; i<i1-i0; i++) Jac[itcon][i]=0.;
+    const long long b=seg_start(j)>i0?seg_start(j):i0, e=seg_start(j)+seg_len(j)<i1?seg_start(j)+seg_len(j):i1;
+    for(long long i=b; i<e; i++) Jac[itcon][i-i0]=1.;
+    const long long inext=seg_start(j+1);
+    if(inext>=i0 && inext<i1) Jac[itcon][inext-i0] += 0.5;
+  }
+  return true;
+}
+
+bool Ex3::get_vecdistrib_info(long long global_n, long long* cols)
+{
+  if(global_n==n_vars)
+    for(int i=0; i<=comm_size; i++) cols[i]=col_partition[i];
+  else 
+    assert(false && "You shouldn't need distrib info for this size.");
+  return true;
+}
+
+bool Ex3::get_starting_point(const long long& global_n, double* x0)
+{
+  assert(global_n==n_vars); 
+  long long n_local=col_partition[my_rank+1]-col_partition[my_rank];
+  for(long long i=0; i<n_local; i++)
+    x0[i]=0.0;
+  return true;
+}
@@ -0,0 +1,56 @@
+#ifndef HIOP_EXAMPLE_EX3
+#define  HIOP_EXAMPLE_EX3
+
+#include "hiopInterface.hpp"
+
+#include <cassert>
+
+#ifdef WITH_MPI
+#include "mpi.h"
+#else
+#define MPI_COMM_WORLD 0
+#define MPI_Comm int
+#endif
+
+/* Problem with a number of dense constraints that grows with the size of the problem. The variables 
+ * are split in m consecutive segments S_j, j=0,...,m-1, and each constraint couples a segment with the 
+ * first variable of the next one.
+ *  min   sum 1/2*{ (x_i-cos(i))^2 : i=1,...,n}
+ *  s.t.  
+ *        c_j(x) := sum {x_i : i in S_j} + 1/2*x_{first of S_{j+1}} = 0.5*|S_j|,  j=0,4,8,...  and j=2,6,10,...
+ *        c_j(x) >= 0.6*|S_j|,  j=1,5,9,...
+ *        c_j(x) <= 0.1*|S_j|,  j=3,7,11,...
+ *        -1 <= x_i <= 1, i=1,...,n
+ * (S_m is S_0). The constraints are linear, so the Hessian of the Lagrangian is the identity.
+ */
+class Ex3 : public hiop::hiopInterfaceDenseConstraints
+{
+public: 
+  Ex3(long long n, long long m);
+  virtual ~Ex3();
+
+  virtual bool get_prob_sizes(long long& n, long long& m);
+  virtual bool get_vars_info(const long long& n, double *xlow, double* xupp, NonlinearityType* type);
+  virtual bool get_cons_info(const long long& m, double* clow, double* cupp, NonlinearityType* type);
+
+  virtual bool eval_f(const long long& n, const double* x, bool new_x, double& obj_value);
+  virtual bool eval_cons(const long long& n, const long long& m, 
+			 const long long& num_cons, const long long* idx_cons,  
+			 const double* x, bool new_x, double* cons);
+  virtual bool eval_grad_f(const long long& n, const double* x, bool new_x, double* gradf);
+  virtual bool eval_Jac_cons(const long long& n, const long long& m,
+			     const long long& num_cons, const long long* idx_cons,  
+			     const double* x, bool new_x, double** Jac);
+  virtual bool get_vecdistrib_info(long long global_n, long long* cols);
+  virtual bool get_starting_point(const long long&n, double* x0);
+private:
+  //first variable of the segment j
+  inline long long seg_start(long long j) const { return (j%n_cons)*n_vars/n_cons; }
+  inline long long seg_len(long long j) const { return (j+1)*n_vars/n_cons - j*n_vars/n_cons; }
+private:
+  long long n_vars, n_cons;
+  MPI_Comm comm;
+  int my_rank, comm_size;
+  long long* col_partition;
+};
+#endif
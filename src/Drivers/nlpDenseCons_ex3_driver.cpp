@@ -0,0 +1,221 @@
+#include "nlpDenseCons_ex3.hpp"
+#include "hiopNlpFormulation.hpp"
+#include "hiopAlgFilterIPM.hpp"
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+using namespace hiop;
+
+static bool self_check(long long n, long long m, double obj_value);
+
+/* keeps the last record of the per-iteration metrics */
+class MetricsCheck : public hiopMetricsSink
+{
+public:
+  MetricsCheck() : num_records(0), ended(false) {};
+  virtual void record(const hiopIterationRecord& r) { last=r; num_records++; }
+  virtual void end() { ended=true; }
+  hiopIterationRecord last;
+  int num_records;
+  bool ended;
+};
+static bool metrics_check(const MetricsCheck& metrics, int num_iter, double obj_value);
+static bool metrics_file_check(const char* filename, bool binary, const MetricsCheck& metrics, int num_iter, double obj_value);
+
+static bool parse_arguments(int argc, char **argv, long long& n, long long& m, bool& dist, bool& nodeshared, 
+			    bool& profile, bool& metrics, bool& metrics_binary, bool& self_check)
+{
+  n=10000; m=100; dist=false; nodeshared=false; profile=false; metrics=false; metrics_binary=false; self_check=false;
+  int npos=0;
+  for(int i=1; i<argc; i++) {
+    std::string arg(argv[i]);
+    if(arg=="-selfcheck") { self_check=true; continue; }
+    if(arg=="-dist")      { dist=true; continue; }
+    if(arg=="-nodeshared"){ nodeshared=true; continue; }
+    if(arg=="-profile")   { profile=true; continue; }
+    if(arg=="-metrics")   { metrics=true; continue; }
+    if(arg=="-metrics_binary") { metrics=metrics_binary=true; continue; }
+    long long val=std::atoll(argv[i]);
+    if(val<=0) return false;
+    if(npos==0) n=val;
+    else if(npos==1) m=val;
+    else return false;
+    npos++;
+  }
+  if(m<1 || 2*m>n) return false;
+  return true;
+};
+
+static void usage(const char* exeName)
+{
+  printf("hiOp driver %s that solves a synthetic problem with a variable number of dense constraints.\n", exeName);
+  printf("Usage: \n");
+  printf("  '$ %s problem_size num_constraints -dist -nodeshared -profile -metrics -metrics_binary -selfcheck'\n", exeName);
+  printf("Arguments:\n");
+  printf("  'problem_size': number of decision variables [optional, default is 10k]\n");
+  printf("  'num_constraints': number of constraints, at most problem_size/2 [optional, default is 100]\n");
+  printf("  '-dist': the reduced matrices are distributed regardless of their size (with more than one rank) [optional]\n");
+  printf("  '-nodeshared': the replicated reduced matrices are shared by the ranks of a node (with more than one rank) [optional]\n");
+  printf("  '-profile': prints the time profile and the hardware counters (when available) of the solver phases and saves the trace in nlpDenseCons_ex3_trace.json [optional]\n");
+  printf("  '-metrics': writes the metrics of the iterations in nlpDenseCons_ex3_metrics.csv; with -selfcheck, also checks the file and the records received by a user sink [optional]\n");
+  printf("  '-metrics_binary': same as '-metrics', but the metrics are written as binary records in nlpDenseCons_ex3_metrics.bin [optional]\n");
+  printf("  '-selfcheck': compares the optimal objective with a previously saved value for the problem specified by 'problem_size' and 'num_constraints'. [optional]\n");
+}
+
+
+int main(int argc, char **argv)
+{
+  int rank=0;
+#ifdef WITH_MPI
+  MPI_Init(&argc, &argv);
+  assert(MPI_SUCCESS==MPI_Comm_rank(MPI_COMM_WORLD,&rank));
+#endif
+  bool selfCheck, dist, nodeshared, profile, metrics, metrics_binary; long long n, m;
+  if(!parse_arguments(argc, argv, n, m, dist, nodeshared, profile, metrics, metrics_binary, selfCheck)) { usage(argv[0]); return 1;}
+
+  Ex3 nlp_interface(n, m);
+  hiopNlpDenseConstraints nlp(nlp_interface);
+  if(dist) {
+    //small blocks, so that each rank owns several of them
+    nlp.options->SetIntegerValue("dist_reduced_mat_min_size", 1);
+    nlp.options->SetIntegerValue("dist_reduced_mat_block_size", 8);
+  }
+  if(nodeshared)
+    nlp.options->SetStringValue("node_shared_reduced_mats", "yes");
+  if(profile) {
+    nlp.options->SetStringValue("time_profile", "yes");
+    nlp.options->SetStringValue("time_profile_counters", "yes");
+    nlp.options->SetStringValue("time_profile_trace", "nlpDenseCons_ex3_trace.json");
+  }
+  const char* metrics_file = metrics_binary ? "nlpDenseCons_ex3_metrics.bin" : "nlpDenseCons_ex3_metrics.csv";
+  if(metrics) {
+    nlp.options->SetStringValue("metrics_file", metrics_file);
+    if(metrics_binary) nlp.options->SetStringValue("metrics_format", "binary");
+  }
+
+  hiopAlgFilterIPM solver(&nlp);
+  MetricsCheck metrics_sink;
+  if(metrics) solver.setMetricsSink(&metrics_sink);
+  hiopSolveStatus status = solver.run();
+
+  double obj_value = solver.getObjective();
+  
+  if(status<0) {
+    if(rank==0) printf("solver returned negative solve status: %d (with objective is %18.12e)\n", status, obj_value);
+    return -1;
+  }
+
+  //this is used for "regression" testing when the driver is called with -selfcheck
+  if(selfCheck) {
+    if(!self_check(n, m, obj_value))
+      return -1;
+    if(metrics && rank==0 && !metrics_check(metrics_sink, solver.getNumIterations(), obj_value))
+      return -1;
+    //the file is flushed at the end of the solve
+    if(metrics && rank==0 && 
+       !metrics_file_check(metrics_file, metrics_binary, metrics_sink, solver.getNumIterations(), obj_value))
+      return -1;
+  } else {
+    if(rank==0) {
+      printf("Optimal objective: %22.14e. Solver status: %d\n", obj_value, status);
+    }
+  }
+
+#ifdef WITH_MPI
+  MPI_Finalize();
+#endif
+
+  return 0;
+}
+
+
+static bool self_check(long long n, long long m, double objval)
+{
+#define num_n_saved 2 //keep this is sync with n_saved, m_saved, and objval_saved
+  const long long n_saved[] = {1000, 10000};
+  const long long m_saved[] = { 100,   400};
+  const double objval_saved[] = {1.29221420723414e+02, 1.30509309312131e+03};
+
+#define relerr 1e-6
+  bool found=false;
+  for(int it=0; it<num_n_saved; it++) {
+    if(n_saved[it]==n && m_saved[it]==m) {
+      found=true;
+      if(fabs( (objval_saved[it]-objval)/(1+objval_saved[it])) > relerr) {
+	printf("selfcheck failure. Objective (%18.12e) does not agree (%d digits) with the saved value (%18.12e) for n=%lld m=%lld.\n",
+	       objval, -(int)log10(relerr), objval_saved[it], n, m);
+	return false;
+      } else {
+	printf("selfcheck success (%d digits)\n",  -(int)log10(relerr));
+      }
+      break;
+    }
+  }
+
+  if(!found) {
+    printf("selfcheck: driver does not have the objective for n=%lld m=%lld saved. BTW, obj=%18.12e was obtained for this n and m.\n", n, m, objval);
+    return false;
+  }
+
+  return true;
+}
+
+static bool metrics_check(const MetricsCheck& metrics, int num_iter, double obj_value)
+{
+  //a record per iteration (and for the starting point); the last one is of the solution
+  if(!metrics.ended || metrics.num_records<num_iter+1 || metrics.last.iter!=num_iter || 
+     metrics.last.objective!=obj_value || metrics.last.n_eval_obj<1) {
+    printf("selfcheck failure. The metrics sink received %d records (%s), the last one of iteration %d with objective "
+	   "%18.12e, for %d iterations and the objective %18.12e.\n", metrics.num_records, metrics.ended ? "ended" : "not ended", 
+	   metrics.last.iter, metrics.last.objective, num_iter, obj_value);
+    return false;
+  }
+  printf("selfcheck success (%d metrics records)\n", metrics.num_records);
+  return true;
+}
+
+/* the file has the header and the same records as the user sink, the last one of the solution */
+static bool metrics_file_check(const char* filename, bool binary, const MetricsCheck& metrics, int num_iter, double obj_value)
+{
+  FILE* f = fopen(filename, binary ? "rb" : "r");
+  if(NULL==f) {
+    printf("selfcheck failure. The metrics file %s could not be opened.\n", filename);
+    return false;
+  }
+  bool header_ok=false;
+  int num_records=0, last_iter=-1, rec_size=0;
+  double last_obj=0.;
+  if(binary) {
+    char magic[8]; 
+    header_ok = fread(magic, 1, 8, f)==8 && 0==memcmp(magic, "HIOPMTR1", 8) && 
+      fread(&rec_size, sizeof(int), 1, f)==1 && rec_size==(int)sizeof(hiopIterationRecord);
+    hiopIterationRecord r;
+    while(header_ok && fread(&r, sizeof(hiopIterationRecord), 1, f)==1) {
+      num_records++; last_iter=r.iter; last_obj=r.objective;
+    }
+    //no partial record at the end
+    if(header_ok && fgetc(f)!=EOF) header_ok=false;
+  } else {
+    char line[1024];
+    header_ok = NULL!=fgets(line, sizeof(line), f) && 0==strncmp(line, "iter,ls_num,", 12);
+    while(header_ok && NULL!=fgets(line, sizeof(line), f)) {
+      num_records++;
+      if(2!=sscanf(line, "%d,%*d,%*d,%*d,%*d,%*d,%*d,%*d,%*d,%*d,%*d,%*d,%lf", &last_iter, &last_obj)) last_iter=-1;
+    }
+  }
+  fclose(f);
+  //the CSV has the objective with 13 digits
+  const double tol = binary ? 0. : 1e-11*(1+fabs(obj_value));
+  if(!header_ok || num_records!=metrics.num_records || last_iter!=num_iter || fabs(last_obj-obj_value)>tol) {
+    printf("selfcheck failure. The metrics file %s has %s header (record size %d) and %d records, the last one of "
+	   "iteration %d with objective %18.12e, for %d records of the sink, %d iterations and the objective %18.12e.\n", 
+	   filename, header_ok ? "a valid" : "an invalid", rec_size, num_records, last_iter, last_obj, 
+	   metrics.num_records, num_iter, obj_value);
+    return false;
+  }
+  printf("selfcheck success (%d records in the metrics file)\n", num_records);
+  return true;
+}
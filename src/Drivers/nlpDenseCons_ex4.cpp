@@ -0,0 +1,81 @@
+#include "nlpDenseCons_ex4.hpp"
+
+#include <cmath>
+
+#define EX4_TILT 0.1
+
+Ex4::Ex4(int n, int start_, int num_starts_, MPI_Comm comm_)
+  : n_vars(n), start(start_), num_starts(num_starts_), comm(comm_)
+{
+  assert(start>=0 && start<num_starts);
+}
+
+bool Ex4::get_prob_sizes(long long& n, long long& m)
+  { n=n_vars; m=1; return true; }
+
+bool Ex4::get_vars_info(const long long& n, double *xlow, double* xupp, NonlinearityType* type)
+{
+  for(long long i=0; i<n; i++) { xlow[i]=-2.; xupp[i]=2.; type[i]=hiopNonlinear; }
+  return true;
+}
+
+bool Ex4::get_cons_info(const long long& m, double* clow, double* cupp, NonlinearityType* type)
+{
+  assert(m==1);
+  clow[0]=-1e20; cupp[0]=1.5*n_vars; type[0]=hiopInterfaceBase::hiopLinear;
+  return true;
+}
+
+bool Ex4::eval_f(const long long& n, const double* x, bool new_x, double& obj_value)
+{
+  obj_value=0.;
+  for(long long i=0; i<n; i++) obj_value += 0.25*pow(x[i],4) - 0.5*x[i]*x[i] + EX4_TILT*x[i];
+  return true;
+}
+
+bool Ex4::eval_grad_f(const long long& n, const double* x, bool new_x, double* gradf)
+{
+  for(long long i=0; i<n; i++) gradf[i] = pow(x[i],3) - x[i] + EX4_TILT;
+  return true;
+}
+
+bool Ex4::eval_cons(const long long& n, const long long& m, 
+		    const long long& num_cons, const long long* idx_cons,  
+		    const double* x, bool new_x, double* cons)
+{
+  for(int itcon=0; itcon<num_cons; itcon++) {
+    assert(idx_cons[itcon]==0);
+    cons[itcon]=0.;
+    for(long long i=0; i<n; i++) cons[itcon] += x[i];
+  }
+  return true;
+}
+
+bool Ex4::eval_Jac_cons(const long long& n, const long long& m,
+			const long long& num_cons, const long long* idx_cons,  
+			const double* x, bool new_x, double** Jac) 
+{
+  for(int itcon=0; itcon<num_cons; itcon++)
+    for(long long i=0; i<n; i++) Jac[itcon][i]=1.;
+  return true;
+}
+
+bool Ex4::get_starting_point(const long long& n, double* x0)
+{
+  const double frac_neg = num_starts>1 ? 1.-(double)start/(num_starts-1) : 1.;
+  const long long num_neg = (long long)floor(frac_neg*n+0.5);
+  for(long long i=0; i<n; i++) x0[i] = i<num_neg ? -1.5 : 1.5;
+  return true;
+}
+
+double Ex4::local_min_objective(int n, int num_neg)
+{
+  //the roots of x^3-x+a=0 near -1 and +1, by Newton's method
+  double xm=-1., xp=1.;
+  for(int k=0; k<50; k++) {
+    xm -= (xm*xm*xm-xm+EX4_TILT)/(3*xm*xm-1);
+    xp -= (xp*xp*xp-xp+EX4_TILT)/(3*xp*xp-1);
+  }
+  const double fm=0.25*pow(xm,4)-0.5*xm*xm+EX4_TILT*xm, fp=0.25*pow(xp,4)-0.5*xp*xp+EX4_TILT*xp;
+  return num_neg*fm + (n-num_neg)*fp;
+}
@@ -0,0 +1,51 @@
+#ifndef HIOP_EXAMPLE_EX4
+#define  HIOP_EXAMPLE_EX4
+
+#include "hiopInterface.hpp"
+
+#include <cassert>
+
+#ifdef WITH_MPI
+#include "mpi.h"
+#else
+#define MPI_COMM_SELF 0
+#define MPI_Comm int
+#endif
+
+/* Nonconvex test problem with 2^n local minima, used by the multi-start driver.
+ *  min   sum { 1/4*x_i^4 - 1/2*x_i^2 + a*x_i : i=1,...,n}
+ *  s.t.  sum x_i <= 1.5*n
+ *        -2 <= x_i <= 2, i=1,...,n
+ * with a=0.1. Each x_i is near -1 or +1 at a local minimum; the global minimum has all x_i near -1.
+ * The starting point 'start' of 'num_starts' has the first 1-start/(num_starts-1) fraction of the x_i 
+ * equal to -1.5 and the rest equal to 1.5 (all -1.5 for start 0). The problem is not distributed.
+ */
+class Ex4 : public hiop::hiopInterfaceDenseConstraints
+{
+public: 
+  Ex4(int n, int start=0, int num_starts=1, MPI_Comm comm=MPI_COMM_SELF);
+  virtual ~Ex4() {};
+
+  virtual bool get_prob_sizes(long long& n, long long& m);
+  virtual bool get_vars_info(const long long& n, double *xlow, double* xupp, NonlinearityType* type);
+  virtual bool get_cons_info(const long long& m, double* clow, double* cupp, NonlinearityType* type);
+
+  virtual bool eval_f(const long long& n, const double* x, bool new_x, double& obj_value);
+  virtual bool eval_cons(const long long& n, const long long& m, 
+			 const long long& num_cons, const long long* idx_cons,  
+			 const double* x, bool new_x, double* cons);
+  virtual bool eval_grad_f(const long long& n, const double* x, bool new_x, double* gradf);
+  virtual bool eval_Jac_cons(const long long& n, const long long& m,
+			     const long long& num_cons, const long long* idx_cons,  
+			     const double* x, bool new_x, double** Jac);
+  virtual bool get_MPI_comm(MPI_Comm& comm_out) { comm_out=comm; return true; }
+
+  virtual bool get_starting_point(const long long&n, double* x0);
+
+  /* the objective at the local minimum with 'num_neg' entries near -1 */
+  static double local_min_objective(int n, int num_neg);
+private:
+  int n_vars, start, num_starts;
+  MPI_Comm comm;
+};
+#endif
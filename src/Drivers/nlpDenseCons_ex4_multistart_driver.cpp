@@ -0,0 +1,123 @@
+#include "nlpDenseCons_ex4.hpp"
+#include "hiopMultiStart.hpp"
+
+#include <cstdlib>
+#include <cmath>
+#include <string>
+
+using namespace hiop;
+
+/* the starts of Ex4, which differ in their starting points */
+class Ex4Starts : public hiopBatchProblems
+{
+public:
+  Ex4Starts(int n_, int num_starts_) : n(n_), num_starts(num_starts_) {};
+  virtual ~Ex4Starts() {};
+
+  virtual int get_num_problems() const { return num_starts; }
+  virtual hiopInterfaceDenseConstraints* create_problem(int idx, MPI_Comm comm)
+  {
+    return new Ex4(n, idx, num_starts, comm);
+  }
+  virtual void set_options(int idx, hiopOptions& options) 
+  {
+    //the starts are solved concurrently; only the errors are printed
+    options.SetIntegerValue("verbosity_level", 0);
+  }
+private:
+  int n, num_starts;
+};
+
+static bool parse_arguments(int argc, char **argv, int& n, int& num_starts, int& num_threads, bool& self_check)
+{
+  n=100; num_starts=16; num_threads=4; self_check=false;
+  int npos=0;
+  for(int i=1; i<argc; i++) {
+    std::string arg(argv[i]);
+    if(arg=="-selfcheck") { self_check=true; continue; }
+    int val=std::atoi(argv[i]);
+    if(val<=0) return false;
+    if(npos==0) n=val;
+    else if(npos==1) num_starts=val;
+    else if(npos==2) num_threads=val;
+    else return false;
+    npos++;
+  }
+  return n>=2 && num_starts>=1;
+};
+
+static void usage(const char* exeName)
+{
+  printf("hiOp driver %s that solves the nonconvex problem of nlpDenseCons_ex4 from several starting points.\n", exeName);
+  printf("Usage: \n");
+  printf("  '$ %s n num_starts num_threads -selfcheck'\n", exeName);
+  printf("Arguments:\n");
+  printf("  'n': number of variables [optional, default is 100]\n");
+  printf("  'num_starts': number of starting points [optional, default is 16]\n");
+  printf("  'num_threads': number of threads solving the starts concurrently [optional, default is 4]\n");
+  printf("  '-selfcheck': checks that the global minimum is found and that each start either converged or was "
+	 "cancelled. [optional]\n");
+}
+
+static bool self_check(const hiopMultiStart& ms, int n, int num_starts);
+
+int main(int argc, char **argv)
+{
+  int rank=0;
+#ifdef WITH_MPI
+  int provided=MPI_THREAD_SINGLE;
+  MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+  int ierr=MPI_Comm_rank(MPI_COMM_WORLD,&rank); assert(MPI_SUCCESS==ierr);
+#endif
+  bool selfCheck; int n, num_starts, num_threads;
+  if(!parse_arguments(argc, argv, n, num_starts, num_threads, selfCheck)) { usage(argv[0]); return 1;}
+
+  //each rank solves all the starts
+  Ex4Starts starts(n, num_starts);
+  hiopMultiStart ms(starts, num_threads);
+  int best = ms.run();
+
+  if(rank==0) {
+    printf("Best start %d of %d with objective %22.14e; %d start(s) cancelled as dominated; %d of %d thread(s) used\n", 
+	   best, num_starts, ms.get_best_objective(), ms.get_num_dominated(), ms.get_num_threads_used(), num_threads);
+    for(int i=0; i<num_starts; i++)
+      printf("  start %3d: status %3d, objective %22.14e, iterations %4d, time %8.3f sec%s\n", i, 
+	     ms.get_status(i), ms.get_objective(i), ms.get_iterations(i), ms.get_time(i), 
+	     ms.is_dominated(i) ? " (dominated)" : "");
+  }
+  bool ok = true;
+  if(selfCheck) {
+    ok = self_check(ms, n, num_starts);
+    if(rank==0) printf("selfcheck %s\n", ok ? "success" : "failure");
+  }
+#ifdef WITH_MPI
+  MPI_Finalize();
+#endif
+  return ok ? 0 : -1;
+}
+
+static bool self_check(const hiopMultiStart& ms, int n, int num_starts)
+{
+#define relerr 1e-6
+  bool ok=true;
+  //start 0 is in the basin of the global minimum
+  const double global_min = Ex4::local_min_objective(n, n);
+  if(ms.get_best_start()!=0 || fabs(ms.get_best_objective()-global_min) > relerr*(1+fabs(global_min))) {
+    printf("selfcheck failure. The best start %d with objective %18.12e is not the global minimum (%18.12e, start 0).\n",
+	   ms.get_best_start(), ms.get_best_objective(), global_min);
+    ok=false;
+  }
+  const std::vector<double>& x = ms.get_best_solution();
+  if((int)x.size()!=n) {
+    printf("selfcheck failure. The best solution has %d entries instead of %d.\n", (int)x.size(), n);
+    ok=false;
+  }
+  for(int i=0; i<num_starts; i++) {
+    const bool converged = Solve_Success==ms.get_status(i) || Solve_Acceptable_Level==ms.get_status(i);
+    if(!converged && !ms.is_dominated(i)) {
+      printf("selfcheck failure. Start %d neither converged nor was cancelled (status %d).\n", i, ms.get_status(i));
+      ok=false;
+    }
+  }
+  return ok;
+}
@@ -0,0 +1,70 @@
+#include "nlpDenseCons_ex5.hpp"
+
+#include <cmath>
+
+Ex5::Ex5(int n, MPI_Comm comm_)
+  : n_vars(n), comm(comm_)
+{
+  assert(n_vars>=2);
+}
+
+bool Ex5::get_prob_sizes(long long& n, long long& m)
+  { n=n_vars; m=1; return true; }
+
+bool Ex5::get_vars_info(const long long& n, double *xlow, double* xupp, NonlinearityType* type)
+{
+  for(long long i=0; i<n; i++) { xlow[i]=-5.; xupp[i]=5.; type[i]=hiopNonlinear; }
+  return true;
+}
+
+bool Ex5::get_cons_info(const long long& m, double* clow, double* cupp, NonlinearityType* type)
+{
+  assert(m==1);
+  clow[0]=-1e20; cupp[0]=2.*n_vars; type[0]=hiopInterfaceBase::hiopNonlinear;
+  return true;
+}
+
+bool Ex5::eval_f(const long long& n, const double* x, bool new_x, double& obj_value)
+{
+  obj_value=0.;
+  for(long long i=0; i<n-1; i++) obj_value += 100.*pow(x[i+1]-x[i]*x[i],2) + pow(1.-x[i],2);
+  return true;
+}
+
+bool Ex5::eval_grad_f(const long long& n, const double* x, bool new_x, double* gradf)
+{
+  for(long long i=0; i<n; i++) gradf[i]=0.;
+  for(long long i=0; i<n-1; i++) {
+    const double t = x[i+1]-x[i]*x[i];
+    gradf[i]   += -400.*t*x[i] - 2.*(1.-x[i]);
+    gradf[i+1] += 200.*t;
+  }
+  return true;
+}
+
+bool Ex5::eval_cons(const long long& n, const long long& m, 
+		    const long long& num_cons, const long long* idx_cons,  
+		    const double* x, bool new_x, double* cons)
+{
+  for(int itcon=0; itcon<num_cons; itcon++) {
+    assert(idx_cons[itcon]==0);
+    cons[itcon]=0.;
+    for(long long i=0; i<n; i++) cons[itcon] += x[i]*x[i];
+  }
+  return true;
+}
+
+bool Ex5::eval_Jac_cons(const long long& n, const long long& m,
+			const long long& num_cons, const long long* idx_cons,  
+			const double* x, bool new_x, double** Jac) 
+{
+  for(int itcon=0; itcon<num_cons; itcon++)
+    for(long long i=0; i<n; i++) Jac[itcon][i]=2.*x[i];
+  return true;
+}
+
+bool Ex5::get_starting_point(const long long& n, double* x0)
+{
+  for(long long i=0; i<n; i++) x0[i] = i%2==0 ? -1.2 : 1.;
+  return true;
+}
@@ -0,0 +1,48 @@
+#ifndef HIOP_EXAMPLE_EX5
+#define  HIOP_EXAMPLE_EX5
+
+#include "hiopInterface.hpp"
+
+#include <cassert>
+
+#ifdef WITH_MPI
+#include "mpi.h"
+#else
+#define MPI_COMM_SELF 0
+#define MPI_Comm int
+#endif
+
+/* Chained Rosenbrock test problem, whose curved valley makes the line search backtrack; used by the 
+ * driver of the solver's features.
+ *  min   sum { 100*(x_{i+1}-x_i^2)^2 + (1-x_i)^2 : i=1,...,n-1}
+ *  s.t.  sum x_i^2 <= 2*n
+ *        -5 <= x_i <= 5, i=1,...,n
+ * The starting point is x_i=-1.2 for odd i and x_i=1 for even i. The minimum is 0 at x_i=1.
+ * The problem is not distributed.
+ */
+class Ex5 : public hiop::hiopInterfaceDenseConstraints
+{
+public: 
+  Ex5(int n, MPI_Comm comm=MPI_COMM_SELF);
+  virtual ~Ex5() {};
+
+  virtual bool get_prob_sizes(long long& n, long long& m);
+  virtual bool get_vars_info(const long long& n, double *xlow, double* xupp, NonlinearityType* type);
+  virtual bool get_cons_info(const long long& m, double* clow, double* cupp, NonlinearityType* type);
+
+  virtual bool eval_f(const long long& n, const double* x, bool new_x, double& obj_value);
+  virtual bool eval_cons(const long long& n, const long long& m, 
+			 const long long& num_cons, const long long* idx_cons,  
+			 const double* x, bool new_x, double* cons);
+  virtual bool eval_grad_f(const long long& n, const double* x, bool new_x, double* gradf);
+  virtual bool eval_Jac_cons(const long long& n, const long long& m,
+			     const long long& num_cons, const long long* idx_cons,  
+			     const double* x, bool new_x, double** Jac);
+  virtual bool get_MPI_comm(MPI_Comm& comm_out) { comm_out=comm; return true; }
+
+  virtual bool get_starting_point(const long long&n, double* x0);
+private:
+  int n_vars;
+  MPI_Comm comm;
+};
+#endif
@@ -0,0 +1,101 @@
+#include "nlpDenseCons_ex6.hpp"
+
+#include <cmath>
+
+Ex6::Ex6(int n, MPI_Comm comm_)
+  : n_vars(n), comm(comm_)
+{
+  assert(n_vars>=4);
+}
+
+bool Ex6::get_prob_sizes(long long& n, long long& m)
+  { n=n_vars; m=7; return true; }
+
+bool Ex6::get_vars_info(const long long& n, double *xlow, double* xupp, NonlinearityType* type)
+{
+  for(long long i=0; i<n; i++) { xlow[i]=-10.; xupp[i]=10.; type[i]=hiopNonlinear; }
+  xlow[n-1]=xupp[n-1]=2.;
+  return true;
+}
+
+bool Ex6::get_cons_info(const long long& m, double* clow, double* cupp, NonlinearityType* type)
+{
+  assert(m==7);
+  clow[0]=-1e20;      cupp[0]=0.5*n_vars;
+  clow[1]=-1e20;      cupp[1]=n_vars;
+  clow[2]=-n_vars;    cupp[2]=1e20;
+  clow[3]=0.;         cupp[3]=0.;
+  clow[4]=0.;         cupp[4]=0.;
+  clow[5]=-1e20;      cupp[5]=5.;
+  clow[6]=-1e20;      cupp[6]=4.*n_vars;
+  for(int j=0; j<6; j++) type[j]=hiopInterfaceBase::hiopLinear;
+  type[6]=hiopInterfaceBase::hiopNonlinear;
+  return true;
+}
+
+bool Ex6::eval_f(const long long& n, const double* x, bool new_x, double& obj_value)
+{
+  obj_value=0.;
+  for(long long i=0; i<n; i++) obj_value += 0.5*(x[i]-1.)*(x[i]-1.);
+  return true;
+}
+
+bool Ex6::eval_grad_f(const long long& n, const double* x, bool new_x, double* gradf)
+{
+  for(long long i=0; i<n; i++) gradf[i] = x[i]-1.;
+  return true;
+}
+
+bool Ex6::eval_cons(const long long& n, const long long& m, 
+		    const long long& num_cons, const long long* idx_cons,  
+		    const double* x, bool new_x, double* cons)
+{
+  for(int itcon=0; itcon<num_cons; itcon++) {
+    const long long j=idx_cons[itcon];
+    cons[itcon]=0.;
+    if(j<=2) {
+      for(long long i=0; i<n; i++) cons[itcon] += x[i];
+    } else if(j<=4) {
+      cons[itcon] = x[0]-x[1];
+    } else if(j==5) {
+      cons[itcon] = x[n-1];
+    } else {
+      assert(j==6);
+      for(long long i=0; i<n; i++) cons[itcon] += x[i]*x[i];
+    }
+  }
+  return true;
+}
+
+bool Ex6::eval_Jac_cons(const long long& n, const long long& m,
+			const long long& num_cons, const long long* idx_cons,  
+			const double* x, bool new_x, double** Jac) 
+{
+  for(int itcon=0; itcon<num_cons; itcon++) {
+    const long long j=idx_cons[itcon];
+    for(long long i=0; i<n; i++) Jac[itcon][i]=0.;
+    if(j<=2) {
+      for(long long i=0; i<n; i++) Jac[itcon][i]=1.;
+    } else if(j<=4) {
+      Jac[itcon][0]=1.; Jac[itcon][1]=-1.;
+    } else if(j==5) {
+      Jac[itcon][n-1]=1.;
+    } else {
+      for(long long i=0; i<n; i++) Jac[itcon][i]=2.*x[i];
+    }
+  }
+  return true;
+}
+
+bool Ex6::get_starting_point(const long long& n, double* x0)
+{
+  for(long long i=0; i<n; i++) x0[i]=0.;
+  x0[n-1]=2.;
+  return true;
+}
+
+double Ex6::optimal_objective(int n)
+{
+  const double t=(0.5*n-2.)/(n-1);
+  return 0.5*(n-1)*(t-1.)*(t-1.) + 0.5;
+}
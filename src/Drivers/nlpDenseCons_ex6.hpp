@@ -0,0 +1,57 @@
+#ifndef HIOP_EXAMPLE_EX6
+#define  HIOP_EXAMPLE_EX6
+
+#include "hiopInterface.hpp"
+
+#include <cassert>
+
+#ifdef WITH_MPI
+#include "mpi.h"
+#else
+#define MPI_COMM_SELF 0
+#define MPI_Comm int
+#endif
+
+/* Test problem for the presolve, with a fixed variable and duplicated, redundant, and empty linear constraints.
+ *  min   sum { 1/2*(x_i-1)^2 : i=1,...,n}
+ *  s.t.  sum x_i <= n/2                     
+ *        sum x_i <= n            (duplicate of the first constraint, redundant)
+ *        sum x_i >= -n           (duplicate of the first constraint)
+ *        x_1 - x_2 = 0
+ *        x_1 - x_2 = 0           (duplicate)
+ *        x_n <= 5                (empty once x_n is fixed)
+ *        sum x_i^2 <= 4*n        (nonlinear, not presolved)
+ *        -10 <= x_i <= 10, i=1,...,n-1,  x_n = 2
+ * The solution has x_i=(n/2-2)/(n-1) for i<n. The problem is not distributed.
+ */
+class Ex6 : public hiop::hiopInterfaceDenseConstraints
+{
+public: 
+  Ex6(int n, MPI_Comm comm=MPI_COMM_SELF);
+  virtual ~Ex6() {};
+
+  virtual bool get_prob_sizes(long long& n, long long& m);
+  virtual bool get_vars_info(const long long& n, double *xlow, double* xupp, NonlinearityType* type);
+  virtual bool get_cons_info(const long long& m, double* clow, double* cupp, NonlinearityType* type);
+
+  virtual bool eval_f(const long long& n, const double* x, bool new_x, double& obj_value);
+  virtual bool eval_cons(const long long& n, const long long& m, 
+			 const long long& num_cons, const long long* idx_cons,  
+			 const double* x, bool new_x, double* cons);
+  virtual bool eval_grad_f(const long long& n, const double* x, bool new_x, double* gradf);
+  virtual bool eval_Jac_cons(const long long& n, const long long& m,
+			     const long long& num_cons, const long long* idx_cons,  
+			     const double* x, bool new_x, double** Jac);
+  virtual bool get_MPI_comm(MPI_Comm& comm_out) { comm_out=comm; return true; }
+
+  virtual bool get_starting_point(const long long&n, double* x0);
+
+  /* the optimal objective */
+  static double optimal_objective(int n);
+  /* the number of variables and of linear constraints removed by the presolve */
+  static const int num_fixed_vars=1, num_removed_cons=4;
+private:
+  int n_vars;
+  MPI_Comm comm;
+};
+#endif
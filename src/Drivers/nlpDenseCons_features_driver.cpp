@@ -0,0 +1,306 @@
+#include "nlpDenseCons_ex2.hpp"
+#include "nlpDenseCons_ex3.hpp"
+#include "nlpDenseCons_ex5.hpp"
+#include "nlpDenseCons_ex6.hpp"
+#include "hiopNlpFormulation.hpp"
+#include "hiopAlgFilterIPM.hpp"
+
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <string>
+
+using namespace hiop;
+
+/* Regression tests of the optional code paths of the solver. Each feature solves one of the examples with
+ * the options that trigger the feature and, with -selfcheck, checks the solve status, the objective and the 
+ * number of iterations against saved values and that the feature's run statistic is nonzero. */
+
+static void usage(const char* exeName)
+{
+  printf("hiOp driver %s that checks the optional code paths of the solver.\n", exeName);
+  printf("Usage: \n");
+  printf("  '$ %s feature -selfcheck'\n", exeName);
+  printf("Arguments:\n");
+  printf("  'feature': one of soc, restoration, watchdog, mu_update, scaling, freeze, adaptive_memory, sr1, "
+	 "diag_B0, structured, exact, exact_fallback, presolve, wall_time, cancel, checkpoint\n");
+  printf("  '-selfcheck': compares the objective, the number of iterations and the statistic of the feature "
+	 "with previously saved values. [optional]\n");
+}
+
+/* Ex2 that stops the solve at the iteration 'stop_iter' (if not negative) from the iterate callback: the 
+ * cancellation token is triggered or, when 'solver' is set, the wall-clock limit of the solver is lowered below 
+ * the time elapsed so far. The callback keeps the first iteration it sees and the best objective of the iterates 
+ * with primal infeasibility at most 'feas_tol'. */
+class Ex2Stopped : public Ex2
+{
+public:
+  Ex2Stopped(int n, int stop_iter_)
+    : Ex2(n), stop_iter(stop_iter_), token(NULL), solver(NULL), nlp(NULL), feas_tol(1e-6), 
+      iter(-1), first_iter(-1), best_obj(1e20), best_iter(-1) {};
+  virtual bool iterate_callback(int iter_, double obj_value, int n, const double* x, const double* z_L, const double* z_U,
+				int m, const double* g, const double* lambda, double inf_pr, double inf_du, double mu,
+				double alpha_du, double alpha_pr, int ls_trials)
+  {
+    iter=iter_;
+    if(first_iter<0) first_iter=iter;
+    if(inf_pr<=feas_tol && obj_value<best_obj) { best_obj=obj_value; best_iter=iter; }
+    if(stop_iter>=0 && iter==stop_iter) {
+      if(token) token->cancel();
+      if(solver) solver->setMaxWallTime(0.5*nlp->runStats.tmOptimizTotal.getElapsedTimeSinceStart());
+    }
+    return true;
+  }
+  int stop_iter;
+  hiopCancelToken* token;
+  hiopAlgFilterIPM* solver;
+  hiopNlpFormulation* nlp;
+  double feas_tol;
+  int iter, first_iter;
+  double best_obj;
+  int best_iter;
+};
+
+/* Ex2 whose Hessian of the Lagrangian has a NaN at the evaluation 'bad_eval', so that the factorization of 
+ * the KKT system of the exact Hessian fails at that iteration. */
+class Ex2BadHess : public Ex2
+{
+public:
+  Ex2BadHess(int n, int bad_eval_) : Ex2(n), bad_eval(bad_eval_), num_evals(0) {};
+  virtual bool eval_Hess_Lagr(const long long& n, const long long& m, const double* x, bool new_x, 
+			      const double& obj_factor, const double* lambda, bool new_lambda, double** Hess)
+  {
+    bool bret = Ex2::eval_Hess_Lagr(n, m, x, new_x, obj_factor, lambda, new_lambda, Hess);
+    if(num_evals++==bad_eval) Hess[0][0]=NAN;
+    return bret;
+  }
+  int bad_eval, num_evals;
+};
+
+static hiopSolveStatus solve(hiopNlpDenseConstraints& nlp, double& obj_value, int& num_iter)
+{
+  hiopAlgFilterIPM solver(&nlp);
+  hiopSolveStatus status = solver.run();
+  obj_value = solver.getObjective();
+  num_iter = solver.getNumIterations();
+  return status;
+}
+
+static bool self_check(const std::string& feature, hiopSolveStatus status, double obj_value, int num_iter,
+		       const char* stat_name, int stat,
+		       hiopSolveStatus status_saved, double obj_value_saved, int num_iter_saved);
+
+int main(int argc, char **argv)
+{
+  int rank=0;
+#ifdef WITH_MPI
+  MPI_Init(&argc, &argv);
+  assert(MPI_SUCCESS==MPI_Comm_rank(MPI_COMM_WORLD,&rank));
+#endif
+  if(argc<2 || argc>3 || (argc==3 && std::string(argv[2])!="-selfcheck")) { usage(argv[0]); return 1; }
+  std::string feature(argv[1]);
+  bool selfCheck = argc==3;
+
+  hiopSolveStatus status=UnknownNLPSolveStatus, status_saved=Solve_Success;
+  double obj_value=0., obj_value_saved=0.;
+  int num_iter=0, num_iter_saved=0, stat=0;
+  const char* stat_name="";
+  if(feature=="soc") {
+    //the second-order corrections are taken at the larger sizes of Ex2
+    Ex2 ex(30000); hiopNlpDenseConstraints nlp(ex);
+    status = solve(nlp, obj_value, num_iter);
+    stat_name = "accepted second-order corrections"; stat = nlp.runStats.nSOCAccepted;
+    obj_value_saved = 1.56250010008796e-02; num_iter_saved = 34;
+  } else if(feature=="restoration") {
+    Ex2 ex(50000); hiopNlpDenseConstraints nlp(ex);
+    status = solve(nlp, obj_value, num_iter);
+    stat_name = "restoration phases"; stat = nlp.runStats.nRestorationPhases;
+    obj_value_saved = 1.56250010008796e-02; num_iter_saved = 32;
+  } else if(feature=="watchdog") {
+    //the line search backtracks in the curved valley of the Rosenbrock function; 453 iterations without the watchdog
+    Ex5 ex(2); hiopNlpDenseConstraints nlp(ex);
+    nlp.options->SetIntegerValue("watchdog_shortened_iter_trigger", 3);
+    status = solve(nlp, obj_value, num_iter);
+    stat_name = "watchdog activations"; stat = nlp.runStats.nWatchdogActivations;
+    obj_value_saved = 0.; num_iter_saved = 70;
+  } else if(feature=="mu_update") {
+    //the residuals and the log-barrier terms are updated incrementally at each reduction of mu
+    Ex2 ex(5000); hiopNlpDenseConstraints nlp(ex);
+    status = solve(nlp, obj_value, num_iter);
+    stat_name = "barrier reductions"; stat = nlp.runStats.nMuReductions;
+    obj_value_saved = 1.56250010008796e-02; num_iter_saved = 28;
+  } else if(feature=="scaling") {
+    //a small max gradient so that the objective and the constraints are scaled
+    Ex2 ex(5000); hiopNlpDenseConstraints nlp(ex);
+    nlp.options->SetStringValue("scaling_type", "gradient");
+    nlp.options->SetNumericValue("scaling_max_grad", 1e-2);
+    status = solve(nlp, obj_value, num_iter);
+    stat_name = "scaled objective"; stat = nlp.get_obj_scale()<1.;
+    obj_value_saved = 1.56251024095817e-02; num_iter_saved = 25;
+  } else if(feature=="freeze") {
+    //about a sixth of the variables of Ex3 are at their bounds at the solution
+    Ex3 ex(1000, 100); hiopNlpDenseConstraints nlp(ex);
+    nlp.options->SetStringValue("freeze_active_vars", "yes");
+    status = solve(nlp, obj_value, num_iter);
+    stat_name = "active-set freezes"; stat = nlp.runStats.nActiveSetFreezes;
+    obj_value_saved = 1.29221420723414e+02; num_iter_saved = 15;
+  } else if(feature=="adaptive_memory") {
+    Ex2 ex(5000); hiopNlpDenseConstraints nlp(ex);
+    nlp.options->SetStringValue("secant_memory_adaptive", "yes");
+    status = solve(nlp, obj_value, num_iter);
+    stat_name = "secant memory length changes"; stat = nlp.runStats.nSecantMemChanges;
+    obj_value_saved = 1.56250010008796e-02; num_iter_saved = 28;
+  } else if(feature=="sr1") {
+    Ex2 ex(5000); hiopNlpDenseConstraints nlp(ex);
+    nlp.options->SetStringValue("secant_update_type", "sr1");
+    status = solve(nlp, obj_value, num_iter);
+    //the BFGS updates never need an inertia correction
+    stat_name = "SR1 inertia corrections"; stat = nlp.runStats.nSR1InertiaCorr;
+    obj_value_saved = 1.56250010008796e-02; num_iter_saved = 29;
+  } else if(feature=="diag_B0") {
+    //Ex2 provides the diagonal of the Hessian, which is used as B0; B0=sigma*I takes more iterations
+    int num_iter_sigma;
+    {
+      Ex2 ex(5000); hiopNlpDenseConstraints nlp(ex);
+      nlp.options->SetStringValue("secant_B0_user_diag", "no");
+      solve(nlp, obj_value, num_iter_sigma);
+      if(nlp.runStats.nEvalHessDiag>0) num_iter_sigma=-1;
+    }
+    Ex2 ex(5000); hiopNlpDenseConstraints nlp(ex);
+    nlp.options->SetStringValue("secant_B0_user_diag", "yes");
+    status = solve(nlp, obj_value, num_iter);
+    stat_name = "Hessian diagonal evaluations with fewer iterations than B0=sigma*I"; 
+    stat = num_iter<num_iter_sigma ? nlp.runStats.nEvalHessDiag : 0;
+    if(!stat) printf("B0 from the Hessian diagonal: %d iterations, B0=sigma*I: %d iterations\n", num_iter, num_iter_sigma);
+    obj_value_saved = 1.56250010008796e-02; num_iter_saved = 28;
+  } else if(feature=="structured") {
+    Ex2 ex(5000); hiopNlpDenseConstraints nlp(ex);
+    nlp.options->SetStringValue("hessian_mode", "structured");
+    status = solve(nlp, obj_value, num_iter);
+    stat_name = "PCG solves"; stat = nlp.runStats.nPCGSolves;
+    obj_value_saved = 1.56250010008796e-02; num_iter_saved = 22;
+  } else if(feature=="exact") {
+    //the Hessian of the Lagrangian is given by Ex2; the secant updates are not done
+    Ex2 ex(500); hiopNlpDenseConstraints nlp(ex);
+    nlp.options->SetStringValue("hessian_mode", "exact");
+    status = solve(nlp, obj_value, num_iter);
+    stat_name = "solves with the exact Hessian without secant updates"; 
+    stat = nlp.runStats.nEvalHess>0 && 0==nlp.runStats.nHessUpdates;
+    obj_value_saved = 1.56250010008796e-02; num_iter_saved = 23;
+  } else if(feature=="exact_fallback") {
+    //the failed factorization at iteration 5 is replaced by the quasi-Newton system
+    Ex2BadHess ex(500, 5); hiopNlpDenseConstraints nlp(ex);
+    nlp.options->SetStringValue("hessian_mode", "exact");
+    status = solve(nlp, obj_value, num_iter);
+    stat_name = "search direction failures"; stat = nlp.runStats.nDirFailures;
+    obj_value_saved = 1.56250010008796e-02; num_iter_saved = 23;
+  } else if(feature=="presolve") {
+    //one fixed variable, three duplicated and one empty linear constraints; the presolve is done when the 
+    //formulation is created, so its option is passed in an options file
+    const char* options_file="nlpDenseCons_features_presolve.options";
+    FILE* f=fopen(options_file, "w");
+    if(f) { fprintf(f, "presolve yes\n"); fclose(f); }
+    Ex6 ex(100); hiopNlpDenseConstraints nlp(ex, options_file);
+    remove(options_file);
+    status = solve(nlp, obj_value, num_iter);
+    stat_name = "presolve with the expected numbers of removed variables and constraints";
+    stat = nlp.n_presolved_vars()==Ex6::num_fixed_vars && nlp.n_presolved_cons()==Ex6::num_removed_cons;
+    if(!stat) printf("presolve removed %lld variables and %lld constraints\n", nlp.n_presolved_vars(), nlp.n_presolved_cons());
+    obj_value_saved = Ex6::optimal_objective(100); num_iter_saved = 8;
+  } else if(feature=="wall_time") {
+    //the wall-clock limit is lowered to half of the elapsed time at iteration 18, whose iterate is not feasible
+    Ex2Stopped ex(5000, 18); hiopNlpDenseConstraints nlp(ex);
+    nlp.options->SetNumericValue("max_wall_time", 1e+3);
+    ex.feas_tol = nlp.options->GetNumeric("acceptable_tolerance");
+    hiopAlgFilterIPM solver(&nlp);
+    ex.solver = &solver; ex.nlp = &nlp;
+    status = solver.run();
+    obj_value = solver.getObjective(); num_iter = solver.getNumIterations();
+    //the objective of the iterate returned needs to be the one of the best feasible iterate, not within a tolerance
+    stat_name = "returns of the best feasible iterate"; stat = ex.best_iter>=0 && ex.best_iter<num_iter && obj_value==ex.best_obj;
+    status_saved = Max_CpuTime_Exceeded; obj_value_saved = ex.best_obj; num_iter_saved = 18;
+  } else if(feature=="cancel") {
+    //the solve is cancelled at iteration 25, whose iterate is not feasible
+    Ex2Stopped ex(5000, 25); hiopNlpDenseConstraints nlp(ex);
+    ex.feas_tol = nlp.options->GetNumeric("acceptable_tolerance");
+    hiopAlgFilterIPM solver(&nlp);
+    ex.token = &solver.getCancelToken();
+    status = solver.run();
+    obj_value = solver.getObjective(); num_iter = solver.getNumIterations();
+    //as above, the objective is compared exactly
+    stat_name = "returns of the best feasible iterate"; stat = ex.best_iter>=0 && ex.best_iter<num_iter && obj_value==ex.best_obj;
+    status_saved = User_Stopped; obj_value_saved = ex.best_obj; num_iter_saved = 25;
+  } else if(feature=="checkpoint") {
+    //an uninterrupted solve, a solve cancelled at iteration 15 after the checkpoint of iteration 10, and its restart
+    const char* checkpoint_file="nlpDenseCons_features_checkpoint";
+    double obj_value_ref; int num_iter_ref;
+    {
+      Ex2 ex(5000); hiopNlpDenseConstraints nlp(ex);
+      solve(nlp, obj_value_ref, num_iter_ref);
+    }
+    {
+      Ex2Stopped ex(5000, 15); hiopNlpDenseConstraints nlp(ex);
+      nlp.options->SetIntegerValue("checkpoint_interval", 10);
+      nlp.options->SetStringValue("checkpoint_file", checkpoint_file);
+      hiopAlgFilterIPM solver(&nlp);
+      ex.token = &solver.getCancelToken();
+      solver.run();
+    }
+    Ex2Stopped ex(5000, -1); hiopNlpDenseConstraints nlp(ex);
+    nlp.options->SetStringValue("checkpoint_file", checkpoint_file);
+    nlp.options->SetStringValue("checkpoint_restart", "yes");
+    status = solve(nlp, obj_value, num_iter);
+    remove((std::string(checkpoint_file)+".0").c_str());
+    //the restarted solve gives the same iterates as the uninterrupted one
+    stat_name = "restarts at iteration 10 that reproduce the uninterrupted solve";
+    stat = ex.first_iter==10 && obj_value==obj_value_ref && num_iter==num_iter_ref;
+    if(!stat) printf("restart at iteration %d: objective %18.12e and %d iterations, uninterrupted: %18.12e and %d iterations\n",
+		     ex.first_iter, obj_value, num_iter, obj_value_ref, num_iter_ref);
+    obj_value_saved = 1.56250010008796e-02; num_iter_saved = 28;
+  } else {
+    usage(argv[0]); return 1;
+  }
+
+  if(selfCheck) {
+    if(!self_check(feature, status, obj_value, num_iter, stat_name, stat, status_saved, obj_value_saved, num_iter_saved))
+      return -1;
+  } else {
+    if(rank==0)
+      printf("Objective: %22.14e. Solver status: %d. Iterations: %d. %s: %d\n", obj_value, status, num_iter, stat_name, stat);
+  }
+
+#ifdef WITH_MPI
+  MPI_Finalize();
+#endif
+
+  return 0;
+}
+
+static bool self_check(const std::string& feature, hiopSolveStatus status, double obj_value, int num_iter,
+		       const char* stat_name, int stat,
+		       hiopSolveStatus status_saved, double obj_value_saved, int num_iter_saved)
+{
+#define relerr 1e-6
+  //a couple of iterations of slack for the differences in the floating-point roundoff of the platforms
+#define iter_slack 2
+  if(status!=status_saved) {
+    printf("selfcheck failure. Solver status %d instead of %d for the feature '%s'.\n", status, status_saved, feature.c_str());
+    return false;
+  }
+  if(fabs( (obj_value_saved-obj_value)/(1+obj_value_saved)) > relerr) {
+    printf("selfcheck failure. Objective (%18.12e) does not agree (%d digits) with the saved value (%18.12e) for the feature '%s'.\n",
+	   obj_value, -(int)log10(relerr), obj_value_saved, feature.c_str());
+    return false;
+  }
+  if(abs(num_iter-num_iter_saved) > iter_slack) {
+    printf("selfcheck failure. %d iterations instead of %d (+/-%d) for the feature '%s'.\n",
+	   num_iter, num_iter_saved, iter_slack, feature.c_str());
+    return false;
+  }
+  if(stat<=0) {
+    printf("selfcheck failure. No %s for the feature '%s'.\n", stat_name, feature.c_str());
+    return false;
+  }
+  printf("selfcheck success (%d digits, %d iterations, %d %s)\n",  -(int)log10(relerr), num_iter, stat, stat_name);
+  return true;
+}
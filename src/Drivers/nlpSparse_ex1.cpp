@@ -0,0 +1,125 @@
+#include "nlpSparse_ex1.hpp"
+
+#include <cmath>
+#include <cstdio>
+
+SparseEx1::SparseEx1(int n)
+  : n_vars(n), n_cons(n-1), h(n/2)
+{
+  assert(n>=4 && n%2==0);
+}
+SparseEx1::~SparseEx1()
+{
+}
+
+bool SparseEx1::get_prob_sizes(long long& n, long long& m)
+  { n=n_vars; m=n_cons; return true; }
+
+bool SparseEx1::get_vars_info(const long long& n, double *xlow, double* xupp, NonlinearityType* type)
+{
+  assert(n==n_vars);
+  for(long long i=0; i<n; i++) {
+    if(i%2==0) { xlow[i]=-2.;   xupp[i]=1e20; }
+    else       { xlow[i]=-1e20; xupp[i]=5.;   }
+    type[i]=hiopNonlinear;
+  }
+  return true;
+}
+bool SparseEx1::get_cons_info(const long long& m, double* clow, double* cupp, NonlinearityType* type)
+{
+  assert(m==n_cons);
+  for(long long c=0; c<m; c++) {
+    if(is_eq(c)) { clow[c]= 1.; cupp[c]=1.; type[c]=hiopNonlinear; }
+    else         { clow[c]=-1.; cupp[c]=1.; type[c]=hiopLinear; }
+  }
+  return true;
+}
+bool SparseEx1::get_sparse_blocks_info(long long& nnz_jac, long long& nnz_hess_lagr)
+{
+  nnz_jac = 3*(h-1) + 2*h;
+  nnz_hess_lagr = n_vars + n_vars-1;
+  return true;
+}
+
+bool SparseEx1::eval_f(const long long& n, const double* x, bool new_x, double& obj_value)
+{
+  obj_value=0.;
+  for(long long i=0; i<n; i++) {
+    obj_value += 0.25*pow(x[i]-1., 4);
+    obj_value += (i%2==0 ? 0.2 : -0.2)*x[i];
+  }
+  for(long long i=0; i<n-1; i++) obj_value += 0.5*(x[i+1]-x[i])*(x[i+1]-x[i]);
+  return true;
+}
+bool SparseEx1::eval_grad_f(const long long& n, const double* x, bool new_x, double* gradf)
+{
+  for(long long i=0; i<n; i++) gradf[i] = pow(x[i]-1., 3) + (i%2==0 ? 0.2 : -0.2);
+  for(long long i=0; i<n-1; i++) {
+    gradf[i]   -= x[i+1]-x[i];
+    gradf[i+1] += x[i+1]-x[i];
+  }
+  return true;
+}
+
+bool SparseEx1::eval_cons(const long long& n, const long long& m, 
+			  const long long& num_cons, const long long* idx_cons,  
+			  const double* x, bool new_x, double* cons)
+{
+  assert(n==n_vars); assert(m==n_cons);
+  for(long long it=0; it<num_cons; it++) {
+    const long long c=idx_cons[it], k=c/2;
+    if(is_eq(c)) cons[it] = x[2*k]*x[2*k] + x[2*k+1] - x[2*k+2];
+    else         cons[it] = x[k] - x[k+h];
+  }
+  return true;
+}
+
+bool SparseEx1::eval_Jac_cons(const long long& n, const long long& m, const double* x, bool new_x,
+			      const long long& nnz, int* iRow, int* jCol, double* MJac)
+{
+  assert(n==n_vars); assert(m==n_cons);
+  long long nz=0;
+  for(long long c=0; c<m; c++) {
+    const long long k=c/2;
+    if(is_eq(c)) {
+      if(iRow) { 
+	iRow[nz]=c; jCol[nz]=2*k; iRow[nz+1]=c; jCol[nz+1]=2*k+1; iRow[nz+2]=c; jCol[nz+2]=2*k+2; 
+      } else {
+	MJac[nz]=2*x[2*k]; MJac[nz+1]=1.; MJac[nz+2]=-1.;
+      }
+      nz+=3;
+    } else {
+      if(iRow) { iRow[nz]=c; jCol[nz]=k; iRow[nz+1]=c; jCol[nz+1]=k+h; }
+      else     { MJac[nz]=1.; MJac[nz+1]=-1.; }
+      nz+=2;
+    }
+  }
+  assert(nz==nnz);
+  return true;
+}
+
+bool SparseEx1::eval_Hess_Lagr(const long long& n, const long long& m, const double* x, bool new_x, 
+			       const double& obj_factor, const double* lambda, bool new_lambda, 
+			       const long long& nnz, int* iRow, int* jCol, double* MHess)
+{
+  assert(n==n_vars); assert(m==n_cons);
+  //the diagonal entries first, then the subdiagonal ones 
+  if(iRow) {
+    for(long long i=0; i<n; i++)   { iRow[i]=i; jCol[i]=i; }
+    for(long long i=0; i<n-1; i++) { iRow[n+i]=i+1; jCol[n+i]=i; }
+    return true;
+  }
+  for(long long i=0; i<n; i++) 
+    MHess[i] = obj_factor*(3*pow(x[i]-1.,2) + (i==0 || i==n-1 ? 1. : 2.));
+  for(long long i=0; i<n-1; i++) MHess[n+i] = -obj_factor;
+  //the equalities contribute to the diagonal entries of x_{2k}
+  for(long long c=0; c<m; c++)
+    if(is_eq(c)) MHess[c] += 2*lambda[c];
+  return true;
+}
+
+bool SparseEx1::get_starting_point(const long long& n, double* x0)
+{
+  for(long long i=0; i<n; i++) x0[i]=0.5;
+  return true;
+}
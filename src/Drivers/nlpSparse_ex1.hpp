@@ -0,0 +1,54 @@
+#ifndef HIOP_EXAMPLE_SPARSE_EX1
+#define  HIOP_EXAMPLE_SPARSE_EX1
+
+#include "hiopInterface.hpp"
+
+#include <cassert>
+
+#ifdef WITH_MPI
+#include "mpi.h"
+#else
+#define MPI_COMM_WORLD 0
+#define MPI_Comm int
+#endif
+
+/* Test problem with sparse constraints of all types and a nonconvex Lagrangian (n even, h=n/2).
+ *  min   sum 1/4* { (x_{i}-1)^4 : i=0,...,n-1} + 1/2* sum { (x_{i+1}-x_i)^2 : i=0,...,n-2} 
+ *                 + 0.2 * sum { x_{i} : i even} - 0.2 * sum { x_{i} : i odd}
+ *  s.t.  
+ *        x_{2k}^2 + x_{2k+1} - x_{2k+2} = 1,  k=0,...,h-2
+ *        -1 <= x_{k} - x_{k+h} <= 1,          k=0,...,h-1
+ *        -2 <= x_i, i even
+ *        x_i <= 5, i odd
+ *  The constraints are interleaved: the constraint 2k is the k-th equality and 2k+1 is the k-th inequality;
+ *  the last constraint is the inequality h-1.
+ */
+class SparseEx1 : public hiop::hiopInterfaceSparse
+{
+public: 
+  SparseEx1(int n);
+  virtual ~SparseEx1();
+
+  virtual bool get_prob_sizes(long long& n, long long& m);
+  virtual bool get_vars_info(const long long& n, double *xlow, double* xupp, NonlinearityType* type);
+  virtual bool get_cons_info(const long long& m, double* clow, double* cupp, NonlinearityType* type);
+  virtual bool get_sparse_blocks_info(long long& nnz_jac, long long& nnz_hess_lagr);
+
+  virtual bool eval_f(const long long& n, const double* x, bool new_x, double& obj_value);
+  virtual bool eval_cons(const long long& n, const long long& m, 
+			 const long long& num_cons, const long long* idx_cons,  
+			 const double* x, bool new_x, double* cons);
+  virtual bool eval_grad_f(const long long& n, const double* x, bool new_x, double* gradf);
+  virtual bool eval_Jac_cons(const long long& n, const long long& m, const double* x, bool new_x,
+			     const long long& nnz, int* iRow, int* jCol, double* MJac);
+  virtual bool eval_Hess_Lagr(const long long& n, const long long& m, const double* x, bool new_x, 
+			      const double& obj_factor, const double* lambda, bool new_lambda, 
+			      const long long& nnz, int* iRow, int* jCol, double* MHess);
+
+  virtual bool get_starting_point(const long long&n, double* x0);
+private:
+  int n_vars, n_cons, h;
+  //whether the constraint c is an equality; its index k among the equalities or inequalities is c/2
+  inline bool is_eq(long long c) const { return c%2==0 && c/2<h-1; }
+};
+#endif
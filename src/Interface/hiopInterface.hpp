@@ -175,6 +175,14 @@ public:
   virtual bool get_vecdistrib_info(long long global_n, long long* cols) {
     return false; //defaults to serial 
   }
+  /** load balancing (option 'repartition_iter'): hiop proposes a new column partitioning 'cols' of the 
+   *  variables, computed from the time each rank spent in the evaluations. Return true to accept it, in which 
+   *  case all the subsequent calls, including get_vars_info, use the new partitioning. All the ranks need to 
+   *  return the same value. The default keeps the current partitioning.
+   */
+  virtual bool repartition_vecdistrib(long long global_n, const long long* cols) {
+    return false;
+  }
 
   /* To provide a primal starting point. This point is subject to adjustments internally in hiOP.
    * ToDo: provide API for a full, primal-dual restart. 
@@ -236,6 +244,92 @@ public:
 			     const long long& num_cons, const long long* idx_cons,  
 			     const double* x, bool new_x,
 			     double** Jac) = 0;
+
+  /** Optional: a diagonal estimate of the Hessian of the Lagrangian at x, for example, the exact Hessian 
+   *  of a separable objective when the constraints are linear. When provided, it is used as the initial
+   *  matrix B0 of the quasi-Newton approximation instead of a multiple of the identity. Entries that are 
+   *  not positive mean that no curvature information is available for the corresponding variables.
+   *  When MPI enabled, each rank computes only the local entries.
+   *  Return false (the default) if such an estimate is not available.
+   */
+  virtual bool eval_Hess_diag(const long long& n, const double* x, bool new_x, double* diag) { return false; }
+
+  /** Optional: the product Hv of the Hessian of the objective at x with the vector v. It is needed by the
+   *  structured Hessian mode (option 'hessian_mode' set to 'structured'), in which only the curvature of 
+   *  the constraints is approximated by secant updates. In this mode, eval_Hess_diag, when provided, should
+   *  return the diagonal of the Hessian of the objective; it is used for preconditioning.
+   *  When MPI enabled, v and Hv are the local entries.
+   *  Return false (the default) if the product is not available.
+   */
+  virtual bool eval_Hess_f_vec(const long long& n, const double* x, bool new_x, const double* v, double* Hv) { return false; }
+
+  /** Optional: the Hessian of the Lagrangian, obj_factor*Hess_f + sum{lambda_i*Hess_c_i}, as a dense nxn 
+   *  matrix (both triangles), with lambda in the order of the constraints of 'eval_cons'. It is needed by 
+   *  the exact Hessian mode (option 'hessian_mode' set to 'exact'), which is intended for problems of 
+   *  moderate size (n up to a few tens of thousands) solved on one rank.
+   *  Return false (the default) if the Hessian is not available.
+   */
+  virtual bool eval_Hess_Lagr(const long long& n, const long long& m, const double* x, bool new_x, 
+			      const double& obj_factor, const double* lambda, bool new_lambda, double** Hess) { return false; }
+};
+
+/** Specialized interface for NLPs with a small number of global constraints, as in hiopInterfaceDenseConstraints,
+ *  and (possibly many) local constraints, each involving only variables owned by one MPI rank, for example, 
+ *  the constraints of the scenarios of a stochastic problem distributed over the ranks. Each rank declares and
+ *  evaluates only its local constraints; their Jacobian is a dense matrix with the local columns, which is 
+ *  never communicated. The Jacobian of the global constraints and the methods of the base classes are as in
+ *  hiopInterfaceDenseConstraints (get_prob_sizes, get_cons_info, eval_cons, and eval_Jac_cons refer to the 
+ *  global constraints only). The variables need to be distributed (get_vecdistrib_info) when MPI is enabled.
+ *
+ *  In the solution and iterate callbacks, the constraints and their multipliers are ordered as the global 
+ *  ones followed by the local constraints of each rank, in the order of the ranks.
+ */
+class hiopInterfaceBlockConstraints : public hiopInterfaceDenseConstraints
+{
+public:
+  hiopInterfaceBlockConstraints() {};
+  virtual ~hiopInterfaceBlockConstraints() {};
+
+  /** number of the local constraints of the calling rank */
+  virtual bool get_local_cons_sizes(long long& m_local) = 0;
+  /** bounds and types of the local constraints of the calling rank (as in get_cons_info) */
+  virtual bool get_local_cons_info(const long long& m_local, double* clow, double* cupp, NonlinearityType* type) = 0;
+  /** evaluates all the local constraints of the calling rank; x contains the n_local local variables */
+  virtual bool eval_local_cons(const long long& n_local, const long long& m_local, 
+			       const double* x, bool new_x, double* cons) = 0;
+  /** Jacobian of the local constraints with respect to the local variables, Jac[i][j]=d cons_i/d x_j */
+  virtual bool eval_local_Jac_cons(const long long& n_local, const long long& m_local, 
+				   const double* x, bool new_x, double** Jac) = 0;
+};
+
+/** Specialized interface for NLPs with sparse Jacobian and Hessian, for example, network problems with 
+ *  a large number of constraints, each involving few variables. The derivatives are given in coordinate
+ *  (triplet) format: the sparsity pattern is requested once, with the array of values set to NULL, and 
+ *  the subsequent calls pass NULL row and column arrays and expect the values in the order of the pattern.
+ *  Duplicated entries are summed. 
+ *  The problem is not distributed: when MPI enabled, every rank works with the entire problem.
+ */
+class hiopInterfaceSparse : public hiopInterfaceBase 
+{
+public:
+  hiopInterfaceSparse() {};
+  virtual ~hiopInterfaceSparse() {};
+
+  /** number of nonzeros in the Jacobian of the constraints and in the lower triangle of the Hessian of 
+   *  the Lagrangian */
+  virtual bool get_sparse_blocks_info(long long& nnz_jac, long long& nnz_hess_lagr) = 0;
+
+  /** Jacobian of the m constraints, in the order of 'eval_cons', with 'nnz' entries: 
+   *  the pattern (iRow[k],jCol[k]) when MJac is NULL, otherwise the values MJac[k] */
+  virtual bool eval_Jac_cons(const long long& n, const long long& m, const double* x, bool new_x,
+			     const long long& nnz, int* iRow, int* jCol, double* MJac) = 0;
+
+  /** lower triangle of the Hessian of the Lagrangian, obj_factor*Hess_f + sum{lambda_i*Hess_c_i}, with
+   *  'nnz' entries, given as in 'eval_Jac_cons' (the entries with iRow[k]<jCol[k] are taken as the 
+   *  symmetric ones) */
+  virtual bool eval_Hess_Lagr(const long long& n, const long long& m, const double* x, bool new_x, 
+			      const double& obj_factor, const double* lambda, bool new_lambda, 
+			      const long long& nnz, int* iRow, int* jCol, double* MHess) = 0;
 };
 
 }
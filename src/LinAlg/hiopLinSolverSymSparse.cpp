@@ -0,0 +1,434 @@
+// Copyright (c) 2017, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory (LLNL).
+// Written by Cosmin G. Petra, petra1@llnl.gov.
+// LLNL-CODE-742473. All rights reserved.
+//
+// This file is part of HiOp. For details, see https://github.com/LLNL/hiop. HiOp 
+// is released under the BSD 3-clause license (https://opensource.org/licenses/BSD-3-Clause). 
+// Please also read “Additional BSD Notice” below.
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+// i. Redistributions of source code must retain the above copyright notice, this list 
+// of conditions and the disclaimer below.
+// ii. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the disclaimer (as noted below) in the documentation and/or 
+// other materials provided with the distribution.
+// iii. Neither the name of the LLNS/LLNL nor the names of its contributors may be used to 
+// endorse or promote products derived from this software without specific prior written 
+// permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY 
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES 
+// OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT 
+// SHALL LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR 
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS 
+// OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Additional BSD Notice
+// 1. This notice is required to be provided under our contract with the U.S. Department 
+// of Energy (DOE). This work was produced at Lawrence Livermore National Laboratory under 
+// Contract No. DE-AC52-07NA27344 with the DOE.
+// 2. Neither the United States Government nor Lawrence Livermore National Security, LLC 
+// nor any of their employees, makes any warranty, express or implied, or assumes any 
+// liability or responsibility for the accuracy, completeness, or usefulness of any 
+// information, apparatus, product, or process disclosed, or represents that its use would
+// not infringe privately-owned rights.
+// 3. Also, reference herein to any specific commercial products, process, or services by 
+// trade name, trademark, manufacturer or otherwise does not necessarily constitute or 
+// imply its endorsement, recommendation, or favoring by the United States Government or 
+// Lawrence Livermore National Security, LLC. The views and opinions of authors expressed 
+// herein do not necessarily state or reflect those of the United States Government or 
+// Lawrence Livermore National Security, LLC, and shall not be used for advertising or 
+// product endorsement purposes.
+
+#include "hiopLinSolverSymSparse.hpp"
+
+#include "blasdefs.hpp"
+
+#include <cmath>
+#include <cassert>
+
+namespace hiop
+{
+
+hiopLinSolverSymSparse::hiopLinSolverSymSparse()
+  : n(0), nnz(0), nsuper(0), nnz_factors(0), max_front(0), max_stack(0), npos(0), nneg(0), pivot_tol(1e-14)
+{
+}
+
+hiopLinSolverSymSparse::~hiopLinSolverSymSparse()
+{
+}
+
+void hiopLinSolverSymSparse::analyze(int n_, const int* irow, const int* jcol)
+{
+  n=n_; nnz=irow[n];
+
+  /* fill-reducing ordering, followed by a postorder of the elimination tree, which does not change 
+   * the fill-in but makes the columns of the supernodes consecutive */
+  orderMinDegree(n, irow, jcol, perm);
+  iperm.resize(n);
+  for(int k=0; k<n; k++) iperm[perm[k]]=k;
+
+  std::vector<int> pirow, pjcol, map, parent, post;
+  permutePattern(n, irow, jcol, iperm, pirow, pjcol, map);
+  eliminationTree(n, pirow, pjcol, parent);
+  postorder(n, parent, post);
+  std::vector<int> perm_post(n);
+  for(int k=0; k<n; k++) perm_post[k]=perm[post[k]];
+  perm.swap(perm_post);
+  for(int k=0; k<n; k++) iperm[perm[k]]=k;
+  permutePattern(n, irow, jcol, iperm, pirow, pjcol, map);
+  eliminationTree(n, pirow, pjcol, parent);
+
+  /* column counts of L from the row subtrees of the elimination tree */
+  std::vector<int> colcount(n, 1), mark(n, -1), nchild(n, 0);
+  for(int r=0; r<n; r++) {
+    mark[r]=r;
+    for(int p=pirow[r]; p<pirow[r+1]; p++)
+      for(int i=pjcol[p]; mark[i]!=r; i=parent[i]) {
+	colcount[i]++; mark[i]=r;
+      }
+    if(parent[r]>=0) nchild[parent[r]]++;
+  }
+
+  /* fundamental supernodes */
+  sup_first.clear(); sup_first.push_back(0);
+  col2sup.assign(n, 0);
+  for(int j=1; j<n; j++) {
+    if(!(parent[j-1]==j && colcount[j-1]==colcount[j]+1 && nchild[j]==1)) sup_first.push_back(j);
+    col2sup[j]=sup_first.size()-1;
+  }
+  nsuper = n>0 ? sup_first.size() : 0;
+  sup_first.resize(nsuper+1); sup_first[nsuper]=n;
+  sup_parent.assign(nsuper, -1);
+  sup_rowptr.assign(nsuper+1, 0);
+  for(int s=0; s<nsuper; s++) {
+    const int last=sup_first[s+1]-1;
+    if(parent[last]>=0) sup_parent[s]=col2sup[parent[last]];
+    sup_rowptr[s+1]=sup_rowptr[s]+colcount[sup_first[s]];
+  }
+
+  /* row indexes of the fronts: the columns of the supernode followed by the rows below it */
+  sup_rows.resize(sup_rowptr[nsuper]);
+  std::vector<int> pos(nsuper), supmark(nsuper, -1);
+  for(int s=0; s<nsuper; s++) {
+    int q=sup_rowptr[s];
+    for(int j=sup_first[s]; j<sup_first[s+1]; j++) sup_rows[q++]=j;
+    pos[s]=q;
+  }
+  mark.assign(n, -1);
+  for(int r=0; r<n; r++) {
+    mark[r]=r;
+    for(int p=pirow[r]; p<pirow[r+1]; p++)
+      for(int i=pjcol[p]; mark[i]!=r; i=parent[i]) {
+	const int s=col2sup[i];
+	if(r>=sup_first[s+1] && supmark[s]!=r) { sup_rows[pos[s]++]=r; supmark[s]=r; }
+	mark[i]=r;
+      }
+  }
+#ifndef NDEBUG
+  for(int s=0; s<nsuper; s++) assert(pos[s]==sup_rowptr[s+1]);
+#endif
+
+  /* the permuted matrix by columns, used in the assembly of the fronts */
+  Acolptr.assign(n+1, 0);
+  for(int p=0; p<nnz; p++) Acolptr[pjcol[p]+1]++;
+  for(int j=0; j<n; j++) Acolptr[j+1]+=Acolptr[j];
+  Arowind.resize(nnz); Amap.resize(nnz);
+  std::vector<int> next(Acolptr.begin(), Acolptr.end()-1), pos_col(nnz);
+  for(int r=0; r<n; r++)
+    for(int p=pirow[r]; p<pirow[r+1]; p++) {
+      const int q=next[pjcol[p]]++;
+      Arowind[q]=r; pos_col[p]=q;
+    }
+  for(int k=0; k<nnz; k++) Amap[k]=pos_col[map[k]];
+  Avals.resize(nnz);
+
+  /* storage of the factors and of the fronts; the stack of update matrices is simulated to find its peak */
+  sup_Lptr.assign(nsuper+1, 0);
+  nnz_factors=0; max_front=0; max_stack=0;
+  std::vector<int> stk;
+  long long stack_size=0;
+  for(int s=0; s<nsuper; s++) {
+    const long long k=sup_first[s+1]-sup_first[s], f=sup_rowptr[s+1]-sup_rowptr[s], b=f-k;
+    sup_Lptr[s+1]=sup_Lptr[s]+f*k;
+    nnz_factors += f*k-k*(k-1)/2;
+    if(f*f>max_front) max_front=f*f;
+    while(!stk.empty() && sup_parent[stk.back()]==s) {
+      const long long bt=sup_rowptr[stk.back()+1]-sup_rowptr[stk.back()]-(sup_first[stk.back()+1]-sup_first[stk.back()]);
+      stack_size -= bt*bt; stk.pop_back();
+    }
+    if(b>0) { stk.push_back(s); stack_size+=b*b; }
+    if(stack_size>max_stack) max_stack=stack_size;
+  }
+  L.resize(sup_Lptr[nsuper]);
+  D.resize(n);
+  front.resize(max_front>0 ? max_front : 1);
+  stack.resize(max_stack>0 ? max_stack : 1);
+  relpos.assign(n, -1);
+}
+
+int hiopLinSolverSymSparse::factorize(const double* vals)
+{
+  for(int p=0; p<nnz; p++) Avals[p]=0.;
+  for(int k=0; k<nnz; k++) Avals[Amap[k]] += vals[k];
+  //the pivots are tested relative to the largest entry of their column
+  std::vector<double> amax(n, 0.);
+  for(int j=0; j<n; j++) 
+    for(int p=Acolptr[j]; p<Acolptr[j+1]; p++) {
+      const double a=fabs(Avals[p]);
+      if(a>amax[j]) amax[j]=a;
+      if(a>amax[Arowind[p]]) amax[Arowind[p]]=a;
+    }
+
+  npos=nneg=0;
+  std::vector<int> stk;         //supernodes with update matrices on the stack
+  std::vector<long long> stk_off; //and their offsets in the stack
+  long long stack_top=0;
+  std::vector<double> W;
+  for(int s=0; s<nsuper; s++) {
+    const int first=sup_first[s], k=sup_first[s+1]-first, f=sup_rowptr[s+1]-sup_rowptr[s], b=f-k;
+    const int* rows=&sup_rows[sup_rowptr[s]];
+    for(int a=0; a<f; a++) relpos[rows[a]]=a;
+    double* F=&front[0];
+    for(long long a=0; a<(long long)f*f; a++) F[a]=0.;
+
+    //assemble the entries of the matrix 
+    for(int jj=0; jj<k; jj++)
+      for(int p=Acolptr[first+jj]; p<Acolptr[first+jj+1]; p++)
+	F[relpos[Arowind[p]]+(long long)jj*f] += Avals[p];
+
+    //extend-add the update matrices of the children (on the top of the stack)
+    while(!stk.empty() && sup_parent[stk.back()]==s) {
+      const int t=stk.back(), kt=sup_first[t+1]-sup_first[t], bt=sup_rowptr[t+1]-sup_rowptr[t]-kt;
+      const int* trows=&sup_rows[sup_rowptr[t]+kt];
+      const double* U=&stack[stk_off.back()];
+      for(int cb=0; cb<bt; cb++) {
+	const long long jf=(long long)relpos[trows[cb]]*f;
+	for(int ra=cb; ra<bt; ra++) F[relpos[trows[ra]]+jf] += U[ra+(long long)cb*bt];
+      }
+      stack_top=stk_off.back();
+      stk.pop_back(); stk_off.pop_back();
+    }
+
+    //partial factorization of the first k columns of the front
+    for(int j=0; j<k; j++) {
+      double* Fj=F+(long long)j*f;
+      const double d=Fj[j];
+      if(fabs(d)<=pivot_tol*amax[first+j] || !std::isfinite(d)) return -1;
+      D[first+j]=d;
+      if(d>0) npos++; else nneg++;
+      for(int jj=j+1; jj<k; jj++) {
+	const double c=Fj[jj];
+	double* Fjj=F+(long long)jj*f;
+	for(int i=jj; i<f; i++) Fjj[i] -= Fj[i]*c/d;
+      }
+      for(int i=j+1; i<f; i++) Fj[i] /= d;
+    }
+    //the update matrix F22 -= L21*D*L21^T
+    if(b>0) {
+      W.resize((long long)b*k);
+      for(int j=0; j<k; j++)
+	for(int i=0; i<b; i++) W[i+(long long)j*b] = F[k+i+(long long)j*f]*D[first+j];
+      char transA='N', transB='T'; double minusone=-1., one=1.; int ldf=f, ldw=b, b_=b, k_=k;
+      DGEMM(&transA, &transB, &b_, &b_, &k_, &minusone, F+k, &ldf, &W[0], &ldw, &one, F+k+(long long)k*f, &ldf);
+    }
+    //save the panel of L and push the update matrix
+    double* Ls=&L[sup_Lptr[s]];
+    for(long long a=0; a<(long long)f*k; a++) Ls[a]=F[a];
+    if(b>0) {
+      double* U=&stack[stack_top];
+      for(int j=0; j<b; j++)
+	for(int i=j; i<b; i++) U[i+(long long)j*b]=F[k+i+(long long)(k+j)*f];
+      stk.push_back(s); stk_off.push_back(stack_top);
+      stack_top += (long long)b*b;
+      assert(stack_top<=max_stack);
+    }
+  }
+  return nneg;
+}
+
+void hiopLinSolverSymSparse::solve(double* rhs)
+{
+  std::vector<double> y(n);
+  for(int k=0; k<n; k++) y[k]=rhs[perm[k]];
+  //L*z=y
+  for(int s=0; s<nsuper; s++) {
+    const int first=sup_first[s], k=sup_first[s+1]-first, f=sup_rowptr[s+1]-sup_rowptr[s];
+    const int* rows=&sup_rows[sup_rowptr[s]];
+    const double* Ls=&L[sup_Lptr[s]];
+    for(int j=0; j<k; j++) {
+      const double yj=y[first+j];
+      if(yj==0.) continue;
+      const double* Lj=Ls+(long long)j*f;
+      for(int i=j+1; i<f; i++) y[rows[i]] -= Lj[i]*yj;
+    }
+  }
+  for(int j=0; j<n; j++) y[j] /= D[j];
+  //L^T*x=z
+  for(int s=nsuper-1; s>=0; s--) {
+    const int first=sup_first[s], k=sup_first[s+1]-first, f=sup_rowptr[s+1]-sup_rowptr[s];
+    const int* rows=&sup_rows[sup_rowptr[s]];
+    const double* Ls=&L[sup_Lptr[s]];
+    for(int j=k-1; j>=0; j--) {
+      const double* Lj=Ls+(long long)j*f;
+      double sum=0.;
+      for(int i=j+1; i<f; i++) sum += Lj[i]*y[rows[i]];
+      y[first+j] -= sum;
+    }
+  }
+  for(int k=0; k<n; k++) rhs[perm[k]]=y[k];
+}
+
+void hiopLinSolverSymSparse::permutePattern(int n, const int* irow, const int* jcol, const std::vector<int>& iperm,
+					    std::vector<int>& pirow, std::vector<int>& pjcol, std::vector<int>& map)
+{
+  const int nnz=irow[n];
+  pirow.assign(n+1, 0); pjcol.resize(nnz); map.resize(nnz);
+  for(int i=0; i<n; i++)
+    for(int p=irow[i]; p<irow[i+1]; p++) {
+      const int pi=iperm[i], pj=iperm[jcol[p]];
+      pirow[(pi>pj ? pi : pj)+1]++;
+    }
+  for(int i=0; i<n; i++) pirow[i+1]+=pirow[i];
+  std::vector<int> next(pirow.begin(), pirow.end()-1);
+  for(int i=0; i<n; i++)
+    for(int p=irow[i]; p<irow[i+1]; p++) {
+      const int pi=iperm[i], pj=iperm[jcol[p]];
+      const int q=next[pi>pj ? pi : pj]++;
+      pjcol[q] = pi<pj ? pi : pj;
+      map[p]=q;
+    }
+}
+
+void hiopLinSolverSymSparse::eliminationTree(int n, const std::vector<int>& irow, const std::vector<int>& jcol, 
+					     std::vector<int>& parent)
+{
+  std::vector<int> ancestor(n, -1);
+  parent.assign(n, -1);
+  for(int r=0; r<n; r++) 
+    for(int p=irow[r]; p<irow[r+1]; p++) {
+      int inext;
+      for(int i=jcol[p]; i!=-1 && i<r; i=inext) {
+	inext=ancestor[i]; ancestor[i]=r;
+	if(-1==inext) parent[i]=r;
+      }
+    }
+}
+
+void hiopLinSolverSymSparse::postorder(int n, const std::vector<int>& parent, std::vector<int>& post)
+{
+  std::vector<int> head(n, -1), next(n, -1), stk;
+  for(int j=n-1; j>=0; j--) 
+    if(parent[j]!=-1) { next[j]=head[parent[j]]; head[parent[j]]=j; }
+  post.resize(n);
+  int k=0;
+  for(int j=0; j<n; j++) {
+    if(parent[j]!=-1) continue;
+    stk.push_back(j);
+    while(!stk.empty()) {
+      const int p=stk.back(), i=head[p];
+      if(-1==i) { stk.pop_back(); post[k++]=p; }
+      else      { head[p]=next[i]; stk.push_back(i); }
+    }
+  }
+  assert(k==n);
+}
+
+/* Minimum degree on the quotient graph: the eliminated nodes become elements, which represent the cliques
+ * created by the elimination, and the degrees are approximated as in AMD (Amestoy, Davis, and Duff), by 
+ * |A_i| + |L_p\{i}| + sum |L_e\L_p| over the other elements e adjacent to i. */
+void hiopLinSolverSymSparse::orderMinDegree(int n, const int* irow, const int* jcol, std::vector<int>& perm)
+{
+  std::vector<std::vector<int> > adjv(n), adje(n), Le(n);
+  for(int i=0; i<n; i++)
+    for(int p=irow[i]; p<irow[i+1]; p++)
+      if(jcol[p]!=i) { adjv[i].push_back(jcol[p]); adjv[jcol[p]].push_back(i); }
+
+  //0 for variables, 1 for elements, 2 for the absorbed elements
+  std::vector<char> status(n, 0);
+  std::vector<int> deg(n), head(n+1, -1), next(n, -1), prev(n, -1), mark(n, -1), w(n, 0), wtag(n, -1), Lp;
+  for(int i=0; i<n; i++) {
+    deg[i]=adjv[i].size();
+    next[i]=head[deg[i]]; if(next[i]!=-1) prev[next[i]]=i; head[deg[i]]=i;
+  }
+  perm.resize(n);
+  int mindeg=0;
+  for(int k=0; k<n; k++) {
+    while(-1==head[mindeg]) mindeg++;
+    const int p=head[mindeg];
+    head[mindeg]=next[p]; if(next[p]!=-1) prev[next[p]]=-1;
+    perm[k]=p;
+
+    //the variables adjacent to p; the elements adjacent to p are absorbed in the new element p
+    Lp.clear(); mark[p]=k;
+    for(size_t a=0; a<adjv[p].size(); a++) {
+      const int v=adjv[p][a];
+      if(0==status[v] && mark[v]!=k) { mark[v]=k; Lp.push_back(v); }
+    }
+    for(size_t a=0; a<adje[p].size(); a++) {
+      const int e=adje[p][a];
+      if(1!=status[e]) continue;
+      for(size_t b=0; b<Le[e].size(); b++) {
+	const int v=Le[e][b];
+	if(0==status[v] && mark[v]!=k) { mark[v]=k; Lp.push_back(v); }
+      }
+      status[e]=2; std::vector<int>().swap(Le[e]);
+    }
+    status[p]=1; Le[p]=Lp;
+    std::vector<int>().swap(adjv[p]); std::vector<int>().swap(adje[p]);
+
+    //remove the variables of L_p from the lists and prune their adjacency
+    for(size_t a=0; a<Lp.size(); a++) {
+      const int i=Lp[a];
+      if(prev[i]!=-1) next[prev[i]]=next[i]; else head[deg[i]]=next[i];
+      if(next[i]!=-1) prev[next[i]]=prev[i];
+
+      std::vector<int>& E=adje[i];
+      size_t q=0;
+      for(size_t b=0; b<E.size(); b++) if(1==status[E[b]]) E[q++]=E[b];
+      E.resize(q); E.push_back(p);
+      std::vector<int>& A=adjv[i];
+      q=0;
+      for(size_t b=0; b<A.size(); b++) if(0==status[A[b]] && mark[A[b]]!=k) A[q++]=A[b];
+      A.resize(q);
+    }
+    //w[e]=|L_e\L_p| for the elements adjacent to L_p
+    for(size_t a=0; a<Lp.size(); a++) {
+      const std::vector<int>& E=adje[Lp[a]];
+      for(size_t b=0; b<E.size(); b++) {
+	const int e=E[b];
+	if(e==p) continue;
+	if(wtag[e]!=k) { wtag[e]=k; w[e]=Le[e].size(); }
+	w[e]--;
+      }
+    }
+    //approximate degrees; the elements contained in L_p are absorbed
+    const int nrem=n-k-1, lp=Lp.size();
+    for(size_t a=0; a<Lp.size(); a++) {
+      const int i=Lp[a];
+      long long d=adjv[i].size()+lp-1;
+      const std::vector<int>& E=adje[i];
+      for(size_t b=0; b<E.size(); b++) {
+	const int e=E[b];
+	if(e==p || 1!=status[e]) continue;
+	if(0==w[e]) { status[e]=2; std::vector<int>().swap(Le[e]); } 
+	else d += w[e];
+      }
+      if(d>deg[i]+lp-1) d=deg[i]+lp-1;
+      if(d>nrem-1) d=nrem-1;
+      if(d<0) d=0;
+      deg[i]=d;
+      prev[i]=-1; next[i]=head[d]; if(next[i]!=-1) prev[next[i]]=i; head[d]=i;
+      if(d<mindeg) mindeg=d;
+    }
+  }
+}
+
+}
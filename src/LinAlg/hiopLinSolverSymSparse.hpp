@@ -0,0 +1,117 @@
+// Copyright (c) 2017, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory (LLNL).
+// Written by Cosmin G. Petra, petra1@llnl.gov.
+// LLNL-CODE-742473. All rights reserved.
+//
+// This file is part of HiOp. For details, see https://github.com/LLNL/hiop. HiOp 
+// is released under the BSD 3-clause license (https://opensource.org/licenses/BSD-3-Clause). 
+// Please also read “Additional BSD Notice” below.
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+// i. Redistributions of source code must retain the above copyright notice, this list 
+// of conditions and the disclaimer below.
+// ii. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the disclaimer (as noted below) in the documentation and/or 
+// other materials provided with the distribution.
+// iii. Neither the name of the LLNS/LLNL nor the names of its contributors may be used to 
+// endorse or promote products derived from this software without specific prior written 
+// permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY 
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES 
+// OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT 
+// SHALL LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR 
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS 
+// OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Additional BSD Notice
+// 1. This notice is required to be provided under our contract with the U.S. Department 
+// of Energy (DOE). This work was produced at Lawrence Livermore National Laboratory under 
+// Contract No. DE-AC52-07NA27344 with the DOE.
+// 2. Neither the United States Government nor Lawrence Livermore National Security, LLC 
+// nor any of their employees, makes any warranty, express or implied, or assumes any 
+// liability or responsibility for the accuracy, completeness, or usefulness of any 
+// information, apparatus, product, or process disclosed, or represents that its use would
+// not infringe privately-owned rights.
+// 3. Also, reference herein to any specific commercial products, process, or services by 
+// trade name, trademark, manufacturer or otherwise does not necessarily constitute or 
+// imply its endorsement, recommendation, or favoring by the United States Government or 
+// Lawrence Livermore National Security, LLC. The views and opinions of authors expressed 
+// herein do not necessarily state or reflect those of the United States Government or 
+// Lawrence Livermore National Security, LLC, and shall not be used for advertising or 
+// product endorsement purposes.
+
+#ifndef HIOP_LINSOLVER_SYM_SPARSE
+#define HIOP_LINSOLVER_SYM_SPARSE
+
+#include <vector>
+
+namespace hiop
+{
+
+/** Direct solver for sparse symmetric (indefinite) linear systems based on a supernodal LDL^T 
+ *  factorization, with D diagonal, computed by the multifrontal method. 
+ *  
+ *  The symbolic analysis computes a fill-reducing (approximate minimum degree) ordering, the 
+ *  elimination tree and its postorder, and the fundamental supernodes. The numerical factorization
+ *  uses static 1x1 pivots, which is stable for quasi-definite matrices, e.g., regularized KKT 
+ *  matrices; a (numerically) zero pivot, relative to the largest entry of its column, is reported 
+ *  as a singular matrix. The inertia is given by the signs of D.
+ *
+ *  The matrix is given by its lower triangle in compressed sparse row (CSR) format.
+ */
+class hiopLinSolverSymSparse
+{
+public:
+  hiopLinSolverSymSparse();
+  virtual ~hiopLinSolverSymSparse();
+
+  /* symbolic analysis of the n x n matrix with the lower triangle pattern given by the row starts 'irow'
+   * (of size n+1) and the column indexes 'jcol' (jcol[k]<=row); the entries should not be duplicated */
+  void analyze(int n, const int* irow, const int* jcol);
+  /* numerical factorization of the matrix with the values 'vals' (in the order of 'jcol'); returns the 
+   * number of negative eigenvalues or -1 if the matrix is singular */
+  int factorize(const double* vals);
+  /* solves in place with the factors computed by 'factorize' */
+  void solve(double* rhs);
+
+  inline long long get_nnz_factors() const { return nnz_factors; }
+  inline int get_num_supernodes() const { return nsuper; }
+  inline int get_num_pos_eigenvalues() const { return npos; }
+private:
+  /* approximate minimum degree ordering of the graph of the matrix; perm[k] is the k-th eliminated node */
+  static void orderMinDegree(int n, const int* irow, const int* jcol, std::vector<int>& perm);
+  /* elimination tree of the matrix given by its lower triangle by rows */
+  static void eliminationTree(int n, const std::vector<int>& irow, const std::vector<int>& jcol, 
+			      std::vector<int>& parent);
+  static void postorder(int n, const std::vector<int>& parent, std::vector<int>& post);
+  /* lower triangle by rows of the symmetrically permuted matrix; map[k] is the position of the k-th
+   * original entry in the permuted pattern */
+  static void permutePattern(int n, const int* irow, const int* jcol, const std::vector<int>& iperm, 
+			     std::vector<int>& pirow, std::vector<int>& pjcol, std::vector<int>& map);
+private:
+  int n, nnz;
+  std::vector<int> perm, iperm; //perm[k] is the original index of the k-th pivot
+  std::vector<int> Acolptr, Arowind, Amap; //the lower triangle of the permuted matrix by columns
+  std::vector<double> Avals;
+
+  //supernodes: columns sup_first[s],...,sup_first[s+1]-1; the front of s has the row indexes of
+  //sup_rows[sup_rowptr[s]],..., sup_rows[sup_rowptr[s+1]-1], the first ones being the columns of s
+  int nsuper;
+  std::vector<int> sup_first, sup_parent, sup_rowptr, sup_rows, col2sup;
+  std::vector<long long> sup_Lptr; //start of the (dense, column major) panel of L of each supernode
+  std::vector<double> L, D;
+  std::vector<double> front, stack; //work space
+  std::vector<int> relpos;
+  long long nnz_factors, max_front, max_stack;
+  int npos, nneg;
+  double pivot_tol;
+};
+
+}
+#endif
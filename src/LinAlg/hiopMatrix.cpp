@@ -81,6 +81,7 @@ hiopMatrixDense::hiopMatrixDense(const long long& m,
   
   max_rows=m_max_alloc;
   if(max_rows==-1) max_rows=m_local;
+  own_buffer=true;
   assert(max_rows>=m_local && "the requested extra allocation is smaller than the allocation needed by the matrix");
 
   //M=new double*[m_local==0?1:m_local];
@@ -94,10 +95,23 @@ hiopMatrixDense::hiopMatrixDense(const long long& m,
 
   //internal temporary buffers to follow
 }
+hiopMatrixDense::hiopMatrixDense(const long long& m, const long long& n, double* buffer)
+{
+  m_local=m; n_global=n;
+  comm=MPI_COMM_SELF;
+  glob_jl=0; glob_ju=n; n_local=n;
+  max_rows=m_local;
+  own_buffer=false;
+  M=new double*[max_rows==0?1:max_rows];
+  M[0] = max_rows==0?NULL:buffer;
+  for(int i=1; i<max_rows; i++)
+    M[i]=M[0]+i*n_local;
+}
+
 hiopMatrixDense::~hiopMatrixDense()
 {
   if(M) {
-    if(M[0]) delete[] M[0];
+    if(M[0] && own_buffer) delete[] M[0];
     delete[] M;
   }
 }
@@ -110,6 +124,7 @@ hiopMatrixDense::hiopMatrixDense(const hiopMatrixDense& dm)
 
   //M=new double*[m_local==0?1:m_local];
   max_rows = dm.max_rows;
+  own_buffer=true;
   M=new double*[max_rows==0?1:max_rows];
   //M[0] = m_local==0?NULL:new double[m_local*n_local];
   M[0] = max_rows==0?NULL:new double[max_rows*n_local];
@@ -128,8 +143,9 @@ void hiopMatrixDense::appendRow(const hiopVectorPar& row)
   m_local++;
 }
 
-void hiopMatrixDense::copyFrom(const hiopMatrixDense& dm)
+void hiopMatrixDense::copyFrom(const hiopMatrix& dm_)
 {
+  const hiopMatrixDense& dm = dynamic_cast<const hiopMatrixDense&>(dm_);
   assert(n_local==dm.n_local); assert(m_local==dm.m_local); assert(n_global==dm.n_global);
   assert(glob_jl==dm.glob_jl); assert(glob_ju==dm.glob_ju);
   memcpy(M[0], dm.M[0], m_local*n_local*sizeof(double));
@@ -71,6 +71,8 @@ public:
   virtual ~hiopMatrix() {};
   virtual void setToZero()=0;
   virtual void setToConstant(double c)=0;
+  /* copies the values of X, which has the same type and dimensions */
+  virtual void copyFrom(const hiopMatrix& X)=0;
 
   /** y = beta * y + alpha * this * x */
   virtual void timesVec(double beta,  hiopVector& y,
@@ -101,6 +103,11 @@ public:
   *  will print the first rows and/or columns on the specified rank.
   */
   virtual void print(FILE* f=NULL, const char* msg=NULL, int maxRows=-1, int maxCols=-1, int rank=-1) const = 0;
+
+  /* a matrix with the same type and dimensions; the values are not copied by alloc_clone */
+  virtual hiopMatrix* alloc_clone() const=0;
+  virtual hiopMatrix* new_copy() const=0;
+
   /* number of rows */
   virtual long long m() const = 0;
   /* number of columns */
@@ -118,11 +125,14 @@ class hiopMatrixDense : public hiopMatrix
 {
 public:
   hiopMatrixDense(const long long& m, const long long& glob_n, long long* col_part=NULL, MPI_Comm comm=MPI_COMM_SELF, const long long& m_max_alloc=-1);
+  /* serial m x n matrix over the buffer 'buffer' of m*n doubles (e.g., memory shared by the ranks of a node),
+   * which is not freed by the destructor */
+  hiopMatrixDense(const long long& m, const long long& n, double* buffer);
   virtual ~hiopMatrixDense();
 
   virtual void setToZero();
   virtual void setToConstant(double c);
-  virtual void copyFrom(const hiopMatrixDense& dm);
+  virtual void copyFrom(const hiopMatrix& dm);
   virtual void copyFrom(const double* buffer);
 
   virtual void timesVec(double beta,  hiopVector& y,
@@ -196,6 +206,8 @@ private:
   
   //this is very private do not touch :)
   long long max_rows;
+  //false when M[0] is an external buffer
+  bool own_buffer;
 private:
   hiopMatrixDense() {};
   /** copy constructor, for internal/private use only (it doesn't copy the values) */
@@ -0,0 +1,331 @@
+// Copyright (c) 2017, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory (LLNL).
+// Written by Cosmin G. Petra, petra1@llnl.gov.
+// LLNL-CODE-742473. All rights reserved.
+//
+// This file is part of HiOp. For details, see https://github.com/LLNL/hiop. HiOp 
+// is released under the BSD 3-clause license (https://opensource.org/licenses/BSD-3-Clause). 
+// Please also read “Additional BSD Notice” below.
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+// i. Redistributions of source code must retain the above copyright notice, this list 
+// of conditions and the disclaimer below.
+// ii. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the disclaimer (as noted below) in the documentation and/or 
+// other materials provided with the distribution.
+// iii. Neither the name of the LLNS/LLNL nor the names of its contributors may be used to 
+// endorse or promote products derived from this software without specific prior written 
+// permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY 
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES 
+// OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT 
+// SHALL LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR 
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS 
+// OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Additional BSD Notice
+// 1. This notice is required to be provided under our contract with the U.S. Department 
+// of Energy (DOE). This work was produced at Lawrence Livermore National Laboratory under 
+// Contract No. DE-AC52-07NA27344 with the DOE.
+// 2. Neither the United States Government nor Lawrence Livermore National Security, LLC 
+// nor any of their employees, makes any warranty, express or implied, or assumes any 
+// liability or responsibility for the accuracy, completeness, or usefulness of any 
+// information, apparatus, product, or process disclosed, or represents that its use would
+// not infringe privately-owned rights.
+// 3. Also, reference herein to any specific commercial products, process, or services by 
+// trade name, trademark, manufacturer or otherwise does not necessarily constitute or 
+// imply its endorsement, recommendation, or favoring by the United States Government or 
+// Lawrence Livermore National Security, LLC. The views and opinions of authors expressed 
+// herein do not necessarily state or reflect those of the United States Government or 
+// Lawrence Livermore National Security, LLC, and shall not be used for advertising or 
+// product endorsement purposes.
+
+#include "hiopMatrixDenseLocalRows.hpp"
+
+#include "blasdefs.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <cmath>
+
+namespace hiop
+{
+
+hiopMatrixDenseLocalRows::hiopMatrixDenseLocalRows(long long m_glob_, const long long* row_distrib_, 
+						   const long long& glob_n, long long* col_part, MPI_Comm comm_)
+  : m_glob(m_glob_), col_start(0), comm(comm_), rank(0), num_ranks(1)
+{
+#ifdef WITH_MPI
+  int ierr = MPI_Comm_rank(comm, &rank); assert(MPI_SUCCESS==ierr);
+  ierr = MPI_Comm_size(comm, &num_ranks); assert(MPI_SUCCESS==ierr);
+#endif
+  row_distrib = new long long[num_ranks+1];
+  memcpy(row_distrib, row_distrib_, (num_ranks+1)*sizeof(long long));
+  assert(row_distrib[0]==0);
+  Mglob = new hiopMatrixDense(m_glob, glob_n, col_part, comm);
+  Mloc  = new hiopMatrixDense(row_distrib[rank+1]-row_distrib[rank], Mglob->get_local_size_n());
+#ifdef WITH_MPI
+  long long n_local=Mglob->get_local_size_n();
+  ierr = MPI_Exscan(&n_local, &col_start, 1, MPI_LONG_LONG, MPI_SUM, comm); assert(MPI_SUCCESS==ierr);
+  if(0==rank) col_start=0;
+#endif
+
+  recv_counts.resize(num_ranks); recv_disp.resize(num_ranks);
+  for(int r=0; r<num_ranks; r++) {
+    recv_counts[r] = (int)(row_distrib[r+1]-row_distrib[r]);
+    recv_disp[r] = (int)row_distrib[r];
+  }
+  buff.resize(m_glob+Mloc->m()+1);
+  buff_all.resize(m()+1);
+}
+
+hiopMatrixDenseLocalRows::hiopMatrixDenseLocalRows(const hiopMatrixDenseLocalRows& other)
+  : m_glob(other.m_glob), col_start(other.col_start), comm(other.comm), rank(other.rank), num_ranks(other.num_ranks), 
+    recv_counts(other.recv_counts), recv_disp(other.recv_disp), buff(other.buff.size()), buff_all(other.buff_all.size())
+{
+  row_distrib = new long long[num_ranks+1];
+  memcpy(row_distrib, other.row_distrib, (num_ranks+1)*sizeof(long long));
+  Mglob = other.Mglob->alloc_clone();
+  Mloc  = other.Mloc->alloc_clone();
+}
+
+hiopMatrixDenseLocalRows::~hiopMatrixDenseLocalRows()
+{
+  delete[] row_distrib;
+  delete Mglob;
+  delete Mloc;
+}
+
+hiopMatrixDenseLocalRows* hiopMatrixDenseLocalRows::alloc_clone() const
+{
+  return new hiopMatrixDenseLocalRows(*this);
+}
+
+hiopMatrixDenseLocalRows* hiopMatrixDenseLocalRows::new_copy() const
+{
+  hiopMatrixDenseLocalRows* c = new hiopMatrixDenseLocalRows(*this);
+  c->copyFrom(*this);
+  return c;
+}
+
+void hiopMatrixDenseLocalRows::setToZero()
+{
+  Mglob->setToZero(); Mloc->setToZero();
+}
+void hiopMatrixDenseLocalRows::setToConstant(double c)
+{
+  Mglob->setToConstant(c); Mloc->setToConstant(c);
+}
+void hiopMatrixDenseLocalRows::copyFrom(const hiopMatrix& X_)
+{
+  const hiopMatrixDenseLocalRows& X = dynamic_cast<const hiopMatrixDenseLocalRows&>(X_);
+  assert(X.m_glob==m_glob && X.Mloc->m()==Mloc->m());
+  Mglob->copyFrom(*X.Mglob); 
+  Mloc->copyFrom(*X.Mloc);
+}
+
+/* y = beta*y + alpha*this*x: the products of the global rows are reduced and the ones of the 
+ * local rows are gathered, so that y is replicated */
+void hiopMatrixDenseLocalRows::timesVec(double beta, hiopVector& y_, double alpha, const hiopVector& x_) const
+{
+  hiopVectorPar& y = dynamic_cast<hiopVectorPar&>(y_);
+  const hiopVectorPar& x = dynamic_cast<const hiopVectorPar&>(x_);
+  assert(y.get_local_size()==m());
+  assert(x.get_local_size()==Mglob->get_local_size_n());
+  char trans='T'; int nloc=(int)Mglob->get_local_size_n(), mg=(int)m_glob, ml=(int)Mloc->m(), one=1;
+  double zero=0.;
+  if(nloc>0 && mg>0) DGEMV(&trans, &nloc, &mg, &alpha, Mglob->local_buffer(), &nloc, 
+			   x.local_data_const(), &one, &zero, &buff[0], &one);
+  else for(int i=0; i<mg; i++) buff[i]=0.;
+  if(nloc>0 && ml>0) DGEMV(&trans, &nloc, &ml, &alpha, Mloc->local_buffer(), &nloc, 
+			   x.local_data_const(), &one, &zero, &buff[mg], &one);
+  else for(int i=0; i<ml; i++) buff[mg+i]=0.;
+#ifdef WITH_MPI
+  int ierr;
+  if(mg>0) { ierr = MPI_Allreduce(&buff[0], &buff_all[0], mg, MPI_DOUBLE, MPI_SUM, comm); assert(MPI_SUCCESS==ierr); }
+  ierr = MPI_Allgatherv(&buff[mg], ml, MPI_DOUBLE, &buff_all[mg], const_cast<int*>(&recv_counts[0]), 
+			const_cast<int*>(&recv_disp[0]), MPI_DOUBLE, comm); assert(MPI_SUCCESS==ierr);
+#else
+  memcpy(&buff_all[0], &buff[0], (mg+ml)*sizeof(double));
+#endif
+  double* yv=y.local_data();
+  const long long mm=m();
+  for(long long i=0; i<mm; i++) yv[i] = beta*yv[i] + buff_all[i];
+}
+
+/* y = beta*y + alpha*this^T*x with x replicated; no communication is needed */
+void hiopMatrixDenseLocalRows::transTimesVec(double beta, hiopVector& y_, double alpha, const hiopVector& x_) const
+{
+  hiopVectorPar& y = dynamic_cast<hiopVectorPar&>(y_);
+  const hiopVectorPar& x = dynamic_cast<const hiopVectorPar&>(x_);
+  assert(x.get_local_size()==m());
+  assert(y.get_local_size()==Mglob->get_local_size_n());
+  char trans='N'; int nloc=(int)Mglob->get_local_size_n(), mg=(int)m_glob, ml=(int)Mloc->m(), one=1;
+  double done=1.;
+  const double* xv=x.local_data_const();
+  if(nloc==0) return;
+  if(mg>0) DGEMV(&trans, &nloc, &mg, &alpha, Mglob->local_buffer(), &nloc, xv, &one, &beta, y.local_data(), &one);
+  else     y.scale(beta);
+  if(ml>0) DGEMV(&trans, &nloc, &ml, &alpha, Mloc->local_buffer(), &nloc, xv+m_glob+row_distrib[rank], &one, 
+		 &done, y.local_data(), &one);
+}
+
+/* W = beta*W + P, where the first m_glob rows of P are summed over the ranks and the other rows are the
+ * ones computed by their owners, so that W is replicated; P has k columns and is overwritten */
+void hiopMatrixDenseLocalRows::reduceProducts(double beta, hiopMatrixDense& W, int k, std::vector<double>& P) const
+{
+  assert(W.m()==m() && W.get_local_size_n()==k && W.n()==k);
+  const long long mg=m_glob, ml=Mloc->m();
+  std::vector<double> P_all(m()*k+1);
+#ifdef WITH_MPI
+  int ierr;
+  if(mg*k>0) { ierr = MPI_Allreduce(&P[0], &P_all[0], mg*k, MPI_DOUBLE, MPI_SUM, comm); assert(MPI_SUCCESS==ierr); }
+  std::vector<int> counts(num_ranks), disp(num_ranks);
+  for(int r=0; r<num_ranks; r++) { counts[r]=recv_counts[r]*k; disp[r]=recv_disp[r]*k; }
+  ierr = MPI_Allgatherv(&P[mg*k], ml*k, MPI_DOUBLE, &P_all[mg*k], &counts[0], &disp[0], MPI_DOUBLE, comm); 
+  assert(MPI_SUCCESS==ierr);
+#else
+  memcpy(&P_all[0], &P[0], (mg+ml)*k*sizeof(double));
+#endif
+  double* w=W.local_buffer();
+  const long long mk=m()*k;
+  for(long long i=0; i<mk; i++) w[i] = beta*w[i] + P_all[i];
+}
+
+/* W = beta*W + alpha*this*X, with X having the rows of the local columns of this; W is replicated */
+void hiopMatrixDenseLocalRows::timesMat(double beta, hiopMatrix& W_, double alpha, const hiopMatrix& X_) const
+{
+  hiopMatrixDense& W = dynamic_cast<hiopMatrixDense&>(W_);
+  const hiopMatrixDense& X = dynamic_cast<const hiopMatrixDense&>(X_);
+  int nloc=(int)Mglob->get_local_size_n(), mg=(int)m_glob, ml=(int)Mloc->m(), k=(int)X.n();
+  assert(X.m()==nloc && X.get_local_size_n()==k);
+  std::vector<double> P((mg+ml)*(long long)k+1, 0.);
+  //in Fortran, the rows of P, this, and X are columns: P^T = X^T*this^T
+  char trans='N'; double zero=0.;
+  if(nloc>0 && k>0 && mg>0) 
+    DGEMM(&trans, &trans, &k, &mg, &nloc, &alpha, X.local_buffer(), &k, Mglob->local_buffer(), &nloc, &zero, &P[0], &k);
+  if(nloc>0 && k>0 && ml>0) 
+    DGEMM(&trans, &trans, &k, &ml, &nloc, &alpha, X.local_buffer(), &k, Mloc->local_buffer(), &nloc, &zero, &P[mg*(long long)k], &k);
+  reduceProducts(beta, W, k, P);
+}
+
+/* W = beta*W + alpha*this^T*X with X replicated; W has the rows of the local columns of this, and no
+ * communication is needed */
+void hiopMatrixDenseLocalRows::transTimesMat(double beta, hiopMatrix& W_, double alpha, const hiopMatrix& X_) const
+{
+  hiopMatrixDense& W = dynamic_cast<hiopMatrixDense&>(W_);
+  const hiopMatrixDense& X = dynamic_cast<const hiopMatrixDense&>(X_);
+  int nloc=(int)Mglob->get_local_size_n(), mg=(int)m_glob, ml=(int)Mloc->m(), k=(int)X.n();
+  assert(X.m()==m() && X.get_local_size_n()==k);
+  assert(W.m()==nloc && W.get_local_size_n()==k);
+  if(nloc==0 || k==0) return;
+  char transX='N', transM='T'; double done=1.;
+  double* w=W.local_buffer();
+  if(mg>0) DGEMM(&transX, &transM, &k, &nloc, &mg, &alpha, X.local_buffer(), &k, Mglob->local_buffer(), &nloc, &beta, w, &k);
+  else { int nk=nloc*k, one=1; DSCAL(&nk, &beta, w, &one); }
+  if(ml>0) DGEMM(&transX, &transM, &k, &nloc, &ml, &alpha, X.local_data()[m_glob+row_distrib[rank]], &k, 
+		 Mloc->local_buffer(), &nloc, &done, w, &k);
+}
+
+/* W = beta*W + alpha*this*X^T, with X distributed column-wise as this; W is replicated */
+void hiopMatrixDenseLocalRows::timesMatTrans(double beta, hiopMatrix& W_, double alpha, const hiopMatrix& X_) const
+{
+  hiopMatrixDense& W = dynamic_cast<hiopMatrixDense&>(W_);
+  const hiopMatrixDense& X = dynamic_cast<const hiopMatrixDense&>(X_);
+  int nloc=(int)Mglob->get_local_size_n(), mg=(int)m_glob, ml=(int)Mloc->m(), k=(int)X.m();
+  assert(X.get_local_size_n()==nloc);
+  std::vector<double> P((mg+ml)*(long long)k+1, 0.);
+  char transX='T', transM='N'; double zero=0.;
+  if(nloc>0 && k>0 && mg>0) 
+    DGEMM(&transX, &transM, &k, &mg, &nloc, &alpha, X.local_buffer(), &nloc, Mglob->local_buffer(), &nloc, &zero, &P[0], &k);
+  if(nloc>0 && k>0 && ml>0) 
+    DGEMM(&transX, &transM, &k, &ml, &nloc, &alpha, X.local_buffer(), &nloc, Mloc->local_buffer(), &nloc, &zero, &P[mg*(long long)k], &k);
+  reduceProducts(beta, W, k, P);
+}
+
+double* hiopMatrixDenseLocalRows::diagEntry(long long i) const
+{
+  const long long j=i-col_start;
+  if(j<0 || j>=Mglob->get_local_size_n()) return NULL;
+  if(i<m_glob) return &Mglob->local_data()[i][j];
+  const long long r=i-m_glob-row_distrib[rank];
+  if(r>=0 && r<Mloc->m()) return &Mloc->local_data()[r][j];
+  return NULL;
+}
+
+/* the diagonal entries in the local rows of other ranks need to stay zero since the local rows of a rank 
+ * have nonzeros only in its columns */
+void hiopMatrixDenseLocalRows::addDiagonal(const hiopVector& d_)
+{
+  const hiopVectorPar& d = dynamic_cast<const hiopVectorPar&>(d_);
+  assert(d.get_local_size()==Mglob->get_local_size_n());
+  const double* dv=d.local_data_const();
+  const long long nloc=d.get_local_size(), mm=m();
+  for(long long j=0; j<nloc && col_start+j<mm; j++) {
+    double* a=diagEntry(col_start+j);
+    assert(a!=NULL || dv[j]==0.);
+    if(a) *a += dv[j];
+  }
+}
+void hiopMatrixDenseLocalRows::addDiagonal(const double& value)
+{
+  const long long nloc=Mglob->get_local_size_n(), mm=m();
+  for(long long j=0; j<nloc && col_start+j<mm; j++) {
+    double* a=diagEntry(col_start+j);
+    assert(a!=NULL || value==0.);
+    if(a) *a += value;
+  }
+}
+/* d is replicated; its entry i is added to the diagonal entry start+i */
+void hiopMatrixDenseLocalRows::addSubDiagonal(long long start, const hiopVector& d_)
+{
+  const hiopVectorPar& d = dynamic_cast<const hiopVectorPar&>(d_);
+  const long long len=d.get_local_size(), nloc=Mglob->get_local_size_n();
+  assert(start>=0 && start+len<=m() && start+len<=n());
+  const double* dv=d.local_data_const();
+  for(long long i=start; i<start+len; i++) {
+    if(i<col_start || i>=col_start+nloc) continue;
+    double* a=diagEntry(i);
+    assert(a!=NULL || dv[i-start]==0.);
+    if(a) *a += dv[i-start];
+  }
+}
+
+void hiopMatrixDenseLocalRows::addMatrix(double alpha, const hiopMatrix& X_)
+{
+  const hiopMatrixDenseLocalRows& X = dynamic_cast<const hiopMatrixDenseLocalRows&>(X_);
+  Mglob->addMatrix(alpha, *X.Mglob);
+  Mloc->addMatrix(alpha, *X.Mloc);
+}
+
+double hiopMatrixDenseLocalRows::max_abs_value()
+{
+  double maxv = Mglob->max_abs_value(); //already reduced
+  if(Mloc->m()>0 && Mloc->get_local_size_n()>0) maxv = fmax(maxv, Mloc->max_abs_value());
+#ifdef WITH_MPI
+  double maxvg;
+  int ierr=MPI_Allreduce(&maxv,&maxvg,1,MPI_DOUBLE,MPI_MAX,comm); assert(ierr==MPI_SUCCESS);
+  return maxvg;
+#endif
+  return maxv;
+}
+
+void hiopMatrixDenseLocalRows::print(FILE* f, const char* msg/*=NULL*/, int maxRows/*=-1*/, int maxCols/*=-1*/, 
+				     int rank_/*=-1*/) const
+{
+  if(NULL==f) f=stdout;
+  if(rank==rank_ || rank_==-1) {
+    if(msg) fprintf(f, "%s (dims=[%lld,%lld], global rows=%lld)\n", msg, m(), n(), m_glob);
+    else    fprintf(f, "hiopMatrixDenseLocalRows::printing (dims=[%lld,%lld], global rows=%lld)\n", m(), n(), m_glob);
+  }
+  Mglob->print(f, "global rows", maxRows, maxCols, rank_);
+  if(rank==rank_ || rank_==-1) Mloc->print(f, "local rows", maxRows, maxCols, -1);
+}
+
+}
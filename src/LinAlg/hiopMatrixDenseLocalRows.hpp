@@ -0,0 +1,133 @@
+// Copyright (c) 2017, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory (LLNL).
+// Written by Cosmin G. Petra, petra1@llnl.gov.
+// LLNL-CODE-742473. All rights reserved.
+//
+// This file is part of HiOp. For details, see https://github.com/LLNL/hiop. HiOp 
+// is released under the BSD 3-clause license (https://opensource.org/licenses/BSD-3-Clause). 
+// Please also read “Additional BSD Notice” below.
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+// i. Redistributions of source code must retain the above copyright notice, this list 
+// of conditions and the disclaimer below.
+// ii. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the disclaimer (as noted below) in the documentation and/or 
+// other materials provided with the distribution.
+// iii. Neither the name of the LLNS/LLNL nor the names of its contributors may be used to 
+// endorse or promote products derived from this software without specific prior written 
+// permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY 
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES 
+// OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT 
+// SHALL LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR 
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS 
+// OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Additional BSD Notice
+// 1. This notice is required to be provided under our contract with the U.S. Department 
+// of Energy (DOE). This work was produced at Lawrence Livermore National Laboratory under 
+// Contract No. DE-AC52-07NA27344 with the DOE.
+// 2. Neither the United States Government nor Lawrence Livermore National Security, LLC 
+// nor any of their employees, makes any warranty, express or implied, or assumes any 
+// liability or responsibility for the accuracy, completeness, or usefulness of any 
+// information, apparatus, product, or process disclosed, or represents that its use would
+// not infringe privately-owned rights.
+// 3. Also, reference herein to any specific commercial products, process, or services by 
+// trade name, trademark, manufacturer or otherwise does not necessarily constitute or 
+// imply its endorsement, recommendation, or favoring by the United States Government or 
+// Lawrence Livermore National Security, LLC. The views and opinions of authors expressed 
+// herein do not necessarily state or reflect those of the United States Government or 
+// Lawrence Livermore National Security, LLC, and shall not be used for advertising or 
+// product endorsement purposes.
+
+#ifndef HIOP_MATRIX_DENSE_LOCAL_ROWS
+#define HIOP_MATRIX_DENSE_LOCAL_ROWS
+
+#include "hiopMatrix.hpp"
+#include "hiopVector.hpp"
+
+#include <vector>
+
+namespace hiop
+{
+
+/** Matrix whose first m_glob rows are dense and distributed column-wise as a hiopMatrixDense (the global 
+ *  rows), followed by rows that are local to the ranks: the rank r owns the rows m_glob+row_distrib[r], ..., 
+ *  m_glob+row_distrib[r+1]-1, which have nonzeros only in the columns owned by r. The local rows are stored
+ *  only by their owner, as a serial dense matrix with the local columns, and are never communicated; the 
+ *  products with vectors of size m() reduce the global part and gather the local parts of the result.
+ *  Used for the Jacobians of the block formulation (hiopNlpBlockConstraints).
+ */
+class hiopMatrixDenseLocalRows : public hiopMatrix
+{
+public:
+  /* 'row_distrib' has num_ranks+1 entries and is copied; 'col_part' is as for hiopMatrixDense */
+  hiopMatrixDenseLocalRows(long long m_glob, const long long* row_distrib, const long long& glob_n, 
+			   long long* col_part=NULL, MPI_Comm comm=MPI_COMM_SELF);
+  virtual ~hiopMatrixDenseLocalRows();
+
+  virtual void setToZero();
+  virtual void setToConstant(double c);
+  virtual void copyFrom(const hiopMatrix& X);
+
+  virtual void timesVec(double beta,  hiopVector& y,
+			double alpha, const hiopVector& x) const;
+  virtual void transTimesVec(double beta,   hiopVector& y,
+			     double alpha, const hiopVector& x) const;
+
+  /* as for the products with vectors, W is replicated in timesMat and timesMatTrans, and transTimesMat
+   * needs no communication; X and W are hiopMatrixDense */
+  virtual void timesMat(double beta, hiopMatrix& W, double alpha, const hiopMatrix& X) const;
+  virtual void transTimesMat(double beta, hiopMatrix& W, double alpha, const hiopMatrix& X) const;
+  virtual void timesMatTrans(double beta, hiopMatrix& W, double alpha, const hiopMatrix& X) const;
+
+  /* the diagonal entries (i,i), i<min(m,n); d is distributed as the columns in addDiagonal */
+  virtual void addDiagonal(const hiopVector& d_);
+  virtual void addDiagonal(const double& value);
+  virtual void addSubDiagonal(long long start, const hiopVector& d_);
+  /* this += alpha*X, where X has the same row distribution */
+  virtual void addMatrix(double alpha, const hiopMatrix& X);
+  virtual double max_abs_value();
+
+  virtual void print(FILE* f=NULL, const char* msg=NULL, int maxRows=-1, int maxCols=-1, int rank=-1) const;
+
+  virtual hiopMatrixDenseLocalRows* alloc_clone() const;
+  virtual hiopMatrixDenseLocalRows* new_copy() const;
+
+  virtual long long m() const {return m_glob+row_distrib[num_ranks];}
+  virtual long long n() const {return Mglob->n();}
+  /* the global rows and the local rows of the calling rank */
+  inline hiopMatrixDense& get_glob_block() const { return *Mglob; }
+  inline hiopMatrixDense& get_local_block() const { return *Mloc; }
+  inline long long m_glob_rows() const { return m_glob; }
+  inline const long long* get_row_distrib() const { return row_distrib; }
+#ifdef DEEP_CHECKING
+  virtual bool assertSymmetry(double tol=1e-16) const { return false; }
+#endif
+private:
+  long long m_glob;
+  long long* row_distrib;
+  long long col_start; //global index of the first local column
+  hiopMatrixDense *Mglob, *Mloc;
+  MPI_Comm comm;
+  int rank, num_ranks;
+  //counts and displacements of the local parts of the products (for MPI_Allgatherv)
+  std::vector<int> recv_counts, recv_disp;
+  mutable std::vector<double> buff, buff_all;
+private:
+  //W = beta*W + P with P the local products of the global rows (summed) and of the local rows (gathered)
+  void reduceProducts(double beta, hiopMatrixDense& W, int k, std::vector<double>& P) const;
+  //the diagonal entry (i,i) if stored by this rank, otherwise NULL
+  double* diagEntry(long long i) const;
+  //same dimensions and distribution as 'other'; the values are not copied (used by alloc_clone)
+  hiopMatrixDenseLocalRows(const hiopMatrixDenseLocalRows& other);
+};
+
+}
+#endif
@@ -0,0 +1,331 @@
+// Copyright (c) 2017, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory (LLNL).
+// Written by Cosmin G. Petra, petra1@llnl.gov.
+// LLNL-CODE-742473. All rights reserved.
+//
+// This file is part of HiOp. For details, see https://github.com/LLNL/hiop. HiOp 
+// is released under the BSD 3-clause license (https://opensource.org/licenses/BSD-3-Clause). 
+// Please also read “Additional BSD Notice” below.
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+// i. Redistributions of source code must retain the above copyright notice, this list 
+// of conditions and the disclaimer below.
+// ii. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the disclaimer (as noted below) in the documentation and/or 
+// other materials provided with the distribution.
+// iii. Neither the name of the LLNS/LLNL nor the names of its contributors may be used to 
+// endorse or promote products derived from this software without specific prior written 
+// permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY 
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES 
+// OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT 
+// SHALL LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR 
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS 
+// OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Additional BSD Notice
+// 1. This notice is required to be provided under our contract with the U.S. Department 
+// of Energy (DOE). This work was produced at Lawrence Livermore National Laboratory under 
+// Contract No. DE-AC52-07NA27344 with the DOE.
+// 2. Neither the United States Government nor Lawrence Livermore National Security, LLC 
+// nor any of their employees, makes any warranty, express or implied, or assumes any 
+// liability or responsibility for the accuracy, completeness, or usefulness of any 
+// information, apparatus, product, or process disclosed, or represents that its use would
+// not infringe privately-owned rights.
+// 3. Also, reference herein to any specific commercial products, process, or services by 
+// trade name, trademark, manufacturer or otherwise does not necessarily constitute or 
+// imply its endorsement, recommendation, or favoring by the United States Government or 
+// Lawrence Livermore National Security, LLC. The views and opinions of authors expressed 
+// herein do not necessarily state or reflect those of the United States Government or 
+// Lawrence Livermore National Security, LLC, and shall not be used for advertising or 
+// product endorsement purposes.
+
+#include "hiopMatrixSparse.hpp"
+#include "hiopVector.hpp"
+
+#include <cstdio>
+#include <cstring> //for memcpy
+#include <cmath>
+#include <cassert>
+#include <vector>
+#include <algorithm> //for sort
+
+namespace hiop
+{
+
+hiopMatrixSparse::hiopMatrixSparse(int m, int n, int nnz, const int* iRow, const int* jCol, int* map/*=NULL*/)
+  : nrows(m), ncols(n)
+{
+  //sort the entries by row and then by column
+  std::vector<std::pair<long long,int> > entries(nnz);
+  for(int k=0; k<nnz; k++) {
+    assert(iRow[k]>=0 && iRow[k]<m && jCol[k]>=0 && jCol[k]<n);
+    entries[k] = std::make_pair(((long long)iRow[k])*n+jCol[k], k);
+  }
+  std::sort(entries.begin(), entries.end());
+
+  //compress, summing the duplicates
+  irow = new int[m+1];
+  jcol = new int[nnz>0?nnz:1];
+  nonzeroes=0; irow[0]=0;
+  for(int p=0, i=0; i<m; i++) {
+    for(; p<nnz && iRow[entries[p].second]==i; p++) {
+      if(irow[i]==nonzeroes || entries[p].first!=entries[p-1].first) 
+	jcol[nonzeroes++]=jCol[entries[p].second];
+      if(map) map[entries[p].second]=nonzeroes-1;
+    }
+    irow[i+1]=nonzeroes;
+  }
+  values = new double[nonzeroes>0?nonzeroes:1];
+  setToZero();
+}
+
+hiopMatrixSparse::hiopMatrixSparse(const hiopMatrixSparse& dm)
+  : nrows(dm.nrows), ncols(dm.ncols), nonzeroes(dm.nonzeroes)
+{
+  irow = new int[nrows+1];
+  jcol = new int[nonzeroes>0?nonzeroes:1];
+  values = new double[nonzeroes>0?nonzeroes:1];
+  memcpy(irow, dm.irow, (nrows+1)*sizeof(int));
+  memcpy(jcol, dm.jcol, nonzeroes*sizeof(int));
+}
+
+hiopMatrixSparse::~hiopMatrixSparse()
+{
+  if(irow)   delete[] irow;
+  if(jcol)   delete[] jcol;
+  if(values) delete[] values;
+}
+
+hiopMatrixSparse* hiopMatrixSparse::alloc_clone() const
+{
+  hiopMatrixSparse* c = new hiopMatrixSparse(*this);
+  assert(c);
+  return c;
+}
+
+hiopMatrixSparse* hiopMatrixSparse::new_copy() const
+{
+  hiopMatrixSparse* c = new hiopMatrixSparse(*this);
+  assert(c);
+  memcpy(c->values, values, nonzeroes*sizeof(double));
+  return c;
+}
+
+void hiopMatrixSparse::copyFrom(const hiopMatrix& X_)
+{
+  const hiopMatrixSparse& X = dynamic_cast<const hiopMatrixSparse&>(X_);
+  assert(X.nonzeroes==nonzeroes && X.nrows==nrows);
+  memcpy(values, X.values, nonzeroes*sizeof(double));
+}
+
+void hiopMatrixSparse::setToZero()
+{
+  for(int k=0; k<nonzeroes; k++) values[k]=0.;
+}
+void hiopMatrixSparse::setToConstant(double c)
+{
+  for(int k=0; k<nonzeroes; k++) values[k]=c;
+}
+
+void hiopMatrixSparse::setFromTriplets(const double* vals, const int* map, int nnz_triplets)
+{
+  setToZero();
+  for(int k=0; k<nnz_triplets; k++) values[map[k]] += vals[k];
+}
+
+void hiopMatrixSparse::timesVec(double beta,  hiopVector& y_,
+				double alpha, const hiopVector& x_) const
+{
+  hiopVectorPar& y = dynamic_cast<hiopVectorPar&>(y_);
+  const hiopVectorPar& x = dynamic_cast<const hiopVectorPar&>(x_);
+  assert(y.get_local_size()==nrows);
+  assert(x.get_local_size()==ncols);
+  double* yv=y.local_data(); const double* xv=x.local_data_const();
+  for(int i=0; i<nrows; i++) {
+    double s=0.;
+    for(int k=irow[i]; k<irow[i+1]; k++) s += values[k]*xv[jcol[k]];
+    yv[i] = beta*yv[i] + alpha*s;
+  }
+}
+
+void hiopMatrixSparse::transTimesVec(double beta,   hiopVector& y_,
+				     double alpha, const hiopVector& x_) const
+{
+  hiopVectorPar& y = dynamic_cast<hiopVectorPar&>(y_);
+  const hiopVectorPar& x = dynamic_cast<const hiopVectorPar&>(x_);
+  assert(y.get_local_size()==ncols);
+  assert(x.get_local_size()==nrows);
+  double* yv=y.local_data(); const double* xv=x.local_data_const();
+  if(beta!=1.) y.scale(beta);
+  for(int i=0; i<nrows; i++) {
+    const double ax=alpha*xv[i];
+    if(ax==0.) continue;
+    for(int k=irow[i]; k<irow[i+1]; k++) yv[jcol[k]] += values[k]*ax;
+  }
+}
+
+void hiopMatrixSparse::symTimesVec(double beta, hiopVector& y_, double alpha, const hiopVector& x_) const
+{
+  hiopVectorPar& y = dynamic_cast<hiopVectorPar&>(y_);
+  const hiopVectorPar& x = dynamic_cast<const hiopVectorPar&>(x_);
+  assert(nrows==ncols);
+  assert(y.get_local_size()==nrows);
+  assert(x.get_local_size()==ncols);
+  double* yv=y.local_data(); const double* xv=x.local_data_const();
+  if(beta!=1.) y.scale(beta);
+  for(int i=0; i<nrows; i++) {
+    for(int k=irow[i]; k<irow[i+1]; k++) {
+      const int j=jcol[k];
+      assert(j<=i);
+      yv[i] += alpha*values[k]*xv[j];
+      if(j!=i) yv[j] += alpha*values[k]*xv[i];
+    }
+  }
+}
+
+void hiopMatrixSparse::timesMat(double beta, hiopMatrix& W_, double alpha, const hiopMatrix& X_) const
+{
+  hiopMatrixDense& W = dynamic_cast<hiopMatrixDense&>(W_);
+  const hiopMatrixDense& X = dynamic_cast<const hiopMatrixDense&>(X_);
+  const int p=X.get_local_size_n();
+  assert(X.m()==ncols && X.n()==p);
+  assert(W.m()==nrows && W.get_local_size_n()==p);
+  double **Wd=W.local_data(), **Xd=X.local_data();
+  for(int i=0; i<nrows; i++) {
+    double* Wi=Wd[i];
+    if(beta!=1.) for(int c=0; c<p; c++) Wi[c] *= beta;
+    for(int k=irow[i]; k<irow[i+1]; k++) {
+      const double a=alpha*values[k], *Xj=Xd[jcol[k]];
+      for(int c=0; c<p; c++) Wi[c] += a*Xj[c];
+    }
+  }
+}
+void hiopMatrixSparse::transTimesMat(double beta, hiopMatrix& W_, double alpha, const hiopMatrix& X_) const
+{
+  hiopMatrixDense& W = dynamic_cast<hiopMatrixDense&>(W_);
+  const hiopMatrixDense& X = dynamic_cast<const hiopMatrixDense&>(X_);
+  const int p=X.get_local_size_n();
+  assert(X.m()==nrows && X.n()==p);
+  assert(W.m()==ncols && W.get_local_size_n()==p);
+  double **Wd=W.local_data(), **Xd=X.local_data();
+  if(beta!=1.) 
+    for(int j=0; j<ncols; j++) for(int c=0; c<p; c++) Wd[j][c] *= beta;
+  for(int i=0; i<nrows; i++) {
+    const double* Xi=Xd[i];
+    for(int k=irow[i]; k<irow[i+1]; k++) {
+      const double a=alpha*values[k];
+      double* Wj=Wd[jcol[k]];
+      for(int c=0; c<p; c++) Wj[c] += a*Xi[c];
+    }
+  }
+}
+void hiopMatrixSparse::timesMatTrans(double beta, hiopMatrix& W_, double alpha, const hiopMatrix& X_) const
+{
+  hiopMatrixDense& W = dynamic_cast<hiopMatrixDense&>(W_);
+  const hiopMatrixDense& X = dynamic_cast<const hiopMatrixDense&>(X_);
+  const int q=X.m();
+  assert(X.get_local_size_n()==ncols && X.n()==ncols);
+  assert(W.m()==nrows && W.get_local_size_n()==q && W.n()==q);
+  double **Wd=W.local_data(), **Xd=X.local_data();
+  for(int i=0; i<nrows; i++) {
+    double* Wi=Wd[i];
+    for(int r=0; r<q; r++) {
+      const double* Xr=Xd[r];
+      double sum=0.;
+      for(int k=irow[i]; k<irow[i+1]; k++) sum += values[k]*Xr[jcol[k]];
+      Wi[r] = beta*Wi[r] + alpha*sum;
+    }
+  }
+}
+
+void hiopMatrixSparse::addDiagonal(const hiopVector& d_)
+{
+  const hiopVectorPar& d = dynamic_cast<const hiopVectorPar&>(d_);
+  assert(d.get_local_size()==nrows && nrows==ncols);
+  const double* dv=d.local_data_const();
+  for(int i=0; i<nrows; i++) {
+    int k=irow[i];
+    while(k<irow[i+1] && jcol[k]!=i) k++;
+    assert(k<irow[i+1] && "diagonal entry not in the pattern");
+    values[k] += dv[i];
+  }
+}
+void hiopMatrixSparse::addDiagonal(const double& value)
+{
+  assert(nrows==ncols);
+  for(int i=0; i<nrows; i++) {
+    int k=irow[i];
+    while(k<irow[i+1] && jcol[k]!=i) k++;
+    assert(k<irow[i+1] && "diagonal entry not in the pattern");
+    values[k] += value;
+  }
+}
+void hiopMatrixSparse::addSubDiagonal(long long start, const hiopVector& d_)
+{
+  const hiopVectorPar& d = dynamic_cast<const hiopVectorPar&>(d_);
+  const int nd=d.get_local_size();
+  assert(nrows==ncols && start>=0 && start+nd<=nrows);
+  const double* dv=d.local_data_const();
+  for(int i=start; i<start+nd; i++) {
+    int k=irow[i];
+    while(k<irow[i+1] && jcol[k]!=i) k++;
+    assert(k<irow[i+1] && "diagonal entry not in the pattern");
+    values[k] += dv[i-start];
+  }
+}
+
+void hiopMatrixSparse::addMatrix(double alpha, const hiopMatrix& X_)
+{
+  const hiopMatrixSparse& X = dynamic_cast<const hiopMatrixSparse&>(X_);
+  assert(X.nonzeroes==nonzeroes && X.nrows==nrows);
+  for(int k=0; k<nonzeroes; k++) values[k] += alpha*X.values[k];
+}
+
+double hiopMatrixSparse::max_abs_value()
+{
+  double maxv=0.;
+  for(int k=0; k<nonzeroes; k++) maxv=fmax(maxv, fabs(values[k]));
+  return maxv;
+}
+
+void hiopMatrixSparse::print(FILE* f, const char* msg/*=NULL*/, int maxRows/*=-1*/, int maxCols/*=-1*/, 
+			     int rank/*=-1*/) const
+{
+  int myrank=0;
+#ifdef WITH_MPI
+  if(rank>=0) assert(MPI_Comm_rank(MPI_COMM_WORLD, &myrank)==MPI_SUCCESS);
+#endif
+  if(myrank==rank || rank==-1) {
+    if(NULL==f) f=stdout;
+    if(maxRows<0 || maxRows>nrows) maxRows=nrows;
+    if(msg) {
+      fprintf(f, "%s (dims=[%d,%d], nnz=%d)\n", msg, nrows, ncols, nonzeroes);
+    } else {
+      fprintf(f, "hiopMatrixSparse::printing max=[%d,%d] (dims=[%d,%d], nnz=%d)\n", 
+	      maxRows, maxCols, nrows, ncols, nonzeroes);
+    }
+    for(int i=0; i<maxRows; i++)
+      for(int k=irow[i]; k<irow[i+1]; k++)
+	if(maxCols<0 || jcol[k]<maxCols) fprintf(f, "(%d,%d) %22.16e\n", i, jcol[k], values[k]);
+  }
+}
+
+#ifdef DEEP_CHECKING
+bool hiopMatrixSparse::assertSymmetry(double tol) const
+{
+  //only the lower triangle is stored
+  for(int i=0; i<nrows; i++)
+    for(int k=irow[i]; k<irow[i+1]; k++)
+      if(jcol[k]>i) return false;
+  return true;
+}
+#endif
+
+}
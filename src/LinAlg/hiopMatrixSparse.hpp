@@ -0,0 +1,121 @@
+// Copyright (c) 2017, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory (LLNL).
+// Written by Cosmin G. Petra, petra1@llnl.gov.
+// LLNL-CODE-742473. All rights reserved.
+//
+// This file is part of HiOp. For details, see https://github.com/LLNL/hiop. HiOp 
+// is released under the BSD 3-clause license (https://opensource.org/licenses/BSD-3-Clause). 
+// Please also read “Additional BSD Notice” below.
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+// i. Redistributions of source code must retain the above copyright notice, this list 
+// of conditions and the disclaimer below.
+// ii. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the disclaimer (as noted below) in the documentation and/or 
+// other materials provided with the distribution.
+// iii. Neither the name of the LLNS/LLNL nor the names of its contributors may be used to 
+// endorse or promote products derived from this software without specific prior written 
+// permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY 
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES 
+// OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT 
+// SHALL LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR 
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS 
+// OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Additional BSD Notice
+// 1. This notice is required to be provided under our contract with the U.S. Department 
+// of Energy (DOE). This work was produced at Lawrence Livermore National Laboratory under 
+// Contract No. DE-AC52-07NA27344 with the DOE.
+// 2. Neither the United States Government nor Lawrence Livermore National Security, LLC 
+// nor any of their employees, makes any warranty, express or implied, or assumes any 
+// liability or responsibility for the accuracy, completeness, or usefulness of any 
+// information, apparatus, product, or process disclosed, or represents that its use would
+// not infringe privately-owned rights.
+// 3. Also, reference herein to any specific commercial products, process, or services by 
+// trade name, trademark, manufacturer or otherwise does not necessarily constitute or 
+// imply its endorsement, recommendation, or favoring by the United States Government or 
+// Lawrence Livermore National Security, LLC. The views and opinions of authors expressed 
+// herein do not necessarily state or reflect those of the United States Government or 
+// Lawrence Livermore National Security, LLC, and shall not be used for advertising or 
+// product endorsement purposes.
+
+#ifndef HIOP_MATRIX_SPARSE
+#define HIOP_MATRIX_SPARSE
+
+#include "hiopMatrix.hpp"
+
+namespace hiop
+{
+
+/** Sparse matrix stored in compressed sparse row (CSR) format; not distributed. 
+ *  The pattern is built from coordinate (triplet) entries, with the duplicated entries summed. 
+ *  Symmetric matrices (e.g., Hessians) are stored as their lower triangle.
+ */
+class hiopMatrixSparse : public hiopMatrix
+{
+public:
+  /* builds the pattern of a m x n matrix from the nnz entries (iRow[k],jCol[k]); when 'map' is not NULL, 
+   * map[k] receives the position in the CSR values of the k-th entry */
+  hiopMatrixSparse(int m, int n, int nnz, const int* iRow, const int* jCol, int* map=NULL);
+  virtual ~hiopMatrixSparse();
+
+  virtual void setToZero();
+  virtual void setToConstant(double c);
+  /* X has the same pattern */
+  virtual void copyFrom(const hiopMatrix& X);
+  /* sets the values from the coordinate values 'vals' using the map returned by the constructor */
+  void setFromTriplets(const double* vals, const int* map, int nnz_triplets);
+
+  virtual void timesVec(double beta,  hiopVector& y,
+			double alpha, const hiopVector& x) const;
+  virtual void transTimesVec(double beta,   hiopVector& y,
+			     double alpha, const hiopVector& x) const;
+  /* y = beta*y + alpha*this*x for a symmetric matrix stored as its lower triangle */
+  void symTimesVec(double beta, hiopVector& y, double alpha, const hiopVector& x) const;
+
+  //products with a dense (not distributed) X, the result W being dense
+  virtual void timesMat(double beta, hiopMatrix& W, double alpha, const hiopMatrix& X) const;
+  virtual void transTimesMat(double beta, hiopMatrix& W, double alpha, const hiopMatrix& X) const;
+  virtual void timesMatTrans(double beta, hiopMatrix& W, double alpha, const hiopMatrix& X) const;
+
+  /* the diagonal entries need to be in the pattern */
+  virtual void addDiagonal(const hiopVector& d_);
+  virtual void addDiagonal(const double& value);
+  virtual void addSubDiagonal(long long start, const hiopVector& d_);
+  /* this += alpha*X, where X has the same pattern */
+  virtual void addMatrix(double alpha, const hiopMatrix& X);
+  virtual double max_abs_value();
+
+  virtual void print(FILE* f=NULL, const char* msg=NULL, int maxRows=-1, int maxCols=-1, int rank=-1) const;
+
+  virtual hiopMatrixSparse* alloc_clone() const;
+  virtual hiopMatrixSparse* new_copy() const;
+
+  virtual long long m() const {return nrows;}
+  virtual long long n() const {return ncols;}
+  inline int nnz() const { return nonzeroes; }
+  inline const int* get_irow() const { return irow; }
+  inline const int* get_jcol() const { return jcol; }
+  inline double* get_values() const { return values; }
+#ifdef DEEP_CHECKING
+  virtual bool assertSymmetry(double tol=1e-16) const;
+#endif
+private:
+  int nrows, ncols, nonzeroes;
+  int *irow; //row starts, of size nrows+1
+  int *jcol; //column indexes, sorted within each row
+  double* values;
+private:
+  hiopMatrixSparse() {};
+  hiopMatrixSparse(const hiopMatrixSparse&);
+};
+
+}
+#endif
@@ -0,0 +1,405 @@
+// Copyright (c) 2017, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory (LLNL).
+// Written by Cosmin G. Petra, petra1@llnl.gov.
+// LLNL-CODE-742473. All rights reserved.
+//
+// This file is part of HiOp. For details, see https://github.com/LLNL/hiop. HiOp 
+// is released under the BSD 3-clause license (https://opensource.org/licenses/BSD-3-Clause). 
+// Please also read “Additional BSD Notice” below.
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+// i. Redistributions of source code must retain the above copyright notice, this list 
+// of conditions and the disclaimer below.
+// ii. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the disclaimer (as noted below) in the documentation and/or 
+// other materials provided with the distribution.
+// iii. Neither the name of the LLNS/LLNL nor the names of its contributors may be used to 
+// endorse or promote products derived from this software without specific prior written 
+// permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY 
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES 
+// OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT 
+// SHALL LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR 
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS 
+// OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Additional BSD Notice
+// 1. This notice is required to be provided under our contract with the U.S. Department 
+// of Energy (DOE). This work was produced at Lawrence Livermore National Laboratory under 
+// Contract No. DE-AC52-07NA27344 with the DOE.
+// 2. Neither the United States Government nor Lawrence Livermore National Security, LLC 
+// nor any of their employees, makes any warranty, express or implied, or assumes any 
+// liability or responsibility for the accuracy, completeness, or usefulness of any 
+// information, apparatus, product, or process disclosed, or represents that its use would
+// not infringe privately-owned rights.
+// 3. Also, reference herein to any specific commercial products, process, or services by 
+// trade name, trademark, manufacturer or otherwise does not necessarily constitute or 
+// imply its endorsement, recommendation, or favoring by the United States Government or 
+// Lawrence Livermore National Security, LLC. The views and opinions of authors expressed 
+// herein do not necessarily state or reflect those of the United States Government or 
+// Lawrence Livermore National Security, LLC, and shall not be used for advertising or 
+// product endorsement purposes.
+
+#include "hiopMatrixSymBlockCyclic.hpp"
+
+#include "blasdefs.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <cmath>
+
+namespace hiop
+{
+
+hiopMatrixSymBlockCyclic::hiopMatrixSymBlockCyclic(long long m, int block_size, MPI_Comm comm_)
+  : n(m), nb(block_size), comm(comm_), rank(0), num_ranks(1)
+{
+  assert(nb>0);
+  nblk = (n+nb-1)/nb;
+#ifdef WITH_MPI
+  int ierr = MPI_Comm_rank(comm, &rank); assert(MPI_SUCCESS==ierr);
+  ierr = MPI_Comm_size(comm, &num_ranks); assert(MPI_SUCCESS==ierr);
+#endif
+  //the grid is pr x pc with pr>=pc and as square as possible
+  pc=1;
+  for(int p=1; p*p<=num_ranks; p++) 
+    if(num_ranks%p==0) pc=p;
+  pr=num_ranks/pc;
+  myrow=rank/pc; mycol=rank%pc;
+#ifdef WITH_MPI
+  ierr = MPI_Comm_split(comm, myrow, mycol, &row_comm); assert(MPI_SUCCESS==ierr);
+  ierr = MPI_Comm_split(comm, mycol, myrow, &col_comm); assert(MPI_SUCCESS==ierr);
+#endif
+
+  //the blocks of each rank are stored by block columns
+  blk_pos.resize(nblk*(nblk+1)/2);
+  recv_counts.assign(num_ranks, 0);
+  std::vector<long long> sizes(num_ranks, 0);
+  for(long long J=0; J<nblk; J++) {
+    for(long long I=J; I<nblk; I++) {
+      const int p=owner(I,J);
+      blk_pos[I*(I+1)/2+J] = sizes[p];
+      sizes[p] += (long long)block_dim(I)*block_dim(J);
+    }
+  }
+  contrib_disp.resize(num_ranks+1);
+  contrib_disp[0]=0;
+  for(int p=0; p<num_ranks; p++) {
+    recv_counts[p] = (int)sizes[p];
+    contrib_disp[p+1] = contrib_disp[p]+sizes[p];
+  }
+  vals.assign(sizes[rank], 0.);
+}
+
+hiopMatrixSymBlockCyclic::~hiopMatrixSymBlockCyclic()
+{
+#ifdef WITH_MPI
+  //the owner may be destroyed after MPI_Finalize
+  int finalized=0;
+  MPI_Finalized(&finalized);
+  if(!finalized) {
+    MPI_Comm_free(&row_comm);
+    MPI_Comm_free(&col_comm);
+  }
+#endif
+}
+
+void hiopMatrixSymBlockCyclic::setToZero()
+{
+  if(!vals.empty()) memset(&vals[0], 0, vals.size()*sizeof(double));
+}
+
+void hiopMatrixSymBlockCyclic::copyFrom(const hiopMatrixSymBlockCyclic& other)
+{
+  assert(n==other.n && nb==other.nb && num_ranks==other.num_ranks);
+  vals = other.vals;
+}
+
+void hiopMatrixSymBlockCyclic::zeroContributions()
+{
+  contrib.assign(contrib_disp[num_ranks], 0.);
+}
+
+void hiopMatrixSymBlockCyclic::
+addContribSymmTimesDiagTimesMatTrans(double alpha, const hiopMatrixDense& X, const hiopVectorPar* d)
+{
+  assert(X.m()==n);
+  assert((long long)contrib.size()==contrib_disp[num_ranks]);
+  int nloc=(int)X.get_local_size_n();
+  if(0==nloc) return;
+  double** Xd=X.local_data();
+  const double* dd = d ? d->local_data_const() : NULL;
+  char transA='T', transB='N'; double one=1.;
+  std::vector<double>& XDJ=work1;
+  XDJ.resize((size_t)nb*nloc);
+  for(long long J=0; J<nblk; J++) {
+    int bJ=block_dim(J);
+    //the rows of block J of X scaled by d
+    for(int j=0; j<bJ; j++) {
+      const double* xj=Xd[J*nb+j]; double* dst=&XDJ[(size_t)j*nloc];
+      if(dd) for(int p=0; p<nloc; p++) dst[p]=xj[p]*dd[p];
+      else   memcpy(dst, xj, nloc*sizeof(double));
+    }
+    for(long long I=J; I<nblk; I++) {
+      int bI=block_dim(I);
+      double* C=&contrib[contrib_disp[owner(I,J)]+blk_pos[I*(I+1)/2+J]];
+      DGEMM(&transA, &transB, &bI, &bJ, &nloc, &alpha, Xd[I*nb], &nloc, &XDJ[0], &nloc, &one, C, &bI);
+    }
+  }
+}
+
+void hiopMatrixSymBlockCyclic::
+addContribMatTimesMatTrans(double alpha, const hiopMatrixDense& A, const hiopMatrixDense& B)
+{
+  assert(A.m()==n && B.m()==n);
+  assert(A.get_local_size_n()==B.get_local_size_n());
+  assert((long long)contrib.size()==contrib_disp[num_ranks]);
+  int nloc=(int)A.get_local_size_n();
+  if(0==nloc) return;
+  double **Ad=A.local_data(), **Bd=B.local_data();
+  char transA='T', transB='N'; double one=1.;
+  for(long long J=0; J<nblk; J++) {
+    int bJ=block_dim(J);
+    for(long long I=J; I<nblk; I++) {
+      int bI=block_dim(I);
+      double* C=&contrib[contrib_disp[owner(I,J)]+blk_pos[I*(I+1)/2+J]];
+      DGEMM(&transA, &transB, &bI, &bJ, &nloc, &alpha, Ad[I*nb], &nloc, Bd[J*nb], &nloc, &one, C, &bI);
+    }
+  }
+}
+
+void hiopMatrixSymBlockCyclic::reduceContributions()
+{
+  assert((long long)contrib.size()==contrib_disp[num_ranks]);
+#ifdef WITH_MPI
+  int ierr = MPI_Reduce_scatter(contrib.size()>0 ? &contrib[0] : NULL, vals.size()>0 ? &vals[0] : NULL, 
+				&recv_counts[0], MPI_DOUBLE, MPI_SUM, comm); 
+  assert(MPI_SUCCESS==ierr);
+#else
+  vals=contrib;
+#endif
+}
+
+void hiopMatrixSymBlockCyclic::addMatTimesMatTrans(double alpha, const hiopMatrixDense& A, const hiopMatrixDense& B)
+{
+  assert(A.m()==n && B.m()==n);
+  assert(A.n()==B.n());
+  int l=(int)A.n();
+  if(0==l) return;
+  double **Ad=A.local_data(), **Bd=B.local_data();
+  char transA='T', transB='N'; double one=1.;
+  for(long long J=mycol; J<nblk; J+=pc) {
+    int bJ=block_dim(J);
+    for(long long I=J+((myrow-J%pr)+pr)%pr; I<nblk; I+=pr) {
+      int bI=block_dim(I);
+      DGEMM(&transA, &transB, &bI, &bJ, &l, &alpha, Ad[I*nb], &l, Bd[J*nb], &l, &one, &vals[local_offset(I,J)], &bI);
+    }
+  }
+}
+
+void hiopMatrixSymBlockCyclic::addSubDiagonal(long long start, const hiopVectorPar& d)
+{
+  const long long len=d.get_size();
+  assert(start>=0 && start+len<=n);
+  const double* dd=d.local_data_const();
+  for(long long i=start; i<start+len; i++) {
+    long long I=i/nb, off=local_offset(I,I);
+    if(off<0) continue;
+    int bI=block_dim(I), ii=(int)(i-I*nb);
+    vals[off+ii+(long long)ii*bI] += dd[i-start];
+  }
+}
+
+void hiopMatrixSymBlockCyclic::addSubDiagonal(long long start, long long len, double value)
+{
+  assert(start>=0 && start+len<=n);
+  for(long long i=start; i<start+len; i++) {
+    long long I=i/nb, off=local_offset(I,I);
+    if(off<0) continue;
+    int bI=block_dim(I), ii=(int)(i-I*nb);
+    vals[off+ii+(long long)ii*bI] += value;
+  }
+}
+
+/* the diagonal blocks are used in full, so this is not valid after 'factorize' */
+void hiopMatrixSymBlockCyclic::timesVec(double beta, hiopVectorPar& y, double alpha, const hiopVectorPar& x) const
+{
+  assert(x.get_size()==n && y.get_size()==n);
+  if(0==n) return;
+  std::vector<double>& t=work1;
+  t.assign(n, 0.);
+  const double* xd=x.local_data_const();
+  char transN='N', transT='T'; double one=1.; int ione=1;
+  for(long long J=mycol; J<nblk; J+=pc) {
+    int bJ=block_dim(J);
+    for(long long I=J+((myrow-J%pr)+pr)%pr; I<nblk; I+=pr) {
+      int bI=block_dim(I);
+      double* A=const_cast<double*>(&vals[local_offset(I,J)]);
+      DGEMV(&transN, &bI, &bJ, &one, A, &bI, xd+J*nb, &ione, &one, &t[I*nb], &ione);
+      if(I!=J)
+	DGEMV(&transT, &bI, &bJ, &one, A, &bI, xd+I*nb, &ione, &one, &t[J*nb], &ione);
+    }
+  }
+#ifdef WITH_MPI
+  int ierr = MPI_Allreduce(MPI_IN_PLACE, &t[0], n, MPI_DOUBLE, MPI_SUM, comm); assert(MPI_SUCCESS==ierr);
+#endif
+  double* yd=y.local_data();
+  for(long long i=0; i<n; i++) yd[i] = beta*yd[i]+alpha*t[i];
+}
+
+int hiopMatrixSymBlockCyclic::factorize()
+{
+  if(0==n) return 0;
+  std::vector<double> &panel=work1, &buf=work2, diag((size_t)nb*nb+1);
+  panel.resize((size_t)n*nb+1);
+  char uplo='L', side='R', transT='T', transN='N', unit='N'; 
+  double one=1., mone=-1.;
+  for(long long K=0; K<nblk; K++) {
+    int bK=block_dim(K);
+    const long long r0=K*nb+bK; //first row of the panel
+    int ldp=(int)(n-r0);
+    if(mycol==K%pc) {
+      //factorize the diagonal block and send it down the column of the grid
+      if(myrow==K%pr) {
+	double* A=&vals[local_offset(K,K)];
+	int info=0;
+	DPOTRF(&uplo, &bK, A, &bK, &info);
+	assert(info>=0);
+	memcpy(&diag[0], A, (size_t)bK*bK*sizeof(double));
+	diag[(size_t)bK*bK] = info>0 ? (double)(K*nb+info) : 0.;
+      }
+#ifdef WITH_MPI
+      int ierr = MPI_Bcast(&diag[0], bK*bK+1, MPI_DOUBLE, (int)(K%pr), col_comm); assert(MPI_SUCCESS==ierr);
+#endif
+      //the local blocks of the panel: L_IK = A_IK*L_KK^{-T}
+      const double info = diag[(size_t)bK*bK];
+      buf.clear();
+      for(long long I=K+1+((myrow-(K+1)%pr)+pr)%pr; I<nblk; I+=pr) {
+	int bI=block_dim(I);
+	double* A=&vals[local_offset(I,K)];
+	if(0==info) DTRSM(&side, &uplo, &transT, &unit, &bI, &bK, &one, &diag[0], &bK, A, &bI);
+	buf.insert(buf.end(), A, A+(size_t)bI*bK);
+      }
+      //gather the panel within the column of the grid
+      std::vector<int> counts(pr,0), displs(pr+1,0);
+      for(long long I=K+1; I<nblk; I++) counts[I%pr] += block_dim(I)*bK;
+      for(int q=0; q<pr; q++) displs[q+1]=displs[q]+counts[q];
+      std::vector<double> gath(displs[pr]);
+#ifdef WITH_MPI
+      ierr = MPI_Allgatherv(buf.size()>0 ? &buf[0] : NULL, (int)buf.size(), MPI_DOUBLE, 
+			    gath.size()>0 ? &gath[0] : NULL, &counts[0], &displs[0], MPI_DOUBLE, col_comm);
+      assert(MPI_SUCCESS==ierr);
+#else
+      gath=buf;
+#endif
+      for(int q=0; q<pr; q++) {
+	long long pos=displs[q];
+	for(long long I=K+1+((q-(K+1)%pr)+pr)%pr; I<nblk; I+=pr) {
+	  int bI=block_dim(I);
+	  for(int j=0; j<bK; j++)
+	    memcpy(&panel[(size_t)j*ldp+I*nb-r0], &gath[pos+(size_t)j*bI], bI*sizeof(double));
+	  pos += (long long)bI*bK;
+	}
+      }
+      panel[(size_t)ldp*bK]=info;
+    }
+    //send the panel along the rows of the grid
+#ifdef WITH_MPI
+    int ierr = MPI_Bcast(&panel[0], ldp*bK+1, MPI_DOUBLE, (int)(K%pc), row_comm); assert(MPI_SUCCESS==ierr);
+#endif
+    if(panel[(size_t)ldp*bK]!=0.) return (int)panel[(size_t)ldp*bK];
+
+    //update of the local blocks of the trailing matrix
+    for(long long J=K+1+((mycol-(K+1)%pc)+pc)%pc; J<nblk; J+=pc) {
+      int bJ=block_dim(J);
+      for(long long I=J+((myrow-J%pr)+pr)%pr; I<nblk; I+=pr) {
+	int bI=block_dim(I);
+	DGEMM(&transN, &transT, &bI, &bJ, &bK, &mone, &panel[I*nb-r0], &ldp, &panel[J*nb-r0], &ldp, 
+	      &one, &vals[local_offset(I,J)], &bI);
+      }
+    }
+  }
+  return 0;
+}
+
+void hiopMatrixSymBlockCyclic::solve(hiopVectorPar& x) const
+{
+  assert(x.get_size()==n);
+  if(0==n) return;
+  double* xd=x.local_data();
+  std::vector<double> &acc=work1, red(nb);
+  char uplo='L', side='L', transN='N', transT='T', unit='N';
+  double one=1.; int ione=1;
+#ifdef WITH_MPI
+  int ierr;
+#endif
+  //forward substitution L*y=x; the contributions L_KJ*y_J are summed along the rows of the grid
+  acc.assign(n, 0.);
+  for(long long K=0; K<nblk; K++) {
+    int bK=block_dim(K);
+    double* xK=xd+K*nb;
+    if(myrow==K%pr) {
+#ifdef WITH_MPI
+      ierr = MPI_Reduce(&acc[K*nb], &red[0], bK, MPI_DOUBLE, MPI_SUM, (int)(K%pc), row_comm); assert(MPI_SUCCESS==ierr);
+#else
+      memcpy(&red[0], &acc[K*nb], bK*sizeof(double));
+#endif
+      if(mycol==K%pc) {
+	for(int i=0; i<bK; i++) xK[i] -= red[i];
+	DTRSM(&side, &uplo, &transN, &unit, &bK, &ione, &one, &vals[local_offset(K,K)], &bK, xK, &bK);
+      }
+    }
+    if(mycol==K%pc) {
+#ifdef WITH_MPI
+      ierr = MPI_Bcast(xK, bK, MPI_DOUBLE, (int)(K%pr), col_comm); assert(MPI_SUCCESS==ierr);
+#endif
+      for(long long I=K+1+((myrow-(K+1)%pr)+pr)%pr; I<nblk; I+=pr) {
+	int bI=block_dim(I);
+	DGEMV(&transN, &bI, &bK, &one, const_cast<double*>(&vals[local_offset(I,K)]), &bI, xK, &ione, 
+	      &one, &acc[I*nb], &ione);
+      }
+    }
+  }
+  //backward substitution L^T*x=y; the contributions L_IK^T*x_I are summed along the columns of the grid
+  acc.assign(n, 0.);
+  for(long long K=nblk-1; K>=0; K--) {
+    int bK=block_dim(K);
+    double* xK=xd+K*nb;
+    if(mycol==K%pc) {
+#ifdef WITH_MPI
+      ierr = MPI_Reduce(&acc[K*nb], &red[0], bK, MPI_DOUBLE, MPI_SUM, (int)(K%pr), col_comm); assert(MPI_SUCCESS==ierr);
+#else
+      memcpy(&red[0], &acc[K*nb], bK*sizeof(double));
+#endif
+      if(myrow==K%pr) {
+	for(int i=0; i<bK; i++) xK[i] -= red[i];
+	DTRSM(&side, &uplo, &transT, &unit, &bK, &ione, &one, &vals[local_offset(K,K)], &bK, xK, &bK);
+      }
+    }
+    if(myrow==K%pr) {
+#ifdef WITH_MPI
+      ierr = MPI_Bcast(xK, bK, MPI_DOUBLE, (int)(K%pc), row_comm); assert(MPI_SUCCESS==ierr);
+#endif
+      for(long long J=mycol; J<K; J+=pc) {
+	int bJ=block_dim(J);
+	DGEMV(&transT, &bK, &bJ, &one, const_cast<double*>(&vals[local_offset(K,J)]), &bK, xK, &ione, 
+	      &one, &acc[J*nb], &ione);
+      }
+    }
+  }
+#ifdef WITH_MPI
+  //the solution is on the ranks owning the diagonal blocks
+  for(long long K=0; K<nblk; K++) 
+    if(owner(K,K)!=rank) 
+      memset(xd+K*nb, 0, block_dim(K)*sizeof(double));
+  ierr = MPI_Allreduce(MPI_IN_PLACE, xd, n, MPI_DOUBLE, MPI_SUM, comm); assert(MPI_SUCCESS==ierr);
+#endif
+}
+
+}
@@ -0,0 +1,140 @@
+// Copyright (c) 2017, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory (LLNL).
+// Written by Cosmin G. Petra, petra1@llnl.gov.
+// LLNL-CODE-742473. All rights reserved.
+//
+// This file is part of HiOp. For details, see https://github.com/LLNL/hiop. HiOp 
+// is released under the BSD 3-clause license (https://opensource.org/licenses/BSD-3-Clause). 
+// Please also read “Additional BSD Notice” below.
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+// i. Redistributions of source code must retain the above copyright notice, this list 
+// of conditions and the disclaimer below.
+// ii. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the disclaimer (as noted below) in the documentation and/or 
+// other materials provided with the distribution.
+// iii. Neither the name of the LLNS/LLNL nor the names of its contributors may be used to 
+// endorse or promote products derived from this software without specific prior written 
+// permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY 
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES 
+// OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT 
+// SHALL LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR 
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS 
+// OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Additional BSD Notice
+// 1. This notice is required to be provided under our contract with the U.S. Department 
+// of Energy (DOE). This work was produced at Lawrence Livermore National Laboratory under 
+// Contract No. DE-AC52-07NA27344 with the DOE.
+// 2. Neither the United States Government nor Lawrence Livermore National Security, LLC 
+// nor any of their employees, makes any warranty, express or implied, or assumes any 
+// liability or responsibility for the accuracy, completeness, or usefulness of any 
+// information, apparatus, product, or process disclosed, or represents that its use would
+// not infringe privately-owned rights.
+// 3. Also, reference herein to any specific commercial products, process, or services by 
+// trade name, trademark, manufacturer or otherwise does not necessarily constitute or 
+// imply its endorsement, recommendation, or favoring by the United States Government or 
+// Lawrence Livermore National Security, LLC. The views and opinions of authors expressed 
+// herein do not necessarily state or reflect those of the United States Government or 
+// Lawrence Livermore National Security, LLC, and shall not be used for advertising or 
+// product endorsement purposes.
+
+#ifndef HIOP_MATRIX_SYM_BLOCK_CYCLIC
+#define HIOP_MATRIX_SYM_BLOCK_CYCLIC
+
+#include "hiopMatrix.hpp"
+#include "hiopVector.hpp"
+
+#include <vector>
+
+namespace hiop
+{
+
+/** Symmetric matrix distributed over the ranks of a communicator in a 2D block-cyclic layout: the 
+ *  ranks form a pr x pc grid and the block (I,J) is owned by the rank (I%pr, J%pc). Only the blocks
+ *  of the lower triangle are stored (each one dense and column major); the diagonal blocks are full.
+ *
+ *  The matrix is usually assembled from local contributions of the same (global) size on each rank,
+ *  which are summed with one MPI_Reduce_scatter directly in the block-cyclic layout. The Cholesky 
+ *  factorization is a right-looking blocked algorithm in which the panel of each block column is
+ *  broadcast along the rows and the columns of the grid. The solves take a right-hand side that is 
+ *  replicated on all ranks and return a replicated solution.
+ */
+class hiopMatrixSymBlockCyclic
+{
+public:
+  hiopMatrixSymBlockCyclic(long long m, int block_size, MPI_Comm comm);
+  virtual ~hiopMatrixSymBlockCyclic();
+
+  void setToZero();
+  void copyFrom(const hiopMatrixSymBlockCyclic& other);
+
+  /* local contributions: reset, add to, and sum over the ranks in 'this' (collective); only the blocks 
+   * of the lower triangle of the contributions are formed */
+  void zeroContributions();
+  /* contributions += alpha*X*diag(d)*X^T, where X is distributed column-wise; d=NULL means identity */
+  void addContribSymmTimesDiagTimesMatTrans(double alpha, const hiopMatrixDense& X, const hiopVectorPar* d);
+  /* contributions += alpha*A*B^T, where A and B are distributed column-wise */
+  void addContribMatTimesMatTrans(double alpha, const hiopMatrixDense& A, const hiopMatrixDense& B);
+  /* this = the sum over the ranks of the contributions */
+  void reduceContributions();
+
+  /* this += alpha*A*B^T, with A and B of size m x l and replicated; done on the local blocks */
+  void addMatTimesMatTrans(double alpha, const hiopMatrixDense& A, const hiopMatrixDense& B);
+  /* adds d to the diagonal, starting at 'start' */
+  void addSubDiagonal(long long start, const hiopVectorPar& d);
+  void addSubDiagonal(long long start, long long len, double value);
+
+  /* y = beta*y + alpha*this*x, with x and y replicated (collective) */
+  void timesVec(double beta, hiopVectorPar& y, double alpha, const hiopVectorPar& x) const;
+
+  /* in-place Cholesky factorization (collective); returns 0 or the (1-based) index of the first 
+   * non-positive pivot, the same on all ranks */
+  int factorize();
+  /* solves with the Cholesky factors; x is replicated and is overwritten with the solution (collective) */
+  void solve(hiopVectorPar& x) const;
+
+  inline long long m() const { return n; }
+  inline int get_block_size() const { return nb; }
+  inline int get_grid_rows() const { return pr; }
+  inline int get_grid_cols() const { return pc; }
+  /* number of entries stored by this rank */
+  inline long long get_local_size() const { return (long long)vals.size(); }
+private:
+  inline int block_dim(long long I) const { return (int)((I+1)*nb<=n ? nb : n-I*nb); }
+  inline int owner(long long I, long long J) const { return (int)(I%pr)*pc + (int)(J%pc); }
+  /* position of the local block (I,J) in 'vals' or -1 if it is not local */
+  inline long long local_offset(long long I, long long J) const
+  {
+    if(I<J || I%pr!=myrow || J%pc!=mycol) return -1;
+    return blk_pos[I*(I+1)/2+J];
+  }
+private:
+  long long n, nblk;
+  int nb;
+  MPI_Comm comm;
+#ifdef WITH_MPI
+  MPI_Comm row_comm, col_comm;
+#endif
+  int rank, num_ranks, pr, pc, myrow, mycol;
+  //position of each block (I,J), I>=J, in the storage of its owner
+  std::vector<long long> blk_pos;
+  std::vector<double> vals;
+  //contributions of this rank, ordered by the owner ranks and then as in the storage of the owners
+  std::vector<double> contrib;
+  std::vector<long long> contrib_disp;
+  std::vector<int> recv_counts;
+  mutable std::vector<double> work1, work2;
+private:
+  hiopMatrixSymBlockCyclic(const hiopMatrixSymBlockCyclic&) {};
+};
+
+}
+#endif
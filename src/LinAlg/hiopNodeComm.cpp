@@ -0,0 +1,190 @@
+// Copyright (c) 2017, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory (LLNL).
+// Written by Cosmin G. Petra, petra1@llnl.gov.
+// LLNL-CODE-742473. All rights reserved.
+//
+// This file is part of HiOp. For details, see https://github.com/LLNL/hiop. HiOp 
+// is released under the BSD 3-clause license (https://opensource.org/licenses/BSD-3-Clause). 
+// Please also read “Additional BSD Notice” below.
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+// i. Redistributions of source code must retain the above copyright notice, this list 
+// of conditions and the disclaimer below.
+// ii. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the disclaimer (as noted below) in the documentation and/or 
+// other materials provided with the distribution.
+// iii. Neither the name of the LLNS/LLNL nor the names of its contributors may be used to 
+// endorse or promote products derived from this software without specific prior written 
+// permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY 
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES 
+// OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT 
+// SHALL LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR 
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS 
+// OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Additional BSD Notice
+// 1. This notice is required to be provided under our contract with the U.S. Department 
+// of Energy (DOE). This work was produced at Lawrence Livermore National Laboratory under 
+// Contract No. DE-AC52-07NA27344 with the DOE.
+// 2. Neither the United States Government nor Lawrence Livermore National Security, LLC 
+// nor any of their employees, makes any warranty, express or implied, or assumes any 
+// liability or responsibility for the accuracy, completeness, or usefulness of any 
+// information, apparatus, product, or process disclosed, or represents that its use would
+// not infringe privately-owned rights.
+// 3. Also, reference herein to any specific commercial products, process, or services by 
+// trade name, trademark, manufacturer or otherwise does not necessarily constitute or 
+// imply its endorsement, recommendation, or favoring by the United States Government or 
+// Lawrence Livermore National Security, LLC. The views and opinions of authors expressed 
+// herein do not necessarily state or reflect those of the United States Government or 
+// Lawrence Livermore National Security, LLC, and shall not be used for advertising or 
+// product endorsement purposes.
+
+#include "hiopNodeComm.hpp"
+
+#include "blasdefs.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+
+namespace hiop
+{
+
+hiopNodeComm::hiopNodeComm(MPI_Comm comm)
+  : node_rank(0), node_size(1), num_nodes(1)
+{
+#ifdef WITH_MPI
+  int rank, ierr;
+  ierr = MPI_Comm_rank(comm, &rank); assert(MPI_SUCCESS==ierr);
+  ierr = MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node_comm); assert(MPI_SUCCESS==ierr);
+  ierr = MPI_Comm_rank(node_comm, &node_rank); assert(MPI_SUCCESS==ierr);
+  ierr = MPI_Comm_size(node_comm, &node_size); assert(MPI_SUCCESS==ierr);
+  ierr = MPI_Comm_split(comm, node_rank==0 ? 0 : MPI_UNDEFINED, rank, &leader_comm); assert(MPI_SUCCESS==ierr);
+  if(is_leader()) { ierr = MPI_Comm_size(leader_comm, &num_nodes); assert(MPI_SUCCESS==ierr); }
+  ierr = MPI_Bcast(&num_nodes, 1, MPI_INT, 0, node_comm); assert(MPI_SUCCESS==ierr);
+#endif
+}
+
+hiopNodeComm::~hiopNodeComm()
+{
+  while(!bufs.empty()) free_shared(bufs.back());
+#ifdef WITH_MPI
+  //the owner may be destroyed after MPI_Finalize
+  int finalized=0;
+  MPI_Finalized(&finalized);
+  if(!finalized) {
+    if(leader_comm!=MPI_COMM_NULL) MPI_Comm_free(&leader_comm);
+    MPI_Comm_free(&node_comm);
+  }
+#endif
+}
+
+double* hiopNodeComm::alloc_shared(long long n)
+{
+  double* buf=NULL;
+#ifdef WITH_MPI
+  MPI_Win win;
+  double* base;
+  MPI_Aint size = is_leader() ? (MPI_Aint)(std::max(n,1LL)*sizeof(double)) : 0;
+  int ierr = MPI_Win_allocate_shared(size, sizeof(double), MPI_INFO_NULL, node_comm, &base, &win); 
+  assert(MPI_SUCCESS==ierr);
+  int disp_unit;
+  ierr = MPI_Win_shared_query(win, 0, &size, &disp_unit, &buf); assert(MPI_SUCCESS==ierr);
+  //passive target epoch for the lifetime of the window; the accesses are ordered by 'sync'
+  ierr = MPI_Win_lock_all(MPI_MODE_NOCHECK, win); assert(MPI_SUCCESS==ierr);
+  wins.push_back(win);
+#else
+  buf = new double[std::max(n,1LL)];
+#endif
+  bufs.push_back(buf);
+  return buf;
+}
+
+void hiopNodeComm::free_shared(double* buf)
+{
+  std::vector<double*>::iterator it = std::find(bufs.begin(), bufs.end(), buf);
+  assert(it!=bufs.end());
+#ifdef WITH_MPI
+  MPI_Win& win = wins[it-bufs.begin()];
+  int finalized=0;
+  MPI_Finalized(&finalized);
+  if(!finalized) {
+    MPI_Win_unlock_all(win);
+    MPI_Win_free(&win);
+  }
+  wins.erase(wins.begin()+(it-bufs.begin()));
+#else
+  delete[] buf;
+#endif
+  bufs.erase(it);
+}
+
+void hiopNodeComm::reduce(const double* local, double* shared, long long n)
+{
+#ifdef WITH_MPI
+  int ierr = MPI_Reduce(const_cast<double*>(local), is_leader() ? shared : NULL, (int)n, MPI_DOUBLE, MPI_SUM, 0, node_comm);
+  assert(MPI_SUCCESS==ierr);
+  if(is_leader() && num_nodes>1) {
+    ierr = MPI_Allreduce(MPI_IN_PLACE, shared, (int)n, MPI_DOUBLE, MPI_SUM, leader_comm); assert(MPI_SUCCESS==ierr);
+  }
+#else
+  memcpy(shared, local, n*sizeof(double));
+#endif
+}
+
+void hiopNodeComm::allreduce(const double* local, double* shared, long long n)
+{
+  reduce(local, shared, n);
+  sync();
+}
+
+void hiopNodeComm::matTimesDiagTimesMatTrans(hiopMatrixDense& W, double alpha, const hiopMatrixDense& X, 
+					     const hiopVectorPar* d, const hiopMatrixDense& Y)
+{
+  const int m=W.m(), k=W.n();
+  assert(X.m()==m && Y.m()==k);
+  int nloc=X.get_local_size_n(), ld=nloc>0 ? nloc : 1;
+  assert(Y.get_local_size_n()==nloc);
+  const int rb=row_block, b=std::min(rb, std::max(m,1));
+  std::vector<double> XD((size_t)b*ld), C((size_t)b*std::max(k,1));
+  const double* dv = d ? d->local_data_const() : NULL;
+  char transA='T', transB='N'; double zero=0.;
+  int k_=k;
+  for(int i0=0; i0<m; i0+=b) {
+    int nb=std::min(b, m-i0);
+    //XD = rows i0:i0+nb of X*diag(d) and C = alpha*XD*Y^T (row-major, hence the transposes)
+    const double* Xi=X.local_buffer()+(size_t)i0*nloc;
+    for(int i=0; i<nb; i++)
+      for(int p=0; p<nloc; p++) XD[(size_t)i*ld+p] = dv ? Xi[(size_t)i*nloc+p]*dv[p] : Xi[(size_t)i*nloc+p];
+    if(k>0)
+      DGEMM(&transA, &transB, &k_, &nb, &nloc, &alpha, Y.local_buffer(), &ld, &XD[0], &ld, &zero, &C[0], &k_);
+    reduce(&C[0], W.local_buffer()+(size_t)i0*k, (long long)nb*k);
+  }
+  sync();
+}
+
+void hiopNodeComm::sync()
+{
+#ifdef WITH_MPI
+  for(size_t i=0; i<wins.size(); i++) MPI_Win_sync(wins[i]);
+  int ierr = MPI_Barrier(node_comm); assert(MPI_SUCCESS==ierr);
+  for(size_t i=0; i<wins.size(); i++) MPI_Win_sync(wins[i]);
+#endif
+}
+
+int hiopNodeComm::bcast_from_leader(int v)
+{
+#ifdef WITH_MPI
+  int ierr = MPI_Bcast(&v, 1, MPI_INT, 0, node_comm); assert(MPI_SUCCESS==ierr);
+#endif
+  return v;
+}
+
+}
@@ -0,0 +1,109 @@
+// Copyright (c) 2017, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory (LLNL).
+// Written by Cosmin G. Petra, petra1@llnl.gov.
+// LLNL-CODE-742473. All rights reserved.
+//
+// This file is part of HiOp. For details, see https://github.com/LLNL/hiop. HiOp 
+// is released under the BSD 3-clause license (https://opensource.org/licenses/BSD-3-Clause). 
+// Please also read “Additional BSD Notice” below.
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+// i. Redistributions of source code must retain the above copyright notice, this list 
+// of conditions and the disclaimer below.
+// ii. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the disclaimer (as noted below) in the documentation and/or 
+// other materials provided with the distribution.
+// iii. Neither the name of the LLNS/LLNL nor the names of its contributors may be used to 
+// endorse or promote products derived from this software without specific prior written 
+// permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY 
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES 
+// OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT 
+// SHALL LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR 
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS 
+// OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Additional BSD Notice
+// 1. This notice is required to be provided under our contract with the U.S. Department 
+// of Energy (DOE). This work was produced at Lawrence Livermore National Laboratory under 
+// Contract No. DE-AC52-07NA27344 with the DOE.
+// 2. Neither the United States Government nor Lawrence Livermore National Security, LLC 
+// nor any of their employees, makes any warranty, express or implied, or assumes any 
+// liability or responsibility for the accuracy, completeness, or usefulness of any 
+// information, apparatus, product, or process disclosed, or represents that its use would
+// not infringe privately-owned rights.
+// 3. Also, reference herein to any specific commercial products, process, or services by 
+// trade name, trademark, manufacturer or otherwise does not necessarily constitute or 
+// imply its endorsement, recommendation, or favoring by the United States Government or 
+// Lawrence Livermore National Security, LLC. The views and opinions of authors expressed 
+// herein do not necessarily state or reflect those of the United States Government or 
+// Lawrence Livermore National Security, LLC, and shall not be used for advertising or 
+// product endorsement purposes.
+
+#ifndef HIOP_NODE_COMM
+#define HIOP_NODE_COMM
+
+#include "hiopMatrix.hpp"
+#include "hiopVector.hpp"
+
+#include <vector>
+
+namespace hiop
+{
+
+/** Node-aware storage and reductions for the small matrices that are otherwise replicated on all the ranks
+ *  (option 'node_shared_reduced_mats'). The communicator is split by shared memory: the buffers are MPI-3 
+ *  shared windows allocated by the leader (rank 0) of each node and read directly by the other ranks of the 
+ *  node. Sums over all the ranks are reduced within the node into the shared buffer and all-reduced across 
+ *  the node leaders only. The leaders do the updates of the shared matrices (e.g., the factorizations) and 
+ *  'sync' makes them visible to the node. Without MPI, the buffers are local.
+ */
+class hiopNodeComm
+{
+public:
+  hiopNodeComm(MPI_Comm comm);
+  virtual ~hiopNodeComm();
+
+  /* buffer of n doubles shared by the ranks of the node (collective over the node) */
+  double* alloc_shared(long long n);
+  void free_shared(double* buf);
+
+  /* shared = the sum over all the ranks of 'local' (n entries); 'shared' is complete on the node on return */
+  void allreduce(const double* local, double* shared, long long n);
+  /* W = alpha*X*diag(d)*Y^T summed over the ranks, for X and Y distributed column-wise and W in a shared 
+   * buffer (d=NULL means identity); the local products are formed and reduced in blocks of rows of W, so 
+   * that no rank holds a full local copy of W */
+  void matTimesDiagTimesMatTrans(hiopMatrixDense& W, double alpha, const hiopMatrixDense& X, 
+				 const hiopVectorPar* d, const hiopMatrixDense& Y);
+  /* the writes of the leader to the shared buffers become visible to the ranks of the node (collective) */
+  void sync();
+  /* value of the leader on all the ranks of the node */
+  int bcast_from_leader(int v);
+
+  inline bool is_leader() const { return 0==node_rank; }
+  inline int get_node_size() const { return node_size; }
+  inline int get_num_nodes() const { return num_nodes; }
+private:
+  //reduces within the node into 'shared' and across the node leaders; no synchronization
+  void reduce(const double* local, double* shared, long long n);
+private:
+  MPI_Comm node_comm, leader_comm;
+  int node_rank, node_size, num_nodes;
+  std::vector<double*> bufs;
+#ifdef WITH_MPI
+  std::vector<MPI_Win> wins;
+#endif
+  //number of rows of W reduced at once by matTimesDiagTimesMatTrans
+  static const int row_block=64;
+private:
+  hiopNodeComm(const hiopNodeComm&) {};
+};
+
+}
+#endif
@@ -56,6 +56,8 @@
 
 #include <limits>
 #include <cstddef>
+#include <vector>
+#include <algorithm>
 
 namespace hiop
 {
@@ -143,6 +145,54 @@ void hiopVectorPar::copyFrom(const double* v_local_data )
 }
 
 
+void hiopVectorPar::copyFromRedistributed(const hiopVectorPar& v)
+{
+  assert(n==v.n);
+  redistribute(v.data, v.n_local, data, n_local, comm);
+}
+
+void hiopVectorPar::redistribute(const double* src, long long n_src, double* dest, long long n_dest, MPI_Comm comm)
+{
+#ifdef WITH_MPI
+  int P, r, ierr;
+  ierr=MPI_Comm_size(comm, &P); assert(MPI_SUCCESS==ierr);
+  ierr=MPI_Comm_rank(comm, &r); assert(MPI_SUCCESS==ierr);
+  long long sizes[2]={n_src, n_dest};
+  std::vector<long long> all(2*P);
+  ierr=MPI_Allgather(sizes, 2, MPI_LONG_LONG, &all[0], 2, MPI_LONG_LONG, comm); assert(MPI_SUCCESS==ierr);
+  //starts of the slices of the old and new distributions
+  std::vector<long long> src_start(P+1,0), dest_start(P+1,0);
+  for(int p=0; p<P; p++) {
+    src_start[p+1]=src_start[p]+all[2*p];
+    dest_start[p+1]=dest_start[p]+all[2*p+1];
+  }
+  assert(src_start[P]==dest_start[P]);
+  //each rank sends to (receives from) rank p the overlap of its old (new) slice with the new (old) slice of p
+  std::vector<int> scounts(P,0), sdispls(P,0), rcounts(P,0), rdispls(P,0);
+  for(int p=0; p<P; p++) {
+    long long lo=std::max(src_start[r], dest_start[p]), hi=std::min(src_start[r+1], dest_start[p+1]);
+    if(hi>lo) { scounts[p]=hi-lo; sdispls[p]=lo-src_start[r]; }
+    lo=std::max(dest_start[r], src_start[p]); hi=std::min(dest_start[r+1], src_start[p+1]);
+    if(hi>lo) { rcounts[p]=hi-lo; rdispls[p]=lo-dest_start[r]; }
+  }
+  ierr=MPI_Alltoallv(const_cast<double*>(src), &scounts[0], &sdispls[0], MPI_DOUBLE, 
+		     dest, &rcounts[0], &rdispls[0], MPI_DOUBLE, comm); assert(MPI_SUCCESS==ierr);
+#else
+  assert(n_src==n_dest);
+  memcpy(dest, src, n_src*sizeof(double));
+#endif
+}
+
+void hiopVectorPar::copyFromSelected(const hiopVectorPar& v, const long long* idx)
+{
+  select(v.data, data, n_local, idx);
+}
+
+void hiopVectorPar::select(const double* src, double* dest, long long n_dest, const long long* idx)
+{
+  for(long long k=0; k<n_dest; k++) dest[k] = idx[k]>=0 ? src[idx[k]] : 0.;
+}
+
 void hiopVectorPar::copyFromStarting(const hiopVector& v_, int start_index)
 {
   const hiopVectorPar& v = dynamic_cast<const hiopVectorPar&>(v_);
@@ -172,6 +172,11 @@ public:
   virtual void copyFromStarting(const hiopVector& v, int start_index);
   virtual void copyTo(double* dest) const;
   virtual void copyToStarting(hiopVector& v, int start_index);
+  /* copies 'v', which has the same global size as 'this' but a different (contiguous) columns partitioning */
+  virtual void copyFromRedistributed(const hiopVectorPar& v);
+  /* copies the local entries idx[k] of 'v' in the local entries k, or zero where idx[k]<0; used when the working 
+   * set of the variables changes, which keeps the variables on their rank */
+  virtual void copyFromSelected(const hiopVectorPar& v, const long long* idx);
   virtual double twonorm() const;
   virtual double dotProductWith( const hiopVector& v ) const;
   virtual double infnorm() const;
@@ -222,6 +227,13 @@ public:
   inline double* local_data() { return data; }
   inline const double* local_data_const() const { return data; }
 
+  /* moves a vector distributed contiguously, in the order of the ranks of 'comm', to another such 
+   * distribution: 'src' is the local slice of length n_src of the old distribution and 'dest' receives 
+   * the local slice of length n_dest of the new one */
+  static void redistribute(const double* src, long long n_src, double* dest, long long n_dest, MPI_Comm comm);
+  /* dest[k]=src[idx[k]], or zero where idx[k]<0, for k<n_dest */
+  static void select(const double* src, double* dest, long long n_dest, const long long* idx);
+
 protected:
   MPI_Comm comm;
   double* data;
@@ -52,40 +52,22 @@
 #include <cmath>
 #include <cstring>
 #include <cassert>
+#include <vector>
 
 namespace hiop
 {
 
-hiopAlgFilterIPM::hiopAlgFilterIPM(hiopNlpDenseConstraints* nlp_)
+hiopAlgFilterIPM::hiopAlgFilterIPM(hiopNlpFormulation* nlp_)
 {
   nlp = nlp_;
-
-  it_curr = new hiopIterate(nlp);
-  it_trial= it_curr->alloc_clone();
-  dir     = it_curr->alloc_clone();
-
-  logbar = new hiopLogBarProblem(nlp);
+  nlpdc = dynamic_cast<hiopNlpDenseConstraints*>(nlp_);
+  nlpbc = dynamic_cast<hiopNlpBlockConstraints*>(nlp_);
+  monitor = NULL;
+  metrics_sink = NULL;
+  metrics_file_sink = NULL;
 
   _f_nlp = _f_log = 0; 
-  _c = nlp->alloc_dual_eq_vec(); 
-  _d = nlp->alloc_dual_ineq_vec();
-
-  _grad_f  = nlp->alloc_primal_vec();
-  _Jac_c   = nlp->alloc_Jac_c();
-  _Jac_d   = nlp->alloc_Jac_d();
-
   _f_nlp_trial = _f_log_trial = 0;
-  _c_trial = nlp->alloc_dual_eq_vec(); 
-  _d_trial = nlp->alloc_dual_ineq_vec();
-
-  _grad_f_trial  = nlp->alloc_primal_vec();
-  _Jac_c_trial   = nlp->alloc_Jac_c();
-  _Jac_d_trial   = nlp->alloc_Jac_d();
-
-  _Hess    = new hiopHessianLowRank(nlp,nlp->options->GetInteger("secant_memory_len"));
-
-  resid = new hiopResidual(nlp);
-  resid_trial = new hiopResidual(nlp);
 
   //algorithm parameters parameters
   mu0=_mu  = nlp->options->GetNumeric("mu0"); 
@@ -103,40 +85,130 @@ hiopAlgFilterIPM::hiopAlgFilterIPM(hiopNlpDenseConstraints* nlp_)
 
   accep_n_it    = nlp->options->GetInteger("acceptable_iterations");
   eps_tol_accep = nlp->options->GetNumeric("acceptable_tolerance");
+  max_wall_time = nlp->options->GetNumeric("max_wall_time");
+  checkpoint_interval = nlp->options->GetInteger("checkpoint_interval");
+  checkpoint_file = nlp->options->GetString("checkpoint_file");
+  checkpoint_restart = nlp->options->GetString("checkpoint_restart")=="yes";
+  time_profile_trace = nlp->options->GetString("time_profile_trace");
+  time_profile_counters = nlp->options->GetString("time_profile_counters")=="yes";
+  time_profile = nlp->options->GetString("time_profile")=="yes" || time_profile_trace!="none" || time_profile_counters;
+  const std::string metrics_file = nlp->options->GetString("metrics_file");
+  if(metrics_file!="none" && 0==nlp->get_rank()) {
+    metrics_file_sink = new hiopMetricsFileSink(metrics_file.c_str(), nlp->options->GetString("metrics_format")=="binary" ? 
+						hiopMetricsFileSink::Binary : hiopMetricsFileSink::CSV);
+    if(!metrics_file_sink->is_open())
+      nlp->log->printf(hovWarning, "the metrics file '%s' could not be opened; no metrics are written\n", metrics_file.c_str());
+  }
 
   dualsUpdateType = nlp->options->GetString("dualsUpdateType")=="lsq"?0:1;     //0 LSQ (default), 1 linear update (more stable)
   dualsInitializ = nlp->options->GetString("dualsInitialization")=="lsq"?0:1;  //0 LSQ (default), 1 set to zero
 
+  max_soc_iter = nlp->options->GetInteger("max_soc_iter");
+  max_resto_iter = nlp->options->GetInteger("max_resto_iter");
+  watchdog_trigger = nlp->options->GetInteger("watchdog_shortened_iter_trigger");
+  watchdog_max_trials = nlp->options->GetInteger("watchdog_trial_iter_max");
+  freeze_active = nlp->options->GetString("freeze_active_vars")=="yes";
+  freeze_ratio = nlp->options->GetNumeric("freeze_active_ratio");
+  freeze_mu = nlp->options->GetNumeric("freeze_active_mu");
+  repartition_iter = nlp->options->GetInteger("repartition_iter");
+  repartition_imbalance = nlp->options->GetNumeric("repartition_imbalance");
+  if(NULL==nlpdc) {
+    //the LSQ duals and the active-set freezing work with the dense constraints' Jacobian
+    if(0==dualsUpdateType || 0==dualsInitializ || freeze_active)
+      nlp->log->printf(hovSummary, "The %s formulation uses the linear duals update, zero initial duals, "
+		       "and no active-set freezing\n", nlpbc ? "block" : "sparse");
+    dualsUpdateType=1; dualsInitializ=1; freeze_active=false;
+    if(repartition_iter>0) 
+      nlp->log->printf(hovWarning, "The repartitioning of the variables is available only for the dense formulation\n");
+    repartition_iter=0;
+  }
+
   gamma_theta = 1e-5; //sufficient progress parameters for the feasibility violation
   gamma_phi=1e-5;     //and log barrier objective
   s_theta=1.1;        //parameters in the switch condition of 
   s_phi=2.3;          // the linearsearch (equation 19) in
   delta=1.;           // the WachterBiegler paper
   eta_phi=1e-4;       // parameter in the Armijo rule
+  kappa_soc=0.99;     // decrease in the infeasibility required to continue the second-order correction
+  freeze_min_frac=0.05;// min fraction of the working set that needs to be identified as active to freeze it
   kappa_Sigma = 1e10; //parameter in resetting the duals to guarantee closedness of the primal-dual logbar Hessian to the primal logbar Hessian
   _tau=fmax(tau_min,1.0-_mu);
   theta_max = 1e7; //temporary - will be updated after ini pt is computed
   theta_min = 1e7; //temporary - will be updated after ini pt is computed
 
 
-  //parameter based initialization
-  if(dualsUpdateType==0) 
-    dualsUpdate = new hiopDualsLsqUpdate(nlp);
-  else if(dualsUpdateType==1)
-    dualsUpdate = new hiopDualsNewtonLinearUpdate(nlp);
-  else assert(false && "dualsUpdateType has an unrecognized value");
+  allocAlgObjects();
 
 
   _n_accep_iters = 0;
+  _inRestoration = false; _n_resto_iters = 0; _theta_resto = 0.;
+  _watchdogActive = false; _n_shortened_iters = _n_watchdog_trials = 0; 
+  _theta_watchdog = _f_logbar_watchdog = _grad_phi_dx_watchdog = _alpha_watchdog = 0.;
+  _freezeDisabled = false;
+  _repartitionDone = false;
+  _hasBest = false; _f_best = 0.; _iter_best = -1;
+  _stopRequested = false;
+  _cancelTokenUsed = _stopChecks = false;
+  _iter_last_ckpt = -1;
 
   _solverStatus = NlpSolve_IncompleteInit;
 }
 
 hiopAlgFilterIPM::~hiopAlgFilterIPM()
+{
+  deallocAlgObjects();
+  if(metrics_file_sink) delete metrics_file_sink;
+}
+
+/* the objects whose sizes depend on the working set of variables */
+void hiopAlgFilterIPM::allocAlgObjects()
+{
+  it_curr = new hiopIterate(nlp);
+  it_trial= it_curr->alloc_clone();
+  dir     = it_curr->alloc_clone();
+  dir_soc = it_curr->alloc_clone();
+  it_watchdog = it_curr->alloc_clone();
+  it_best = it_curr->alloc_clone();
+
+  logbar = new hiopLogBarProblem(nlp);
+
+  _c = nlp->alloc_dual_eq_vec(); 
+  _d = nlp->alloc_dual_ineq_vec();
+
+  _grad_f  = nlp->alloc_primal_vec();
+  _Jac_c   = nlp->alloc_Jac_c();
+  _Jac_d   = nlp->alloc_Jac_d();
+
+  _c_trial = nlp->alloc_dual_eq_vec(); 
+  _d_trial = nlp->alloc_dual_ineq_vec();
+
+  _grad_f_trial  = nlp->alloc_primal_vec();
+  _Jac_c_trial   = nlp->alloc_Jac_c();
+  _Jac_d_trial   = nlp->alloc_Jac_d();
+
+  _Hess = NULL;
+  if(nlpdc || nlpbc) _Hess = new hiopHessianLowRank(nlp,nlp->options->GetInteger("secant_memory_len"));
+
+  resid = new hiopResidual(nlp);
+  resid_trial = new hiopResidual(nlp);
+  resid_aux = new hiopResidual(nlp);
+
+  //parameter based initialization
+  if(dualsUpdateType==0) 
+    dualsUpdate = new hiopDualsLsqUpdate(nlp);
+  else if(dualsUpdateType==1)
+    dualsUpdate = new hiopDualsNewtonLinearUpdate(nlp);
+  else assert(false && "dualsUpdateType has an unrecognized value");
+}
+
+void hiopAlgFilterIPM::deallocAlgObjects()
 {
   if(it_curr)  delete it_curr;
   if(it_trial) delete it_trial;
   if(dir)      delete dir;
+  if(dir_soc)  delete dir_soc;
+  if(it_watchdog) delete it_watchdog;
+  if(it_best)  delete it_best;
 
   if(_c)       delete _c;
   if(_d)       delete _d;
@@ -154,6 +226,7 @@ hiopAlgFilterIPM::~hiopAlgFilterIPM()
   if(_Jac_d_trial)   delete _Jac_d_trial;
 
   if(resid_trial)    delete resid_trial;
+  if(resid_aux)      delete resid_aux;
 
   if(logbar) delete logbar;
 
@@ -162,7 +235,7 @@ hiopAlgFilterIPM::~hiopAlgFilterIPM()
 
 bool hiopAlgFilterIPM::evalNlp(hiopIterate& iter, 			       
 			       double &f, hiopVector& c_, hiopVector& d_, 
-			       hiopVector& gradf_,  hiopMatrixDense& Jac_c,  hiopMatrixDense& Jac_d)
+			       hiopVector& gradf_,  hiopMatrix& Jac_c,  hiopMatrix& Jac_d)
 {
   bool new_x=true, bret; 
   const hiopVectorPar& it_x = dynamic_cast<const hiopVectorPar&>(*iter.get_x());
@@ -178,15 +251,15 @@ bool hiopAlgFilterIPM::evalNlp(hiopIterate& iter,
 
   bret = nlp->eval_c     (x, new_x, c.local_data());     assert(bret);
   bret = nlp->eval_d     (x, new_x, d.local_data());     assert(bret);
-  bret = nlp->eval_Jac_c (x, new_x, Jac_c.local_data()); assert(bret);
-  bret = nlp->eval_Jac_d (x, new_x, Jac_d.local_data()); assert(bret);
+  bret = nlp->eval_Jac_c (x, new_x, Jac_c); assert(bret);
+  bret = nlp->eval_Jac_d (x, new_x, Jac_d); assert(bret);
 
   return bret;
 }
 
 int hiopAlgFilterIPM::startingProcedure(hiopIterate& it_ini,			       
 					double &f, hiopVector& c, hiopVector& d, 
-					hiopVector& gradf,  hiopMatrixDense& Jac_c,  hiopMatrixDense& Jac_d)
+					hiopVector& gradf,  hiopMatrix& Jac_c,  hiopMatrix& Jac_d)
 {
   if(!nlp->get_starting_point(*it_ini.get_x())) {
     nlp->log->printf(hovError, "error: in getting the user provided starting point\n");
@@ -253,11 +326,21 @@ hiopSolveStatus hiopAlgFilterIPM::run()
 #endif  
   nlp->log->write("---------------\nProblem Summary\n---------------", *nlp, hovSummary);
 
+  nlp->runStats.profile.enable(time_profile, time_profile_trace!="none", time_profile_counters);
+  if(nlp->runStats.profile.counters_failed())
+    nlp->log->printf(hovWarning, "hardware counters not available, the profile has the timings only: %s\n", 
+		     nlp->runStats.profile.get_counters_error().c_str());
   nlp->runStats.tmOptimizTotal.start();
+  startMetrics();
 
   startingProcedure(*it_curr, _f_nlp, *_c, *_d, *_grad_f, *_Jac_c, *_Jac_d); //this also evaluates the nlp
   _mu=mu0;
 
+  int lsStatus=-1, lsNum=0;
+  //on success, this overwrites the iterate, mu, and the state of the algorithm and evaluates the nlp
+  const bool restarted = checkpoint_restart && loadCheckpoint(lsStatus, lsNum);
+  //the counters of the interrupted run are not part of the first record
+  if(restarted) startMetrics();
 
 
   //update log bar
@@ -269,14 +352,16 @@ hiopSolveStatus hiopAlgFilterIPM::run()
   nlp->log->write("First residual-------------", *resid, hovIteration);
   //nlp->log->printf(hovSummary, "Iter[%d] -> full iterate -------------", iter_num); nlp->log->write("", *it_curr, hovSummary); 
 
-  iter_num=0; nlp->runStats.nIter=iter_num;
+  if(!restarted) {
+    iter_num=0; nlp->runStats.nIter=iter_num;
 
-  theta_max=1e+4*fmax(1.0,resid->getInfeasInfNorm());
-  theta_min=1e-4*fmax(1.0,resid->getInfeasInfNorm());
+    theta_max=1e+4*fmax(1.0,resid->getInfeasInfNorm());
+    theta_min=1e-4*fmax(1.0,resid->getInfeasInfNorm());
+  }
   
-  hiopKKTLinSysLowRank* kkt=new hiopKKTLinSysLowRank(nlp);
+  hiopKKTLinSys* kkt=newKKTLinSys();
 
-  _alpha_primal = _alpha_dual = 0;
+  if(!restarted) _alpha_primal = _alpha_dual = 0;
 
   // --- Algorithm status 'algStatus ----
   //-1 couldn't solve the problem (most likely because small search step. Restauration phase likely needed)
@@ -285,10 +370,27 @@ hiopSolveStatus hiopAlgFilterIPM::run()
   // 2 user stop via the iteration callback
 
   //int algStatus=0; 
-  bool bret=true; int lsStatus=-1, lsNum=0;
+  bool bret=true;
   _solverStatus = NlpSolve_Pending;
+  if(!restarted) _hasBest = false; 
+  _repartitionDone = false;
+  _stopRequested = false;
+  //the stop requests (a collective check) and the best iterate are needed only with a wall-clock limit or when 
+  //the cancellation token was handed out; the ranks need to agree on it
+  int stop_checks = (max_wall_time<1e+20 || _cancelTokenUsed) ? 1 : 0;
+#ifdef WITH_MPI
+  if(nlp->get_num_ranks()>1) {
+    int ierr = MPI_Allreduce(MPI_IN_PLACE, &stop_checks, 1, MPI_INT, MPI_MAX, nlp->get_comm()); assert(MPI_SUCCESS==ierr);
+  }
+#endif
+  _stopChecks = stop_checks!=0;
   while(true) {
+    hiopTimeScope iterScope(nlp->runStats.profile, tpIteration);
+    nlp->runStats.profile.set_iteration(iter_num);
+    if(checkpoint_interval>0 && iter_num>0 && iter_num%checkpoint_interval==0 && iter_num!=_iter_last_ckpt)
+      saveCheckpoint(lsStatus, lsNum);
 
+    const double err_nlp_prev = _err_nlp; //the nlp error does not depend on mu
     bret = evalNlpAndLogErrors(*it_curr, *resid, _mu, 
 			       _err_nlp_optim, _err_nlp_feas, _err_nlp_complem, _err_nlp, 
 			       _err_log_optim, _err_log_feas, _err_log_complem, _err_log); assert(bret);
@@ -297,6 +399,15 @@ hiopSolveStatus hiopAlgFilterIPM::run()
     nlp->log->printf(hovScalars, "  LogBar errs: pr-infeas:%20.14e   dual-infeas:%20.14e  comp:%20.14e  overall:%20.14e\n",
 		     _err_log_feas, _err_log_optim, _err_log_complem, _err_log);
     outputIteration(lsStatus, lsNum);
+    recordMetrics(lsStatus, lsNum);
+    updateBestIterate();
+    if(lsStatus>0 && _Hess && !kkt->exactHessian()) {
+      //full steps and the decrease of the error drive the length of the secant memory (when adaptive)
+      const bool fullStep = lsNum<=1 && lsStatus!=4 && lsStatus!=6;
+      _Hess->adaptMemoryLength(fullStep, err_nlp_prev>0 ? _err_nlp/err_nlp_prev : 1.);
+      nlp->log->printf(hovScalars, "Iter[%d] secant memory length %d (%d pairs stored)\n", 
+		       iter_num, _Hess->get_memory_length(), _Hess->get_num_pairs());
+    }
     //user callback
     if(!nlp->user_callback_iterate(iter_num, _f_nlp, 
 				   *it_curr->get_x(),
@@ -309,28 +420,50 @@ hiopSolveStatus hiopAlgFilterIPM::run()
 				   _alpha_dual, _alpha_primal,  lsNum)) {
       _solverStatus = User_Stopped; break;
     }
+    if(monitor && !monitor->iterate(iter_num, nlp->user_obj_value(_f_nlp), _err_nlp_feas, _err_nlp_optim, _mu)) {
+      nlp->log->printf(hovSummary, "Iter[%d] solve stopped by the iteration monitor\n", iter_num);
+      _solverStatus = User_Stopped; break;
+    }
 
     /*************************************************
      * Termination check
      ************************************************/
     if(checkTermination(_err_nlp, iter_num, _solverStatus)) {
+      //the frozen variables need bounds multipliers of the correct sign at the solution; otherwise they are released
+      if(nlpdc && nlpdc->n_frozen()>0 && (Solve_Success==_solverStatus || Solve_Acceptable_Level==_solverStatus)) {
+	const double infeas = nlpdc->frozen_vars_duals_infeas(dynamic_cast<const hiopVectorPar&>(*it_curr->get_x()),
+							    dynamic_cast<const hiopVectorPar&>(*it_curr->get_yc()),
+							    dynamic_cast<const hiopVectorPar&>(*it_curr->get_yd()));
+	if(infeas>eps_tol) {
+	  nlp->log->printf(hovWarning, "Iter[%d] frozen variables have multipliers of the wrong sign (%g); releasing them\n", 
+			   iter_num, infeas);
+	  changeWorkingSet(NULL, NULL);
+	  delete kkt; kkt=newKKTLinSys();
+	  _freezeDisabled=true; _n_accep_iters=0;
+	  _solverStatus=NlpSolve_Pending;
+	  continue;
+	}
+      }
       break;
     }
     if(NlpSolve_Pending!=_solverStatus) break; //failure of the line search or user stopped. 
+    if(checkStopRequest()) break;
 
     /************************************************
      * update mu and other parameters
      ************************************************/
+    bool mu_reduced=false;
     while(_err_log<=kappa_eps * _mu) {
       //update mu and tau (fraction-to-boundary)
       bret = updateLogBarrierParameters(*it_curr, _mu, _tau, _mu, _tau);
       if(!bret) break; //no update is necessary
       nlp->log->printf(hovScalars, "Iter[%d] barrier params reduced: mu=%g tau=%g\n", iter_num, _mu, _tau);
+      mu_reduced=true;
+      nlp->runStats.nMuReductions++;
 
-      //update only logbar problem  and residual (the NLP didn't change)
-      //this->evalNlp(*it_curr, _f_nlp, *_c, *_d, *_grad_f, *_Jac_c, *_Jac_d);
-      logbar->updateWithNlpInfo(*it_curr, _mu, _f_nlp, *_c, *_d, *_grad_f, *_Jac_c, *_Jac_d);
-      resid->update(*it_curr,_f_nlp, *_c, *_d,*_grad_f,*_Jac_c,*_Jac_d, *logbar); //! should perform only a partial update since NLP didn't change
+      //update only the mu-dependent parts of the logbar problem and residual (the NLP didn't change)
+      logbar->updateWithMu(_mu);
+      resid->updateMu(*it_curr, *logbar);
       bret = evalNlpAndLogErrors(*it_curr, *resid, _mu, 
 				 _err_nlp_optim, _err_nlp_feas, _err_nlp_complem, _err_nlp, 
 				 _err_log_optim, _err_log_feas, _err_log_complem, _err_log); assert(bret);
@@ -345,19 +478,57 @@ hiopSolveStatus hiopAlgFilterIPM::run()
       //	continue; 
       //}
     }
+    //active-set freezing: shrink the working set after the barrier parameter is reduced
+    if(freeze_active && !_freezeDisabled && mu_reduced && _mu<=freeze_mu && !_inRestoration && !_watchdogActive) {
+      if(freezeActiveVariables()) {
+	delete kkt; kkt=newKKTLinSys();
+      }
+    }
+    //load balancing: repartition the variables once, based on the evaluation times of the first iterations
+    if(repartition_iter>0 && !_repartitionDone && iter_num>=repartition_iter && !_inRestoration && !_watchdogActive) {
+      _repartitionDone=true;
+      if(repartitionVariables()) {
+	delete kkt; kkt=newKKTLinSys();
+      }
+    }
     nlp->log->printf(hovScalars, "Iter[%d] logbarObj=%20.14e (mu=%12.5e)\n", iter_num, logbar->f_logbar,_mu);
     /****************************************************
      * Search direction calculation
      ***************************************************/
-    //first update the Hessian and kkt system
-    _Hess->update(*it_curr,*_grad_f,*_Jac_c,*_Jac_d);
+    //first update the Hessian and kkt system (no secant update when the kkt system has the exact Hessian)
+    if(_Hess && !kkt->exactHessian()) _Hess->update(*it_curr,*_grad_f,*_Jac_c,*_Jac_d);
+    nlp->runStats.tmSearchDir.start();
     kkt->update(it_curr,_grad_f,_Jac_c,_Jac_d, _Hess);
-    bret = kkt->computeDirections(resid,dir); assert(bret==true);
+    if(!_inRestoration) {
+      bret = kkt->computeDirections(resid,dir);
+    } else {
+      bret = computeRestorationDirection(kkt);
+    }
+    if(!bret) {
+      //after a failed solve the kkt system falls back to a more regularized one (e.g., the quasi-Newton 
+      //Hessian instead of the exact one); the direction is recomputed, as a restoration step if infeasible
+      const double theta = resid->getInfeasInfNorm();
+      nlp->runStats.nDirFailures++;
+      if(!_inRestoration && max_resto_iter>0 && theta>eps_tol) {
+	nlp->log->printf(hovWarning, "Iter[%d] search direction failed; entering the feasibility restoration phase (theta=%g)\n", iter_num, theta);
+	startRestoration(theta);
+      } else {
+	nlp->log->printf(hovWarning, "Iter[%d] search direction failed; recomputing it\n", iter_num);
+      }
+      bret = _inRestoration ? computeRestorationDirection(kkt) : kkt->computeDirections(resid,dir);
+    }
+    nlp->runStats.tmSearchDir.stop();
+    if(!bret) {
+      nlp->log->write("Panic: the search direction could not be computed. Will exit here.", hovError);
+      _solverStatus = Err_Step_Computation;
+      break;
+    }
 
     nlp->log->printf(hovIteration, "Iter[%d] full search direction -------------\n", iter_num); nlp->log->write("", *dir, hovIteration);
     /***************************************************************
      * backtracking line search
      ****************************************************************/
+    nlp->runStats.profile.begin(tpLineSearch);
     nlp->runStats.tmSolverInternal.start();
 
     //maximum  step
@@ -366,12 +537,25 @@ hiopSolveStatus hiopAlgFilterIPM::run()
     double theta_trial;
     nlp->runStats.tmSolverInternal.stop();
 
+    //after too many consecutive shortened steps, store the iterate and take tentative full steps
+    if(watchdog_trigger>0 && !_watchdogActive && !_inRestoration && _n_shortened_iters>=watchdog_trigger) {
+      nlp->log->printf(hovScalars, "Iter[%d] watchdog activated after %d shortened steps\n", iter_num, _n_shortened_iters);
+      it_watchdog->copyFrom(*it_curr);
+      _theta_watchdog = theta; _f_logbar_watchdog = logbar->f_logbar; _alpha_watchdog = _alpha_primal;
+      _grad_phi_dx_watchdog = logbar->directionalDerivative(*dir);
+      _watchdogActive = true; _n_watchdog_trials = 0; _n_shortened_iters = 0;
+      nlp->runStats.nWatchdogActivations++;
+    }
+
     //lsStatus: line search status for the accepted trial point. Needed to update the filter
     //-1 uninitialized (first iteration)
     //0 unsuccessful (small step size)
     //1 "sufficient decrease" when far away from solution (theta_trial>theta_min)
     //2 close to solution but switching condition does not hold, so trial accepted based on "sufficient decrease"
     //3 close to solution and switching condition is true; trial accepted based on Armijo
+    //4 restoration phase step; trial accepted based on sufficient decrease of the infeasibility
+    //5 watchdog step; trial tentatively accepted without backtracking
+    //6 watchdog failed; the algorithm returns to the iterate stored when the watchdog was activated
     lsStatus=0; lsNum=0;
 
     bool grad_phi_dx_computed=false; double grad_phi_dx;
@@ -380,8 +564,27 @@ hiopSolveStatus hiopAlgFilterIPM::run()
     while(true) {
       nlp->runStats.tmSolverInternal.start(); //---
 
+      //the trial points may be expensive to evaluate: the time limit and cancellation are checked for each of them;
+      //the timer is stopped after the loop
+      if(checkStopRequest()) break;
+
       //check the step against the minimum step size
       if(_alpha_primal<1e-16) {
+	if(!_inRestoration && max_resto_iter>0 && theta>eps_tol) {
+	  nlp->log->printf(hovWarning, "Iter[%d] line search failed; entering the feasibility restoration phase (theta=%g)\n", iter_num, theta);
+	  startRestoration(theta);
+
+	  nlp->runStats.tmSolverInternal.stop(); //---
+	  bret = computeRestorationDirection(kkt);
+	  nlp->runStats.tmSolverInternal.start(); //---
+	  if(!bret) {
+	    nlp->log->write("Panic: the restoration direction could not be computed. Will exit here.", hovError);
+	    _solverStatus = Err_Step_Computation;
+	    break;
+	  }
+	  bret = it_curr->fractionToTheBdry(*dir, _tau, _alpha_primal, _alpha_dual); assert(bret);
+	  continue;
+	}
 	nlp->log->write("Panic: minimum step size reached. The problem may be infeasible or the gradient inaccurate. Will exit here.",hovError);
 	_solverStatus = Steplength_Too_Small;
 	break;
@@ -394,86 +597,51 @@ hiopSolveStatus hiopAlgFilterIPM::run()
       logbar->updateWithNlpInfo_trial_funcOnly(*it_trial, _f_nlp_trial, *_c_trial, *_d_trial);
 
       nlp->runStats.tmSolverInternal.start(); //---
-      //compute infeasibility theta at trial point.
-      infeas_nrm_trial = theta_trial = resid->computeNlpInfeasInfNorm(*it_trial, *_c_trial, *_d_trial);
+      //compute infeasibility theta at trial point (resid_trial is used as buffer so that resid is preserved)
+      infeas_nrm_trial = theta_trial = resid_trial->computeNlpInfeasInfNorm(*it_trial, *_c_trial, *_d_trial);
 
       lsNum++;
 
       nlp->log->printf(hovLinesearch, "  trial point %d: alphaPrimal=%14.8e barier:(%22.16e)>%15.9e theta:(%22.16e)>%22.16e\n",
 		       lsNum, _alpha_primal, logbar->f_logbar, logbar->f_logbar_trial, theta, theta_trial);
 
-      //let's do the cheap, "sufficient progress" test first, before more involved/expensive tests. 
-      // This simple test is good enough when iterate is far away from solution
-      if(theta>=theta_min) {
-	//check the filter and the sufficient decrease condition (18)
-	if(!filter.contains(theta_trial,logbar->f_logbar_trial)) {
-	  if(theta_trial<=(1-gamma_theta)*theta || logbar->f_logbar_trial<=logbar->f_logbar - gamma_phi*theta) {
-	    //trial good to go
-	    nlp->log->printf(hovLinesearchVerb, "Linesearch: accepting based on suff. decrease (far from solution)\n");
-	    lsStatus=1;
-	    break;
-	  } else {
-	    //there is no sufficient progress 
-	    _alpha_primal *= 0.5;
-	    continue;
-	  }
+      if(_inRestoration) {
+	//restoration phase: only the infeasibility needs to decrease sufficiently
+	if(theta_trial<=(1-gamma_theta)*theta) lsStatus=4;
+      } else if(_watchdogActive) {
+	//watchdog: the trial is checked against the stored iterate; no backtracking is done
+	bool computed=true;
+	lsStatus = lineSearchAcceptance(_theta_watchdog, _f_logbar_watchdog, theta_trial, _alpha_watchdog, 
+					computed, _grad_phi_dx_watchdog);
+	if(lsStatus>0) {
+	  nlp->log->printf(hovScalars, "Iter[%d] watchdog succeeded after %d trial steps\n", iter_num, _n_watchdog_trials+1);
+	  _watchdogActive=false;
 	} else {
-	  //it is in the filter 
-	  _alpha_primal *= 0.5;
-	  continue;
-	}  
-	nlp->log->write("Warning (close to panic): I got to a point where I wasn't supposed to be. (1)", hovWarning);
+	  _n_watchdog_trials++;
+	  lsStatus = _n_watchdog_trials<watchdog_max_trials ? 5 : 6;
+	}
+	break;
       } else {
-	// if(theta<theta_min,  then check the switching condition and, if true, rely on Armijo rule.
-	// first compute grad_phi^T d_x if it hasn't already been computed
-	if(!grad_phi_dx_computed) { 
-	  nlp->runStats.tmSolverInternal.stop(); //---
-	  grad_phi_dx = logbar->directionalDerivative(*dir); 
-	  grad_phi_dx_computed=true; 
-	  nlp->runStats.tmSolverInternal.start(); //---
+	lsStatus = lineSearchAcceptance(theta, logbar->f_logbar, theta_trial, _alpha_primal, grad_phi_dx_computed, grad_phi_dx);
+      }
+      if(lsStatus>0) break;
+
+      //the first trial point increased the infeasibility; try to correct it before backtracking
+      if(lsNum==1 && theta_trial>=theta && max_soc_iter>0 && !_inRestoration) {
+	nlp->runStats.tmSolverInternal.stop(); //---
+	lsStatus = secondOrderCorrection(kkt, theta, theta_trial, grad_phi_dx_computed, grad_phi_dx);
+	nlp->runStats.tmSolverInternal.start(); //---
+	if(lsStatus>0) {
+	  infeas_nrm_trial = theta_trial;
+	  break;
 	}
-	nlp->log->printf(hovLinesearch, "Linesearch: grad_phi_dx = %22.15e\n", grad_phi_dx);
-	//nlp->log->printf(hovSummary, "Linesearch: grad_phi_dx = %22.15e      %22.15e >   %22.15e  \n", grad_phi_dx, _alpha_primal*pow(-grad_phi_dx,s_phi), delta*pow(theta,s_theta));
-	//nlp->log->printf(hovSummary, "Linesearch: s_phi=%22.15e;   s_theta=%22.15e; theta=%22.15e; delta=%22.15e \n", s_phi, s_theta, theta, delta);
-	//this is the actual switching condition
-	if(grad_phi_dx<0 && _alpha_primal*pow(-grad_phi_dx,s_phi)>delta*pow(theta,s_theta)) {
-
-	  if(logbar->f_logbar_trial <= logbar->f_logbar + eta_phi*_alpha_primal*grad_phi_dx) {
-	    lsStatus=3;
-	    nlp->log->printf(hovLinesearchVerb, "Linesearch: accepting based on Armijo (switch cond also passed)\n");
-	    break; //iterate good to go since it satisfies Armijo
-	  } else {  //Armijo is not satisfied
-	    _alpha_primal *= 0.5; //reduce step and try again
-	    continue;
-	  }
-	} else {//switching condition does not hold  
-	  
-	  //ok to go with  "sufficient progress" condition even when close to solution, provided the switching condition is not satisfied
-	  //check the filter and the sufficient decrease condition (18)
-	  if(!filter.contains(theta_trial,logbar->f_logbar_trial)) {
-	    if(theta_trial<=(1-gamma_theta)*theta || logbar->f_logbar_trial<=logbar->f_logbar - gamma_phi*theta) {
-	    //if(logbar->f_logbar_trial<=logbar->f_logbar - gamma_phi*theta) {
-	      //trial good to go
-	      nlp->log->printf(hovLinesearchVerb, "Linesearch: accepting based on suff. decrease (switch cond also passed)\n");
-	      lsStatus=2;
-	      break;
-	    } else {
-	      //there is no sufficient progress 
-	      _alpha_primal *= 0.5;
-	      continue;
-	    }
-	  } else {
-	    //it is in the filter 
-	    _alpha_primal *= 0.5;
-	    continue;
-	  } 
-	} // end of else: switching condition does not hold
-
-	nlp->log->write("Warning (close to panic): I got to a point where I wasn't supposed to be. (2)", hovWarning);
-
-      } //end of else: theta_trial<theta_min
+      }
+      _alpha_primal *= 0.5;
     } //end of while for the linesearch loop
     nlp->runStats.tmSolverInternal.stop();
+    nlp->runStats.profile.end(tpLineSearch);
+    if(_stopRequested) break; //the current iterate is kept
+    if(Err_Step_Computation==_solverStatus) break;
 
     //post line-search stuff  
     //filter is augmented whenever the switching condition or Armijo rule do not hold for the trial point that was just accepted
@@ -488,22 +656,54 @@ hiopSolveStatus hiopAlgFilterIPM::run()
 	  //filter does not change
 	} else {
 	  //Armijo does not hold
-	  filter.add(logbar->f_logbar_trial, theta_trial);
+	  filter.add(theta_trial, logbar->f_logbar_trial);
 	}
       } else { //switching condition does not hold
-	filter.add(logbar->f_logbar_trial, theta_trial);
+	filter.add(theta_trial, logbar->f_logbar_trial);
       }
 
     } else if(lsStatus==2) {
       //switching condition does not hold for the trial
-      filter.add(logbar->f_logbar_trial, theta_trial);
+      filter.add(theta_trial, logbar->f_logbar_trial);
     } else if(lsStatus==3) {
       //Armijo (and switching condition) hold, nothing to do.
+    } else if(lsStatus==4) {
+      //restoration step; the filter was augmented when the restoration started. Return to the regular 
+      //iterations once the trial is acceptable to the filter and the infeasibility decreased sufficiently
+      nlp->runStats.nRestorationIter++; _n_resto_iters++;
+      if(!filter.contains(theta_trial, logbar->f_logbar_trial) && theta_trial<=(1-gamma_theta)*_theta_resto) {
+	nlp->log->printf(hovWarning, "Iter[%d] leaving the restoration phase after %d iterations (theta=%g)\n", 
+			 iter_num, _n_resto_iters, theta_trial);
+	_inRestoration=false;
+      } else if(_n_resto_iters>=max_resto_iter) {
+	nlp->log->printf(hovError, "Iter[%d] restoration phase failed to find an acceptable point in %d iterations\n", 
+			 iter_num, _n_resto_iters);
+	_solverStatus = Steplength_Too_Small;
+      }
+    } else if(lsStatus==5) {
+      //tentative watchdog step; the filter is not augmented
+    } else if(lsStatus==6) {
+      //watchdog failed; go back to the stored iterate and do a regular line search from there
+      nlp->log->printf(hovScalars, "Iter[%d] watchdog failed after %d trial steps; returning to the stored iterate\n", 
+		       iter_num, _n_watchdog_trials);
+      _watchdogActive=false;
+      nlp->runStats.nWatchdogFailures++;
+      iter_num++; nlp->runStats.nIter=iter_num;
+
+      it_curr->copyFrom(*it_watchdog);
+      this->evalNlp(*it_curr, _f_nlp, *_c, *_d, *_grad_f, *_Jac_c, *_Jac_d);
+      logbar->updateWithNlpInfo(*it_curr, _mu, _f_nlp, *_c, *_d, *_grad_f, *_Jac_c, *_Jac_d);
+      resid->update(*it_curr,_f_nlp, *_c, *_d,*_grad_f,*_Jac_c,*_Jac_d, *logbar);
+      continue;
     } else if(lsStatus==0) {
       //small step; take the update; if the update doesn't pass the convergence test, the optimiz. loop will exit.
     } else 
       assert(false && "unrecognized value for lsStatus");
 
+    //consecutive iterations with shortened (backtracked) steps trigger the watchdog
+    if(lsStatus>=1 && lsStatus<=3 && lsNum>1) _n_shortened_iters++;
+    else _n_shortened_iters=0;
+
     nlp->log->printf(hovScalars, "Iter[%d] -> accepted step primal=[%17.11e] dual=[%17.11e]\n", iter_num, _alpha_primal, _alpha_dual);
     iter_num++; nlp->runStats.nIter=iter_num;
 
@@ -518,9 +718,11 @@ hiopSolveStatus hiopAlgFilterIPM::run()
     //it_trial->takeStep_duals(*it_curr, *dir, _alpha_primal, _alpha_dual); assert(bret);
     //bret = it_trial->adjustDuals_primalLogHessian(_mu,kappa_Sigma); assert(bret);
     assert(infeas_nrm_trial>=0 && "this should not happen");
+    nlp->runStats.tmMultUpdate.start();
     bret = dualsUpdate->go(*it_curr, *it_trial, 
 			   _f_nlp, *_c, *_d, *_grad_f, *_Jac_c, *_Jac_d, *dir,  
 			   _alpha_primal, _alpha_dual, _mu, kappa_Sigma, infeas_nrm_trial); assert(bret);
+    nlp->runStats.tmMultUpdate.stop();
 
     //update current iterate (do a fast swap of the pointers)
     hiopIterate* pit=it_curr; it_curr=it_trial; it_trial=pit;
@@ -534,11 +736,31 @@ hiopSolveStatus hiopAlgFilterIPM::run()
     nlp->log->printf(hovIteration, "Iter[%d] full residual:-------------\n", iter_num); nlp->log->write("", *resid, hovIteration);
   }
 
+  //on timeout or cancellation the best feasible iterate is returned rather than the last one
+  if(_stopRequested && _hasBest && (_err_nlp_feas>eps_tol_accep || _f_best<_f_nlp)) {
+    nlp->log->printf(hovWarning, "returning the best feasible iterate, found at iteration %d\n", _iter_best);
+    it_curr->copyFrom(*it_best);
+    this->evalNlp(*it_curr, _f_nlp, *_c, *_d, *_grad_f, *_Jac_c, *_Jac_d);
+    logbar->updateWithNlpInfo(*it_curr, _mu, _f_nlp, *_c, *_d, *_grad_f, *_Jac_c, *_Jac_d);
+    resid->update(*it_curr,_f_nlp, *_c, *_d,*_grad_f,*_Jac_c,*_Jac_d, *logbar);
+    evalNlpAndLogErrors(*it_curr, *resid, _mu, 
+			_err_nlp_optim, _err_nlp_feas, _err_nlp_complem, _err_nlp, 
+			_err_log_optim, _err_log_feas, _err_log_complem, _err_log);
+  }
+
   nlp->runStats.tmOptimizTotal.stop();
+  nlp->runStats.profile.close_counters();
+  if(0==nlp->get_rank()) {
+    if(metrics_file_sink) metrics_file_sink->end();
+    if(metrics_sink) metrics_sink->end();
+  }
 
   //_solverStatus contains the termination information
   displayTerminationMsg();
 
+  if(time_profile_trace!="none" && !nlp->runStats.profile.writeChromeTrace(time_profile_trace.c_str(), nlp->get_comm()))
+    nlp->log->printf(hovWarning, "the time profile trace could not be written to '%s'\n", time_profile_trace.c_str());
+
   //user callback
   nlp->user_callback_solution(_solverStatus,
 			      *it_curr->get_x(),
@@ -553,6 +775,342 @@ hiopSolveStatus hiopAlgFilterIPM::run()
 }
 
 
+hiopKKTLinSys* hiopAlgFilterIPM::newKKTLinSys()
+{
+  //the block formulation uses the quasi-Newton Hessian regardless of 'hessian_mode'
+  if(nlpbc) return new hiopKKTLinSysBlock(nlp);
+  if(NULL==nlpdc) return new hiopKKTLinSysSparse(nlp);
+  const std::string mode = nlp->options->GetString("hessian_mode");
+  if(mode=="structured") return new hiopKKTLinSysStructured(nlp);
+  if(mode=="exact")      return new hiopKKTLinSysDense(nlp);
+  return new hiopKKTLinSysLowRank(nlp);
+}
+
+bool hiopAlgFilterIPM::freezeActiveVariables()
+{
+  const hiopVectorPar &zl=dynamic_cast<const hiopVectorPar&>(*it_curr->get_zl()), &zu=dynamic_cast<const hiopVectorPar&>(*it_curr->get_zu());
+  const hiopVectorPar &sxl=dynamic_cast<const hiopVectorPar&>(*it_curr->get_sxl()), &sxu=dynamic_cast<const hiopVectorPar&>(*it_curr->get_sxu());
+  const double *ixl=nlp->get_ixl().local_data_const(), *ixu=nlp->get_ixu().local_data_const();
+  //variables with bound multipliers much larger than the slacks are strongly active
+  hiopVectorPar *at_low=zl.alloc_clone(), *at_upp=zu.alloc_clone();
+  at_low->setToZero(); at_upp->setToZero();
+  double *lowv=at_low->local_data(), *uppv=at_upp->local_data();
+  for(long long k=0; k<zl.get_local_size(); k++) {
+    if(ixl[k]==1. && zl.local_data_const()[k]>=freeze_ratio*sxl.local_data_const()[k]) lowv[k]=1.;
+    else if(ixu[k]==1. && zu.local_data_const()[k]>=freeze_ratio*sxu.local_data_const()[k]) uppv[k]=1.;
+  }
+  bool bret=false;
+  const double n_active = at_low->onenorm()+at_upp->onenorm();
+  if(n_active>0 && n_active>=freeze_min_frac*nlp->n()) {
+    nlp->log->printf(hovScalars, "Iter[%d] freezing %g strongly active variables\n", iter_num, n_active);
+    bret = changeWorkingSet(at_low, at_upp);
+    if(bret) nlp->runStats.nActiveSetFreezes++;
+  }
+  delete at_low; delete at_upp;
+  return bret;
+}
+
+/* Changes the working set of variables: the variables marked in 'at_low' and 'at_upp' are frozen or, when 
+ * these are NULL, all the frozen variables are released. The algorithm's objects are reallocated and the current
+ * iterate is mapped to the new working set (through the user's space). The secant memory is restricted to (or, on 
+ * release, extended with zeros to) the new working set. On freezing, the best iterate is restricted too and the 
+ * filter is kept. The released variables are moved slightly inside the bounds, with duals mu/slack; since the 
+ * iterate moves, the best iterate is dropped and the filter is reset. The watchdog and the restoration phase are 
+ * reset. */
+bool hiopAlgFilterIPM::changeWorkingSet(const hiopVectorPar* at_low, const hiopVectorPar* at_upp)
+{
+  nlp->runStats.tmSolverInternal.start();
+  hiopVectorPar *x_u=nlpdc->alloc_usr_primal_vec(), *sxl_u=nlpdc->alloc_usr_primal_vec(), *sxu_u=nlpdc->alloc_usr_primal_vec();
+  hiopVectorPar *zl_u=nlpdc->alloc_usr_primal_vec(), *zu_u=nlpdc->alloc_usr_primal_vec();
+  const hiopVectorPar& x = dynamic_cast<const hiopVectorPar&>(*it_curr->get_x());
+  nlpdc->x_to_usr(x, *x_u);
+  //slacks of -1 mark the variables that are not in the current working set
+  nlpdc->primal_vec_to_usr(dynamic_cast<const hiopVectorPar&>(*it_curr->get_sxl()), *sxl_u, -1.);
+  nlpdc->primal_vec_to_usr(dynamic_cast<const hiopVectorPar&>(*it_curr->get_sxu()), *sxu_u, -1.);
+  nlpdc->primal_vec_to_usr(dynamic_cast<const hiopVectorPar&>(*it_curr->get_zl()),  *zl_u, 0.);
+  nlpdc->primal_vec_to_usr(dynamic_cast<const hiopVectorPar&>(*it_curr->get_zu()),  *zu_u, 0.);
+  //the local indices of the variables in the current working set; mapped below to the new working set
+  hiopVectorPar* ix=x.alloc_clone();
+  for(long long k=0; k<ix->get_local_size(); k++) ix->local_data()[k]=k;
+  hiopVectorPar* ix_u=nlpdc->alloc_usr_primal_vec();
+  nlpdc->primal_vec_to_usr(*ix, *ix_u, -1.);
+  delete ix;
+  hiopIterate* it_saved = it_curr->new_copy();
+
+  bool bret=true;
+  if(at_low) bret = nlpdc->freeze_vars(x, *at_low, *at_upp)>0;
+  else nlpdc->release_frozen_vars();
+
+  if(bret) {
+    //the secant memory and the best iterate are kept aside and restricted to the new working set
+    hiopHessianLowRank* hess_saved=_Hess; _Hess=NULL;
+    hiopIterate* it_best_saved = _hasBest && at_low ? it_best->new_copy() : NULL;
+    deallocAlgObjects();
+    allocAlgObjects();
+
+    ix=dynamic_cast<hiopVectorPar*>(nlp->alloc_primal_vec());
+    nlpdc->primal_vec_from_usr(*ix_u, *ix);
+    std::vector<long long> idx(ix->get_local_size());
+    for(long long k=0; k<ix->get_local_size(); k++) idx[k]=(long long)ix->local_data_const()[k];
+    delete ix;
+    if(_Hess && hess_saved) _Hess->copySelectedFrom(*hess_saved, idx.empty() ? NULL : &idx[0]);
+    if(hess_saved) delete hess_saved;
+    _hasBest=false;
+    if(it_best_saved) {
+      //the frozen variables are at their bounds also in the best iterate: its objective and infeasibility change
+      it_best->copySelectedFrom(*it_best_saved, idx.empty() ? NULL : &idx[0]);
+      delete it_best_saved;
+      const double* xb=dynamic_cast<const hiopVectorPar&>(*it_best->get_x()).local_data_const();
+      hiopVectorPar &cb=dynamic_cast<hiopVectorPar&>(*_c_trial), &db=dynamic_cast<hiopVectorPar&>(*_d_trial);
+      _hasBest = nlp->eval_f(xb, true, _f_best) && nlp->eval_c(xb, false, cb.local_data()) && 
+	nlp->eval_d(xb, false, db.local_data()) && resid_trial->computeNlpInfeasInfNorm(*it_best, cb, db)<=eps_tol_accep;
+    }
+
+    it_curr->copyConsPartsFrom(*it_saved);
+    hiopVectorPar &xn=dynamic_cast<hiopVectorPar&>(*it_curr->get_x());
+    hiopVectorPar &sxl=dynamic_cast<hiopVectorPar&>(*it_curr->get_sxl()), &sxu=dynamic_cast<hiopVectorPar&>(*it_curr->get_sxu());
+    hiopVectorPar &zl=dynamic_cast<hiopVectorPar&>(*it_curr->get_zl()), &zu=dynamic_cast<hiopVectorPar&>(*it_curr->get_zu());
+    nlpdc->primal_vec_from_usr(*x_u, xn);
+    nlpdc->primal_vec_from_usr(*sxl_u, sxl); nlpdc->primal_vec_from_usr(*sxu_u, sxu);
+    nlpdc->primal_vec_from_usr(*zl_u, zl);   nlpdc->primal_vec_from_usr(*zu_u, zu);
+
+    //the released variables are at their bounds; move them inside
+    const double *xl=nlp->get_xl().local_data_const(), *xu=nlp->get_xu().local_data_const();
+    const double *ixl=nlp->get_ixl().local_data_const(), *ixu=nlp->get_ixu().local_data_const();
+    double *xv=xn.local_data(), *sxlv=sxl.local_data(), *sxuv=sxu.local_data(), *zlv=zl.local_data(), *zuv=zu.local_data();
+    for(long long k=0; k<xn.get_local_size(); k++) {
+      if(sxlv[k]>=0.) continue;
+      double push = kappa1*fmax(1., fabs(xv[k]));
+      if(ixl[k]==1. && ixu[k]==1.) push = fmin(push, 0.5*(xu[k]-xl[k]));
+      if(ixl[k]==1. && xv[k]==xl[k]) xv[k] += push;
+      else                           xv[k] -= push;
+      sxlv[k] = ixl[k]==1. ? xv[k]-xl[k] : 0.;  zlv[k] = ixl[k]==1. ? _mu/sxlv[k] : 0.;
+      sxuv[k] = ixu[k]==1. ? xu[k]-xv[k] : 0.;  zuv[k] = ixu[k]==1. ? _mu/sxuv[k] : 0.;
+    }
+    nlp->runStats.tmSolverInternal.stop();
+
+    this->evalNlp(*it_curr, _f_nlp, *_c, *_d, *_grad_f, *_Jac_c, *_Jac_d);
+    logbar->updateWithNlpInfo(*it_curr, _mu, _f_nlp, *_c, *_d, *_grad_f, *_Jac_c, *_Jac_d);
+    resid->update(*it_curr,_f_nlp, *_c, *_d,*_grad_f,*_Jac_c,*_Jac_d, *logbar);
+    evalNlpAndLogErrors(*it_curr, *resid, _mu, 
+			_err_nlp_optim, _err_nlp_feas, _err_nlp_complem, _err_nlp, 
+			_err_log_optim, _err_log_feas, _err_log_complem, _err_log);
+    if(NULL==at_low) filter.reinitialize(theta_max);
+    _inRestoration=false; _watchdogActive=false; _n_shortened_iters=0;
+    if(NULL==at_low) nlp->runStats.nActiveSetReleases++;
+  } else {
+    nlp->runStats.tmSolverInternal.stop();
+  }
+  delete it_saved; delete ix_u;
+  delete x_u; delete sxl_u; delete sxu_u; delete zl_u; delete zu_u;
+  return bret;
+}
+
+/* Load balancing: the cost of a variable is the evaluation time of its rank divided by the number of variables
+ * of the rank, plus the smallest internal time per variable over the ranks (the internal computations are about
+ * proportional to the number of local variables). The new partitioning splits the total cost evenly across the
+ * ranks. The algorithm's objects are reallocated; the iterate, the best iterate, and the secant memory are moved
+ * to the new partitioning. The filter is kept since the iterate does not change. */
+bool hiopAlgFilterIPM::repartitionVariables()
+{
+#ifdef WITH_MPI
+  const int P=nlp->get_num_ranks(), rank=nlp->get_rank();
+  const long long* cols=nlpdc->get_vec_distrib();
+  if(P<=1 || NULL==cols || cols[P]<P) return false;
+  hiopRunStats& stats=nlp->runStats;
+  const long long n_loc=cols[rank+1]-cols[rank];
+  double loc[2] = {stats.tmEvalObj.getElapsedTime() + stats.tmEvalGrad_f.getElapsedTime() + 
+		   stats.tmEvalCons.getElapsedTime() + stats.tmEvalJac_con.getElapsedTime(),
+		   stats.tmSolverInternal.getElapsedTime()/(n_loc>0 ? n_loc : 1)};
+  std::vector<double> times(2*P);
+  int ierr=MPI_Allgather(loc, 2, MPI_DOUBLE, &times[0], 2, MPI_DOUBLE, nlp->get_comm()); assert(MPI_SUCCESS==ierr);
+  double t_mean=0., t_max=0., t_int=times[1];
+  for(int p=0; p<P; p++) {
+    t_mean += times[2*p]; t_max=fmax(t_max, times[2*p]); t_int=fmin(t_int, times[2*p+1]);
+  }
+  t_mean /= P;
+  const double imbalance = t_mean>0. ? (t_max-t_mean)/t_mean : 0.;
+  if(imbalance<=repartition_imbalance) {
+    nlp->log->printf(hovSummary, "Iter[%d] repartitioning: evaluation times imbalance %.3f, the variables are not moved\n", 
+		     iter_num, imbalance);
+    return false;
+  }
+
+  //cost per variable on each rank and cumulative cost at the start of each rank's slice
+  const long long n=cols[P];
+  std::vector<double> rho(P), cum(P+1, 0.);
+  for(int p=0; p<P; p++) {
+    const long long np=cols[p+1]-cols[p];
+    rho[p] = (np>0 ? times[2*p]/np : 0.) + t_int;
+    cum[p+1] = cum[p] + rho[p]*np;
+  }
+  std::vector<long long> cols_new(P+1);
+  cols_new[0]=0; cols_new[P]=n;
+  for(int k=1, p=0; k<P; k++) {
+    const double target=cum[P]*k/P;
+    while(p<P-1 && cum[p+1]<=target) p++;
+    long long c = cols[p] + (rho[p]>0. ? (long long)((target-cum[p])/rho[p]+0.5) : 0);
+    //each rank keeps at least one variable
+    if(c<cols_new[k-1]+1) c=cols_new[k-1]+1;
+    if(c>n-(P-k)) c=n-(P-k);
+    cols_new[k]=c;
+  }
+  nlp->log->printf(hovSummary, "Iter[%d] repartitioning: evaluation times imbalance %.3f, local variables %lld -> %lld\n", 
+		   iter_num, imbalance, n_loc, cols_new[rank+1]-cols_new[rank]);
+
+  stats.tmSolverInternal.start();
+  hiopIterate* it_saved = it_curr->new_copy();
+  hiopIterate* it_best_saved = _hasBest ? it_best->new_copy() : NULL;
+  if(!nlpdc->repartition_vars(&cols_new[0])) {
+    stats.tmSolverInternal.stop();
+    delete it_saved;
+    if(it_best_saved) delete it_best_saved;
+    return false;
+  }
+  //the secant memory is kept aside and copied into the new Hessian
+  hiopHessianLowRank* hess_saved=_Hess; _Hess=NULL;
+  deallocAlgObjects();
+  allocAlgObjects();
+  it_curr->copyRedistributedFrom(*it_saved);
+  if(it_best_saved) it_best->copyRedistributedFrom(*it_best_saved);
+  if(_Hess && hess_saved) _Hess->copyRedistributedFrom(*hess_saved);
+  delete it_saved;
+  if(it_best_saved) delete it_best_saved;
+  if(hess_saved) delete hess_saved;
+  stats.tmSolverInternal.stop();
+
+  this->evalNlp(*it_curr, _f_nlp, *_c, *_d, *_grad_f, *_Jac_c, *_Jac_d);
+  logbar->updateWithNlpInfo(*it_curr, _mu, _f_nlp, *_c, *_d, *_grad_f, *_Jac_c, *_Jac_d);
+  resid->update(*it_curr,_f_nlp, *_c, *_d,*_grad_f,*_Jac_c,*_Jac_d, *logbar);
+  evalNlpAndLogErrors(*it_curr, *resid, _mu, 
+		      _err_nlp_optim, _err_nlp_feas, _err_nlp_complem, _err_nlp, 
+		      _err_log_optim, _err_log_feas, _err_log_complem, _err_log);
+  stats.nRepartitions++;
+  return true;
+#else
+  return false;
+#endif
+}
+
+void hiopAlgFilterIPM::startRestoration(double theta)
+{
+  _inRestoration=true; _n_resto_iters=0; _theta_resto=theta;
+  nlp->runStats.nRestorationPhases++;
+  //the current iterate is added to the filter so that the restoration returns to a different point
+  filter.add(theta, logbar->f_logbar);
+}
+
+bool hiopAlgFilterIPM::computeRestorationDirection(hiopKKTLinSys* kkt)
+{
+  //same right-hand side as the regular direction, but without the optimality (dual infeasibility) 
+  //terms, so that the direction is the minimum (H+Dx)-norm step towards the linearized feasible set
+  nlp->runStats.tmSolverInternal.start();
+  resid_aux->copyFrom(*resid);
+  resid_aux->setOptimalityToZero();
+  nlp->runStats.tmSolverInternal.stop();
+  return kkt->computeDirections(resid_aux, dir);
+}
+
+int hiopAlgFilterIPM::lineSearchAcceptance(const double& theta, const double& f_logbar, 
+					   const double& theta_trial, const double& alpha_primal,
+					   bool& grad_phi_dx_computed, double& grad_phi_dx)
+{
+  //let's do the cheap, "sufficient progress" test first, before more involved/expensive tests. 
+  // This simple test is good enough when iterate is far away from solution
+  if(theta>=theta_min) {
+    //check the filter and the sufficient decrease condition (18)
+    if(!filter.contains(theta_trial,logbar->f_logbar_trial)) {
+      if(theta_trial<=(1-gamma_theta)*theta || logbar->f_logbar_trial<=f_logbar - gamma_phi*theta) {
+	//trial good to go
+	nlp->log->printf(hovLinesearchVerb, "Linesearch: accepting based on suff. decrease (far from solution)\n");
+	return 1;
+      } 
+    }
+    //there is no sufficient progress or it is in the filter 
+    return 0;
+  } 
+  // if(theta<theta_min,  then check the switching condition and, if true, rely on Armijo rule.
+  // first compute grad_phi^T d_x if it hasn't already been computed
+  if(!grad_phi_dx_computed) { 
+    nlp->runStats.tmSolverInternal.stop(); //---
+    grad_phi_dx = logbar->directionalDerivative(*dir); 
+    grad_phi_dx_computed=true; 
+    nlp->runStats.tmSolverInternal.start(); //---
+  }
+  nlp->log->printf(hovLinesearch, "Linesearch: grad_phi_dx = %22.15e\n", grad_phi_dx);
+  //this is the actual switching condition
+  if(grad_phi_dx<0 && alpha_primal*pow(-grad_phi_dx,s_phi)>delta*pow(theta,s_theta)) {
+    if(logbar->f_logbar_trial <= f_logbar + eta_phi*alpha_primal*grad_phi_dx) {
+      nlp->log->printf(hovLinesearchVerb, "Linesearch: accepting based on Armijo (switch cond also passed)\n");
+      return 3; //iterate good to go since it satisfies Armijo
+    } 
+    //Armijo is not satisfied
+    return 0;
+  } 
+  //switching condition does not hold  
+  //ok to go with  "sufficient progress" condition even when close to solution, provided the switching condition is not satisfied
+  //check the filter and the sufficient decrease condition (18)
+  if(!filter.contains(theta_trial,logbar->f_logbar_trial)) {
+    if(theta_trial<=(1-gamma_theta)*theta || logbar->f_logbar_trial<=f_logbar - gamma_phi*theta) {
+      //trial good to go
+      nlp->log->printf(hovLinesearchVerb, "Linesearch: accepting based on suff. decrease (switch cond also passed)\n");
+      return 2;
+    }
+  }
+  //there is no sufficient progress or it is in the filter 
+  return 0;
+}
+
+int hiopAlgFilterIPM::secondOrderCorrection(hiopKKTLinSys* kkt, const double& theta, double& theta_trial,
+					    bool& grad_phi_dx_computed, double& grad_phi_dx)
+{
+  //the acceptance tests are done with the step size and directional derivative of the original direction
+  if(!grad_phi_dx_computed) { grad_phi_dx = logbar->directionalDerivative(*dir); grad_phi_dx_computed=true; }
+
+  bool bret; int lsStatus=0, nSOC=0;
+  double theta_soc_old=0., alpha_soc=_alpha_primal, alpha_dual_soc=_alpha_dual;
+  resid_aux->copyFrom(*resid);
+  while(nSOC<max_soc_iter && (0==nSOC || theta_trial<=kappa_soc*theta_soc_old)) {
+    theta_soc_old = theta_trial;
+
+    //rhs of the SOC: ryc_soc = alpha_soc*ryc_soc + ryc(x_trial), and similarly for ryd
+    nlp->runStats.tmSolverInternal.start(); 
+    resid_aux->updateSOC(alpha_soc, *resid_trial);
+    nlp->runStats.tmSolverInternal.stop();
+
+    //the KKT matrix did not change: the factorization is reused
+    if(!kkt->computeDirections(resid_aux, dir_soc)) break;
+
+    nlp->runStats.tmSolverInternal.start(); 
+    bret = it_curr->fractionToTheBdry(*dir_soc, _tau, alpha_soc, alpha_dual_soc); assert(bret);
+    bret = it_trial->takeStep_primals(*it_curr, *dir_soc, alpha_soc, alpha_dual_soc); assert(bret);
+    nlp->runStats.tmSolverInternal.stop(); 
+
+    this->evalNlp_funcOnly(*it_trial, _f_nlp_trial, *_c_trial, *_d_trial);
+    logbar->updateWithNlpInfo_trial_funcOnly(*it_trial, _f_nlp_trial, *_c_trial, *_d_trial);
+
+    nlp->runStats.tmSolverInternal.start(); 
+    theta_trial = resid_trial->computeNlpInfeasInfNorm(*it_trial, *_c_trial, *_d_trial);
+    nSOC++;
+    nlp->runStats.nSOCSteps++;
+
+    nlp->log->printf(hovLinesearch, "  SOC point %d: alphaPrimal=%14.8e barier:(%22.16e)>%15.9e theta:(%22.16e)>%22.16e\n",
+		     nSOC, alpha_soc, logbar->f_logbar, logbar->f_logbar_trial, theta, theta_trial);
+
+    lsStatus = lineSearchAcceptance(theta, logbar->f_logbar, theta_trial, _alpha_primal, grad_phi_dx_computed, grad_phi_dx);
+    nlp->runStats.tmSolverInternal.stop(); 
+    if(lsStatus>0) break;
+  }
+
+  if(lsStatus>0) {
+    nlp->log->printf(hovLinesearchVerb, "Linesearch: accepted the second-order correction %d\n", nSOC);
+    nlp->runStats.nSOCAccepted++;
+    hiopIterate* pdir=dir; dir=dir_soc; dir_soc=pdir;
+    _alpha_primal=alpha_soc; _alpha_dual=alpha_dual_soc;
+  }
+  return lsStatus;
+}
+
 bool hiopAlgFilterIPM::
 checkTermination(const double& err_nlp, const int& iter_num, hiopSolveStatus& status)
 {
@@ -567,6 +1125,175 @@ checkTermination(const double& err_nlp, const int& iter_num, hiopSolveStatus& st
   return false;
 }
 
+bool hiopAlgFilterIPM::checkStopRequest()
+{
+  if(!_stopChecks) return false;
+  int stop = 0;
+  if(cancelToken.isCancelled()) stop = 1;
+  else if(nlp->runStats.tmOptimizTotal.getElapsedTimeSinceStart()>max_wall_time) stop = 2;
+#ifdef WITH_MPI
+  //the ranks need to agree, otherwise the ones that continue would hang in the collective calls
+  if(nlp->get_num_ranks()>1) {
+    int stop_glob; 
+    int ierr = MPI_Allreduce(&stop, &stop_glob, 1, MPI_INT, MPI_MAX, nlp->get_comm()); assert(MPI_SUCCESS==ierr);
+    stop = stop_glob;
+  }
+#endif
+  if(0==stop) return false;
+
+  _stopRequested = true;
+  if(1==stop) {
+    nlp->log->printf(hovWarning, "Iter[%d] solve cancelled\n", iter_num);
+    _solverStatus = User_Stopped;
+  } else {
+    nlp->log->printf(hovWarning, "Iter[%d] wall-clock limit of %g seconds reached\n", iter_num, max_wall_time);
+    _solverStatus = Max_CpuTime_Exceeded;
+  }
+  return true;
+}
+
+void hiopAlgFilterIPM::updateBestIterate()
+{
+  //the best iterate is returned only when the solve is stopped
+  if(!_stopChecks) return;
+  if(_err_nlp_feas>eps_tol_accep) return;
+  if(_hasBest && _f_nlp>=_f_best) return;
+  nlp->runStats.tmSolverInternal.start();
+  it_best->copyFrom(*it_curr);
+  _f_best = _f_nlp; _iter_best = iter_num; _hasBest = true;
+  nlp->runStats.tmSolverInternal.stop();
+}
+
+std::string hiopAlgFilterIPM::checkpointFileName() const
+{
+  int rank=0;
+#ifdef WITH_MPI
+  rank = nlp->get_rank();
+#endif
+  char buf[32]; sprintf(buf, ".%d", rank);
+  return checkpoint_file + buf;
+}
+
+bool hiopAlgFilterIPM::saveCheckpoint(const int& lsStatus, const int& lsNum)
+{
+  _iter_last_ckpt = iter_num;
+  //the working set of variables is not saved
+  if(nlpdc && nlpdc->n_frozen()>0) {
+    nlp->log->printf(hovWarning, "Iter[%d] checkpoint skipped since variables are frozen\n", iter_num);
+    return false;
+  }
+  nlp->runStats.tmSolverInternal.start();
+  int rank=0, num_ranks=1;
+#ifdef WITH_MPI
+  rank=nlp->get_rank(); num_ranks=nlp->get_num_ranks();
+#endif
+  hiopCheckpointWriter w(rank, num_ranks);
+
+  const long long sizes[] = {nlp->n(), nlp->get_xl().get_local_size(), nlp->m_eq(), nlp->m_ineq()};
+  w.add_copy("alg.sizes", sizes, 4);
+  const double scalars[] = {_mu, _tau, theta_max, theta_min, _alpha_primal, _alpha_dual, 
+			    _err_nlp_optim, _err_nlp_feas, _err_nlp_complem, _err_log_optim, _err_log_feas, _err_log_complem,
+			    _err_nlp, _err_log, _theta_resto, 
+			    _theta_watchdog, _f_logbar_watchdog, _grad_phi_dx_watchdog, _alpha_watchdog, _f_best};
+  assert(sizeof(scalars)/sizeof(double)==ckptNumScalars);
+  w.add_copy("alg.scalars", scalars, ckptNumScalars);
+  const hiopRunStats& rs = nlp->runStats;
+  const long long counters[] = {iter_num, lsStatus, lsNum, _n_accep_iters, 
+				_inRestoration, _n_resto_iters, _watchdogActive, _n_shortened_iters, _n_watchdog_trials,
+				_freezeDisabled, _hasBest, _iter_best,
+				rs.nEvalObj, rs.nEvalGrad_f, rs.nEvalCons_eq, rs.nEvalCons_ineq, rs.nEvalJac_con_eq, rs.nEvalJac_con_ineq,
+				rs.nRestorationPhases, rs.nRestorationIter, rs.nWatchdogActivations, rs.nWatchdogFailures,
+				rs.nActiveSetFreezes, rs.nActiveSetReleases};
+  assert(sizeof(counters)/sizeof(long long)==ckptNumCounters);
+  w.add_copy("alg.counters", counters, ckptNumCounters);
+  std::vector<double> filter_entries;
+  filter.getEntries(filter_entries);
+  w.add("alg.filter", filter_entries.size()>0 ? &filter_entries[0] : NULL, filter_entries.size());
+
+  it_curr->saveToCheckpoint(w, "it.");
+  if(_watchdogActive) it_watchdog->saveToCheckpoint(w, "watchdog.");
+  if(_hasBest) it_best->saveToCheckpoint(w, "best.");
+  if(_Hess) _Hess->saveToCheckpoint(w);
+
+  const std::string filename = checkpointFileName();
+  const bool bret = w.write(filename);
+  nlp->runStats.tmSolverInternal.stop();
+  if(bret) nlp->log->printf(hovScalars, "Iter[%d] checkpoint written to '%s'\n", iter_num, filename.c_str());
+  else nlp->log->printf(hovWarning, "Iter[%d] could not write the checkpoint file '%s'\n", iter_num, filename.c_str());
+  return bret;
+}
+
+bool hiopAlgFilterIPM::loadCheckpoint(int& lsStatus, int& lsNum)
+{
+  int rank=0, num_ranks=1;
+#ifdef WITH_MPI
+  rank=nlp->get_rank(); num_ranks=nlp->get_num_ranks();
+#endif
+  const std::string filename = checkpointFileName();
+  hiopCheckpointReader r;
+  long long sizes[4];
+  bool bret = r.open(filename, rank, num_ranks) && r.read("alg.sizes", sizes, 4) &&
+    sizes[0]==nlp->n() && sizes[1]==nlp->get_xl().get_local_size() && sizes[2]==nlp->m_eq() && sizes[3]==nlp->m_ineq();
+
+  //the state was written by a version of the solver with a different layout
+  if(bret && (r.size("alg.scalars")!=ckptNumScalars || r.size("alg.counters", sizeof(long long))!=ckptNumCounters)) {
+    nlp->log->printf(hovWarning, "the checkpoint file '%s' has %lld scalars and %lld counters instead of %d and %d\n",
+		     filename.c_str(), r.size("alg.scalars"), r.size("alg.counters", sizeof(long long)), 
+		     ckptNumScalars, ckptNumCounters);
+    bret = false;
+  }
+  double scalars[ckptNumScalars];
+  long long counters[ckptNumCounters];
+  if(bret) bret = r.read("alg.scalars", scalars, ckptNumScalars) && r.read("alg.counters", counters, ckptNumCounters);
+  if(bret) bret = it_curr->loadFromCheckpoint(r, "it.") && (NULL==_Hess || _Hess->loadFromCheckpoint(r));
+  if(bret && counters[6]) bret = it_watchdog->loadFromCheckpoint(r, "watchdog.");
+  if(bret && counters[10]) bret = it_best->loadFromCheckpoint(r, "best.");
+  std::vector<double> filter_entries(r.size("alg.filter")>0 ? r.size("alg.filter") : 0);
+  if(bret && filter_entries.size()>0) bret = r.read("alg.filter", &filter_entries[0], filter_entries.size());
+#ifdef WITH_MPI
+  //all the ranks need to restart or none
+  int ok = bret, ok_glob;
+  int ierr = MPI_Allreduce(&ok, &ok_glob, 1, MPI_INT, MPI_MIN, nlp->get_comm()); assert(MPI_SUCCESS==ierr);
+  bret = ok_glob;
+#endif
+  if(!bret) {
+    nlp->log->printf(hovWarning, "could not restart from the checkpoint file '%s'; starting from the initial point\n", 
+		     filename.c_str());
+    //the objects may have been partially overwritten
+    deallocAlgObjects();
+    allocAlgObjects();
+    startingProcedure(*it_curr, _f_nlp, *_c, *_d, *_grad_f, *_Jac_c, *_Jac_d);
+    return false;
+  }
+
+  _mu=scalars[0]; _tau=scalars[1]; theta_max=scalars[2]; theta_min=scalars[3]; 
+  _alpha_primal=scalars[4]; _alpha_dual=scalars[5];
+  _err_nlp_optim=scalars[6]; _err_nlp_feas=scalars[7]; _err_nlp_complem=scalars[8]; 
+  _err_log_optim=scalars[9]; _err_log_feas=scalars[10]; _err_log_complem=scalars[11];
+  _err_nlp=scalars[12]; _err_log=scalars[13]; _theta_resto=scalars[14];
+  _theta_watchdog=scalars[15]; _f_logbar_watchdog=scalars[16]; _grad_phi_dx_watchdog=scalars[17]; _alpha_watchdog=scalars[18];
+  _f_best=scalars[19];
+
+  iter_num=counters[0]; lsStatus=counters[1]; lsNum=counters[2]; _n_accep_iters=counters[3];
+  _inRestoration=counters[4]; _n_resto_iters=counters[5]; 
+  _watchdogActive=counters[6]; _n_shortened_iters=counters[7]; _n_watchdog_trials=counters[8];
+  _freezeDisabled=counters[9]; _hasBest=counters[10]; _iter_best=counters[11];
+  filter.setEntries(filter_entries);
+  _iter_last_ckpt=iter_num;
+
+  //the functions and derivatives at the restored iterate (evaluated the same way as in the uninterrupted run)
+  this->evalNlp(*it_curr, _f_nlp, *_c, *_d, *_grad_f, *_Jac_c, *_Jac_d);
+  hiopRunStats& rs = nlp->runStats;
+  rs.nIter=iter_num;
+  rs.nEvalObj=counters[12]; rs.nEvalGrad_f=counters[13]; rs.nEvalCons_eq=counters[14]; rs.nEvalCons_ineq=counters[15];
+  rs.nEvalJac_con_eq=counters[16]; rs.nEvalJac_con_ineq=counters[17];
+  rs.nRestorationPhases=counters[18]; rs.nRestorationIter=counters[19]; 
+  rs.nWatchdogActivations=counters[20]; rs.nWatchdogFailures=counters[21];
+  rs.nActiveSetFreezes=counters[22]; rs.nActiveSetReleases=counters[23];
+  nlp->log->printf(hovSummary, "Restarted from the checkpoint file '%s' at iteration %d\n", filename.c_str(), iter_num);
+  return true;
+}
+
 /***** Termination message *****/
 void hiopAlgFilterIPM::displayTerminationMsg() {
 
@@ -592,9 +1319,17 @@ void hiopAlgFilterIPM::displayTerminationMsg() {
       nlp->log->printf(hovSummary, "Linesearch returned unsuccessfully (small step). Probable cause: inaccurate gradients/Jacobians or infeasible problem.\n");
       break;
     }
+  case Max_CpuTime_Exceeded:
+    {
+      nlp->log->printf(hovSummary, "Maximum wall-clock time reached.\n%s\n", nlp->runStats.getSummary().c_str());
+      break;
+    }
   case User_Stopped:
     {
-      nlp->log->printf(hovSummary, "Stopped by the user through the user provided iterate callback.\n%s\n", nlp->runStats.getSummary().c_str());
+      if(_stopRequested)
+	nlp->log->printf(hovSummary, "Stopped by the user through the cancellation token.\n%s\n", nlp->runStats.getSummary().c_str());
+      else
+	nlp->log->printf(hovSummary, "Stopped by the user through the user provided iterate callback.\n%s\n", nlp->runStats.getSummary().c_str());
       break;
     }
   default:
@@ -677,7 +1412,7 @@ bool hiopAlgFilterIPM::evalNlp_funcOnly(hiopIterate& iter,
   return bret;
 }
 bool hiopAlgFilterIPM::evalNlp_derivOnly(hiopIterate& iter,
-					 hiopVector& gradf_,  hiopMatrixDense& Jac_c,  hiopMatrixDense& Jac_d)
+					 hiopVector& gradf_,  hiopMatrix& Jac_c,  hiopMatrix& Jac_d)
 {
   bool new_x=false; //functions were previously evaluated in the line search
   bool bret;
@@ -685,8 +1420,8 @@ bool hiopAlgFilterIPM::evalNlp_derivOnly(hiopIterate& iter,
   hiopVectorPar & gradf=dynamic_cast<hiopVectorPar&>(gradf_);
   const double* x = it_x.local_data_const();
   bret = nlp->eval_grad_f(x, new_x, gradf.local_data()); assert(bret);
-  bret = nlp->eval_Jac_c (x, new_x, Jac_c.local_data()); assert(bret);
-  bret = nlp->eval_Jac_d (x, new_x, Jac_d.local_data()); assert(bret);
+  bret = nlp->eval_Jac_c (x, new_x, Jac_c); assert(bret);
+  bret = nlp->eval_Jac_d (x, new_x, Jac_d); assert(bret);
   return bret;
 }
 
@@ -697,18 +1432,62 @@ void hiopAlgFilterIPM::outputIteration(int lsStatus, int lsNum)
 
   if(lsStatus==-1) 
     nlp->log->printf(hovSummary, "%4d %14.7e %7.3e  %7.3e %6.2f  %7.3e  %7.3e  -(-)\n",
-		     iter_num, _f_nlp, _err_nlp_feas, _err_nlp_optim, log10(_mu), _alpha_dual, _alpha_primal); 
+		     iter_num, nlp->user_obj_value(_f_nlp), _err_nlp_feas, _err_nlp_optim, log10(_mu), _alpha_dual, _alpha_primal); 
   else {
     char stepType[2];
     if(lsStatus==1) strcpy(stepType, "s");
     else if(lsStatus==2) strcpy(stepType, "h");
     else if(lsStatus==3) strcpy(stepType, "f");
+    else if(lsStatus==4) strcpy(stepType, "r");
+    else if(lsStatus==5) strcpy(stepType, "w");
+    else if(lsStatus==6) strcpy(stepType, "W");
     else strcpy(stepType, "?");
     nlp->log->printf(hovSummary, "%4d %14.7e %7.3e  %7.3e %6.2f  %7.3e  %7.3e  %d(%s)\n",
-		     iter_num, _f_nlp, _err_nlp_feas, _err_nlp_optim, log10(_mu), _alpha_dual, _alpha_primal, lsNum, stepType); 
+		     iter_num, nlp->user_obj_value(_f_nlp), _err_nlp_feas, _err_nlp_optim, log10(_mu), _alpha_dual, _alpha_primal, lsNum, stepType); 
   }
 }
 
+void hiopAlgFilterIPM::totalMetrics(hiopIterationRecord& tot) const
+{
+  const hiopRunStats& rs = nlp->runStats;
+  tot.hess_updates=rs.nHessUpdates; tot.hess_skips=rs.nHessSkips; tot.n_refin=rs.nIterRefin;
+  tot.n_eval_obj=rs.nEvalObj; tot.n_eval_grad=rs.nEvalGrad_f; tot.n_eval_cons=rs.nEvalCons_eq+rs.nEvalCons_ineq;
+  tot.n_eval_jac=rs.nEvalJac_con_eq+rs.nEvalJac_con_ineq; tot.n_eval_hess=rs.nEvalHess;
+  tot.t_iter=hiopTimer::now(); tot.t_search_dir=rs.tmSearchDir.getElapsedTime(); 
+  tot.t_dual_update=rs.tmMultUpdate.getElapsedTime();
+  tot.t_eval=rs.tmEvalObj.getElapsedTime()+rs.tmEvalGrad_f.getElapsedTime()+rs.tmEvalCons.getElapsedTime()
+    +rs.tmEvalJac_con.getElapsedTime()+rs.tmEvalHess.getElapsedTime();
+}
+
+void hiopAlgFilterIPM::startMetrics()
+{
+  if(NULL==metrics_sink && NULL==metrics_file_sink) return;
+  totalMetrics(_metrics_last);
+}
+
+void hiopAlgFilterIPM::recordMetrics(int lsStatus, int lsNum)
+{
+  if(NULL==metrics_sink && NULL==metrics_file_sink) return;
+  if(0!=nlp->get_rank()) return;
+  hiopIterationRecord tot, r;
+  totalMetrics(tot);
+  r.iter=iter_num; r.ls_num=lsNum; r.ls_status=lsStatus; r.restoration=_inRestoration ? 1 : 0;
+  r.hess_updates=tot.hess_updates-_metrics_last.hess_updates; r.hess_skips=tot.hess_skips-_metrics_last.hess_skips;
+  r.n_refin=tot.n_refin-_metrics_last.n_refin;
+  r.n_eval_obj=tot.n_eval_obj-_metrics_last.n_eval_obj; r.n_eval_grad=tot.n_eval_grad-_metrics_last.n_eval_grad;
+  r.n_eval_cons=tot.n_eval_cons-_metrics_last.n_eval_cons; r.n_eval_jac=tot.n_eval_jac-_metrics_last.n_eval_jac;
+  r.n_eval_hess=tot.n_eval_hess-_metrics_last.n_eval_hess;
+  r.objective=nlp->user_obj_value(_f_nlp); 
+  r.inf_pr=_err_nlp_feas; r.inf_du=_err_nlp_optim; r.complem=_err_nlp_complem; r.mu=_mu;
+  r.alpha_pr=_alpha_primal; r.alpha_du=_alpha_dual;
+  r.t_iter=tot.t_iter-_metrics_last.t_iter; r.t_search_dir=tot.t_search_dir-_metrics_last.t_search_dir;
+  r.t_dual_update=tot.t_dual_update-_metrics_last.t_dual_update; r.t_eval=tot.t_eval-_metrics_last.t_eval;
+  _metrics_last=tot;
+
+  if(metrics_file_sink) metrics_file_sink->record(r);
+  if(metrics_sink) metrics_sink->record(r);
+}
+
 /* returns the objective value; valid only after 'run' method has been called */
 double hiopAlgFilterIPM::getObjective() const
 {
@@ -716,15 +1495,29 @@ double hiopAlgFilterIPM::getObjective() const
     nlp->log->printf(hovError, "getObjective: hiOp did not initialize entirely or the 'run' function was not called.");
   if(_solverStatus==NlpSolve_Pending)
     nlp->log->printf(hovWarning, "getObjective: hiOp does not seem to have completed yet. The objective value returned may not be optimal.");
-  return _f_nlp;
+  return nlp->user_obj_value(_f_nlp);
 }
   /* returns the primal vector x; valid only after 'run' method has been called */
-void hiopAlgFilterIPM::getSolution(const double* x) const
+void hiopAlgFilterIPM::getSolution(double* x) const
 {
-  if(_solverStatus==NlpSolve_IncompleteInit || _solverStatus == NlpSolve_SolveNotCalled)
+  if(_solverStatus==NlpSolve_IncompleteInit || _solverStatus == NlpSolve_SolveNotCalled) {
     nlp->log->printf(hovError, "getSolution: hiOp did not initialize entirely or the 'run' function was not called.");
+    return;
+  }
   if(_solverStatus==NlpSolve_Pending)
     nlp->log->printf(hovWarning, "getSolution: hiOp does not seem to have completed yet. The primal vector returned may not be optimal.");
+
+  const hiopVectorPar& xp = dynamic_cast<const hiopVectorPar&>(*it_curr->get_x());
+  hiopNlpDenseConstraints* nlpd = dynamic_cast<hiopNlpDenseConstraints*>(nlp);
+  if(nlpd) {
+    //the fixed and frozen variables are added back
+    hiopVectorPar* x_usr = nlpd->alloc_usr_primal_vec();
+    nlpd->x_to_usr(xp, *x_usr);
+    x_usr->copyTo(x);
+    delete x_usr;
+  } else {
+    xp.copyTo(x);
+  }
 }
 
 hiopSolveStatus hiopAlgFilterIPM::getSolveStatus() const
@@ -57,14 +57,40 @@
 #include "hiopLogBarProblem.hpp"
 #include "hiopDualsUpdater.hpp"
 #include "hiopTimer.hpp"
+#include "hiopCancelToken.hpp"
+#include "hiopCheckpoint.hpp"
+#include "hiopIterationMetrics.hpp"
+
+#include <string>
 
 namespace hiop
 {
 
+class hiopKKTLinSys;
+
+/* Observer of the iterations of the solver, called after the user's iterate callback with the (unscaled) 
+ * objective and the primal and dual infeasibilities of the current iterate. Returning false stops the solve 
+ * (status User_Stopped); with more than one rank, it has to return the same value on all of them. */
+class hiopIterationMonitor
+{
+public:
+  hiopIterationMonitor() {};
+  virtual ~hiopIterationMonitor() {};
+  virtual bool iterate(int iter, double obj_value, double inf_pr, double inf_du, double mu) = 0;
+};
+
+/* The solver keeps all its state in the instance and in the NLP formulation it works on, hence distinct 
+ * instances can run concurrently in the threads of a process provided that
+ *  - each hiopNlpFormulation/hiopAlgFilterIPM pair is used by one thread at a time;
+ *  - each instance has its own communicator (e.g., a duplicate of MPI_COMM_SELF created beforehand by one thread)
+ *    and MPI is initialized with MPI_THREAD_MULTIPLE;
+ *  - the user callbacks are reentrant and, when enabled, the checkpoint files of the instances are different.
+ * The output of each instance goes through its own logger (see hiopLogger::set_output).
+ */
 class hiopAlgFilterIPM
 {
 public:
-  hiopAlgFilterIPM(hiopNlpDenseConstraints* nlp);
+  hiopAlgFilterIPM(hiopNlpFormulation* nlp);
   virtual ~hiopAlgFilterIPM();
 
   virtual hiopSolveStatus run();
@@ -72,20 +98,35 @@ public:
   /** computes primal-dual point and returns the evaluation of the problem at this point */
   virtual int startingProcedure(hiopIterate& it_ini,
 	       double &f, hiopVector& c_, hiopVector& d_, 
-	       hiopVector& grad_,  hiopMatrixDense& Jac_c,  hiopMatrixDense& Jac_d);
+	       hiopVector& grad_,  hiopMatrix& Jac_c,  hiopMatrix& Jac_d);
 
   /* returns the objective value; valid only after 'run' method has been called */
   virtual double getObjective() const;
-  /* returns the primal vector x; valid only after 'run' method has been called */
-  virtual void getSolution(const double* x) const;
+  /* copies the local entries of the primal solution x (in the user's space and distribution) in 'x'; valid only 
+   * after 'run' method has been called */
+  virtual void getSolution(double* x) const;
   /* returns the status of the solver */
   virtual hiopSolveStatus getSolveStatus() const;
+
+  /* token that can be used (from any thread) to stop the solver; the best feasible iterate is returned. The token 
+   * needs to be obtained before 'run' is called, otherwise the solver does not check it */
+  inline hiopCancelToken& getCancelToken() { _cancelTokenUsed=true; return cancelToken; }
+  /* changes the wall-clock limit (option max_wall_time), also during a solve; the stop requests are checked only 
+   * if the limit was finite or the cancellation token was obtained when 'run' was called */
+  inline void setMaxWallTime(double t) { max_wall_time=t; }
+  /* the monitor is not owned by the solver; NULL removes it */
+  inline void setIterationMonitor(hiopIterationMonitor* monitor_) { monitor=monitor_; }
+  /* number of iterations done by the last call of 'run' */
+  inline int getNumIterations() const { return iter_num; }
+  /* the sink receives a record per iteration on rank 0, in addition to the file of the option 'metrics_file'; 
+   * it is not owned by the solver; NULL removes it */
+  inline void setMetricsSink(hiopMetricsSink* sink) { metrics_sink=sink; }
 private:
   bool evalNlp(hiopIterate& iter,
 	       double &f, hiopVector& c_, hiopVector& d_, 
-	       hiopVector& grad_,  hiopMatrixDense& Jac_c,  hiopMatrixDense& Jac_d);
+	       hiopVector& grad_,  hiopMatrix& Jac_c,  hiopMatrix& Jac_d);
   bool evalNlp_funcOnly(hiopIterate& iter, double& f, hiopVector& c_, hiopVector& d_);
-  bool evalNlp_derivOnly(hiopIterate& iter, hiopVector& gradf_,  hiopMatrixDense& Jac_c,  hiopMatrixDense& Jac_d);
+  bool evalNlp_derivOnly(hiopIterate& iter, hiopVector& gradf_,  hiopMatrix& Jac_c,  hiopMatrix& Jac_d);
  /* internal helper for error computation */
   virtual bool evalNlpAndLogErrors(const hiopIterate& it, const hiopResidual& resid, const double& mu,
 				   double& nlpoptim, double& nlpfeas, double& nlpcomplem, double& nlpoverall,
@@ -95,13 +136,65 @@ private:
   bool updateLogBarrierParameters(const hiopIterate& it, const double& mu_curr, const double& tau_curr,
 				  double& mu_new, double& tau_new);
 
+  /* checks the trial point against the filter, the sufficient decrease and the switching/Armijo conditions
+   * relative to a reference point with infeasibility 'theta' and log-barrier objective 'f_logbar'; returns 
+   * the line search status (1,2, or 3, see 'run') of the trial point or 0 if it is not acceptable.
+   * grad_phi_dx is computed along 'dir' only when needed and cached in the last two arguments. */
+  int lineSearchAcceptance(const double& theta, const double& f_logbar, 
+			   const double& theta_trial, const double& alpha_primal,
+			   bool& grad_phi_dx_computed, double& grad_phi_dx);
+  /* second-order correction (SOC) steps for a rejected first trial point that increased the infeasibility.
+   * Reuses the factorization of the KKT system. Returns the line search status of the accepted corrected 
+   * point or 0. On success, dir, _alpha_primal, _alpha_dual, it_trial and the trial quantities correspond 
+   * to the accepted SOC step. */
+  int secondOrderCorrection(hiopKKTLinSys* kkt, const double& theta, double& theta_trial,
+			    bool& grad_phi_dx_computed, double& grad_phi_dx);
+
+  //enters the restoration phase at an iterate with infeasibility theta
+  void startRestoration(double theta);
+  /* computes in 'dir' a direction that reduces the infeasibility at it_curr (restoration phase); 
+   * the KKT system is the one of the regular iterations (its factorization is reused if available) */
+  bool computeRestorationDirection(hiopKKTLinSys* kkt);
+  //the KKT linear system for the option 'hessian_mode' or the sparse one for the sparse formulation
+  hiopKKTLinSys* newKKTLinSys();
+
+  /* active-set freezing: the variables with bound multipliers much larger than their slacks are frozen at their
+   * bounds and removed from the working set; returns true if the working set changed */
+  bool freezeActiveVariables();
+  bool changeWorkingSet(const hiopVectorPar* at_low, const hiopVectorPar* at_upp);
+  /* load balancing: the variables are repartitioned across the ranks based on the time spent in the evaluations;
+   * returns true if the partitioning changed (the algorithm's objects are then reallocated) */
+  bool repartitionVariables();
+  //(de)allocation of the objects whose sizes depend on the working set of variables
+  void allocAlgObjects();
+  void deallocAlgObjects();
+
   virtual void outputIteration(int lsStatus, int lsNum);
+  /* the per-iteration metrics: the current totals of the counters and timers are the baseline of the next record */
+  void startMetrics();
+  void recordMetrics(int lsStatus, int lsNum);
+  void totalMetrics(hiopIterationRecord& tot) const;
 
   //returns whether the algorithm should stop and set an appropriate solve status
   bool checkTermination(const double& _err_nlp, const int& iter_num, hiopSolveStatus& status);
+  //returns whether the wall-clock limit was reached or the solve was cancelled (on any rank) and sets the solve status
+  bool checkStopRequest();
+  //keeps a copy of the current iterate if it is feasible and has the lowest objective so far
+  void updateBestIterate();
+
+  /* checkpoint/restart of the complete state of the algorithm at the beginning of an iteration; each rank
+   * writes its local slices in its own file. Restarting from a checkpoint gives the same iterates as an 
+   * uninterrupted run. On failure to restart (on any rank), the objects are reinitialized at the starting point */
+  bool saveCheckpoint(const int& lsStatus, const int& lsNum);
+  bool loadCheckpoint(int& lsStatus, int& lsNum);
+  std::string checkpointFileName() const;
+  //number of scalars and of counters of the algorithm's state in a checkpoint; files with other numbers are rejected
+  static const int ckptNumScalars=20, ckptNumCounters=24;
   void displayTerminationMsg();
 private:
-  hiopNlpDenseConstraints* nlp;
+  hiopNlpFormulation* nlp;
+  hiopNlpDenseConstraints* nlpdc; //NULL for the sparse and block formulations
+  hiopNlpBlockConstraints* nlpbc; //NULL unless the block formulation is used
   hiopFilter filter;
 
   hiopLogBarProblem* logbar;
@@ -110,8 +203,12 @@ private:
   hiopIterate*it_curr;
   hiopIterate*it_trial;
   hiopIterate* dir;
+  hiopIterate* dir_soc; //direction of the second-order correction
+  hiopIterate* it_watchdog; //iterate stored when the watchdog is activated
+  hiopIterate* it_best; //best feasible iterate, returned when the solver is stopped by the time limit or cancelled
 
   hiopResidual* resid, *resid_trial;
+  hiopResidual* resid_aux; //right-hand side of the second-order correction and restoration steps
 
   int iter_num;
   double _err_nlp_optim, _err_nlp_feas, _err_nlp_complem;//not scaled by sd, sc, and sc
@@ -130,10 +227,10 @@ private:
   double _f_nlp, _f_log, _f_nlp_trial, _f_log_trial;
   hiopVector *_c,*_d, *_c_trial, *_d_trial;
   hiopVector* _grad_f, *_grad_f_trial; //gradient of the log-barrier objective function
-  hiopMatrixDense* _Jac_c, *_Jac_c_trial; //Jacobian of c(x), the equality part
-  hiopMatrixDense* _Jac_d, *_Jac_d_trial; //Jacobian of d(x), the inequality part
+  hiopMatrix* _Jac_c, *_Jac_c_trial; //Jacobian of c(x), the equality part
+  hiopMatrix* _Jac_d, *_Jac_d_trial; //Jacobian of d(x), the inequality part
 
-  hiopHessianLowRank* _Hess;
+  hiopHessianLowRank* _Hess; //quasi-Newton Hessian; NULL for the sparse formulation (exact Hessian)
 
   /** Algorithms's working quantities */  
   double _mu, _tau, _alpha_primal, _alpha_dual;
@@ -156,18 +253,64 @@ private:
   double s_theta,       //parameters in the switch condition of the linearsearch (eq 19)
     s_phi, delta;
   double eta_phi;       //parameter in the Armijo rule
+  int max_resto_iter;   //max number of iterations of a feasibility restoration phase
+  int watchdog_trigger;    //number of consecutive shortened steps that activate the watchdog (0 disables it)
+  int watchdog_max_trials; //max number of tentative watchdog steps 
+  int max_soc_iter;     //max number of second-order correction steps per line search
+  double kappa_soc;     //required decrease in the infeasibility for continuing the second-order correction
+  bool freeze_active;   //whether the strongly active variables are frozen (removed from the working set)
+  double freeze_ratio;  //bound multiplier to slack ratio above which a variable is considered strongly active
+  double freeze_mu;     //the variables are frozen only when mu is below this value
+  double freeze_min_frac;//min fraction of the working set identified as active for the working set to change
+  int repartition_iter;  //iteration at which the variables are repartitioned for load balancing (0 disables it)
+  double repartition_imbalance; //relative imbalance of the evaluation times above which the variables are repartitioned
   double kappa_Sigma;   //parameter in resetting the duals to guarantee closedness of the primal-dual logbar Hessian to the primal logbar Hessian
   int dualsUpdateType;  //type of the update for dual multipliers: 0 LSQ (default, recommended for quasi-Newton); 1 Newton
   int max_n_it;
   int dualsInitializ;  //type of initialization for the duals of constraints: 0 LSQ (default), 1 set to zero
   int accep_n_it;      //after how many iterations with acceptable tolerance should the alg. stop
   double eps_tol_accep;//acceptable tolerance
+  double max_wall_time;//wall-clock limit in seconds
+  int checkpoint_interval; //a checkpoint is written every this many iterations (0 disables checkpointing)
+  std::string checkpoint_file; //prefix of the checkpoint files (the rank is appended)
+  bool time_profile;
+  bool time_profile_counters; //hardware counters per phase of the profile
+  std::string time_profile_trace; //file of the Chrome trace of the profile ("none" disables it)
+  bool checkpoint_restart; //whether the solver restarts from the checkpoint files
   //timers
   hiopTimer tmSol;
 
   //internal flags related to the state of the solver
   hiopSolveStatus _solverStatus;
   int _n_accep_iters;
+  //restoration phase state: whether active, number of iterations, and infeasibility when it started
+  bool _inRestoration;
+  int _n_resto_iters;
+  double _theta_resto;
+  //watchdog state: whether active, counters, and quantities at the stored iterate
+  bool _watchdogActive;
+  int _n_shortened_iters, _n_watchdog_trials;
+  double _theta_watchdog, _f_logbar_watchdog, _grad_phi_dx_watchdog, _alpha_watchdog;
+  //set when frozen variables had to be released; no further freezing is done
+  bool _freezeDisabled;
+  //set once the load-balancing repartitioning was attempted
+  bool _repartitionDone;
+  //best feasible iterate state: whether available, its objective and iteration number
+  bool _hasBest;
+  double _f_best;
+  int _iter_best;
+  //set when the solver was stopped by the wall-clock limit or the cancellation token
+  bool _stopRequested;
+  //whether the cancellation token was handed out, and whether the stop requests are checked (by all ranks) in 'run'
+  bool _cancelTokenUsed, _stopChecks;
+  //iteration at which the last checkpoint was written or loaded
+  int _iter_last_ckpt;
+  hiopCancelToken cancelToken;
+  hiopIterationMonitor* monitor;
+  //sinks of the per-iteration metrics (on rank 0 only) and the totals at the last record
+  hiopMetricsSink* metrics_sink;
+  hiopMetricsFileSink* metrics_file_sink;
+  hiopIterationRecord _metrics_last;
 private:
   hiopAlgFilterIPM() {};
   hiopAlgFilterIPM(const hiopAlgFilterIPM& ) {};
@@ -0,0 +1,246 @@
+// Copyright (c) 2017, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory (LLNL).
+// Written by Cosmin G. Petra, petra1@llnl.gov.
+// LLNL-CODE-742473. All rights reserved.
+//
+// This file is part of HiOp. For details, see https://github.com/LLNL/hiop. HiOp 
+// is released under the BSD 3-clause license (https://opensource.org/licenses/BSD-3-Clause). 
+// Please also read “Additional BSD Notice” below.
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+// i. Redistributions of source code must retain the above copyright notice, this list 
+// of conditions and the disclaimer below.
+// ii. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the disclaimer (as noted below) in the documentation and/or 
+// other materials provided with the distribution.
+// iii. Neither the name of the LLNS/LLNL nor the names of its contributors may be used to 
+// endorse or promote products derived from this software without specific prior written 
+// permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY 
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES 
+// OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT 
+// SHALL LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR 
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS 
+// OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Additional BSD Notice
+// 1. This notice is required to be provided under our contract with the U.S. Department 
+// of Energy (DOE). This work was produced at Lawrence Livermore National Laboratory under 
+// Contract No. DE-AC52-07NA27344 with the DOE.
+// 2. Neither the United States Government nor Lawrence Livermore National Security, LLC 
+// nor any of their employees, makes any warranty, express or implied, or assumes any 
+// liability or responsibility for the accuracy, completeness, or usefulness of any 
+// information, apparatus, product, or process disclosed, or represents that its use would
+// not infringe privately-owned rights.
+// 3. Also, reference herein to any specific commercial products, process, or services by 
+// trade name, trademark, manufacturer or otherwise does not necessarily constitute or 
+// imply its endorsement, recommendation, or favoring by the United States Government or 
+// Lawrence Livermore National Security, LLC. The views and opinions of authors expressed 
+// herein do not necessarily state or reflect those of the United States Government or 
+// Lawrence Livermore National Security, LLC, and shall not be used for advertising or 
+// product endorsement purposes.
+
+#include "hiopBatchSolver.hpp"
+#include "hiopNlpFormulation.hpp"
+#include "hiopAlgFilterIPM.hpp"
+
+#include <cassert>
+#include <climits>
+#include <algorithm>
+
+namespace hiop
+{
+
+hiopBatchSolver::hiopBatchSolver(hiopBatchProblems& problems_, MPI_Comm comm_, int group_size_, 
+				 const char* options_file_)
+  : problems(problems_), options_file(options_file_), comm(comm_), group_comm(comm_), 
+    rank(0), num_ranks(1), group_size(1), num_groups(1), my_group(0), group_rank(0)
+{
+  //reports the problems that cannot be solved, i.e., before their NLP exists; used by the leaders of the groups
+  log = new hiopLogger(NULL, hovWarning, stdout);
+  num_problems = problems.get_num_problems();
+  status.assign(num_problems, NlpSolve_SolveNotCalled);
+  group_of.assign(num_problems, -1);
+  objective.assign(num_problems, 0.);
+  solution.resize(num_problems);
+#ifdef WITH_MPI
+  int ierr;
+  ierr = MPI_Comm_rank(comm, &rank); assert(MPI_SUCCESS==ierr);
+  ierr = MPI_Comm_size(comm, &num_ranks); assert(MPI_SUCCESS==ierr);
+  group_size = std::max(1, std::min(group_size_, num_ranks));
+  num_groups = (num_ranks+group_size-1)/group_size;
+  my_group = rank/group_size;
+  ierr = MPI_Comm_split(comm, my_group, rank, &group_comm); assert(MPI_SUCCESS==ierr);
+  ierr = MPI_Comm_rank(group_comm, &group_rank); assert(MPI_SUCCESS==ierr);
+
+  //the counter is on rank 0; the other ranks expose an empty window
+  ierr = MPI_Win_allocate(0==rank ? sizeof(int) : 0, sizeof(int), MPI_INFO_NULL, comm, &counter, &counter_win);
+  assert(MPI_SUCCESS==ierr);
+#endif
+}
+
+hiopBatchSolver::~hiopBatchSolver()
+{
+#ifdef WITH_MPI
+  //the owner may be destroyed after MPI_Finalize
+  int finalized=0;
+  MPI_Finalized(&finalized);
+  if(!finalized) {
+    MPI_Win_free(&counter_win);
+    MPI_Comm_free(&group_comm);
+  }
+#endif
+  delete log;
+}
+
+int hiopBatchSolver::run()
+{
+#ifdef WITH_MPI
+  int ierr;
+  if(0==rank) {
+    ierr = MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 0, 0, counter_win); assert(MPI_SUCCESS==ierr);
+    *counter = 0;
+    ierr = MPI_Win_unlock(0, counter_win); assert(MPI_SUCCESS==ierr);
+  }
+  ierr = MPI_Barrier(comm); assert(MPI_SUCCESS==ierr);
+#endif
+  int idx;
+  while((idx=next_problem())>=0)
+    solve(idx);
+
+  collect();
+
+  int nsolved=0;
+  for(int i=0; i<num_problems; i++)
+    if(status[i]>=0) nsolved++;
+  return nsolved;
+}
+
+int hiopBatchSolver::next_problem()
+{
+#ifdef WITH_MPI
+  int idx=-1, ierr;
+  if(0==group_rank) {
+    int one=1;
+    ierr = MPI_Win_lock(MPI_LOCK_SHARED, 0, 0, counter_win); assert(MPI_SUCCESS==ierr);
+    ierr = MPI_Fetch_and_op(&one, &idx, MPI_INT, 0, 0, MPI_SUM, counter_win); assert(MPI_SUCCESS==ierr);
+    ierr = MPI_Win_unlock(0, counter_win); assert(MPI_SUCCESS==ierr);
+  }
+  ierr = MPI_Bcast(&idx, 1, MPI_INT, 0, group_comm); assert(MPI_SUCCESS==ierr);
+  return idx<num_problems ? idx : -1;
+#else
+  //sequential solves
+  int idx=0;
+  while(idx<num_problems && status[idx]!=NlpSolve_SolveNotCalled) idx++;
+  return idx<num_problems ? idx : -1;
+#endif
+}
+
+void hiopBatchSolver::solve(int idx)
+{
+  hiopInterfaceDenseConstraints* prob = problems.create_problem(idx, group_comm);
+  assert(prob);
+#ifdef WITH_MPI
+  //the instance must run on the group only
+  MPI_Comm prob_comm; int cmp=MPI_UNEQUAL;
+  if(prob->get_MPI_comm(prob_comm)) MPI_Comm_compare(prob_comm, group_comm, &cmp);
+  if(cmp!=MPI_IDENT && cmp!=MPI_CONGRUENT) {
+    if(0==group_rank) {
+      log->printf(hovWarning, "hiopBatchSolver: the communicator of problem %d is not the one of its group; the problem is skipped\n", idx);
+      status[idx]=Invalid_Parallelization; group_of[idx]=my_group;
+    }
+    problems.release_problem(idx, prob);
+    return;
+  }
+#endif
+  hiopSolveStatus st;
+  {
+    hiopNlpDenseConstraints nlp(*prob, options_file);
+    problems.set_options(idx, *nlp.options);
+    nlp.log->set_verbosity((hiopOutVerbosity) nlp.options->GetInteger("verbosity_level"));
+
+    hiopAlgFilterIPM solver(&nlp);
+    st = solver.run();
+
+    //the local entries of x are gathered on the leader of the group
+    hiopVectorPar* x_usr = nlp.alloc_usr_primal_vec();
+    std::vector<double> xloc(x_usr->get_local_size());
+    if(st!=NlpSolve_IncompleteInit && !xloc.empty()) solver.getSolution(&xloc[0]);
+    const long long n=x_usr->get_size();
+    if(0==group_rank) {
+      status[idx]=st; group_of[idx]=my_group; objective[idx]=solver.getObjective();
+    }
+#ifdef WITH_MPI
+    //the branch must be the same on all the ranks of the group: it depends on the distribution of the NLP only
+    if(nlp.get_vec_distrib()) {
+      int gsize, nloc=(int)xloc.size(), ierr;
+      ierr = MPI_Comm_size(group_comm, &gsize); assert(MPI_SUCCESS==ierr);
+      std::vector<int> counts(gsize), displs(gsize, 0);
+      ierr = MPI_Gather(&nloc, 1, MPI_INT, &counts[0], 1, MPI_INT, 0, group_comm); assert(MPI_SUCCESS==ierr);
+      if(0==group_rank) {
+	for(int r=1; r<gsize; r++) displs[r]=displs[r-1]+counts[r-1];
+	solution[idx].resize(n);
+      }
+      ierr = MPI_Gatherv(xloc.empty() ? NULL : &xloc[0], nloc, MPI_DOUBLE, 
+			 0==group_rank ? &solution[idx][0] : NULL, &counts[0], &displs[0], MPI_DOUBLE, 0, group_comm);
+      assert(MPI_SUCCESS==ierr);
+    } else if(0==group_rank) {
+      //x is not distributed
+      solution[idx].swap(xloc);
+    }
+#else
+    solution[idx].swap(xloc);
+#endif
+    delete x_usr;
+  }
+  problems.release_problem(idx, prob);
+}
+
+void hiopBatchSolver::collect()
+{
+#ifdef WITH_MPI
+  //only the leader that solved a problem has its results
+  int ierr;
+  if(0!=group_rank) { 
+    status.assign(num_problems, INT_MIN); 
+    objective.assign(num_problems, 0.); 
+  } else {
+    for(int i=0; i<num_problems; i++)
+      if(group_of[i]!=my_group) { status[i]=INT_MIN; objective[i]=0.; }
+  }
+  if(num_problems>0) {
+    ierr = MPI_Allreduce(MPI_IN_PLACE, &status[0],    num_problems, MPI_INT,    MPI_MAX, comm); assert(MPI_SUCCESS==ierr);
+    ierr = MPI_Allreduce(MPI_IN_PLACE, &group_of[0],  num_problems, MPI_INT,    MPI_MAX, comm); assert(MPI_SUCCESS==ierr);
+    ierr = MPI_Allreduce(MPI_IN_PLACE, &objective[0], num_problems, MPI_DOUBLE, MPI_SUM, comm); assert(MPI_SUCCESS==ierr);
+  }
+  //the solutions are sent to rank 0 in increasing order of the problems; the messages from a leader are 
+  //received in the order they are sent, hence the single tag
+  const int tag=1;
+  for(int i=0; i<num_problems; i++) {
+    if(group_of[i]<0) continue;
+    const int owner = group_of[i]*group_size;
+    if(owner==rank) {
+      if(0!=rank) {
+	ierr = MPI_Send(solution[i].empty() ? NULL : &solution[i][0], (int)solution[i].size(), MPI_DOUBLE, 0, tag, comm);
+	assert(MPI_SUCCESS==ierr);
+	std::vector<double>().swap(solution[i]);
+      }
+    } else if(0==rank) {
+      MPI_Status mpistat; int count;
+      ierr = MPI_Probe(owner, tag, comm, &mpistat); assert(MPI_SUCCESS==ierr);
+      ierr = MPI_Get_count(&mpistat, MPI_DOUBLE, &count); assert(MPI_SUCCESS==ierr);
+      solution[i].resize(count);
+      ierr = MPI_Recv(count>0 ? &solution[i][0] : NULL, count, MPI_DOUBLE, owner, tag, comm, &mpistat); 
+      assert(MPI_SUCCESS==ierr);
+    }
+  }
+#endif
+}
+
+}
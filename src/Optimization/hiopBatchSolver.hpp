@@ -0,0 +1,142 @@
+// Copyright (c) 2017, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory (LLNL).
+// Written by Cosmin G. Petra, petra1@llnl.gov.
+// LLNL-CODE-742473. All rights reserved.
+//
+// This file is part of HiOp. For details, see https://github.com/LLNL/hiop. HiOp 
+// is released under the BSD 3-clause license (https://opensource.org/licenses/BSD-3-Clause). 
+// Please also read “Additional BSD Notice” below.
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+// i. Redistributions of source code must retain the above copyright notice, this list 
+// of conditions and the disclaimer below.
+// ii. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the disclaimer (as noted below) in the documentation and/or 
+// other materials provided with the distribution.
+// iii. Neither the name of the LLNS/LLNL nor the names of its contributors may be used to 
+// endorse or promote products derived from this software without specific prior written 
+// permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY 
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES 
+// OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT 
+// SHALL LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR 
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS 
+// OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Additional BSD Notice
+// 1. This notice is required to be provided under our contract with the U.S. Department 
+// of Energy (DOE). This work was produced at Lawrence Livermore National Laboratory under 
+// Contract No. DE-AC52-07NA27344 with the DOE.
+// 2. Neither the United States Government nor Lawrence Livermore National Security, LLC 
+// nor any of their employees, makes any warranty, express or implied, or assumes any 
+// liability or responsibility for the accuracy, completeness, or usefulness of any 
+// information, apparatus, product, or process disclosed, or represents that its use would
+// not infringe privately-owned rights.
+// 3. Also, reference herein to any specific commercial products, process, or services by 
+// trade name, trademark, manufacturer or otherwise does not necessarily constitute or 
+// imply its endorsement, recommendation, or favoring by the United States Government or 
+// Lawrence Livermore National Security, LLC. The views and opinions of authors expressed 
+// herein do not necessarily state or reflect those of the United States Government or 
+// Lawrence Livermore National Security, LLC, and shall not be used for advertising or 
+// product endorsement purposes.
+
+#ifndef HIOP_BATCHSOLVER
+#define HIOP_BATCHSOLVER
+
+#include "hiopInterface.hpp"
+#include "hiopOptions.hpp"
+#include "hiopLogger.hpp"
+
+#ifdef WITH_MPI
+#include "mpi.h"
+#endif
+
+#include <vector>
+
+namespace hiop
+{
+
+/* The problems of a batch of independent NLPs, implemented by the user. */
+class hiopBatchProblems
+{
+public:
+  hiopBatchProblems() {};
+  virtual ~hiopBatchProblems() {};
+
+  virtual int get_num_problems() const = 0;
+  /* creates the interface of problem 'idx', which is solved by the ranks of 'comm'; the interface should 
+   * return 'comm' in get_MPI_comm. Called by all the ranks of 'comm'. */
+  virtual hiopInterfaceDenseConstraints* create_problem(int idx, MPI_Comm comm) = 0;
+  /* called after the solve of problem 'idx' */
+  virtual void release_problem(int idx, hiopInterfaceDenseConstraints* prob) { delete prob; }
+  /* options specific to problem 'idx', set after the ones from the options file are loaded. The options used 
+   * in the setup of the NLP (e.g., 'presolve') should be set in the options file [optional] */
+  virtual void set_options(int idx, hiopOptions& options) {};
+};
+
+/* Solves a batch of independent NLPs on the ranks of a communicator. The ranks are split in groups of 
+ * 'group_size' consecutive ranks (the last group may be smaller) and each group solves one problem at a 
+ * time. The problems are assigned to the groups from a work queue shared by all the ranks: the leader of a 
+ * group takes the next problem from a counter on rank 0 of the communicator (MPI-3 atomic fetch-and-add),
+ * so that the groups that get small problems solve more of them.
+ *
+ * The statuses, objectives, and the groups that solved the problems are available on all the ranks after
+ * 'run'; the primal solutions (in the user's space) are collected on rank 0 of the communicator. Each solve
+ * uses its own options (read from 'options_file'), logger, and statistics.
+ */
+class hiopBatchSolver
+{
+public:
+  hiopBatchSolver(hiopBatchProblems& problems, MPI_Comm comm=MPI_COMM_WORLD, int group_size=1, 
+		  const char* options_file=NULL);
+  virtual ~hiopBatchSolver();
+
+  /* solves all the problems; collective over the communicator. Returns the number of problems solved with a 
+   * nonnegative status */
+  virtual int run();
+
+  inline hiopSolveStatus get_status(int idx) const { return (hiopSolveStatus)status[idx]; }
+  inline double get_objective(int idx) const { return objective[idx]; }
+  /* the group that solved problem 'idx' */
+  inline int get_group(int idx) const { return group_of[idx]; }
+  /* the primal solution of problem 'idx'; empty except on rank 0 of the communicator */
+  inline const std::vector<double>& get_solution(int idx) const { return solution[idx]; }
+
+  inline int get_num_groups() const { return num_groups; }
+  inline int get_my_group() const { return my_group; }
+private:
+  /* solves problem 'idx' on the group and stores the results on the leader of the group */
+  void solve(int idx);
+  /* next problem for this group from the shared counter (collective over the group); -1 when none is left */
+  int next_problem();
+  /* the results of the leaders are made available on all the ranks and the solutions on rank 0 */
+  void collect();
+private:
+  hiopBatchProblems& problems;
+  const char* options_file;
+  int num_problems;
+  MPI_Comm comm, group_comm;
+  int rank, num_ranks, group_size, num_groups, my_group, group_rank;
+  //results; on the leaders of the groups during 'run'
+  std::vector<int> status, group_of;
+  std::vector<double> objective;
+  std::vector<std::vector<double> > solution;
+  hiopLogger* log;
+#ifdef WITH_MPI
+  //the counter of the work queue, on rank 0 of comm
+  MPI_Win counter_win;
+  int* counter;
+#endif
+private:
+  hiopBatchSolver(const hiopBatchSolver&);
+  void operator=(const hiopBatchSolver&);
+};
+
+}
+#endif
@@ -0,0 +1,226 @@
+// Copyright (c) 2017, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory (LLNL).
+// Written by Cosmin G. Petra, petra1@llnl.gov.
+// LLNL-CODE-742473. All rights reserved.
+//
+// This file is part of HiOp. For details, see https://github.com/LLNL/hiop. HiOp 
+// is released under the BSD 3-clause license (https://opensource.org/licenses/BSD-3-Clause). 
+// Please also read “Additional BSD Notice” below.
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+// i. Redistributions of source code must retain the above copyright notice, this list 
+// of conditions and the disclaimer below.
+// ii. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the disclaimer (as noted below) in the documentation and/or 
+// other materials provided with the distribution.
+// iii. Neither the name of the LLNS/LLNL nor the names of its contributors may be used to 
+// endorse or promote products derived from this software without specific prior written 
+// permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY 
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES 
+// OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT 
+// SHALL LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR 
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS 
+// OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Additional BSD Notice
+// 1. This notice is required to be provided under our contract with the U.S. Department 
+// of Energy (DOE). This work was produced at Lawrence Livermore National Laboratory under 
+// Contract No. DE-AC52-07NA27344 with the DOE.
+// 2. Neither the United States Government nor Lawrence Livermore National Security, LLC 
+// nor any of their employees, makes any warranty, express or implied, or assumes any 
+// liability or responsibility for the accuracy, completeness, or usefulness of any 
+// information, apparatus, product, or process disclosed, or represents that its use would
+// not infringe privately-owned rights.
+// 3. Also, reference herein to any specific commercial products, process, or services by 
+// trade name, trademark, manufacturer or otherwise does not necessarily constitute or 
+// imply its endorsement, recommendation, or favoring by the United States Government or 
+// Lawrence Livermore National Security, LLC. The views and opinions of authors expressed 
+// herein do not necessarily state or reflect those of the United States Government or 
+// Lawrence Livermore National Security, LLC, and shall not be used for advertising or 
+// product endorsement purposes.
+
+#include "hiopCheckpoint.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <stdint.h>
+#include <cassert>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace hiop
+{
+
+static const char ckpt_magic[8] = {'H','I','O','P','C','K','P','T'};
+static const uint32_t ckpt_version = 1;
+static const size_t ckpt_name_len = 24;
+
+struct CkptHeader 
+{
+  char magic[8];
+  uint32_t version;
+  int32_t rank;
+  int32_t num_ranks;
+  uint32_t num_sections;
+};
+
+struct CkptTocEntry 
+{
+  char name[ckpt_name_len];
+  uint64_t offset;
+  uint64_t nbytes;
+};
+
+static inline uint64_t align8(uint64_t off) { return (off+7) & ~((uint64_t)7); }
+
+void hiopCheckpointWriter::add(const std::string& name, const double* data, long long n)
+{
+  assert(name.size()<ckpt_name_len);
+  Section s; s.name=name; s.data=data; s.nbytes=n*sizeof(double);
+  sections.push_back(s);
+}
+
+void hiopCheckpointWriter::add(const std::string& name, const long long* data, long long n)
+{
+  assert(name.size()<ckpt_name_len);
+  Section s; s.name=name; s.data=data; s.nbytes=n*sizeof(long long);
+  sections.push_back(s);
+}
+
+void hiopCheckpointWriter::add_copy(const std::string& name, const double* data, long long n)
+{
+  copies.push_back(vector<double>(data, data+n));
+  add(name, n>0 ? &copies.back()[0] : NULL, n);
+}
+
+void hiopCheckpointWriter::add_copy(const std::string& name, const long long* data, long long n)
+{
+  copies_ll.push_back(vector<long long>(data, data+n));
+  add(name, n>0 ? &copies_ll.back()[0] : NULL, n);
+}
+
+bool hiopCheckpointWriter::write(const string& filename) const
+{
+  const string tmpname = filename + ".tmp";
+  FILE* f = fopen(tmpname.c_str(), "wb");
+  if(NULL==f) return false;
+
+  CkptHeader h; 
+  memcpy(h.magic, ckpt_magic, 8); h.version=ckpt_version; 
+  h.rank=rank_; h.num_ranks=num_ranks_; h.num_sections=sections.size();
+
+  vector<CkptTocEntry> toc(sections.size());
+  uint64_t off = align8(sizeof(CkptHeader) + sections.size()*sizeof(CkptTocEntry));
+  for(size_t i=0; i<sections.size(); i++) {
+    memset(toc[i].name, 0, ckpt_name_len);
+    strncpy(toc[i].name, sections[i].name.c_str(), ckpt_name_len-1);
+    toc[i].offset = off; toc[i].nbytes = sections[i].nbytes;
+    off = align8(off + sections[i].nbytes);
+  }
+
+  bool bret = (1==fwrite(&h, sizeof(CkptHeader), 1, f));
+  if(bret && toc.size()>0) bret = (toc.size()==fwrite(&toc[0], sizeof(CkptTocEntry), toc.size(), f));
+  const char zeros[8] = {0,0,0,0,0,0,0,0};
+  uint64_t pos = sizeof(CkptHeader) + toc.size()*sizeof(CkptTocEntry);
+  for(size_t i=0; i<sections.size() && bret; i++) {
+    if(toc[i].offset>pos) bret = (1==fwrite(zeros, toc[i].offset-pos, 1, f));
+    if(bret && sections[i].nbytes>0) 
+      bret = (1==fwrite(sections[i].data, sections[i].nbytes, 1, f));
+    pos = toc[i].offset + sections[i].nbytes;
+  }
+  if(0!=fclose(f)) bret=false;
+  if(bret) bret = (0==rename(tmpname.c_str(), filename.c_str()));
+  if(!bret) remove(tmpname.c_str());
+  return bret;
+}
+
+hiopCheckpointReader::hiopCheckpointReader()
+  : base(NULL), length(0)
+{
+}
+
+hiopCheckpointReader::~hiopCheckpointReader()
+{
+  close();
+}
+
+bool hiopCheckpointReader::open(const string& filename, int rank, int num_ranks)
+{
+  close();
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if(fd<0) return false;
+  struct stat st;
+  if(0!=fstat(fd, &st) || st.st_size<(off_t)sizeof(CkptHeader)) { ::close(fd); return false; }
+  length = st.st_size;
+  base = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if(MAP_FAILED==base) { base=NULL; length=0; return false; }
+
+  const CkptHeader* h = static_cast<const CkptHeader*>(base);
+  bool bret = 0==memcmp(h->magic, ckpt_magic, 8) && h->version==ckpt_version && 
+    h->rank==rank && h->num_ranks==num_ranks &&
+    sizeof(CkptHeader)+h->num_sections*sizeof(CkptTocEntry)<=length;
+  if(!bret) close();
+  return bret;
+}
+
+void hiopCheckpointReader::close()
+{
+  if(base) munmap(base, length);
+  base=NULL; length=0;
+}
+
+const char* hiopCheckpointReader::find(const std::string& name, long long& nbytes) const
+{
+  if(NULL==base) return NULL;
+  const CkptHeader* h = static_cast<const CkptHeader*>(base);
+  const CkptTocEntry* toc = reinterpret_cast<const CkptTocEntry*>(static_cast<const char*>(base)+sizeof(CkptHeader));
+  for(uint32_t i=0; i<h->num_sections; i++) {
+    if(0==strncmp(toc[i].name, name.c_str(), ckpt_name_len)) {
+      if(toc[i].offset+toc[i].nbytes>length) return NULL; //truncated file
+      nbytes = toc[i].nbytes;
+      return static_cast<const char*>(base)+toc[i].offset;
+    }
+  }
+  return NULL;
+}
+
+long long hiopCheckpointReader::size(const std::string& name, size_t elem_size) const
+{
+  long long nbytes;
+  if(NULL==find(name, nbytes)) return -1;
+  return nbytes/elem_size;
+}
+
+bool hiopCheckpointReader::read_bytes(const std::string& name, void* data, long long nbytes) const
+{
+  long long nbytes_sec;
+  const char* p = find(name, nbytes_sec);
+  if(NULL==p || nbytes_sec!=nbytes) return false;
+  if(nbytes>0) memcpy(data, p, nbytes);
+  return true;
+}
+
+bool hiopCheckpointReader::read(const std::string& name, double* data, long long n) const
+{
+  return read_bytes(name, data, n*sizeof(double));
+}
+
+bool hiopCheckpointReader::read(const std::string& name, long long* data, long long n) const
+{
+  return read_bytes(name, data, n*sizeof(long long));
+}
+
+}
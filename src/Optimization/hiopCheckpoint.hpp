@@ -0,0 +1,118 @@
+// Copyright (c) 2017, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory (LLNL).
+// Written by Cosmin G. Petra, petra1@llnl.gov.
+// LLNL-CODE-742473. All rights reserved.
+//
+// This file is part of HiOp. For details, see https://github.com/LLNL/hiop. HiOp 
+// is released under the BSD 3-clause license (https://opensource.org/licenses/BSD-3-Clause). 
+// Please also read “Additional BSD Notice” below.
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+// i. Redistributions of source code must retain the above copyright notice, this list 
+// of conditions and the disclaimer below.
+// ii. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the disclaimer (as noted below) in the documentation and/or 
+// other materials provided with the distribution.
+// iii. Neither the name of the LLNS/LLNL nor the names of its contributors may be used to 
+// endorse or promote products derived from this software without specific prior written 
+// permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY 
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES 
+// OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT 
+// SHALL LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR 
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS 
+// OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Additional BSD Notice
+// 1. This notice is required to be provided under our contract with the U.S. Department 
+// of Energy (DOE). This work was produced at Lawrence Livermore National Laboratory under 
+// Contract No. DE-AC52-07NA27344 with the DOE.
+// 2. Neither the United States Government nor Lawrence Livermore National Security, LLC 
+// nor any of their employees, makes any warranty, express or implied, or assumes any 
+// liability or responsibility for the accuracy, completeness, or usefulness of any 
+// information, apparatus, product, or process disclosed, or represents that its use would
+// not infringe privately-owned rights.
+// 3. Also, reference herein to any specific commercial products, process, or services by 
+// trade name, trademark, manufacturer or otherwise does not necessarily constitute or 
+// imply its endorsement, recommendation, or favoring by the United States Government or 
+// Lawrence Livermore National Security, LLC. The views and opinions of authors expressed 
+// herein do not necessarily state or reflect those of the United States Government or 
+// Lawrence Livermore National Security, LLC, and shall not be used for advertising or 
+// product endorsement purposes.
+
+#ifndef HIOP_CHECKPOINT
+#define HIOP_CHECKPOINT
+
+#include <string>
+#include <vector>
+#include <list>
+#include <cstddef>
+
+namespace hiop
+{
+
+/* Binary checkpoint files. Each MPI rank writes its own file with its local slices of the solver state. 
+ * Layout (host byte order; all offsets and sizes in bytes):
+ *  - header: magic "HIOPCKPT", format version, rank, number of ranks, number of sections (24 bytes)
+ *  - table of contents: for each section, its name, offset from the beginning of the file, and size
+ *  - the data of the sections (arrays of doubles or 64-bit integers), each starting at an 8-byte boundary
+ * The layout is fixed so that the file can be mmap-ed and the sections accessed in place, which is what 
+ * the reader does. Unknown sections are ignored by the reader; the version is increased when the meaning 
+ * of existing sections changes. */
+class hiopCheckpointWriter
+{
+public:
+  hiopCheckpointWriter(int rank, int num_ranks) : rank_(rank), num_ranks_(num_ranks) {};
+
+  /* the data is not copied; it has to be available until 'write' is called */
+  void add(const std::string& name, const double* data, long long n);
+  void add(const std::string& name, const long long* data, long long n);
+  /* same as above but the data is copied (for scalars and small arrays) */
+  void add_copy(const std::string& name, const double* data, long long n);
+  void add_copy(const std::string& name, const long long* data, long long n);
+
+  /* the file is written under a temporary name and then renamed, so that a failure while writing 
+   * does not destroy a previous checkpoint */
+  bool write(const std::string& filename) const;
+private:
+  struct Section { std::string name; const void* data; long long nbytes; };
+  std::vector<Section> sections;
+  std::list<std::vector<double> > copies;
+  std::list<std::vector<long long> > copies_ll;
+  int rank_, num_ranks_;
+};
+
+class hiopCheckpointReader
+{
+public:
+  hiopCheckpointReader();
+  ~hiopCheckpointReader();
+
+  /* maps the file and checks the header against the expected rank and number of ranks */
+  bool open(const std::string& filename, int rank, int num_ranks);
+  void close();
+
+  /* number of elements in a section or -1 if the section is not present */
+  long long size(const std::string& name, size_t elem_size=sizeof(double)) const;
+  /* copy the data of a section; return false if the section is not present or has a different size */
+  bool read(const std::string& name, double* data, long long n) const;
+  bool read(const std::string& name, long long* data, long long n) const;
+private:
+  bool read_bytes(const std::string& name, void* data, long long nbytes) const;
+  const char* find(const std::string& name, long long& nbytes) const;
+
+  void* base;
+  size_t length;
+private:
+  hiopCheckpointReader(const hiopCheckpointReader&) {};
+  hiopCheckpointReader& operator=(const hiopCheckpointReader&) {return *this;};
+};
+
+}
+#endif
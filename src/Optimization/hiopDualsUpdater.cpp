@@ -57,19 +57,33 @@ hiopDualsLsqUpdate::hiopDualsLsqUpdate(hiopNlpFormulation* nlp)
   : hiopDualsUpdater(nlp) 
 {
   hiopNlpDenseConstraints* nlpd = dynamic_cast<hiopNlpDenseConstraints*>(_nlp);
-  _mexme = new hiopMatrixDense(nlpd->m_eq(),   nlpd->m_eq());
-  _mexmi = new hiopMatrixDense(nlpd->m_eq(),   nlpd->m_ineq());
-  _mixmi = new hiopMatrixDense(nlpd->m_ineq(), nlpd->m_ineq());
-  _mxm   = new hiopMatrixDense(nlpd->m(), nlpd->m());
-
-  M      = new hiopMatrixDense(nlpd->m(), nlpd->m());
+  _mexme = _mexmi = _mixmi = _mxm = M = _J = NULL;
+  Mdist = NULL;
+  node = NULL; M_buf = NULL;
+  if(nlpd->get_num_ranks()>1 && nlpd->m()>=nlpd->options->GetInteger("dist_reduced_mat_min_size")) {
+    Mdist = new hiopMatrixSymBlockCyclic(nlpd->m(), nlpd->options->GetInteger("dist_reduced_mat_block_size"), 
+					 nlpd->get_comm());
+    _J = nlpd->alloc_multivector_primal(nlpd->m());
+  } else if(nlpd->get_node_comm()) {
+    //M is stored once per node and is formed from the stacked Jacobian [Jc; Jd]
+    node = nlpd->get_node_comm();
+    M_buf = node->alloc_shared(nlpd->m()*nlpd->m());
+    M  = new hiopMatrixDense(nlpd->m(), nlpd->m(), M_buf);
+    _J = nlpd->alloc_multivector_primal(nlpd->m());
+  } else {
+    _mexme = new hiopMatrixDense(nlpd->m_eq(),   nlpd->m_eq());
+    _mexmi = new hiopMatrixDense(nlpd->m_eq(),   nlpd->m_ineq());
+    _mixmi = new hiopMatrixDense(nlpd->m_ineq(), nlpd->m_ineq());
+    _mxm   = new hiopMatrixDense(nlpd->m(), nlpd->m());
+    M      = new hiopMatrixDense(nlpd->m(), nlpd->m());
+  }
   rhs    = new hiopVectorPar(nlpd->m());
   rhsc   = dynamic_cast<hiopVectorPar*>(nlpd->alloc_dual_eq_vec());
   rhsd   = dynamic_cast<hiopVectorPar*>(nlpd->alloc_dual_ineq_vec());
   _vec_n = dynamic_cast<hiopVectorPar*>(nlpd->alloc_primal_vec());
   _vec_mi= dynamic_cast<hiopVectorPar*>(nlpd->alloc_dual_ineq_vec());
 #ifdef DEEP_CHECKING
-  M_copy = M->alloc_clone();
+  M_copy = new hiopMatrixDense(nlpd->m(), nlpd->m());
   rhs_copy = rhs->alloc_clone();
   _mixme = new hiopMatrixDense(nlpd->m_ineq(), nlpd->m_eq());
 #endif
@@ -79,11 +93,14 @@ hiopDualsLsqUpdate::hiopDualsLsqUpdate(hiopNlpFormulation* nlp)
 
 hiopDualsLsqUpdate::~hiopDualsLsqUpdate()
 {
-  delete _mexme;
-  delete _mexmi;
-  delete _mixmi;
-  delete _mxm;
-  delete M;
+  if(_mexme) delete _mexme;
+  if(_mexmi) delete _mexmi;
+  if(_mixmi) delete _mixmi;
+  if(_mxm)   delete _mxm;
+  if(M)      delete M;
+  if(M_buf)  node->free_shared(M_buf);
+  if(Mdist)  delete Mdist;
+  if(_J)     delete _J;
   delete rhs;
   delete rhsc; 
   delete rhsd;
@@ -150,29 +167,55 @@ bool hiopDualsLsqUpdate::LSQUpdate(hiopIterate& iter, const hiopVector& grad_f,
   hiopNlpDenseConstraints* nlpd = dynamic_cast<hiopNlpDenseConstraints*>(_nlp);
   assert(nlpd!=NULL);
 
-  //compute terms in M: Jc * Jc^T, J_c * J_d^T, and J_d * J_d^T
-  //! streamline the communication (use _mxm as a global buffer for the MPI_Allreduce)
-  jac_c.timesMatTrans(0.0, *_mexme, 1.0, jac_c);
-  jac_c.timesMatTrans(0.0, *_mexmi, 1.0, jac_d);
-  jac_d.timesMatTrans(0.0, *_mixmi, 1.0, jac_d);
-  _mixmi->addDiagonal(1.0);
+  if(Mdist) {
+    //M is summed from the local contributions of [Jc; Jd]*[Jc; Jd]^T directly in the distributed layout
+    _J->copyRowsFrom(dynamic_cast<const hiopMatrixDense&>(jac_c), nlpd->m_eq(), 0);
+    _J->copyRowsFrom(dynamic_cast<const hiopMatrixDense&>(jac_d), nlpd->m_ineq(), nlpd->m_eq());
+    Mdist->zeroContributions();
+    Mdist->addContribSymmTimesDiagTimesMatTrans(1.0, *_J, NULL);
+    Mdist->reduceContributions();
+    Mdist->addSubDiagonal(nlpd->m_eq(), nlpd->m_ineq(), 1.0);
+  } else if(node) {
+    //M is summed from the local contributions of [Jc; Jd]*[Jc; Jd]^T in blocks of rows
+    _J->copyRowsFrom(dynamic_cast<const hiopMatrixDense&>(jac_c), nlpd->m_eq(), 0);
+    _J->copyRowsFrom(dynamic_cast<const hiopMatrixDense&>(jac_d), nlpd->m_ineq(), nlpd->m_eq());
+    node->matTimesDiagTimesMatTrans(*M, 1.0, *_J, NULL, *_J);
+  } else {
+    //compute terms in M: Jc * Jc^T, J_c * J_d^T, and J_d * J_d^T
+    //! streamline the communication (use _mxm as a global buffer for the MPI_Allreduce)
+    jac_c.timesMatTrans(0.0, *_mexme, 1.0, jac_c);
+    jac_c.timesMatTrans(0.0, *_mexmi, 1.0, jac_d);
+    jac_d.timesMatTrans(0.0, *_mixmi, 1.0, jac_d);
+    _mixmi->addDiagonal(1.0);
 
-  M->copyBlockFromMatrix(0,0,*_mexme);
-  M->copyBlockFromMatrix(0, nlpd->m_eq(), *_mexmi);
-  M->copyBlockFromMatrix(nlpd->m_eq(),nlpd->m_eq(), *_mixmi);
+    M->copyBlockFromMatrix(0,0,*_mexme);
+    M->copyBlockFromMatrix(0, nlpd->m_eq(), *_mexmi);
+    M->copyBlockFromMatrix(nlpd->m_eq(),nlpd->m_eq(), *_mixmi);
 
-  //nlpd->log->write("aaa", *M, hovSummary);
+    //nlpd->log->write("aaa", *M, hovSummary);
 #ifdef DEEP_CHECKING
-  M_copy->copyFrom(*M);
-  jac_d.timesMatTrans(0.0, *_mixme, 1.0, jac_c);
-  M_copy->copyBlockFromMatrix(nlpd->m_eq(), 0, *_mixme);
-  M_copy->assertSymmetry(1e-12);
+    M_copy->copyFrom(*M);
+    jac_d.timesMatTrans(0.0, *_mixme, 1.0, jac_c);
+    M_copy->copyBlockFromMatrix(nlpd->m_eq(), 0, *_mixme);
+    M_copy->assertSymmetry(1e-12);
 #endif
-
+  }
 
   //bailout in case there is an error in the Cholesky factorization
-  int info;
-  if(info=this->factorizeMat(*M)) {
+  int info=0;
+  if(node) {
+    //the leader updates and factorizes the shared M; the other ranks of the node only read it
+    if(node->is_leader()) {
+      double** Md=M->local_data();
+      for(long long i=nlpd->m_eq(); i<nlpd->m(); i++) Md[i][i] += 1.0;
+      info = this->factorizeMat(*M);
+    }
+    info = node->bcast_from_leader(info);
+    node->sync();
+  } else {
+    info = Mdist ? Mdist->factorize() : this->factorizeMat(*M);
+  }
+  if(info) {
     nlpd->log->printf(hovError, "dual lsq update: error %d in the Cholesky factorization.\n", info);
     return false;
   }
@@ -203,7 +246,8 @@ bool hiopDualsLsqUpdate::LSQUpdate(hiopIterate& iter, const hiopVector& grad_f,
 #endif
 
   //solve for this rhs
-  if(info=this->solveWithFactors(*M, *rhs)) {
+  if(Mdist) Mdist->solve(*rhs);
+  else if(info=this->solveWithFactors(*M, *rhs)) {
     nlpd->log->printf(hovError, "dual lsq update: error %d in the solution process.\n", info);
     return false;
   }
@@ -213,6 +257,7 @@ bool hiopDualsLsqUpdate::LSQUpdate(hiopIterate& iter, const hiopVector& grad_f,
   rhs->copyToStarting(*iter.get_yd(), nlpd->m_eq());
 
 #ifdef DEEP_CHECKING
+  if(_mxm) {
   double nrmrhs = rhs_copy->twonorm();
   M_copy->timesVec(-1.0,  *rhs_copy, 1.0, *rhs);
   double nrmres = rhs_copy->twonorm() / (1+nrmrhs);
@@ -224,6 +269,7 @@ bool hiopDualsLsqUpdate::LSQUpdate(hiopIterate& iter, const hiopVector& grad_f,
     if(nrmres>1e-6)
       nlpd->log->printf(hovWarning, "hiopDualsLsqUpdate::LSQUpdate linear system residual is dangerously high: %g\n", nrmres);
   }
+  }
 #endif
 
   //nlpd->log->write("yc ini", *iter.get_yc(), hovSummary);
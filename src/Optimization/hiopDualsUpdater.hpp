@@ -53,6 +53,7 @@
 #include "hiopIterate.hpp"
 #include "hiopResidual.hpp"
 #include "hiopMatrix.hpp"
+#include "hiopMatrixSymBlockCyclic.hpp"
 
 namespace hiop
 {
@@ -119,6 +120,14 @@ private: //common code
 private:
   hiopMatrixDense *_mexme, *_mexmi, *_mixmi, *_mxm;
   hiopMatrixDense *M;
+  //M distributed in a 2D block-cyclic layout for large m (option 'dist_reduced_mat_min_size'), in which case
+  //the above are NULL, and the stacked Jacobian [Jc; Jd]
+  hiopMatrixSymBlockCyclic* Mdist;
+  hiopMatrixDense* _J;
+  //M over a buffer shared by the ranks of the node (option 'node_shared_reduced_mats'); _J is then also
+  //allocated and the blocks above are NULL
+  hiopNodeComm* node;
+  double* M_buf;
   
   hiopVectorPar *rhs, *rhsc, *rhsd;
   hiopVectorPar *_vec_n, *_vec_mi;
@@ -53,6 +53,22 @@ using namespace std;
 namespace hiop
 {
 
+void hiopFilter::getEntries(vector<double>& theta_phi) const
+{
+  theta_phi.clear();
+  for(list<FilterEntry>::const_iterator it=entries.begin(); it!=entries.end(); ++it) {
+    theta_phi.push_back(it->theta); theta_phi.push_back(it->phi);
+  }
+}
+
+void hiopFilter::setEntries(const vector<double>& theta_phi)
+{
+  assert(theta_phi.size()%2==0);
+  entries.clear();
+  for(size_t i=0; i+1<theta_phi.size(); i+=2)
+    entries.push_back(FilterEntry(theta_phi[i], theta_phi[i+1]));
+}
+
 bool hiopFilter::contains(const double& theta, const double& phi) const
 {
   list<FilterEntry>::const_iterator it = entries.begin();
@@ -50,6 +50,7 @@
 #define HIOP_FILTER
 
 #include <list>
+#include <vector>
 #include <cassert>
 
 namespace hiop
@@ -66,6 +67,10 @@ public:
   inline void add(const double& theta, const double& phi) { entries.push_front(FilterEntry(theta,phi)); }
   bool contains(const double& theta, const double& phi) const;
 
+  //the entries as (theta,phi) pairs, in the order in which they are stored; used for checkpointing
+  void getEntries(std::vector<double>& theta_phi) const;
+  void setEntries(const std::vector<double>& theta_phi);
+
 private:
   struct FilterEntry { 
     FilterEntry(const double& t, const double& p) : theta(t), phi(p) {};
@@ -59,6 +59,7 @@
 #include <cassert>
 #include <cstring>
 #include <cmath>
+#include <limits>
 
 #include <vector>
 using namespace std;
@@ -72,9 +73,37 @@ using namespace std;
 namespace hiop
 {
 
-hiopHessianLowRank::hiopHessianLowRank(hiopNlpDenseConstraints* nlp_, int max_mem_len)
+hiopHessianLowRank::hiopHessianLowRank(hiopNlpFormulation* nlp_, int max_mem_len)
   : l_max(max_mem_len), l_curr(-1), sigma(1.), sigma0(1.), nlp(nlp_), matrixChanged(false)
 {
+  sr1 = nlp->options->GetString("secant_update_type")=="sr1";
+  B0_user = nlp->options->GetString("secant_B0_user_diag")=="yes";
+  //the structured mode is available only for the dense formulation
+  cons_only = nlp->options->GetString("hessian_mode")=="structured" && 
+    NULL!=dynamic_cast<hiopNlpDenseConstraints*>(nlp);
+  //the memory budget (in MB per rank, for S and Y) caps the length of the memory
+  adaptive_mem = nlp->options->GetString("secant_memory_adaptive")=="yes";
+  l_upper = adaptive_mem ? nlp->options->GetInteger("secant_memory_max_len") : l_max;
+  const double budget = nlp->options->GetNumeric("secant_memory_budget");
+  const long long n_loc = nlp->get_xl().get_local_size();
+  if(budget<1e+20 && n_loc>0) {
+    long long l_budget = (long long)(budget*1024*1024/(2.*sizeof(double)*n_loc));
+#ifdef WITH_MPI
+    long long l_budget_glob;
+    int ierr = MPI_Allreduce(&l_budget, &l_budget_glob, 1, MPI_LONG_LONG, MPI_MIN, nlp->get_comm()); assert(ierr==MPI_SUCCESS);
+    l_budget = l_budget_glob;
+#endif
+    if(l_budget<l_upper) l_upper = l_budget<1 ? 1 : l_budget;
+  }
+  if(l_max>l_upper) {
+    nlp->log->printf(hovWarning, "hiopHessianLowRank: secant memory length reduced to %d to fit the memory budget\n", l_upper);
+    l_max = l_upper;
+  }
+  if(l_upper<l_max) l_upper=l_max;
+  l_init = l_max;
+  l_lower = l_max<2 ? l_max : 2;
+  _n_slow_iters = _n_fast_iters = _n_skipped_updates = 0;
+
   DhInv = dynamic_cast<hiopVectorPar*>(nlp->alloc_primal_vec());
   St = nlp->alloc_multivector_primal(0,l_max);
   Yt = St->alloc_clone(); //faster than nlp->alloc_multivector_primal(...);
@@ -88,16 +117,22 @@ hiopHessianLowRank::hiopHessianLowRank(hiopNlpDenseConstraints* nlp_, int max_me
 
   //internal buffers for memory pool (none of them should be in n)
 #ifdef WITH_MPI
-  _buff_kxk    = new double[nlp->m() * nlp->m()];
-  _buff_2lxk   = new double[nlp->m() * 2*l_max];
-  _buff1_lxlx3 = new double[3*l_max*l_max];
-  _buff2_lxlx3 = new double[3*l_max*l_max];
+  //not needed when the reduced matrix is distributed (see hiopKKTLinSysLowRank) or when the 
+  //constraints are not all dense (see hiopKKTLinSysBlock)
+  if(NULL==dynamic_cast<hiopNlpDenseConstraints*>(nlp) ||
+     (nlp->get_num_ranks()>1 && nlp->m()>=nlp->options->GetInteger("dist_reduced_mat_min_size")) ||
+     nlp->get_node_comm())
+    _buff_kxk  = NULL;
+  else
+    _buff_kxk  = new double[nlp->m() * nlp->m()];
 #else
    //not needed in non-MPI mode
   _buff_kxk  = NULL;
+#endif
   _buff_2lxk = NULL;
   _buff1_lxlx3 = _buff2_lxlx3 = NULL;
-#endif
+  _M_ipiv_vec = NULL;
+  allocLmaxBuffers();
 
   //auxiliary objects/buffers
   _S1=_Y1=NULL;
@@ -105,20 +140,27 @@ hiopHessianLowRank::hiopHessianLowRank(hiopNlpDenseConstraints* nlp_, int max_me
   _l_vec1 = _l_vec2 = _2l_vec1 = NULL;
   _n_vec1 = DhInv->alloc_clone();
   _n_vec2 = DhInv->alloc_clone();
+  _n_vec3 = sr1 ? DhInv->alloc_clone() : NULL;
+  B0 = DhInv->alloc_clone();
 
   _V_work_vec=new hiopVectorPar(0);
   _V_ipiv_vec=NULL; _V_ipiv_size=-1;
+  _Wt=_Mfact=NULL; _M_nneg=0; _sr1_delta_last=0.;
+  _Qfact=NULL; _Q_ipiv_vec=NULL; _Q_valid=false;
 
   sigma=sigma0;
   sigma_update_strategy = SIGMA_STRATEGY1;
   sigma_safe_min=1e-8;
   sigma_safe_max=1e+8;
+  B0->setToConstant(sigma);
   nlp->log->printf(hovScalars, "Hessian Low Rank: initial sigma is %g\n", sigma);
+  if(sr1) nlp->log->printf(hovScalars, "Hessian Low Rank: using the SR1 update\n");
 
 #ifdef DEEP_CHECKING
   _Dx   = DhInv->alloc_clone();
-  _Vmat = V->alloc_clone();
 #endif
+  _Vmat = V->alloc_clone();
+  _Pt = NULL;
 
 }  
 
@@ -134,9 +176,8 @@ hiopHessianLowRank::~hiopHessianLowRank()
   if(L)  delete L;
   if(D)  delete D;
   if(V)  delete V;
-#ifdef DEEP_CHECKING
   delete _Vmat;
-#endif
+  if(_Pt) delete _Pt;
 
 
   if(_it_prev)    delete _it_prev;
@@ -159,15 +200,297 @@ hiopHessianLowRank::~hiopHessianLowRank()
   if(_l_vec2) delete _l_vec2;
   if(_n_vec1) delete _n_vec1;
   if(_n_vec2) delete _n_vec2;
+  if(_n_vec3) delete _n_vec3;
+  if(B0)      delete B0;
   if(_2l_vec1) delete _2l_vec1;
   if(_V_ipiv_vec) delete[] _V_ipiv_vec;
   if(_V_work_vec) delete _V_work_vec;
+  if(_Wt)    delete _Wt;
+  if(_Mfact) delete _Mfact;
+  if(_M_ipiv_vec) delete[] _M_ipiv_vec;
+  if(_Qfact) delete _Qfact;
+  if(_Q_ipiv_vec) delete[] _Q_ipiv_vec;
+}
+
+
+void hiopHessianLowRank::allocLmaxBuffers()
+{
+#ifdef WITH_MPI
+  if(_buff_2lxk)   delete[] _buff_2lxk;
+  if(_buff1_lxlx3) delete[] _buff1_lxlx3;
+  if(_buff2_lxlx3) delete[] _buff2_lxlx3;
+  //only the dense formulation uses the products with the Jacobian (symMatTimesInverseTimesMatTrans)
+  const long long m_dense = NULL==dynamic_cast<hiopNlpDenseConstraints*>(nlp) ? 1 : nlp->m();
+  _buff_2lxk   = new double[m_dense * 2*l_max];
+  _buff1_lxlx3 = new double[3*l_max*l_max];
+  _buff2_lxlx3 = new double[3*l_max*l_max];
+#endif
+  if(sr1) {
+    if(_M_ipiv_vec) delete[] _M_ipiv_vec;
+    _M_ipiv_vec = new int[l_max>0 ? l_max : 1];
+  }
+}
+
+void hiopHessianLowRank::setMemoryLength(int l_new)
+{
+  assert(l_new>=1);
+  if(l_new==l_max) return;
+  //the oldest pairs are dropped if more than l_new are stored
+  dropOldestPairs(l_curr>l_new ? l_curr-l_new : 0, l_new);
+  l_max = l_new;
+  allocLmaxBuffers();
+}
+
+void hiopHessianLowRank::dropOldestPairs(int n_drop, int l_cap)
+{
+  hiopMatrixDense* mats[2] = {St, Yt};
+  hiopVectorPar& row = new_n_vec1(St->n());
+  for(int k=0; k<2; k++) {
+    hiopMatrixDense* Mnew = nlp->alloc_multivector_primal(0, l_cap);
+    for(int i=n_drop; i<mats[k]->m(); i++) { mats[k]->getRow(i, row); Mnew->appendRow(row); }
+    delete mats[k]; mats[k]=Mnew;
+  }
+  St=mats[0]; Yt=mats[1];
+
+  if(n_drop>0) {
+    const int l = l_curr-n_drop;
+    hiopMatrixDense* Lnew = new hiopMatrixDense(l,l);
+    if(l>0) Lnew->copyFromMatrixBlock(*L, n_drop, n_drop);
+    delete L; L=Lnew;
+    hiopVectorPar* Dnew = new hiopVectorPar(l);
+    memcpy(Dnew->local_data(), D->local_data_const()+n_drop, l*sizeof(double));
+    delete D; D=Dnew;
+    l_curr = l;
+  }
+  matrixChanged=true;
+  _Q_valid=false;
+}
+
+void hiopHessianLowRank::adaptMemoryLength(bool fullStep, double errRatio)
+{
+  if(!adaptive_mem || l_curr<0) return;
+  //an iteration is slow if the step was cut or the NLP error did not decrease by at least 10%
+  if(!fullStep || errRatio>0.9) { _n_slow_iters++; _n_fast_iters=0; }
+  else                          { _n_fast_iters++; _n_slow_iters=0; }
+
+  int l_new = l_max;
+  if(_n_skipped_updates>=2) {
+    //the curvature pairs are of poor quality: keep fewer of them
+    if(l_max>l_lower) l_new = l_max-1;
+    _n_skipped_updates=0;
+  } else if(_n_slow_iters>=3) {
+    //grow only when the memory is full; the new pairs are added by growL and growD at the next updates
+    if(l_curr==l_max && l_max<l_upper) l_new = l_max+1;
+    _n_slow_iters=0;
+  } else if(_n_fast_iters>=3) {
+    if(l_max>l_init) l_new = l_max-1;
+    _n_fast_iters=0;
+  }
+  if(l_new!=l_max) {
+    nlp->log->printf(hovScalars, "hiopHessianLowRank: secant memory length changed from %d to %d\n", l_max, l_new);
+    setMemoryLength(l_new);
+    nlp->runStats.nSecantMemChanges++;
+  }
+}
+
+/* the Jacobians are dense or have dense global and rank-local blocks (hiopMatrixDenseLocalRows) */
+static void addJacToCheckpoint(hiopCheckpointWriter& w, const std::string& name, const hiopMatrix& J)
+{
+  const hiopMatrixDenseLocalRows* Jb = dynamic_cast<const hiopMatrixDenseLocalRows*>(&J);
+  if(Jb) {
+    addJacToCheckpoint(w, name+".glob", Jb->get_glob_block());
+    addJacToCheckpoint(w, name+".loc", Jb->get_local_block());
+    return;
+  }
+  const hiopMatrixDense& Jd = dynamic_cast<const hiopMatrixDense&>(J);
+  w.add(name, Jd.local_buffer(), Jd.m()*Jd.get_local_size_n());
+}
+static bool readJacFromCheckpoint(const hiopCheckpointReader& r, const std::string& name, hiopMatrix& J)
+{
+  hiopMatrixDenseLocalRows* Jb = dynamic_cast<hiopMatrixDenseLocalRows*>(&J);
+  if(Jb) {
+    return readJacFromCheckpoint(r, name+".glob", Jb->get_glob_block()) &&
+      readJacFromCheckpoint(r, name+".loc", Jb->get_local_block());
+  }
+  hiopMatrixDense& Jd = dynamic_cast<hiopMatrixDense&>(J);
+  return r.read(name, Jd.local_buffer(), Jd.m()*Jd.get_local_size_n());
+}
+
+void hiopHessianLowRank::saveToCheckpoint(hiopCheckpointWriter& w) const
+{
+  const double scalars[] = {(double)l_max, (double)l_curr, sigma};
+  w.add_copy("hess.scalars", scalars, 3);
+  const double adapt[] = {(double)_n_slow_iters, (double)_n_fast_iters, (double)_n_skipped_updates};
+  w.add_copy("hess.adapt", adapt, 3);
+  if(sr1) w.add_copy("hess.sr1", &_sr1_delta_last, 1);
+  if(l_curr<0) return;
+  w.add("hess.St", St->local_buffer(), St->m()*St->get_local_size_n());
+  w.add("hess.Yt", Yt->local_buffer(), Yt->m()*Yt->get_local_size_n());
+  w.add("hess.L", L->local_buffer(), L->m()*L->get_local_size_n());
+  w.add("hess.D", D->local_data_const(), D->get_local_size());
+  _it_prev->saveToCheckpoint(w, "hess.prev.");
+  w.add("hess.prev.grad_f", _grad_f_prev->local_data_const(), _grad_f_prev->get_local_size());
+  addJacToCheckpoint(w, "hess.prev.Jac_c", *_Jac_c_prev);
+  addJacToCheckpoint(w, "hess.prev.Jac_d", *_Jac_d_prev);
+}
+
+bool hiopHessianLowRank::loadFromCheckpoint(const hiopCheckpointReader& r)
+{
+  assert(St->m()==0 && "the secant memory can be loaded only in a newly created object");
+  double scalars[3];
+  if(!r.read("hess.scalars", scalars, 3)) return false;
+  //with the adaptive memory, the length is the one at the time of the checkpoint
+  if(adaptive_mem && (int)scalars[0]>=l_lower && (int)scalars[0]<=l_upper)
+    setMemoryLength((int)scalars[0]);
+  double adapt[3];
+  if(r.read("hess.adapt", adapt, 3)) {
+    _n_slow_iters=(int)adapt[0]; _n_fast_iters=(int)adapt[1]; _n_skipped_updates=(int)adapt[2];
+  }
+  if((int)scalars[0]!=l_max) {
+    nlp->log->printf(hovWarning, "hiopHessianLowRank: checkpoint was written with a secant memory of %d (current %d)\n", 
+		     (int)scalars[0], l_max);
+    return false;
+  }
+  l_curr = (int)scalars[1]; sigma = scalars[2];
+  //the user's diagonal, if any, is evaluated at the next update
+  B0->setToConstant(sigma);
+  _Q_valid=false;
+  if(sr1 && !r.read("hess.sr1", &_sr1_delta_last, 1)) _sr1_delta_last=0.;
+  if(l_curr<0) return true;
+
+  const long long n_loc = St->get_local_size_n();
+  std::vector<double> buf(l_curr*n_loc);
+  hiopVectorPar& row = new_n_vec1(St->n());
+  if(l_curr>0 && !r.read("hess.St", &buf[0], l_curr*n_loc)) return false;
+  for(int i=0; i<l_curr; i++) { row.copyFrom(&buf[i*n_loc]); St->appendRow(row); }
+  if(l_curr>0 && !r.read("hess.Yt", &buf[0], l_curr*n_loc)) return false;
+  for(int i=0; i<l_curr; i++) { row.copyFrom(&buf[i*n_loc]); Yt->appendRow(row); }
+
+  delete L; L=new hiopMatrixDense(l_curr,l_curr);
+  delete D; D=new hiopVectorPar(l_curr);
+  if(l_curr>0) {
+    if(!r.read("hess.L", L->local_buffer(), l_curr*l_curr)) return false;
+    if(!r.read("hess.D", D->local_data(), l_curr)) return false;
+  }
+
+  if(NULL==_it_prev)     _it_prev     = new hiopIterate(nlp);
+  if(NULL==_grad_f_prev) _grad_f_prev = dynamic_cast<hiopVectorPar*>(nlp->alloc_primal_vec());
+  if(NULL==_Jac_c_prev)  _Jac_c_prev  = nlp->alloc_Jac_c();
+  if(NULL==_Jac_d_prev)  _Jac_d_prev  = nlp->alloc_Jac_d();
+  if(!_it_prev->loadFromCheckpoint(r, "hess.prev.")) return false;
+  if(!r.read("hess.prev.grad_f", _grad_f_prev->local_data(), _grad_f_prev->get_local_size())) return false;
+  if(!readJacFromCheckpoint(r, "hess.prev.Jac_c", *_Jac_c_prev)) return false;
+  if(!readJacFromCheckpoint(r, "hess.prev.Jac_d", *_Jac_d_prev)) return false;
+  matrixChanged=true;
+  return true;
+}
+
+//the rows of a dense Jacobian moved to the columns partitioning of 'dest'
+static void redistributeJacRows(const hiopMatrix& src, hiopMatrix& dest, MPI_Comm comm)
+{
+  const hiopMatrixDense& Js = dynamic_cast<const hiopMatrixDense&>(src);
+  hiopMatrixDense& Jd = dynamic_cast<hiopMatrixDense&>(dest);
+  assert(Js.m()==Jd.m());
+  const long long ns=Js.get_local_size_n(), nd=Jd.get_local_size_n();
+  for(int i=0; i<Js.m(); i++)
+    hiopVectorPar::redistribute(Js.local_buffer()+i*ns, ns, Jd.local_buffer()+i*nd, nd, comm);
+}
+
+void hiopHessianLowRank::copyRedistributedFrom(const hiopHessianLowRank& src)
+{
+  assert(St->m()==0 && "the secant memory can be copied only in a newly created object");
+  if(src.l_max!=l_max) setMemoryLength(src.l_max);
+  l_curr=src.l_curr; sigma=src.sigma;
+  _n_slow_iters=src._n_slow_iters; _n_fast_iters=src._n_fast_iters; _n_skipped_updates=src._n_skipped_updates;
+  _sr1_delta_last=src._sr1_delta_last;
+  //the user's diagonal, if any, is evaluated at the next update
+  B0->setToConstant(sigma);
+  _Q_valid=false;
+  if(l_curr<0) return;
+
+  const MPI_Comm comm=nlp->get_comm();
+  hiopVectorPar& row = new_n_vec1(St->n());
+  const long long ns=src.St->get_local_size_n(), nd=row.get_local_size();
+  for(int i=0; i<l_curr; i++) {
+    hiopVectorPar::redistribute(src.St->local_buffer()+i*ns, ns, row.local_data(), nd, comm);
+    St->appendRow(row);
+    hiopVectorPar::redistribute(src.Yt->local_buffer()+i*ns, ns, row.local_data(), nd, comm);
+    Yt->appendRow(row);
+  }
+  delete L; L=src.L->new_copy();
+  delete D; D=src.D->new_copy();
+
+  if(NULL==_it_prev)     _it_prev     = new hiopIterate(nlp);
+  if(NULL==_grad_f_prev) _grad_f_prev = dynamic_cast<hiopVectorPar*>(nlp->alloc_primal_vec());
+  if(NULL==_Jac_c_prev)  _Jac_c_prev  = nlp->alloc_Jac_c();
+  if(NULL==_Jac_d_prev)  _Jac_d_prev  = nlp->alloc_Jac_d();
+  _it_prev->copyRedistributedFrom(*src._it_prev);
+  _grad_f_prev->copyFromRedistributed(*src._grad_f_prev);
+  redistributeJacRows(*src._Jac_c_prev, *_Jac_c_prev, comm);
+  redistributeJacRows(*src._Jac_d_prev, *_Jac_d_prev, comm);
+  matrixChanged=true;
 }
 
+//the columns idx[k] of a dense Jacobian in the columns k of 'dest'
+static void selectJacCols(const hiopMatrix& src, hiopMatrix& dest, const long long* idx)
+{
+  const hiopMatrixDense& Js = dynamic_cast<const hiopMatrixDense&>(src);
+  hiopMatrixDense& Jd = dynamic_cast<hiopMatrixDense&>(dest);
+  assert(Js.m()==Jd.m());
+  const long long ns=Js.get_local_size_n(), nd=Jd.get_local_size_n();
+  for(int i=0; i<Js.m(); i++)
+    hiopVectorPar::select(Js.local_buffer()+i*ns, Jd.local_buffer()+i*nd, nd, idx);
+}
+
+void hiopHessianLowRank::copySelectedFrom(const hiopHessianLowRank& src, const long long* idx)
+{
+  assert(St->m()==0 && "the secant memory can be copied only in a newly created object");
+  if(src.l_max!=l_max) setMemoryLength(src.l_max);
+  l_curr=src.l_curr; sigma=src.sigma;
+  _n_slow_iters=src._n_slow_iters; _n_fast_iters=src._n_fast_iters; _n_skipped_updates=src._n_skipped_updates;
+  _sr1_delta_last=src._sr1_delta_last;
+  //the user's diagonal, if any, is evaluated at the next update
+  B0->setToConstant(sigma);
+  DhInv->copyFromSelected(*src.DhInv, idx);
+  _Q_valid=false;
+  if(l_curr<0) return;
+
+  //the pairs are appended as in 'update'
+  const long long ns=src.St->get_local_size_n();
+  hiopVectorPar& s = new_n_vec1(St->n());
+  hiopVectorPar& y = new_n_vec2(St->n());
+  int l=0;
+  for(int i=0; i<src.l_curr; i++) {
+    hiopVectorPar::select(src.St->local_buffer()+i*ns, s.local_data(), s.get_local_size(), idx);
+    hiopVectorPar::select(src.Yt->local_buffer()+i*ns, y.local_data(), y.get_local_size(), idx);
+    const double sTy = s.dotProductWith(y), s_nrm2=s.twonorm(), y_nrm2=y.twonorm();
+    if(!sr1 && sTy<=s_nrm2*y_nrm2*std::numeric_limits<double>::epsilon()) continue;
+    hiopVectorPar& YTs = new_l_vec1(l);
+    Yt->timesVec(0.0, YTs, 1.0, s);
+    St->appendRow(s);
+    Yt->appendRow(y);
+    growL(l, l_max, YTs);
+    growD(l, l_max, sTy);
+    l++;
+  }
+  if(l<l_curr) 
+    nlp->log->printf(hovScalars, "hiopHessianLowRank: %d pairs dropped since restricted to the working set\n", l_curr-l);
+  l_curr=l;
+
+  if(NULL==_it_prev)     _it_prev     = new hiopIterate(nlp);
+  if(NULL==_grad_f_prev) _grad_f_prev = dynamic_cast<hiopVectorPar*>(nlp->alloc_primal_vec());
+  if(NULL==_Jac_c_prev)  _Jac_c_prev  = nlp->alloc_Jac_c();
+  if(NULL==_Jac_d_prev)  _Jac_d_prev  = nlp->alloc_Jac_d();
+  _it_prev->copySelectedFrom(*src._it_prev, idx);
+  _grad_f_prev->copyFromSelected(*src._grad_f_prev, idx);
+  selectJacCols(*src._Jac_c_prev, *_Jac_c_prev, idx);
+  selectJacCols(*src._Jac_d_prev, *_Jac_d_prev, idx);
+  matrixChanged=true;
+}
 
 bool hiopHessianLowRank::updateLogBarrierDiagonal(const hiopVector& Dx)
 {
-  DhInv->setToConstant(sigma);
+  DhInv->copyFrom(*B0);
   DhInv->axpy(1.0,Dx);
 #ifdef DEEP_CHECKING
   assert(DhInv->allPositive());
@@ -185,9 +508,10 @@ void hiopHessianLowRank::print(FILE* f, hiopOutVerbosity v, const char* msg) con
 #ifdef DEEP_CHECKING
   nlp->log->write("Dx", *_Dx, v);
 #else
-  fprintf(f, "Dx is not stored in this class, but it can be computed from Dx=DhInv^(1)-sigma");
+  fprintf(f, "Dx is not stored in this class, but it can be computed from Dx=DhInv^(1)-B0");
 #endif
   nlp->log->printf(v, "sigma=%22.16f;\n", sigma);
+  nlp->log->write("B0", *B0, v);
   nlp->log->write("DhInv", *DhInv, v);
   nlp->log->write("S_trans", *St, v);
   nlp->log->write("Y_trans", *Yt, v);
@@ -208,11 +532,12 @@ void hiopHessianLowRank::print(FILE* f, hiopOutVerbosity v, const char* msg) con
 bool hiopHessianLowRank::update(const hiopIterate& it_curr, const hiopVector& grad_f_curr_,
 				const hiopMatrix& Jac_c_curr_, const hiopMatrix& Jac_d_curr_)
 {
+  hiopTimeScope scope(nlp->runStats.profile, tpHessUpdate);
   nlp->runStats.tmSolverInternal.start();
 
   const hiopVectorPar&   grad_f_curr= dynamic_cast<const hiopVectorPar&>(grad_f_curr_);
-  const hiopMatrixDense& Jac_c_curr = dynamic_cast<const hiopMatrixDense&>(Jac_c_curr_);
-  const hiopMatrixDense& Jac_d_curr = dynamic_cast<const hiopMatrixDense&>(Jac_d_curr_);
+  const hiopMatrix& Jac_c_curr = Jac_c_curr_;
+  const hiopMatrix& Jac_d_curr = Jac_d_curr_;
 
 #ifdef DEEP_CHECKING
   assert(it_curr.zl->matchesPattern(nlp->get_ixl()));
@@ -230,9 +555,14 @@ bool hiopHessianLowRank::update(const hiopIterate& it_curr, const hiopVector& gr
 
       //compute y_new = \grad J(x_curr,\lambda_curr) - \grad J(x_prev, \lambda_curr) (yes, J(x_prev, \lambda_curr))
       //              = graf_f_curr-grad_f_prev + (Jac_c_curr-Jac_c_prev)yc_curr+ (Jac_d_curr-Jac_c_prev)yd_curr - zl_curr*s_new + zu_curr*s_new
+      //(the objective's part is not included in the structured mode)
       hiopVectorPar& y_new = new_n_vec2(n);
-      y_new.copyFrom(grad_f_curr); 
-      y_new.axpy(-1., *_grad_f_prev);
+      if(cons_only) {
+	y_new.setToZero();
+      } else {
+	y_new.copyFrom(grad_f_curr); 
+	y_new.axpy(-1., *_grad_f_prev);
+      }
       Jac_c_curr.transTimesVec  (1.0, y_new, 1.0, *it_curr.yc);
       _Jac_c_prev->transTimesVec(1.0, y_new,-1.0, *it_curr.yc); //!opt if nlp->Jac_c_isLinear no need for the multiplications
       Jac_d_curr.transTimesVec  (1.0, y_new, 1.0, *it_curr.yd); //!opt same here
@@ -247,7 +577,24 @@ bool hiopHessianLowRank::update(const hiopIterate& it_curr, const hiopVector& gr
       nlp->log->write("hiopHessianLowRank s_new",s_new, hovIteration);
       nlp->log->write("hiopHessianLowRank y_new",y_new, hovIteration);
 #endif
-      if(sTy>s_nrm2*y_nrm2*std::numeric_limits<double>::epsilon()) { //sTy far away from zero
+      const bool posCurv = sTy>s_nrm2*y_nrm2*std::numeric_limits<double>::epsilon(); //sTy far away from zero
+      double sTr=0., r_nrm2=0.;
+      if(sr1) {
+	//r = y_new - B*s_new, with B the current SR1 approximation B0+W*M^{-1}*W'
+	hiopVectorPar& r = *_n_vec3;
+	r.copyFrom(y_new); r.axzpy(-1.0, s_new, *B0);
+	if(l_curr>0 && factorizeSR1Middle()) {
+	  hiopVectorPar& Wts = new_l_vec1(l_curr);
+	  _Wt->timesVec(0.0, Wts, 1.0, s_new);
+	  int N=l_curr, lda=N, one=1, info; char uplo='L';
+	  DSYTRS(&uplo, &N, &one, _Mfact->local_buffer(), &lda, _M_ipiv_vec, Wts.local_data(), &N, &info);
+	  assert(info==0);
+	  _Wt->transTimesVec(1.0, r, -1.0, Wts);
+	}
+	sTr = s_new.dotProductWith(r); r_nrm2 = r.twonorm();
+      }
+      //BFGS needs s^T*y>0; SR1 needs s^T*(y-B*s) away from zero
+      if(sr1 ? fabs(sTr)>1e-8*s_nrm2*r_nrm2 : posCurv) {
 	//compute the new row in L, update S and Y (either augment them or shift cols and add s_new and y_new)
 	hiopVectorPar& YTs = new_l_vec1(l_curr);
 	Yt->timesVec(0.0, YTs, 1.0, s_new);
@@ -269,41 +616,59 @@ bool hiopHessianLowRank::update(const hiopIterate& it_curr, const hiopVector& gr
 	  updateD(sTy);
 	  l_curr=l_max;
 	}
+	matrixChanged=true;
 #ifdef DEEP_CHECKING
 	nlp->log->printf(hovMatrices, "\nhiopHessianLowRank: these are L and D from the BFGS compact representation\n");
 	nlp->log->write("L", *L, hovMatrices);
 	nlp->log->write("D", *D, hovMatrices);
 	nlp->log->printf(hovMatrices, "\n");
 #endif
-	//update B0 (i.e., sigma)
-	switch (sigma_update_strategy ) {
-	case SIGMA_STRATEGY1:
-	  sigma=sTy/(s_nrm2*s_nrm2);
-	  break;
-	case SIGMA_STRATEGY2:
-	  sigma=y_nrm2*y_nrm2/sTy;
-	  break;
-	case SIGMA_STRATEGY3:
-	  sigma=sqrt(s_nrm2*s_nrm2 / y_nrm2 / y_nrm2);
-	  break;
-	case SIGMA_STRATEGY4:
-	  sigma=0.5*(sTy/(s_nrm2*s_nrm2)+y_nrm2*y_nrm2/sTy);
-	  break;
-	case SIGMA_CONSTANT:
-	  sigma=sigma0;
-	  break;
-	default:
-	  assert(false && "Option value for sigma_update_strategy was not recognized.");
-	  break;
-	} // else of the switch
-	//safe guard it
-	sigma=fmax(fmin(sigma_safe_max, sigma), sigma_safe_min);
-	nlp->log->printf(hovLinAlgScalars, "hiopHessianLowRank: sigma was updated to %22.16e\n", sigma);
+	//update B0 (i.e., sigma); with SR1 only along directions of positive curvature
+	if(posCurv) {
+	  switch (sigma_update_strategy ) {
+	  case SIGMA_STRATEGY1:
+	    sigma=sTy/(s_nrm2*s_nrm2);
+	    break;
+	  case SIGMA_STRATEGY2:
+	    sigma=y_nrm2*y_nrm2/sTy;
+	    break;
+	  case SIGMA_STRATEGY3:
+	    sigma=sqrt(s_nrm2*s_nrm2 / y_nrm2 / y_nrm2);
+	    break;
+	  case SIGMA_STRATEGY4:
+	    sigma=0.5*(sTy/(s_nrm2*s_nrm2)+y_nrm2*y_nrm2/sTy);
+	    break;
+	  case SIGMA_CONSTANT:
+	    sigma=sigma0;
+	    break;
+	  default:
+	    assert(false && "Option value for sigma_update_strategy was not recognized.");
+	    break;
+	  } // else of the switch
+	  //safe guard it
+	  sigma=fmax(fmin(sigma_safe_max, sigma), sigma_safe_min);
+	  nlp->log->printf(hovLinAlgScalars, "hiopHessianLowRank: sigma was updated to %22.16e\n", sigma);
+	}
+	_n_skipped_updates=0;
+	nlp->runStats.nHessUpdates++;
+	if(sr1 && !posCurv) nlp->runStats.nHessUpdatesNegCurv++;
+      } else if(sr1) { //s^T*(y-B*s) is too small -> skip
+	 nlp->log->printf(hovLinAlgScalars, "hiopHessianLowRank: s^T*(y-B*s)=%12.6e too small... skipping the SR1 update\n", sTr);
+	 _n_skipped_updates++;
+	 nlp->runStats.nHessSkips++;
       } else { //sTy is too small or negative -> skip
 	 nlp->log->printf(hovLinAlgScalars, "hiopHessianLowRank: s^T*y=%12.6e not positive enough... skipping the Hessian update\n", sTy);
+	 _n_skipped_updates++;
+	 nlp->runStats.nHessSkips++;
+      }
+      //constraints' part only: no positive curvature along s_new means B0 is likely too large
+      if(cons_only && !posCurv) {
+	sigma=fmax(0.1*sigma, sigma_safe_min);
+	nlp->log->printf(hovLinAlgScalars, "hiopHessianLowRank: sigma was decreased to %22.16e\n", sigma);
       }
     } else {// norm of s_new is too small -> skip
       nlp->log->printf(hovLinAlgScalars, "hiopHessianLowRank: ||s_new||=%12.6e too small... skipping the Hessian update\n", s_infnorm);
+      nlp->runStats.nHessSkips++;
     }
 
     //save this stuff for next update
@@ -324,9 +689,32 @@ bool hiopHessianLowRank::update(const hiopIterate& it_curr, const hiopVector& gr
   }
 
   nlp->runStats.tmSolverInternal.stop();
+  //B0 at the current iterate (it is used starting with the next factorization)
+  updateB0(*it_curr.x);
   return true;
 }
 
+void hiopHessianLowRank::updateB0(const hiopVector& x)
+{
+  _Q_valid=false;
+  //in the structured mode the user's diagonal is the objective's; it is used by the KKT for preconditioning
+  if(B0_user && !cons_only) {
+    if(nlp->eval_Hess_diag(dynamic_cast<const hiopVectorPar&>(x).local_data_const(), true, B0->local_data())) {
+      //no curvature information for the entries that are not positive; sigma*I is used for them
+      nlp->runStats.nEvalHessDiag++;
+      double* b=B0->local_data();
+      for(long long i=0; i<B0->get_local_size(); i++)
+	b[i] = b[i]>0. ? fmax(fmin(sigma_safe_max, b[i]), sigma_safe_min) : sigma;
+      matrixChanged=true;
+      return;
+    }
+    if(l_curr<=0) nlp->log->printf(hovScalars, "Hessian Low Rank: no diagonal Hessian estimate from the user; B0=sigma*I\n");
+    B0_user=false;
+  }
+  B0->setToConstant(sigma);
+  matrixChanged=true;
+}
+
 /* 
  * The dirty work to bring this^{-1} to the form
  * M = DhInv - DhInv*[B0*S Y] * V^{-1} * [ S^T*B0 ] *DhInv
@@ -360,7 +748,7 @@ void hiopHessianLowRank::updateInternalBFGSRepresentation()
   //-- block (1,2)
   hiopMatrixDense& StB0DhInvYmL = DpYtDhInvY; //just a rename
   hiopVectorPar& B0DhInv = new_n_vec1(n);
-  B0DhInv.copyFrom(*DhInv); B0DhInv.scale(sigma);
+  B0DhInv.copyFrom(*DhInv); B0DhInv.componentMult(*B0);
   matTimesDiagTimesMatTrans_local(StB0DhInvYmL, *St, B0DhInv, *Yt);
 #ifdef WITH_MPI
   memcpy(_buff1_lxlx3+l*l, StB0DhInvYmL.local_buffer(), buffsize);
@@ -374,7 +762,7 @@ void hiopHessianLowRank::updateInternalBFGSRepresentation()
   //-- block (2,2)
   hiopVectorPar& theDiag = B0DhInv; //just a rename, also reuses values
   theDiag.addConstant(-1.0); //at this point theDiag=DhInv*B0-I
-  theDiag.scale(sigma);
+  theDiag.componentMult(*B0);
   hiopMatrixDense& StDS = DpYtDhInvY; //a rename
   symmMatTimesDiagTimesMatTrans_local(0.0, StDS, 1.0, *St, theDiag);
 #ifdef WITH_MPI
@@ -402,11 +790,9 @@ void hiopHessianLowRank::updateInternalBFGSRepresentation()
   StDS.copyFrom(_buff2_lxlx3+2*l*l);
   V->copyBlockFromMatrix(0,0,StDS);
 #endif
-#ifdef DEEP_CHECKING
   delete _Vmat;
   _Vmat = V->new_copy();
   _Vmat->overwriteLowerTriangleWithUpper();
-#endif
 
   //finally, factorize V
   factorizeV();
@@ -414,6 +800,35 @@ void hiopHessianLowRank::updateInternalBFGSRepresentation()
   matrixChanged=false;
 }
 
+/* Pt=[St*B0*DhInv; Yt*DhInv] and Vm=V (symmetric) for BFGS; Pt=Wt*DhInv and Vm=M+Wt*DhInv*Wt' for SR1 */
+void hiopHessianLowRank::lowRankInverse(hiopMatrixDense*& Pt, hiopMatrixDense*& Vm)
+{
+  if(matrixChanged) {
+    if(sr1) updateInternalSR1Representation();
+    else    updateInternalBFGSRepresentation();
+  }
+  const int l=St->m(), q= sr1 ? l : 2*l;
+  if(NULL==_Pt || _Pt->m()!=q) { if(_Pt) delete _Pt; _Pt=nlp->alloc_multivector_primal(q); }
+  const long long n_local=St->get_local_size_n();
+  const double *dh=DhInv->local_data_const(), *b=B0->local_data_const();
+  double** P=_Pt->local_data();
+  if(sr1 && l>0) {
+    double** Wd=_Wt->local_data();
+    for(int i=0; i<l; i++)
+      for(long long p=0; p<n_local; p++) P[i][p] = Wd[i][p]*dh[p];
+  } else if(!sr1) {
+    double **Sd=St->local_data(), **Yd=Yt->local_data();
+    for(int i=0; i<l; i++)
+      for(long long p=0; p<n_local; p++) { 
+	P[i][p]   = Sd[i][p]*b[p]*dh[p]; 
+	P[l+i][p] = Yd[i][p]*dh[p]; 
+      }
+  }
+  if(0==q && _Vmat->m()!=0) { delete _Vmat; _Vmat=new hiopMatrixDense(0,0); }
+  assert(_Vmat->m()==q);
+  Pt=_Pt; Vm=_Vmat;
+}
+
 /* Solves this*x = res as x = this^{-1}*res
  * where 'this^{-1}' is
  * M = DhInv - DhInv*[B0*S Y] * V^{-1} * [ S^T*B0 ] *DhInv
@@ -424,10 +839,12 @@ void hiopHessianLowRank::updateInternalBFGSRepresentation()
  */  
 void hiopHessianLowRank::solve(const hiopVector& rhs_, hiopVector& x_)
 {
-  if(matrixChanged) updateInternalBFGSRepresentation();
-
   hiopVectorPar& x = dynamic_cast<hiopVectorPar&>(x_);
   const hiopVectorPar& rhsx = dynamic_cast<const hiopVectorPar&>(rhs_);
+  if(sr1) { solveSR1(rhsx, x); return; }
+
+  if(matrixChanged) updateInternalBFGSRepresentation();
+
   long long n=St->n(), l=St->m();
 #ifdef DEEP_CHECKING
   assert(rhsx.get_size()==n);
@@ -445,7 +862,7 @@ void hiopHessianLowRank::solve(const hiopVector& rhs_, hiopVector& x_)
 
   hiopVectorPar& B0DhInvx = new_n_vec1(n);
   B0DhInvx.copyFrom(x); //it contains DhInv*res
-  B0DhInvx.scale(sigma); //B0*(DhInv*res) 
+  B0DhInvx.componentMult(*B0); //B0*(DhInv*res) 
   St->timesVec(0.0,stx,1.0,B0DhInvx);
 
   //3. solve with V
@@ -456,7 +873,7 @@ void hiopHessianLowRank::solve(const hiopVector& rhs_, hiopVector& x_)
   // result = DhInv*(B0*S*spart + Y*ypart)
   hiopVectorPar&  result = new_n_vec1(n);
   St->transTimesVec(0.0, result, 1.0, spart);
-  result.scale(sigma);
+  result.componentMult(*B0);
   Yt->transTimesVec(1.0, result, 1.0, ypart);
   result.componentMult(*DhInv);
 
@@ -475,6 +892,7 @@ void hiopHessianLowRank::
 symMatTimesInverseTimesMatTrans(double beta, hiopMatrixDense& W, 
 				double alpha, const hiopMatrixDense& X)
 {
+  if(sr1) { symMatTimesInverseTimesMatTransSR1(beta, W, alpha, X); return; }
   if(matrixChanged) updateInternalBFGSRepresentation();
 
   long long n=St->n(), l=St->m();
@@ -499,7 +917,7 @@ symMatTimesInverseTimesMatTrans(double beta, hiopMatrixDense& W,
   //2. compute S1=X*DhInv*B0*S and Y1=X*DhInv*Y
   hiopMatrixDense &S1=new_S1(X,*St), &Y1=new_Y1(X,*Yt); //both are kxl
   hiopVectorPar& B0DhInv = new_n_vec1(n);
-  B0DhInv.copyFrom(*DhInv); B0DhInv.scale(sigma);
+  B0DhInv.copyFrom(*DhInv); B0DhInv.componentMult(*B0);
   matTimesDiagTimesMatTrans_local(S1, X, B0DhInv, *St);
   matTimesDiagTimesMatTrans_local(Y1, X, *DhInv,  *Yt);
 
@@ -552,10 +970,397 @@ symMatTimesInverseTimesMatTrans(double beta, hiopMatrixDense& W,
 }
 
 
-void hiopHessianLowRank::factorizeV()
+void hiopHessianLowRank::
+symMatTimesInverseTimesMatTrans(hiopMatrixSymBlockCyclic& W, double alpha, const hiopMatrixDense& X)
+{
+  if(matrixChanged) {
+    if(sr1) updateInternalSR1Representation();
+    else    updateInternalBFGSRepresentation();
+  }
+  const long long n=St->n(), l=St->m(), k=W.m();
+  assert(X.m()==k);
+  assert(X.n()==n);
+
+  //1. W = alpha*X*DhInv*X', reduce-scattered in the layout of W
+  W.zeroContributions();
+  W.addContribSymmTimesDiagTimesMatTrans(alpha, X, DhInv);
+  W.reduceContributions();
+  if(0==l || 0==k) return;
+#ifdef WITH_MPI
+  int ierr;
+#endif
+  if(sr1) {
+    //2. W = W - alpha*(X*DhInv*W)*V^{-1}*(X*DhInv*W)', where W1=X*DhInv*W is kxl and all-reduced
+    hiopMatrixDense& W1 = new_S1(X, *_Wt);
+    matTimesDiagTimesMatTrans_local(W1, X, *DhInv, *_Wt);
+#ifdef WITH_MPI
+    ierr = MPI_Allreduce(W1.local_buffer(), _buff_2lxk, l*k, MPI_DOUBLE, MPI_SUM, nlp->get_comm()); assert(ierr==MPI_SUCCESS);
+    W1.copyFrom(_buff_2lxk);
+#endif
+    hiopMatrixDense& W2 = new_kxl_mat1(k,l);
+    W2.copyFrom(W1);
+    solveWithV(W2);
+    W.addMatTimesMatTrans(-alpha, W1, W2);
+    return;
+  }
+  //2. S1=X*DhInv*B0*S and Y1=X*DhInv*Y (kxl each) are all-reduced
+  hiopMatrixDense &S1=new_S1(X,*St), &Y1=new_Y1(X,*Yt);
+  hiopVectorPar& B0DhInv = new_n_vec1(n);
+  B0DhInv.copyFrom(*DhInv); B0DhInv.componentMult(*B0);
+  matTimesDiagTimesMatTrans_local(S1, X, B0DhInv, *St);
+  matTimesDiagTimesMatTrans_local(Y1, X, *DhInv,  *Yt);
+
+  hiopMatrixDense& S2Y2 = new_kx2l_mat1(k,l);
+  S2Y2.copyBlockFromMatrix(0,0,S1);
+  S2Y2.copyBlockFromMatrix(0,l,Y1);
+#ifdef WITH_MPI
+  ierr = MPI_Allreduce(S2Y2.local_buffer(), _buff_2lxk, 2*l*k, MPI_DOUBLE, MPI_SUM, nlp->get_comm()); assert(ierr==MPI_SUCCESS);
+  S2Y2.copyFrom(_buff_2lxk);
+  S1.copyFromMatrixBlock(S2Y2, 0,0);
+  Y1.copyFromMatrixBlock(S2Y2, 0,l);
+#endif
+  //3. [S2 Y2]' = V \ [S1 Y1]' and W = W - alpha*(S1*S2'+Y1*Y2') on the local blocks of W
+  solveWithV(S2Y2);
+  hiopMatrixDense& S2=new_kxl_mat1(k,l);
+  S2.copyFromMatrixBlock(S2Y2, 0, 0);
+  W.addMatTimesMatTrans(-alpha, S1, S2);
+  hiopMatrixDense& Y2=S2;
+  Y2.copyFromMatrixBlock(S2Y2, 0, l);
+  W.addMatTimesMatTrans(-alpha, Y1, Y2);
+}
+
+void hiopHessianLowRank::
+symMatTimesInverseTimesMatTrans(hiopNodeComm& node, hiopMatrixDense& W, double alpha, const hiopMatrixDense& X)
+{
+  if(matrixChanged) {
+    if(sr1) updateInternalSR1Representation();
+    else    updateInternalBFGSRepresentation();
+  }
+  const long long n=St->n(), l=St->m(), k=W.m();
+  assert(X.m()==k);
+  assert(X.n()==n);
+
+  //1. W = alpha*X*DhInv*X', reduced in blocks of rows into the node-shared W
+  node.matTimesDiagTimesMatTrans(W, alpha, X, DhInv, X);
+  if(0==l || 0==k) return;
+#ifdef WITH_MPI
+  int ierr;
+#endif
+  //2. the kxl products are small and are all-reduced as in the replicated case; all the ranks solve with V
+  //   and the leader of the node updates W
+  if(sr1) {
+    hiopMatrixDense& W1 = new_S1(X, *_Wt);
+    matTimesDiagTimesMatTrans_local(W1, X, *DhInv, *_Wt);
+#ifdef WITH_MPI
+    ierr = MPI_Allreduce(W1.local_buffer(), _buff_2lxk, l*k, MPI_DOUBLE, MPI_SUM, nlp->get_comm()); assert(ierr==MPI_SUCCESS);
+    W1.copyFrom(_buff_2lxk);
+#endif
+    hiopMatrixDense& W2 = new_kxl_mat1(k,l);
+    W2.copyFrom(W1);
+    solveWithV(W2);
+    if(node.is_leader()) W1.timesMatTrans_local(1.0, W, -alpha, W2);
+    node.sync();
+    return;
+  }
+  hiopMatrixDense &S1=new_S1(X,*St), &Y1=new_Y1(X,*Yt);
+  hiopVectorPar& B0DhInv = new_n_vec1(n);
+  B0DhInv.copyFrom(*DhInv); B0DhInv.componentMult(*B0);
+  matTimesDiagTimesMatTrans_local(S1, X, B0DhInv, *St);
+  matTimesDiagTimesMatTrans_local(Y1, X, *DhInv,  *Yt);
+
+  hiopMatrixDense& S2Y2 = new_kx2l_mat1(k,l);
+  S2Y2.copyBlockFromMatrix(0,0,S1);
+  S2Y2.copyBlockFromMatrix(0,l,Y1);
+#ifdef WITH_MPI
+  ierr = MPI_Allreduce(S2Y2.local_buffer(), _buff_2lxk, 2*l*k, MPI_DOUBLE, MPI_SUM, nlp->get_comm()); assert(ierr==MPI_SUCCESS);
+  S2Y2.copyFrom(_buff_2lxk);
+  S1.copyFromMatrixBlock(S2Y2, 0,0);
+  Y1.copyFromMatrixBlock(S2Y2, 0,l);
+#endif
+  solveWithV(S2Y2);
+  if(node.is_leader()) {
+    hiopMatrixDense& S2=new_kxl_mat1(k,l);
+    S2.copyFromMatrixBlock(S2Y2, 0, 0);
+    S1.timesMatTrans_local(1.0, W, -alpha, S2);
+    hiopMatrixDense& Y2=S2;
+    Y2.copyFromMatrixBlock(S2Y2, 0, l);
+    Y1.timesMatTrans_local(1.0, W, -alpha, Y2);
+  }
+  node.sync();
+}
+
+/* Forms Wt=Yt-St*B0 and M=D+L+L'-St*B0*St' of the SR1 compact representation. M is left in 
+ * _lxl_mat1 and its factors are in _Mfact. Returns false if M is (numerically) singular.
+ */
+bool hiopHessianLowRank::factorizeSR1Middle()
+{
+  const int l=St->m();
+  _M_nneg=0;
+  if(0==l) return true;
+
+  if(NULL==_Wt || _Wt->m()!=l) { if(_Wt) delete _Wt; _Wt=Yt->new_copy(); }
+  else _Wt->copyFrom(*Yt);
+  const long long n_local=St->get_local_size_n();
+  const double* b=B0->local_data_const();
+  double **Wd=_Wt->local_data(), **Sd=St->local_data();
+  for(int i=0; i<l; i++)
+    for(long long p=0; p<n_local; p++) Wd[i][p] -= Sd[i][p]*b[p];
+
+  hiopMatrixDense& M = new_lxl_mat1(l);
+  symmMatTimesDiagTimesMatTrans_local(0.0, M, 1.0, *St, *B0);
+#ifdef WITH_MPI
+  int ierr = MPI_Allreduce(M.local_buffer(), _buff1_lxlx3, l*l, MPI_DOUBLE, MPI_SUM, nlp->get_comm()); assert(ierr==MPI_SUCCESS);
+  M.copyFrom(_buff1_lxlx3);
+#endif
+  //M = D + L + L' - S'*B0*S
+  double **Md=M.local_data(), **Ld=L->local_data(); const double* Dd=D->local_data_const();
+  for(int i=0; i<l; i++)
+    for(int j=0; j<l; j++)
+      Md[i][j] = (i==j ? Dd[i] : (i>j ? Ld[i][j] : Ld[j][i])) - Md[i][j];
+
+  if(NULL==_Mfact || _Mfact->m()!=l) { if(_Mfact) delete _Mfact; _Mfact=new hiopMatrixDense(l,l); }
+  _Mfact->copyFrom(M);
+
+  char uplo='L'; int N=l, lda=l, lwork=-1, info; double work_tmp;
+  DSYTRF(&uplo, &N, _Mfact->local_buffer(), &lda, _M_ipiv_vec, &work_tmp, &lwork, &info);
+  lwork=(int)work_tmp;
+  vector<double> work(lwork>0 ? lwork : 1);
+  DSYTRF(&uplo, &N, _Mfact->local_buffer(), &lda, _M_ipiv_vec, &work[0], &lwork, &info);
+  if(info!=0) return false;
+  _M_nneg = negEigenvaluesFromFactors(*_Mfact, _M_ipiv_vec);
+  return _M_nneg>=0;
+}
+
+/* Computes and factorizes V = M + W'*DhInv*W. Dx+B is positive definite if and only if V and M have 
+ * the same inertia. When this is not the case, a multiple delta of the identity is added to Dx+B, 
+ * similarly to the inertia correction of Newton-based interior-point methods, which amounts to 
+ * DhInv=(Dx+sigma+delta)^{-1}. The oldest pairs are dropped when M is singular or delta is too large.
+ */
+void hiopHessianLowRank::updateInternalSR1Representation()
+{
+  const double delta_min=1e-4, delta_max=1e+20;
+  double delta=0.;
+  while(true) {
+    const int l=St->m();
+    if(V->m()!=l) { delete V; V=new hiopMatrixDense(l,l); }
+    if(0==l) break;
+
+    bool dropPair = !factorizeSR1Middle();
+    if(!dropPair) {
+      V->copyFrom(new_lxl_mat1(l)); //M
+#ifdef WITH_MPI
+      symmMatTimesDiagTimesMatTrans_local(0==nlp->get_rank() ? 1.0 : 0.0, *V, 1.0, *_Wt, *DhInv);
+      int ierr = MPI_Allreduce(V->local_buffer(), _buff1_lxlx3, l*l, MPI_DOUBLE, MPI_SUM, nlp->get_comm()); assert(ierr==MPI_SUCCESS);
+      V->copyFrom(_buff1_lxlx3);
+#else
+      symmMatTimesDiagTimesMatTrans_local(1.0, *V, 1.0, *_Wt, *DhInv);
+#endif
+      delete _Vmat;
+      _Vmat = V->new_copy();
+      if(0==factorizeV() && negEigenvaluesFromFactors(*V, _V_ipiv_vec)==_M_nneg) break;
+
+      //increase delta: start from a fraction of the last correction, then grow geometrically
+      double delta_new;
+      if(0.==delta) delta_new = _sr1_delta_last>0. ? fmax(delta_min, _sr1_delta_last/3.) : delta_min;
+      else          delta_new = delta * (_sr1_delta_last>0. ? 8. : 100.);
+      if(delta_new<=delta_max) {
+	DhInv->invert(); DhInv->addConstant(delta_new-delta); DhInv->invert();
+	delta = delta_new;
+	continue;
+      }
+      dropPair=true;
+    }
+    nlp->log->printf(hovLinAlgScalars, "hiopHessianLowRank: dropping the oldest SR1 pair to keep the Hessian positive definite\n");
+    if(delta>0.) { DhInv->invert(); DhInv->addConstant(-delta); DhInv->invert(); delta=0.; }
+    dropOldestPairs(1, l_max);
+  }
+  if(delta>0.) {
+    nlp->log->printf(hovLinAlgScalars, "hiopHessianLowRank: SR1 inertia correction delta=%12.6e\n", delta);
+    nlp->runStats.nSR1InertiaCorr++;
+  }
+  _sr1_delta_last=delta;
+  matrixChanged=false;
+}
+
+/* x = DhInv*rhs - DhInv*W*V^{-1}*W'*DhInv*rhs */
+void hiopHessianLowRank::solveSR1(const hiopVectorPar& rhs, hiopVectorPar& x)
+{
+  if(matrixChanged) updateInternalSR1Representation();
+  const int l=St->m();
+
+  x.copyFrom(rhs);
+  x.componentMult(*DhInv);
+  if(0==l) return;
+
+  hiopVectorPar& wtx = new_l_vec1(l);
+  _Wt->timesVec(0.0, wtx, 1.0, x);
+
+  char uplo='L'; int N=l, lda=l, one=1, info;
+  DSYTRS(&uplo, &N, &one, V->local_buffer(), &lda, _V_ipiv_vec, wtx.local_data(), &N, &info);
+  if(info<0) nlp->log->printf(hovError, "hiopHessianLowRank::solveSR1 error: %d argument to dsytrs has an illegal value\n", -info);
+  assert(info==0);
+
+  hiopVectorPar& result = new_n_vec1(St->n());
+  _Wt->transTimesVec(0.0, result, 1.0, wtx);
+  result.componentMult(*DhInv);
+  x.axpy(-1.0, result);
+}
+
+/* W = beta*W + alpha*X*DhInv*X' - alpha*(X*DhInv*W)*V^{-1}*(X*DhInv*W)' */
+void hiopHessianLowRank::
+symMatTimesInverseTimesMatTransSR1(double beta, hiopMatrixDense& W, double alpha, const hiopMatrixDense& X)
+{
+  if(matrixChanged) updateInternalSR1Representation();
+  const long long l=St->m(), k=W.m();
+  assert(X.m()==k);
+  assert(X.n()==St->n());
+
+#ifdef WITH_MPI
+  symmMatTimesDiagTimesMatTrans_local(0==nlp->get_rank() ? beta : 0.0, W, alpha, X, *DhInv);
+  int ierr = MPI_Allreduce(W.local_buffer(), _buff_kxk, k*k, MPI_DOUBLE, MPI_SUM, nlp->get_comm()); assert(ierr==MPI_SUCCESS);
+  W.copyFrom(_buff_kxk);
+#else
+  symmMatTimesDiagTimesMatTrans_local(beta, W, alpha, X, *DhInv);
+#endif
+  if(0==l || 0==k) return;
+
+  //W1 = X*DhInv*W is kxl
+  hiopMatrixDense& W1 = new_S1(X, *_Wt);
+  matTimesDiagTimesMatTrans_local(W1, X, *DhInv, *_Wt);
+#ifdef WITH_MPI
+  ierr = MPI_Allreduce(W1.local_buffer(), _buff_2lxk, l*k, MPI_DOUBLE, MPI_SUM, nlp->get_comm()); assert(ierr==MPI_SUCCESS);
+  W1.copyFrom(_buff_2lxk);
+#endif
+  //W2 = V \ W1' (W1 is W1' when Fortran Lapack looks at it)
+  hiopMatrixDense& W2 = new_kxl_mat1(k,l);
+  W2.copyFrom(W1);
+  solveWithV(W2);
+
+  W1.timesMatTrans_local(1.0, W, -alpha, W2);
+}
+
+/* Factorizes the middle matrix of the compact representation of Bk, namely [St*B0*St' L; L' -D] 
+ * for BFGS and M=D+L+L'-St*B0*St' for SR1. Returns false if the matrix is singular.
+ */
+bool hiopHessianLowRank::factorizeSecantMiddle()
 {
+  hiopTimeScope scope(nlp->runStats.profile, tpHessFactorV);
+  if(sr1) return factorizeSR1Middle();
+  const int l=St->m();
+  if(0==l) return true;
+  assert(L->m()==l && D->get_size()==l);
+
+  if(NULL==_Qfact || _Qfact->m()!=2*l) { 
+    if(_Qfact) delete _Qfact; 
+    if(_Q_ipiv_vec) delete[] _Q_ipiv_vec;
+    _Qfact=new hiopMatrixDense(2*l,2*l);
+    _Q_ipiv_vec=new int[2*l];
+  }
+  hiopMatrixDense& StB0S = new_lxl_mat1(l);
+  symmMatTimesDiagTimesMatTrans_local(0.0, StB0S, 1.0, *St, *B0);
+#ifdef WITH_MPI
+  int ierr = MPI_Allreduce(StB0S.local_buffer(), _buff1_lxlx3, l*l, MPI_DOUBLE, MPI_SUM, nlp->get_comm()); assert(ierr==MPI_SUCCESS);
+  StB0S.copyFrom(_buff1_lxlx3);
+#endif
+  double **Q=_Qfact->local_data(), **Sd=StB0S.local_data(), **Ld=L->local_data(); const double* Dd=D->local_data_const();
+  for(int i=0; i<l; i++)
+    for(int j=0; j<l; j++) {
+      Q[i][j] = Sd[i][j];
+      Q[i][l+j] = Q[l+j][i] = (i>j ? Ld[i][j] : 0.);
+      Q[l+i][l+j] = (i==j ? -Dd[i] : 0.);
+    }
+
+  char uplo='L'; int N=2*l, lda=N, lwork=-1, info; double work_tmp;
+  DSYTRF(&uplo, &N, _Qfact->local_buffer(), &lda, _Q_ipiv_vec, &work_tmp, &lwork, &info);
+  lwork=(int)work_tmp;
+  vector<double> work(lwork>0 ? lwork : 1);
+  DSYTRF(&uplo, &N, _Qfact->local_buffer(), &lda, _Q_ipiv_vec, &work[0], &lwork, &info);
+  return 0==info;
+}
+
+/* y = beta*y + alpha*Bk*x, where 
+ *   Bk = B0 - [B0*S Y]*[S'*B0*S L; L' -D]^{-1}*[S'*B0; Y'] (BFGS)  or  Bk = B0 + W*M^{-1}*W' (SR1)
+ */
+void hiopHessianLowRank::timesVecSecant(double beta, hiopVector& y_, double alpha, const hiopVector& x_)
+{
+  hiopVectorPar& y = dynamic_cast<hiopVectorPar&>(y_);
+  const hiopVectorPar& x = dynamic_cast<const hiopVectorPar&>(x_);
+  const int l=St->m();
+
+  hiopVectorPar& B0x = new_n_vec2(St->n());
+  B0x.copyFrom(x); B0x.componentMult(*B0);
+  if(0.==beta) y.setToZero(); else y.scale(beta);
+  y.axpy(alpha, B0x);
+  if(0==l) return;
+
+  if(!_Q_valid) {
+    _Q_valid = factorizeSecantMiddle();
+    if(!_Q_valid) nlp->log->printf(hovWarning, "hiopHessianLowRank::timesVecSecant: singular middle matrix; only B0 is used\n");
+  }
+  if(!_Q_valid) return;
+
+  char uplo='L'; int N, one=1, info;
+  if(sr1) {
+    hiopVectorPar& wtx = new_l_vec1(l);
+    _Wt->timesVec(0.0, wtx, 1.0, x);
+    N=l; 
+    DSYTRS(&uplo, &N, &one, _Mfact->local_buffer(), &N, _M_ipiv_vec, wtx.local_data(), &N, &info);
+    assert(info==0);
+    _Wt->transTimesVec(1.0, y, alpha, wtx);
+  } else {
+    hiopVectorPar &stb0x=new_l_vec1(l), &ytx=new_l_vec2(l), &u=new_2l_vec1(l);
+    St->timesVec(0.0, stb0x, 1.0, B0x);
+    Yt->timesVec(0.0, ytx, 1.0, x);
+    u.copyFromStarting(stb0x, 0); u.copyFromStarting(ytx, l);
+    N=2*l;
+    DSYTRS(&uplo, &N, &one, _Qfact->local_buffer(), &N, _Q_ipiv_vec, u.local_data(), &N, &info);
+    assert(info==0);
+    u.copyToStarting(stb0x, 0); u.copyToStarting(ytx, l);
+    //y = y - alpha*(B0*S*u_s + Y*u_y)
+    St->transTimesVec(0.0, B0x, 1.0, stb0x);
+    B0x.componentMult(*B0);
+    Yt->transTimesVec(1.0, B0x, 1.0, ytx);
+    y.axpy(-alpha, B0x);
+  }
+}
+
+/* Counts the negative eigenvalues using the block diagonal from dsytrf (Sylvester's law of inertia). 
+ * Returns -1 if the matrix is (numerically) singular.
+ */
+int hiopHessianLowRank::negEigenvaluesFromFactors(const hiopMatrixDense& F, const int* ipiv)
+{
+  const int N=F.m();
+  const double* A=F.local_buffer(); //A(i,j) in Fortran is A[i+j*N]
+  double dmax=0.;
+  for(int k=0; k<N; k++) dmax=fmax(dmax, fabs(A[k+k*N]));
+
+  int nneg=0;
+  for(int k=0; k<N; ) {
+    const double a=A[k+k*N];
+    if(ipiv[k]>0) {
+      if(fabs(a)<=1e-14*dmax) return -1;
+      if(a<0) nneg++;
+      k++;
+    } else {
+      //2x2 pivot block
+      assert(k+1<N);
+      const double b=A[k+1+k*N], c=A[k+1+(k+1)*N];
+      const double det=a*c-b*b;
+      if(0.==det) return -1;
+      if(det<0) nneg++;
+      else if(a<0) nneg+=2;
+      k+=2;
+    }
+  }
+  return nneg;
+}
+
+
+int hiopHessianLowRank::factorizeV()
+{
+  hiopTimeScope scope(nlp->runStats.profile, tpHessFactorV);
   int N=V->n(), lda=N, info;
-  if(N==0) return;
+  if(N==0) return 0;
 
 #ifdef DEEP_CHECKING
     nlp->log->write("factorizeV:  V is ", *V, hovMatrices);
@@ -581,13 +1386,13 @@ void hiopHessianLowRank::factorizeV()
   
   if(info<0)
     nlp->log->printf(hovError, "hiopHessianLowRank::factorizeV error: %d argument to dsytrf has an illegal value\n", -info);
-  else if(info>0)
+  else if(info>0 && !sr1) //with SR1 a singular V only causes pairs to be dropped
     nlp->log->printf(hovError, "hiopHessianLowRank::factorizeV error: %d entry in the factorization's diagonal is exactly zero. Division by zero will occur if it a solve is attempted.\n", info);
-  assert(info==0);
+  assert(info==0 || (sr1 && info>0));
 #ifdef DEEP_CHECKING
   nlp->log->write("factorizeV:  factors of V: ", *V, hovMatrices);
 #endif
-
+  return info;
 }
 
 void hiopHessianLowRank::solveWithV(hiopVectorPar& rhs_s, hiopVectorPar& rhs_y)
@@ -865,8 +1670,24 @@ void hiopHessianLowRank::timesVecCmn(double beta, hiopVector& y, double alpha, c
   long long n=St->n();
   assert(l_curr==St->m());
   assert(y.get_size()==n);
+  if(sr1) {
+    //compact representation B = B0 + W*M^{-1}*W'
+    y.scale(beta);
+    if(addLogTerm) y.axzpy(alpha,x,*_Dx);
+    y.axzpy(alpha, x, *B0);
+    y.axpy(alpha*_sr1_delta_last, x);
+    if(l_curr>0 && factorizeSR1Middle()) {
+      hiopVectorPar& wtx = new_l_vec1(l_curr);
+      _Wt->timesVec(0.0, wtx, 1.0, x);
+      char uplo='L'; int N=l_curr, lda=N, one=1, info;
+      DSYTRS(&uplo, &N, &one, _Mfact->local_buffer(), &lda, _M_ipiv_vec, wtx.local_data(), &N, &info);
+      assert(info==0);
+      _Wt->transTimesVec(1.0, y, alpha, wtx);
+    }
+    return;
+  }
   //we have B+=B-B*s*B*s'/(s'*B*s)+yy'/(y'*s)
-  //B0 is sigma*I. There is an additional diagonal log-barrier term _Dx
+  //B0 is diagonal. There is an additional diagonal log-barrier term _Dx
 
   bool print=true;
   if(print) {
@@ -900,7 +1721,7 @@ void hiopHessianLowRank::timesVecCmn(double beta, hiopVector& y, double alpha, c
 
     //compute ak by an inner loop
     a[k]->copyFrom(*sk);
-    a[k]->scale(sigma);
+    a[k]->componentMult(*B0);
 
     for(int i=0; i<k; i++) {
       double biTsk = b[i]->dotProductWith(*sk);
@@ -919,7 +1740,7 @@ void hiopHessianLowRank::timesVecCmn(double beta, hiopVector& y, double alpha, c
   if(addLogTerm) 
     y.axzpy(alpha,x,*_Dx);
 
-  y.axpy(alpha*sigma, x); 
+  y.axzpy(alpha, x, *B0);
 
   for(int k=0; k<l_curr; k++) {
     double bkTx = b[k]->dotProductWith(x);
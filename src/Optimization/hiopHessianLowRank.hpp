@@ -51,6 +51,7 @@
 
 #include "hiopNlpFormulation.hpp"
 #include "hiopIterate.hpp"
+#include "hiopMatrixSymBlockCyclic.hpp"
 
 #include <cassert>
 
@@ -85,13 +86,26 @@ namespace hiop
  *  - U:=[B0*St' Yt'] and  V is defined above
  *  - 
  *  
+ * B0 is sigma*I or, when the user provides it (eval_Hess_diag), a diagonal estimate of the Hessian 
+ * evaluated at the current iterate; sigma is used for the entries without curvature information.
+ *
  * Parallel computations: Dk, B0 are distributed vectors, M is distributed 
  * column-wise, and N is local (stored on all processors).
+ *
+ * Optionally (option 'secant_update_type' set to 'sr1'), the class holds the limited-memory SR1 
+ * approximation in the compact form Bk = B0 + Wk*Mk^{-1}*Wk' with Wk=Yk-B0*Sk and Mk=D+L+L'-Sk'*B0*Sk
+ * (same reference, Section 5). The inverse is computed as above with Wk instead of U and with the lxl 
+ * matrix V=Mk+Wk'*(Dk+B0)^{-1}*Wk. Since Bk can be indefinite, a multiple of the identity is added to
+ * Dk+Bk until it is positive definite, which is the case when V and Mk have the same inertia.
+ *
+ * In the structured Hessian mode (option 'hessian_mode'), the pairs approximate only the curvature of the 
+ * constraints, i.e., y does not include the difference of the gradients of the objective. The KKT system 
+ * then uses 'timesVecSecant' for the products with Bk and the inverse of Dk+Bk as a preconditioner.
  */
 class hiopHessianLowRank
 {
 public:
-  hiopHessianLowRank(hiopNlpDenseConstraints* nlp_, int max_memory_length);
+  hiopHessianLowRank(hiopNlpFormulation* nlp_, int max_memory_length);
   virtual ~hiopHessianLowRank();
 
   /* return false if the update destroys hereditary positive definitness and the BFGS update is not taken*/
@@ -108,6 +122,51 @@ public:
    */ 
   virtual void symMatTimesInverseTimesMatTrans(double beta, hiopMatrixDense& W_, 
 					       double alpha, const hiopMatrixDense& X);
+  /* W = alpha*X*inverse(this)*X^T with W distributed in a 2D block-cyclic layout; the local contributions
+   * are summed with a reduce-scatter and only the small kxl products are all-reduced */
+  virtual void symMatTimesInverseTimesMatTrans(hiopMatrixSymBlockCyclic& W, 
+					       double alpha, const hiopMatrixDense& X);
+  /* W = alpha*X*inverse(this)*X^T with W in a buffer shared by the ranks of the node (option 
+   * 'node_shared_reduced_mats'); W is complete on all the ranks of the node on return */
+  virtual void symMatTimesInverseTimesMatTrans(hiopNodeComm& node, hiopMatrixDense& W, 
+					       double alpha, const hiopMatrixDense& X);
+
+  /* checkpointing of the secant memory (S, Y, L, D, sigma) and of the previous iterate and derivatives;
+   * the quantities depending on the log-barrier diagonal are recomputed at the next update */
+  virtual void saveToCheckpoint(hiopCheckpointWriter& w) const;
+  virtual bool loadFromCheckpoint(const hiopCheckpointReader& r);
+  /* copies the secant memory and the previous iterate and derivatives of 'src', whose primal quantities 
+   * have a different columns partitioning (load-balancing repartitioning of the variables) */
+  virtual void copyRedistributedFrom(const hiopHessianLowRank& src);
+  /* copies the secant memory and the previous iterate and derivatives of 'src', whose primal quantities are 
+   * in another working set of the variables (see hiopVectorPar::copyFromSelected). The products in L and D are
+   * recomputed for the restricted pairs; with BFGS, the pairs that lose the positive curvature are dropped */
+  virtual void copySelectedFrom(const hiopHessianLowRank& src, const long long* idx);
+
+  /* adaptive length of the secant memory: called once per iteration with whether the last step was a 
+   * full (not backtracked) step and the ratio of the NLP errors at the current and previous iterates.
+   * The length grows after a few slow iterations, goes back towards the initial length after a few fast 
+   * iterations, and shrinks when consecutive updates are skipped because of poor curvature (s^T*y). 
+   * It is kept within [min(2,l_init), l_upper], where l_upper accounts for the user's memory budget. */
+  virtual void adaptMemoryLength(bool fullStep, double errRatio);
+  inline int get_memory_length() const { return l_max; }
+  inline int get_num_pairs() const { return l_curr<0 ? 0 : l_curr; }
+
+  /* y = beta*y + alpha*Bk*x, with Bk the secant approximation (without the log-barrier diagonal Dk) */
+  virtual void timesVecSecant(double beta, hiopVector& y, double alpha, const hiopVector& x);
+  /* whether the pairs approximate only the constraints' part of the Hessian of the Lagrangian */
+  inline void setSecantConstraintsOnly(bool consOnly) { cons_only=consOnly; }
+  inline bool secantConstraintsOnly() const { return cons_only; }
+
+  /* the representation of the inverse as (B0+Dk)^{-1} - Pt^T*inv(Vm)*Pt, with Pt of q rows (q=2l for BFGS and 
+   * q=l for SR1) and Vm symmetric qxq; Pt and Vm are owned by this object. Needed by the KKT solvers that 
+   * eliminate blocks of the constraints (hiopKKTLinSysBlock) */
+  virtual void lowRankInverse(hiopMatrixDense*& Pt, hiopMatrixDense*& Vm);
+  inline const hiopVectorPar& get_DhInv() const { return *DhInv; }
+
+  /* number of negative eigenvalues from the dsytrf factors ('L' in Fortran) of a symmetric NxN matrix; 
+   * -1 if the matrix is (numerically) singular */
+  static int negEigenvaluesFromFactors(const hiopMatrixDense& F, const int* ipiv);
 #ifdef DEEP_CHECKING
   /* computes the product of the Hessian with a vector: y=beta*y+alpha*H*x.
    * The function is supposed to use the underlying ***recursive*** definition of the 
@@ -129,7 +188,18 @@ protected:
   double sigma0; //default scaling factor of identity
   int sigma_update_strategy;
   double sigma_safe_min, sigma_safe_max; //min and max safety thresholds for sigma
-  hiopNlpDenseConstraints* nlp;
+  //the diagonal B0 and whether it comes from the user's Hessian estimate
+  hiopVectorPar* B0;
+  bool B0_user;
+  hiopNlpFormulation* nlp;
+  //true when the SR1 update is used instead of BFGS
+  bool sr1;
+  //true when the objective's curvature is not included in the pairs (structured Hessian mode)
+  bool cons_only;
+  //adaptive memory: bounds for l_max, initial l_max, and counters of slow/fast iterations and skipped updates
+  bool adaptive_mem;
+  int l_lower, l_upper, l_init;
+  int _n_slow_iters, _n_fast_iters, _n_skipped_updates;
 private:
   hiopVectorPar* DhInv; //(B0+Dk)^{-1}
 #ifdef DEEP_CHECKING
@@ -146,10 +216,10 @@ private:
   hiopVectorPar* D;       //diag 
   //these are matrices from the representation of the inverse
   hiopMatrixDense* V;    
-#ifdef DEEP_CHECKING
-  //copy of the matrix - needed to check the residual
-   hiopMatrixDense* _Vmat; 
-#endif
+  //copy of the matrix before the factorization - needed to check the residual and by lowRankInverse
+  hiopMatrixDense* _Vmat; 
+  //holds Pt for lowRankInverse
+  hiopMatrixDense* _Pt;
   void growL(const int& lmem_curr, const int& lmem_max, const hiopVectorPar& YTs);
   void growD(const int& l_curr, const int& l_max, const double& sTy);
   void updateL(const hiopVectorPar& STy, const double& sTy);
@@ -157,10 +227,24 @@ private:
   //also stored are the iterate, gradient obj, and Jacobians at the previous optimization iteration
   hiopIterate *_it_prev;
   hiopVectorPar *_grad_f_prev;
-  hiopMatrixDense *_Jac_c_prev, *_Jac_d_prev;
+  hiopMatrix *_Jac_c_prev, *_Jac_d_prev;
 
   //internal helpers
   void updateInternalBFGSRepresentation();
+  //sets B0 from the user's diagonal Hessian estimate at x, or to sigma*I
+  void updateB0(const hiopVector& x);
+  /* SR1 counterparts of the above and of 'solve' and 'symMatTimesInverseTimesMatTrans' */
+  void updateInternalSR1Representation();
+  void solveSR1(const hiopVectorPar& rhs, hiopVectorPar& x);
+  void symMatTimesInverseTimesMatTransSR1(double beta, hiopMatrixDense& W, double alpha, const hiopMatrixDense& X);
+  /* forms Wt=Yt-sigma*St and factorizes M=D+L+L'-sigma*St*St' in _Mfact; returns false if M is singular */
+  bool factorizeSR1Middle();
+  /* removes the oldest n_drop pairs and sets the capacity of S and Y to l_cap */
+  void dropOldestPairs(int n_drop, int l_cap);
+  /* changes l_max; the oldest pairs are dropped if more than l_new are stored. S, Y, and the buffers 
+   * depending on l_max are reallocated, L and D are trimmed (they grow with growL and growD) */
+  void setMemoryLength(int l_new);
+  void allocLmaxBuffers();
 
   //internals buffers, mostly for MPIAll_reduce
   double* _buff_kxk; // size = num_constraints^2 
@@ -176,7 +260,7 @@ private:
   hiopMatrixDense& new_kxl_mat1 (int k, int l);
   hiopMatrixDense& new_kx2l_mat1(int k, int l);
   
-  hiopVectorPar *_l_vec1, *_l_vec2, *_n_vec1, *_n_vec2, *_2l_vec1;
+  hiopVectorPar *_l_vec1, *_l_vec2, *_n_vec1, *_n_vec2, *_n_vec3, *_2l_vec1;
   hiopVectorPar& new_l_vec1(int l);
   hiopVectorPar& new_l_vec2(int l);
   inline hiopVectorPar& new_n_vec1(long long n)
@@ -213,9 +297,22 @@ private:
   /* members and utilities related to V matrix: factorization and solve */
   hiopVectorPar *_V_work_vec;
   int _V_ipiv_size; int* _V_ipiv_vec;
-  void factorizeV();
+  //returns the info of dsytrf
+  int factorizeV();
   void solveWithV(hiopVectorPar& rhs_s, hiopVectorPar& rhs_y);
   void solveWithV(hiopMatrixDense& rhs);
+  /* SR1: Wt=Y^T-sigma*S^T, factors of M, and the number of negative eigenvalues of M */
+  hiopMatrixDense *_Wt, *_Mfact;
+  int* _M_ipiv_vec;
+  int _M_nneg;
+  //SR1: multiple of the identity added to Dx+B at the last factorization to make it positive definite
+  double _sr1_delta_last;
+  /* factors of the middle matrix of Bk, [St*B0*St' L; L' -D] for BFGS and M for SR1, used by timesVecSecant;
+   * they are recomputed only when the pairs or B0 change */
+  hiopMatrixDense* _Qfact;
+  int* _Q_ipiv_vec;
+  bool _Q_valid;
+  bool factorizeSecantMiddle();
 private:
   hiopHessianLowRank() {};
   hiopHessianLowRank(const hiopHessianLowRank&) {};
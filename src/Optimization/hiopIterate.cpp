@@ -54,7 +54,7 @@
 namespace hiop
 {
 
-hiopIterate::hiopIterate(const hiopNlpDenseConstraints* nlp_)
+hiopIterate::hiopIterate(const hiopNlpFormulation* nlp_)
 {
   nlp = nlp_;
   x = dynamic_cast<hiopVectorPar*>(nlp->alloc_primal_vec());
@@ -120,6 +120,56 @@ void  hiopIterate::copyFrom(const hiopIterate& src)
   vu->copyFrom(*src.vu);
 }
 
+void hiopIterate::copyConsPartsFrom(const hiopIterate& src)
+{
+  d->copyFrom(*src.d);
+
+  yc->copyFrom(*src.yc); 
+  yd->copyFrom(*src.yd);
+
+  sdl->copyFrom(*src.sdl);
+  sdu->copyFrom(*src.sdu);
+  vl->copyFrom(*src.vl);
+  vu->copyFrom(*src.vu);
+}
+
+void hiopIterate::copyRedistributedFrom(const hiopIterate& src)
+{
+  x->copyFromRedistributed(*src.x);
+  sxl->copyFromRedistributed(*src.sxl);
+  sxu->copyFromRedistributed(*src.sxu);
+  zl->copyFromRedistributed(*src.zl);
+  zu->copyFromRedistributed(*src.zu);
+  copyConsPartsFrom(src);
+}
+
+void hiopIterate::copySelectedFrom(const hiopIterate& src, const long long* idx)
+{
+  x->copyFromSelected(*src.x, idx);
+  sxl->copyFromSelected(*src.sxl, idx);
+  sxu->copyFromSelected(*src.sxu, idx);
+  zl->copyFromSelected(*src.zl, idx);
+  zu->copyFromSelected(*src.zu, idx);
+  copyConsPartsFrom(src);
+}
+
+void hiopIterate::saveToCheckpoint(hiopCheckpointWriter& w, const std::string& prefix) const
+{
+  const hiopVectorPar* vecs[] = {x, d, sxl, sxu, sdl, sdu, yc, yd, zl, zu, vl, vu};
+  const char* names[] = {"x", "d", "sxl", "sxu", "sdl", "sdu", "yc", "yd", "zl", "zu", "vl", "vu"};
+  for(int i=0; i<12; i++)
+    w.add(prefix+names[i], vecs[i]->local_data_const(), vecs[i]->get_local_size());
+}
+
+bool hiopIterate::loadFromCheckpoint(const hiopCheckpointReader& r, const std::string& prefix)
+{
+  hiopVectorPar* vecs[] = {x, d, sxl, sxu, sdl, sdu, yc, yd, zl, zu, vl, vu};
+  const char* names[] = {"x", "d", "sxl", "sxu", "sdl", "sdu", "yc", "yd", "zl", "zu", "vl", "vu"};
+  for(int i=0; i<12; i++)
+    if(!r.read(prefix+names[i], vecs[i]->local_data(), vecs[i]->get_local_size())) return false;
+  return true;
+}
+
 void hiopIterate::print(FILE* f, const char* msg/*=NULL*/) const
 {
   if(NULL==msg) fprintf(f, "hiopIterate:\n");
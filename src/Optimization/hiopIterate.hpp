@@ -51,6 +51,7 @@
 
 #include "hiopVector.hpp"
 #include "hiopNlpFormulation.hpp"
+#include "hiopCheckpoint.hpp"
 
 namespace hiop
 {
@@ -58,7 +59,7 @@ namespace hiop
 class hiopIterate
 {
 public:
-  hiopIterate(const hiopNlpDenseConstraints* nlp);
+  hiopIterate(const hiopNlpFormulation* nlp);
   virtual ~hiopIterate();
 
   //virtual void projectPrimalsIntoBounds(double kappa1, double kappa2);
@@ -104,11 +105,24 @@ public:
   hiopIterate* alloc_clone() const;
   hiopIterate* new_copy() const;
   void copyFrom(const hiopIterate& src);
+  /* copies only the parts that do not depend on the working set of variables (d, yc, yd, and the 
+   * slacks and duals of d); 'src' can have a different number of variables */
+  void copyConsPartsFrom(const hiopIterate& src);
+  /* copies 'src', whose primal vectors have a different columns partitioning (load-balancing repartitioning) */
+  void copyRedistributedFrom(const hiopIterate& src);
+  /* copies 'src', whose primal quantities are in another working set of the variables; see 
+   * hiopVectorPar::copyFromSelected */
+  void copySelectedFrom(const hiopIterate& src, const long long* idx);
+
+  /* checkpointing: local slices of the vectors are written/read as sections named 'prefix'+vector name */
+  void saveToCheckpoint(hiopCheckpointWriter& w, const std::string& prefix) const;
+  bool loadFromCheckpoint(const hiopCheckpointReader& r, const std::string& prefix);
 
   /* accessors */
   inline hiopVector* get_x()   const {return x;}
   inline hiopVector* get_d()   const {return d;}
   inline hiopVector* get_sxl() const {return sxl;}
+  inline hiopVector* get_sxu() const {return sxu;}
   inline hiopVector* get_yc()  const {return yc;}
   inline hiopVector* get_yd()  const {return yd;}
   inline hiopVector* get_zl()  const {return zl;}
@@ -119,6 +133,7 @@ public:
   void print(FILE* f, const char* msg=NULL) const;
 
   friend class hiopResidual;
+  friend class hiopKKTLinSys;
   friend class hiopKKTLinSysLowRank;
   friend class hiopHessianLowRank;
   friend class hiopHessianInvLowRank_obsolette;
@@ -136,7 +151,7 @@ private:
   hiopVectorPar*vl,*vu;   //for slack eq. in d, e.g., d-sdl=dl
 private:
   // and associated info from problem formulation
-  const hiopNlpDenseConstraints * nlp;
+  const hiopNlpFormulation * nlp;
 private:
   hiopIterate() {};
   hiopIterate(const hiopIterate&) {};
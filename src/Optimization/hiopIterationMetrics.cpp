@@ -0,0 +1,102 @@
+// Copyright (c) 2017, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory (LLNL).
+// Written by Cosmin G. Petra, petra1@llnl.gov.
+// LLNL-CODE-742473. All rights reserved.
+//
+// This file is part of HiOp. For details, see https://github.com/LLNL/hiop. HiOp 
+// is released under the BSD 3-clause license (https://opensource.org/licenses/BSD-3-Clause). 
+// Please also read “Additional BSD Notice” below.
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+// i. Redistributions of source code must retain the above copyright notice, this list 
+// of conditions and the disclaimer below.
+// ii. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the disclaimer (as noted below) in the documentation and/or 
+// other materials provided with the distribution.
+// iii. Neither the name of the LLNS/LLNL nor the names of its contributors may be used to 
+// endorse or promote products derived from this software without specific prior written 
+// permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY 
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES 
+// OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT 
+// SHALL LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR 
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS 
+// OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Additional BSD Notice
+// 1. This notice is required to be provided under our contract with the U.S. Department 
+// of Energy (DOE). This work was produced at Lawrence Livermore National Laboratory under 
+// Contract No. DE-AC52-07NA27344 with the DOE.
+// 2. Neither the United States Government nor Lawrence Livermore National Security, LLC 
+// nor any of their employees, makes any warranty, express or implied, or assumes any 
+// liability or responsibility for the accuracy, completeness, or usefulness of any 
+// information, apparatus, product, or process disclosed, or represents that its use would
+// not infringe privately-owned rights.
+// 3. Also, reference herein to any specific commercial products, process, or services by 
+// trade name, trademark, manufacturer or otherwise does not necessarily constitute or 
+// imply its endorsement, recommendation, or favoring by the United States Government or 
+// Lawrence Livermore National Security, LLC. The views and opinions of authors expressed 
+// herein do not necessarily state or reflect those of the United States Government or 
+// Lawrence Livermore National Security, LLC, and shall not be used for advertising or 
+// product endorsement purposes.
+#include "hiopIterationMetrics.hpp"
+
+
+namespace hiop
+{
+
+//the stdio buffer of the file; a record in CSV takes about 300 bytes
+static const size_t metrics_buffer_size=1<<20;
+
+hiopMetricsFileSink::hiopMetricsFileSink(const char* filename, Format format_)
+  : f(NULL), format(format_), buffer(NULL)
+{
+  f = fopen(filename, Binary==format ? "wb" : "w");
+  if(NULL==f) return;
+  buffer = new char[metrics_buffer_size];
+  setvbuf(f, buffer, _IOFBF, metrics_buffer_size);
+  if(Binary==format) {
+    const int rec_size=(int)sizeof(hiopIterationRecord);
+    fwrite("HIOPMTR1", 1, 8, f);
+    fwrite(&rec_size, sizeof(int), 1, f);
+  } else {
+    fprintf(f, "iter,ls_num,ls_status,restoration,hess_updates,hess_skips,n_refin,"
+	    "n_eval_obj,n_eval_grad,n_eval_cons,n_eval_jac,n_eval_hess,"
+	    "objective,inf_pr,inf_du,complem,mu,alpha_pr,alpha_du,t_iter,t_search_dir,t_dual_update,t_eval\n");
+  }
+}
+
+hiopMetricsFileSink::~hiopMetricsFileSink()
+{
+  //the buffer is used by the file until it is closed
+  if(f) fclose(f);
+  delete[] buffer;
+}
+
+void hiopMetricsFileSink::record(const hiopIterationRecord& r)
+{
+  if(NULL==f) return;
+  if(Binary==format) {
+    fwrite(&r, sizeof(hiopIterationRecord), 1, f);
+    return;
+  }
+  fprintf(f, "%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,"
+	  "%.12e,%.6e,%.6e,%.6e,%.6e,%.6e,%.6e,%.6e,%.6e,%.6e,%.6e\n",
+	  r.iter, r.ls_num, r.ls_status, r.restoration, r.hess_updates, r.hess_skips, r.n_refin,
+	  r.n_eval_obj, r.n_eval_grad, r.n_eval_cons, r.n_eval_jac, r.n_eval_hess,
+	  r.objective, r.inf_pr, r.inf_du, r.complem, r.mu, r.alpha_pr, r.alpha_du, 
+	  r.t_iter, r.t_search_dir, r.t_dual_update, r.t_eval);
+}
+
+void hiopMetricsFileSink::end()
+{
+  if(f) fflush(f);
+}
+
+}
@@ -0,0 +1,121 @@
+// Copyright (c) 2017, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory (LLNL).
+// Written by Cosmin G. Petra, petra1@llnl.gov.
+// LLNL-CODE-742473. All rights reserved.
+//
+// This file is part of HiOp. For details, see https://github.com/LLNL/hiop. HiOp 
+// is released under the BSD 3-clause license (https://opensource.org/licenses/BSD-3-Clause). 
+// Please also read “Additional BSD Notice” below.
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+// i. Redistributions of source code must retain the above copyright notice, this list 
+// of conditions and the disclaimer below.
+// ii. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the disclaimer (as noted below) in the documentation and/or 
+// other materials provided with the distribution.
+// iii. Neither the name of the LLNS/LLNL nor the names of its contributors may be used to 
+// endorse or promote products derived from this software without specific prior written 
+// permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY 
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES 
+// OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT 
+// SHALL LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR 
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS 
+// OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Additional BSD Notice
+// 1. This notice is required to be provided under our contract with the U.S. Department 
+// of Energy (DOE). This work was produced at Lawrence Livermore National Laboratory under 
+// Contract No. DE-AC52-07NA27344 with the DOE.
+// 2. Neither the United States Government nor Lawrence Livermore National Security, LLC 
+// nor any of their employees, makes any warranty, express or implied, or assumes any 
+// liability or responsibility for the accuracy, completeness, or usefulness of any 
+// information, apparatus, product, or process disclosed, or represents that its use would
+// not infringe privately-owned rights.
+// 3. Also, reference herein to any specific commercial products, process, or services by 
+// trade name, trademark, manufacturer or otherwise does not necessarily constitute or 
+// imply its endorsement, recommendation, or favoring by the United States Government or 
+// Lawrence Livermore National Security, LLC. The views and opinions of authors expressed 
+// herein do not necessarily state or reflect those of the United States Government or 
+// Lawrence Livermore National Security, LLC, and shall not be used for advertising or 
+// product endorsement purposes.
+#ifndef HIOP_ITERATION_METRICS
+#define HIOP_ITERATION_METRICS
+
+#include <cstdio>
+#include <string>
+
+namespace hiop
+{
+
+/* Metrics of one iteration of the filter IPM. The counts and times are the ones since the previous record,
+ * i.e., of the work that produced the iterate 'iter' from the previous one (for iteration 0, of the
+ * starting procedure). The times are the ones of the rank that writes the record. */
+struct hiopIterationRecord
+{
+  int iter;
+  int ls_num;        //number of line-search trials
+  int ls_status;     //accepted step: -1 none (first iteration), 1 s, 2 h, 3 f, 4 r, 5 w, 6 W (see outputIteration)
+  int restoration;   //1 while the feasibility restoration is active, 0 otherwise
+  int hess_updates;  //secant updates of the quasi-Newton Hessian, done and skipped
+  int hess_skips;
+  int n_refin;       //steps of the iterative refinement of the solves with N
+  int n_eval_obj;    //calls of the user's callbacks
+  int n_eval_grad;
+  int n_eval_cons;   //equality and inequality constraints
+  int n_eval_jac;
+  int n_eval_hess;
+  double objective;
+  double inf_pr, inf_du, complem;
+  double mu;
+  double alpha_pr, alpha_du;
+  double t_iter;     //wall time since the previous record and the part of it spent in the phases below
+  double t_search_dir;
+  double t_dual_update;
+  double t_eval;     //user's callbacks
+};
+
+/* Receives the records of the iterations. The sink is called by the rank 0 of the communicator of the NLP
+ * only, after the iteration output; 'end' is called once at the end of the solve. */
+class hiopMetricsSink
+{
+public:
+  hiopMetricsSink() {};
+  virtual ~hiopMetricsSink() {};
+  virtual void record(const hiopIterationRecord& r) = 0;
+  virtual void end() {};
+};
+
+/* Writes the records to a file, either as CSV (a header line with the names of the fields, then one line 
+ * per record) or as binary records. The binary file starts with the 8 characters "HIOPMTR1" and the size 
+ * in bytes of a record (an int); then the records follow as the raw bytes of hiopIterationRecord, in the 
+ * byte order of the writer. The file is written through a large stdio buffer and is flushed by 'end' or 
+ * when the sink is destroyed. */
+class hiopMetricsFileSink : public hiopMetricsSink
+{
+public:
+  enum Format { CSV=0, Binary };
+  hiopMetricsFileSink(const char* filename, Format format=CSV);
+  virtual ~hiopMetricsFileSink();
+
+  /* false when the file could not be opened; the records are then dropped */
+  inline bool is_open() const { return f!=NULL; }
+  virtual void record(const hiopIterationRecord& r);
+  virtual void end();
+private:
+  FILE* f;
+  Format format;
+  char* buffer;
+
+  hiopMetricsFileSink(const hiopMetricsFileSink&);
+  hiopMetricsFileSink& operator=(const hiopMetricsFileSink&);
+};
+
+}
+#endif
@@ -50,36 +50,130 @@
 #include "blasdefs.hpp"
 
 #include <cmath>
+#include <cstring>
+#include <vector>
 
 namespace hiop
 {
 
-hiopKKTLinSysLowRank::hiopKKTLinSysLowRank(hiopNlpFormulation* nlp_)
+hiopKKTLinSys::hiopKKTLinSys(hiopNlpFormulation* nlp_)
+  : nlp(nlp_), iter(NULL), delta_w_last(0.)
 {
-  iter=NULL; grad_f=NULL; Jac_c=Jac_d=NULL; Hess=NULL;
-  nlp = dynamic_cast<hiopNlpDenseConstraints*>(nlp_);
   rx_tilde  = dynamic_cast<hiopVectorPar*>(nlp->alloc_primal_vec());
   Dx = rx_tilde->alloc_clone();
   ryd_tilde = dynamic_cast<hiopVectorPar*>(nlp->alloc_dual_ineq_vec());
   Dd_inv = ryd_tilde->alloc_clone();
-  _kxn_mat = nlp->alloc_multivector_primal(nlp->m()); //!opt
-  N = new hiopMatrixDense(nlp->m(),nlp->m());
+}
+
+hiopKKTLinSys::~hiopKKTLinSys()
+{
+  if(rx_tilde)  delete rx_tilde;
+  if(ryd_tilde) delete ryd_tilde;
+  if(Dx)        delete Dx;
+  if(Dd_inv)    delete Dd_inv;
+}
+
+void hiopKKTLinSys::updateDiagonals()
+{
+  //Dx=(Sxl)^{-1}Zl + (Sxu)^{-1}Zu
+  Dx->setToZero();
+  Dx->axdzpy_w_pattern(1.0, *iter->zl, *iter->sxl, nlp->get_ixl());
+  Dx->axdzpy_w_pattern(1.0, *iter->zu, *iter->sxu, nlp->get_ixu());
+  nlp->log->write("Dx in KKT", *Dx, hovMatrices);
+
+  //Dd=(Sdl)^{-1}Vu + (Sdu)^{-1}Vu
+  Dd_inv->setToZero();
+  Dd_inv->axdzpy_w_pattern(1.0, *iter->vl, *iter->sdl, nlp->get_idl());
+  Dd_inv->axdzpy_w_pattern(1.0, *iter->vu, *iter->sdu, nlp->get_idu());
 #ifdef DEEP_CHECKING
-  Nmat=N->alloc_clone();
+  assert(true==Dd_inv->allPositive());
+#endif 
+  Dd_inv->invert();
+  nlp->log->write("Dd_inv in KKT", *Dd_inv, hovMatrices);
+}
+
+bool hiopKKTLinSys::factorizeWithInertiaCorrection(int nneg, bool quasi_definite)
+{
+  hiopTimeScope scope(nlp->runStats.profile, tpNFactor);
+  const double delta_w_min=1e-20, delta_w_0=1e-4, delta_w_max=1e+40, delta_c_reg=1e-8;
+
+  double delta_w=0., delta_c= quasi_definite && nneg>0 ? delta_c_reg : 0.;
+  const double delta_c_init=delta_c;
+  int nneg_K=factorizeK(delta_w, delta_c);
+  if(nneg_K<0 && 0.==delta_c && nneg>0) { delta_c=delta_c_reg; nneg_K=factorizeK(delta_w, delta_c); }
+  while(nneg_K!=nneg) {
+    if(0.==delta_w) delta_w = delta_w_last>0. ? fmax(delta_w_min, delta_w_last/3.) : delta_w_0;
+    else            delta_w *= (delta_w_last>0. ? 8. : 100.);
+    if(delta_w>delta_w_max) {
+      nlp->log->printf(hovError, "hiopKKTLinSys: the inertia correction failed (delta_w=%g)\n", delta_w);
+      return false;
+    }
+    nneg_K=factorizeK(delta_w, delta_c);
+  }
+  if(delta_w>0.) delta_w_last=delta_w;
+  if(delta_w>0. || delta_c>delta_c_init)
+    nlp->log->printf(hovScalars, "hiopKKTLinSys: inertia correction delta_w=%12.5e delta_c=%12.5e\n", delta_w, delta_c);
+  return true;
+}
+
+hiopKKTLinSysLowRank::hiopKKTLinSysLowRank(hiopNlpFormulation* nlp_)
+  : hiopKKTLinSys(nlp_)
+{
+  grad_f=NULL; Jac_c=Jac_d=NULL; Hess=NULL;
+  nlpd = dynamic_cast<hiopNlpDenseConstraints*>(nlp_);
+  _kxn_mat=N=Nref=Nfact=NULL;
+  Ndist=Ndist_fact=NULL;
+  node=NULL; Nref_buf=Nfact_buf=NULL;
+  Nscale=NULL; Nequed='N';
+#ifdef DEEP_CHECKING
+  Nmat=NULL;
+#endif
+  //the block formulation has its own reduced system
+  if(nlpd) {
+    _kxn_mat = nlp->alloc_multivector_primal(nlp->m()); //!opt
+  }
+  if(nlpd && nlp->get_num_ranks()>1 && nlp->m()>=nlp->options->GetInteger("dist_reduced_mat_min_size")) {
+    //N is distributed and is not replicated on the ranks
+    Ndist = new hiopMatrixSymBlockCyclic(nlp->m(), nlp->options->GetInteger("dist_reduced_mat_block_size"), 
+					 nlp->get_comm());
+    Ndist_fact = new hiopMatrixSymBlockCyclic(nlp->m(), Ndist->get_block_size(), nlp->get_comm());
+    nlp->log->printf(hovSummary, "hiopKKTLinSysLowRank: the %lld x %lld reduced matrix is distributed on a %d x %d "
+		     "grid of ranks (block size %d)\n", nlp->m(), nlp->m(), Ndist->get_grid_rows(), 
+		     Ndist->get_grid_cols(), Ndist->get_block_size());
+  } else if(nlpd && nlp->get_node_comm()) {
+    //N is formed directly in Nref; Nref and Nfact are stored once per node
+    node = nlp->get_node_comm();
+    const long long m=nlp->m();
+    Nref_buf  = node->alloc_shared(m*m);
+    Nfact_buf = node->alloc_shared(m*m);
+    Nref  = new hiopMatrixDense(m, m, Nref_buf);
+    Nfact = new hiopMatrixDense(m, m, Nfact_buf);
+  } else if(nlpd) {
+    N = new hiopMatrixDense(nlp->m(),nlp->m());
+    Nref  = N->alloc_clone();
+    Nfact = N->alloc_clone();
+    Nscale = new double[nlp->m()>0 ? nlp->m() : 1];
+#ifdef DEEP_CHECKING
+    Nmat=N->alloc_clone();
 #endif
+  }
+  N_formed = Nfact_valid = false;
   _k_vec1 = dynamic_cast<hiopVectorPar*>(nlp->alloc_dual_vec());
 }
 
 hiopKKTLinSysLowRank::~hiopKKTLinSysLowRank()
 {
-  if(rx_tilde)  delete rx_tilde;
-  if(ryd_tilde) delete ryd_tilde;
   if(N)         delete N;
+  if(Nref)      delete Nref;
+  if(Nfact)     delete Nfact;
+  if(Nscale)    delete[] Nscale;
+  if(Ndist)     delete Ndist;
+  if(Ndist_fact)delete Ndist_fact;
+  if(Nref_buf)  node->free_shared(Nref_buf);
+  if(Nfact_buf) node->free_shared(Nfact_buf);
 #ifdef DEEP_CHECKING
   if(Nmat)      delete Nmat;
 #endif
-  if(Dx)        delete Dx;
-  if(Dd_inv)    delete Dd_inv;
   if(_kxn_mat)  delete _kxn_mat;
   if(_k_vec1)   delete _k_vec1;
 }
@@ -87,42 +181,30 @@ hiopKKTLinSysLowRank::~hiopKKTLinSysLowRank()
 bool hiopKKTLinSysLowRank::
 update(const hiopIterate* iter_, 
        const hiopVector* grad_f_, 
-       const hiopMatrixDense* Jac_c_, const hiopMatrixDense* Jac_d_, 
+       const hiopMatrix* Jac_c_, const hiopMatrix* Jac_d_, 
        hiopHessianLowRank* Hess_)
 {
   nlp->runStats.tmSolverInternal.start();
 
   iter=iter_;
   grad_f = dynamic_cast<const hiopVectorPar*>(grad_f_);
-  Jac_c = Jac_c_; Jac_d = Jac_d_;
+  Jac_c = dynamic_cast<const hiopMatrixDense*>(Jac_c_); 
+  Jac_d = dynamic_cast<const hiopMatrixDense*>(Jac_d_);
   //Hess = dynamic_cast<hiopHessianInvLowRank*>(Hess_);
   Hess=Hess_;
 
-  //compute the diagonals
-  //Dx=(Sxl)^{-1}Zl + (Sxu)^{-1}Zu
-  Dx->setToZero();
-  Dx->axdzpy_w_pattern(1.0, *iter->zl, *iter->sxl, nlp->get_ixl());
-  Dx->axdzpy_w_pattern(1.0, *iter->zu, *iter->sxu, nlp->get_ixu());
-  nlp->log->write("Dx in KKT", *Dx, hovMatrices);
-
-  Hess->updateLogBarrierDiagonal(*Dx);
+  //the reduced matrix needs to be recomputed for the new iterate
+  N_formed = Nfact_valid = false;
 
-  //Dd=(Sdl)^{-1}Vu + (Sdu)^{-1}Vu
-  Dd_inv->setToZero();
-  Dd_inv->axdzpy_w_pattern(1.0, *iter->vl, *iter->sdl, nlp->get_idl());
-  Dd_inv->axdzpy_w_pattern(1.0, *iter->vu, *iter->sdu, nlp->get_idu());
-#ifdef DEEP_CHECKING
-  assert(true==Dd_inv->allPositive());
-#endif 
-  Dd_inv->invert();
+  //compute the diagonals
+  updateDiagonals();
+  if(Hess) Hess->updateLogBarrierDiagonal(*Dx);
 
   nlp->runStats.tmSolverInternal.stop();
-
-  nlp->log->write("Dd_inv in KKT", *Dd_inv, hovMatrices);
   return true;
 }
 
-bool hiopKKTLinSysLowRank::computeDirections(const hiopResidual* resid, 
+bool hiopKKTLinSys::computeDirections(const hiopResidual* resid, 
 					     hiopIterate* dir)
 {
   nlp->runStats.tmSolverInternal.start();
@@ -191,7 +273,10 @@ bool hiopKKTLinSysLowRank::computeDirections(const hiopResidual* resid,
    * solve the compressed system
    * (be aware that rx_tilde is reused/modified inside this function) 
    ***********************************************************************/
-  solveCompressed(*rx_tilde,*r.ryc,*ryd_tilde, *dir->x, *dir->yc, *dir->yd);
+  if(!solveCompressed(*rx_tilde,*r.ryc,*ryd_tilde, *dir->x, *dir->yc, *dir->yd)) {
+    nlp->runStats.tmSolverInternal.stop();
+    return false;
+  }
   //recover dir->d = (D)^{-1}*(dir->yd + ryd2)
   dir->d->copyFrom(ryd2);
   dir->d->axpy(1.0,*dir->yd);
@@ -278,7 +363,7 @@ bool hiopKKTLinSysLowRank::computeDirections(const hiopResidual* resid,
 #ifdef DEEP_CHECKING
 double hiopKKTLinSysLowRank::errorKKT(const hiopResidual* resid, const hiopIterate* sol)
 {
-
+  if(NULL==Hess || NULL==Jac_c) return 0.;
   nlp->log->printf(hovLinAlgScalars, "hiopKKTLinSysLowRank::errorKKT KKT_large residuals norm:\n");
   double derr=1e20,aux;
   hiopVectorPar *RX=resid->rx->new_copy();
@@ -384,6 +469,8 @@ double hiopKKTLinSysLowRank::
 errorCompressedLinsys(const hiopVectorPar& rx, const hiopVectorPar& ryc, const hiopVectorPar& ryd,
 		      const hiopVectorPar& dx, const hiopVectorPar& dyc, const hiopVectorPar& dyd)
 {
+  //the residuals are computed with the quasi-Newton Hessian and the dense Jacobians
+  if(NULL==Hess || NULL==Jac_c) return 0.;
   nlp->log->printf(hovLinAlgScalars, "hiopKKTLinSysLowRank::errorCompressedLinsys residuals norm:\n");
 
   double derr=1e20, aux;
@@ -432,7 +519,7 @@ errorCompressedLinsys(const hiopVectorPar& rx, const hiopVectorPar& ryc, const h
    * 
    * Note that ops H+Dx are provided by hiopHessianLowRank
    */
-void hiopKKTLinSysLowRank::
+bool hiopKKTLinSysLowRank::
 solveCompressed(hiopVectorPar& rx, hiopVectorPar& ryc, hiopVectorPar& ryd,
 		hiopVectorPar& dx, hiopVectorPar& dyc, hiopVectorPar& dyd)
 {
@@ -446,23 +533,39 @@ solveCompressed(hiopVectorPar& rx, hiopVectorPar& ryc, hiopVectorPar& ryd,
 #endif
 
   hiopMatrixDense& J = *_kxn_mat;
-  J.copyRowsFrom(*Jac_c, nlp->m_eq(), 0); //!opt
-  J.copyRowsFrom(*Jac_d, nlp->m_ineq(), nlp->m_eq());//!opt
-
-  //N =  J*(Hess\J')
-  //Hess->symmetricTimesMat(0.0, *N, 1.0, J);
-  Hess->symMatTimesInverseTimesMatTrans(0.0, *N, 1.0, J);
-
-  N->addSubDiagonal(nlp->m_eq(), *Dd_inv);
+  if(!N_formed) nlp->runStats.profile.begin(tpNAssembly);
+  if(!N_formed && Ndist) {
+    J.copyRowsFrom(*Jac_c, nlp->m_eq(), 0); //!opt
+    J.copyRowsFrom(*Jac_d, nlp->m_ineq(), nlp->m_eq());//!opt
+    formReducedMatrix(*Ndist, J);
+    Ndist->addSubDiagonal(nlp->m_eq(), *Dd_inv);
+  } else if(!N_formed && node) {
+    J.copyRowsFrom(*Jac_c, nlp->m_eq(), 0); //!opt
+    J.copyRowsFrom(*Jac_d, nlp->m_ineq(), nlp->m_eq());//!opt
+    formReducedMatrix(*node, *Nref, J);
+    if(node->is_leader()) Nref->addSubDiagonal(nlp->m_eq(), *Dd_inv);
+    node->sync();
+  } else if(!N_formed) {
+    J.copyRowsFrom(*Jac_c, nlp->m_eq(), 0); //!opt
+    J.copyRowsFrom(*Jac_d, nlp->m_ineq(), nlp->m_eq());//!opt
+
+    //N =  J*(Hess\J')
+    //Hess->symmetricTimesMat(0.0, *N, 1.0, J);
+    formReducedMatrix(*N, J);
+
+    N->addSubDiagonal(nlp->m_eq(), *Dd_inv);
+    Nref->copyFrom(*N);
 #ifdef DEEP_CHECKING
-  nlp->log->write("solveCompressed: N is", *N, hovMatrices);
-  nlp->log->write("solveCompressed: rx is", rx, hovMatrices);
-  nlp->log->printf(hovLinAlgScalars, "inf norm of Dd_inv is %g\n", Dd_inv->infnorm());
-  N->assertSymmetry(1e-10);
+    nlp->log->write("solveCompressed: N is", *N, hovMatrices);
+    nlp->log->write("solveCompressed: rx is", rx, hovMatrices);
+    nlp->log->printf(hovLinAlgScalars, "inf norm of Dd_inv is %g\n", Dd_inv->infnorm());
+    N->assertSymmetry(1e-10);
 #endif
+  }
+  nlp->runStats.profile.end(tpNAssembly);
   //compute the rhs of the lin sys involving N 
   //  first compute (H+Dx)^{-1} rx_tilde and store it temporarily in dx
-  Hess->solve(rx, dx);
+  solveWithHessian(rx, dx);
   // then rhs =   [ Jc(H+Dx)^{-1}*rx - ryc ]
   //              [ Jd(H+dx)^{-1}*rx - ryd ]
   hiopVectorPar& rhs=*_k_vec1;
@@ -473,15 +576,27 @@ solveCompressed(hiopVectorPar& rx, hiopVectorPar& ryc, hiopVectorPar& ryd,
 #ifdef DEEP_CHECKING
   nlp->log->write("solveCompressed: dx sol is", dx, hovMatrices);
   nlp->log->write("solveCompressed: rhs for N is", rhs, hovMatrices);
-  Nmat->copyFrom(*N);
+  if(Nmat) Nmat->copyFrom(*Nref);
   hiopVectorPar* r=rhs.new_copy(); //save the rhs to check the norm of the residual
 #endif
 
   //
   //solve N * dyc_dyd = rhs
   //
-  int ierr = solveWithRefin(*N,rhs);
-  //int ierr = solve(*N,rhs);
+  int ierr;
+  nlp->runStats.profile.begin(tpNSolve);
+  if(Ndist || node) {
+    //the distributed or node-shared factorization is computed by the first solve
+    ierr = solveWithFactors(rhs);
+    N_formed=true;
+  } else if(!N_formed) {
+    ierr = solveWithRefin(*N,rhs);
+    //int ierr = solve(*N,rhs);
+    N_formed=true;
+  } else {
+    ierr = solveWithFactors(rhs);
+  }
+  nlp->runStats.profile.end(tpNSolve);
 
   hiopVector& dyc_dyd= rhs;
   dyc_dyd.copyToStarting(dyc,0);
@@ -491,7 +606,7 @@ solveCompressed(hiopVectorPar& rx, hiopVectorPar& ryc, hiopVectorPar& ryd,
   //first rx = -(Jc^T*dyc+Jd^T*dyd - rx)
   J.transTimesVec(1.0, rx, -1.0, dyc_dyd);
   //then dx = (H+Dx)^{-1} rx
-  Hess->solve(rx, dx);
+  solveWithHessian(rx, dx);
 
 #ifdef DEEP_CHECKING
   //some outputing
@@ -499,6 +614,7 @@ solveCompressed(hiopVectorPar& rx, hiopVectorPar& ryc, hiopVectorPar& ryd,
   nlp->log->write("  dx: ",  dx, hovIteration); nlp->log->write(" dyc: ", dyc, hovIteration); nlp->log->write(" dyd: ", dyd, hovIteration);
   delete r;
 #endif
+  return ierr>=0;
 }
 
 
@@ -543,8 +659,9 @@ int hiopKKTLinSysLowRank::solveWithRefin(hiopMatrixDense& M, hiopVectorPar& rhs)
   // 3. If residual norm is not small enough, then perform iterative refinement. This is because dposvx 
   // does not always provide a small enough residual since it stops (possibly without refinement) based on
   // the forward and backward estimates
+  // M is expected to be a copy of Nref; it is overwritten. The factors of dposvx are kept in Nfact (and the
+  // equilibration in Nscale and Nequed) and serve the refinement and the subsequent solves with N.
 
-  hiopMatrixDense* Aref = M.new_copy();
   hiopVectorPar* rhsref = rhs.new_copy();
 
   char FACT='E'; 
@@ -553,10 +670,10 @@ int hiopKKTLinSysLowRank::solveWithRefin(hiopMatrixDense& M, hiopVectorPar& rhs)
   int NRHS=1;
   double* A=M.local_buffer();
   int LDA=N;
-  double* AF=new double[N*N];
+  double* AF=Nfact->local_buffer();
   int LDAF=N;
-  char EQUED='N'; //it is an output if FACT='E'
-  double* S = new double[N];
+  Nequed='N'; //it is an output if FACT='E'
+  double* S = Nscale;
   double* B = rhs.local_data();
   int LDB=N;
   double* X = new double[N];
@@ -572,27 +689,109 @@ int hiopKKTLinSysLowRank::solveWithRefin(hiopMatrixDense& M, hiopVectorPar& rhs)
   DPOSVX(&FACT, &UPLO, &N, &NRHS,
 	 A, &LDA,
 	 AF, &LDAF,
-	 &EQUED,
+	 &Nequed,
 	 S,
 	 B, &LDB,
 	 X, &LDX,
 	 &RCOND, &FERR, &BERR, 
 	 WORK, IWORK,
 	 &INFO); 
-  //printf("INFO ===== %d  RCOND=%g  FERR=%g   BERR=%g  EQUED=%c\n", INFO, RCOND, FERR, BERR, EQUED);
+  //printf("INFO ===== %d  RCOND=%g  FERR=%g   BERR=%g  EQUED=%c\n", INFO, RCOND, FERR, BERR, Nequed);
+  if(INFO>0 && INFO<=N)
+    nlp->log->printf(hovError, "hiopKKTLinSysLowRank::solveWithRefin: dposvx detected %d minor being indefinite.\n", INFO);
+  else if(INFO<0)
+    nlp->log->printf(hovError, "hiopKKTLinSysLowRank::solveWithRefin: dposvx returned error %d\n", INFO);
+  Nfact_valid=true;
   //
-  // 2. check residual
+  // 2. check residual and refine
   //
-  hiopVectorPar* x = rhs.alloc_clone(); 
-  hiopVectorPar dx(N);
+  rhs.copyFrom(X);
+  iterRefin(*rhsref, rhs);
+
+  delete[] X;
+  delete[] WORK;
+  delete[] IWORK;
+  delete rhsref;
+  return INFO;
+}
+
+int hiopKKTLinSysLowRank::solveWithFactors(hiopVectorPar& rhs)
+{
+  int N=nlp->m();
+  if(N==0) return 0;
+  if(!Nfact_valid) factorizeN();
+
+  hiopVectorPar* rhsref = rhs.new_copy();
+  const int info = solveWithNfact(rhs);
+  iterRefin(*rhsref, rhs);
+  delete rhsref;
+  return info;
+}
+
+int hiopKKTLinSysLowRank::solveWithNfact(hiopVectorPar& r)
+{
+  if(Ndist) {
+    Ndist_fact->solve(r);
+    return 0;
+  }
+  char UPLO='L'; 
+  int N=nlp->m(), NRHS=1, info=0;
+  double* rv=r.local_data();
+  //(S*N*S)^{-1} = S^{-1}*N^{-1}*S^{-1}, hence N^{-1}*r = S*(S*N*S)^{-1}*(S*r)
+  if('Y'==Nequed) for(int i=0; i<N; i++) rv[i] *= Nscale[i];
+  DPOTRS(&UPLO,&N, &NRHS, Nfact->local_buffer(), &N, rv, &N, &info);
+  if('Y'==Nequed) for(int i=0; i<N; i++) rv[i] *= Nscale[i];
+  if(info<0) 
+    nlp->log->printf(hovError, "hiopKKTLinSysLowRank::solveWithFactors: dpotrs returned error %d\n", info);
+  return info;
+}
+
+int hiopKKTLinSysLowRank::factorizeN()
+{
+  hiopTimeScope scope(nlp->runStats.profile, tpNFactor);
+  char UPLO='L'; 
+  int N=nlp->m(), info;
+  Nequed='N';
+  if(Ndist) {
+    Ndist_fact->copyFrom(*Ndist);
+    info = Ndist_fact->factorize();
+    if(info>0)
+      nlp->log->printf(hovError, "hiopKKTLinSysLowRank::factorizeN: the distributed Cholesky detected %d minor being indefinite.\n", info);
+    Nfact_valid=true;
+    return info;
+  }
+  if(node) {
+    //the leader factorizes the shared Nfact; the other ranks of the node only read it
+    info=0;
+    if(node->is_leader()) {
+      Nfact->copyFrom(*Nref);
+      DPOTRF(&UPLO, &N, Nfact->local_buffer(), &N, &info);
+    }
+    info = node->bcast_from_leader(info);
+    node->sync();
+  } else {
+    Nfact->copyFrom(*Nref);
+    DPOTRF(&UPLO, &N, Nfact->local_buffer(), &N, &info);
+  }
+  if(info>0)
+    nlp->log->printf(hovError, "hiopKKTLinSysLowRank::factorizeMat: dpotrf (Chol fact) detected %d minor being indefinite.\n", info);
+  else
+    if(info<0) 
+      nlp->log->printf(hovError, "hiopKKTLinSysLowRank::factorizeMat: dpotrf returned error %d\n", info);
+  Nfact_valid=true;
+  return info;
+}
+
+void hiopKKTLinSysLowRank::iterRefin(const hiopVectorPar& rhsref, hiopVectorPar& x)
+{
+  int N=nlp->m();
   hiopVectorPar resid(N); 
   int nIterRefin=0;double nrmResid;
-  int info;
   const int MAX_ITER_REFIN=3;
   while(true) {
-    x->copyFrom(X);
-    resid.copyFrom(*rhsref);
-    Aref->timesVec(1.0, resid, -1.0, *x);
+    resid.copyFrom(rhsref);
+    if(Ndist) Ndist->timesVec(1.0, resid, -1.0, x);
+    else      Nref->timesVec(1.0, resid, -1.0, x);
 
     nlp->log->write("resid", resid, hovLinAlgScalars);
 
@@ -602,89 +801,24 @@ int hiopKKTLinSysLowRank::solveWithRefin(hiopMatrixDense& M, hiopVectorPar& rhs)
     if(nrmResid<1e-8) break;
 
     if(nIterRefin>=MAX_ITER_REFIN) {
-      nlp->log->write("N", *Aref, hovMatrices);
-      nlp->log->write("sol", *x, hovMatrices);
-      nlp->log->write("rhs", *rhsref, hovMatrices);
+      if(Nref) nlp->log->write("N", *Nref, hovMatrices);
+      nlp->log->write("sol", x, hovMatrices);
+      nlp->log->write("rhs", rhsref, hovMatrices);
 
       nlp->log->printf(hovWarning, "hiopKKTLinSysLowRank::solveWithRefin reduced residual to ONLY (inf-norm) %g after %d iterative refinements\n", nrmResid, nIterRefin);
       break;
       //assert(false && "too many refinements");
     }
-    if(0) { //iter refin based on symmetric indefinite factorization+solve 
-      
+    //iter refin based on symmetric positive definite factorization+solve; the factorization 
+    //is computed once and reused by the subsequent refinement steps and solves
+    if(!Nfact_valid) factorizeN();
+    solveWithNfact(resid);
 
-      int _V_ipiv_vec[1000]; double _V_work_vec[1000]; int lwork=1000;
-      M.copyFrom(*Aref);
-      DSYTRF(&UPLO, &N, M.local_buffer(), &LDA, _V_ipiv_vec, _V_work_vec, &lwork, &info);
-      assert(info==0);
-      DSYTRS(&UPLO, &N, &NRHS, M.local_buffer(), &LDA, _V_ipiv_vec, resid.local_data(), &LDB, &info);
-      assert(info==0);
-    } else { //iter refin based on symmetric positive definite factorization+solve 
-      M.copyFrom(*Aref);
-      //for(int i=0; i<4; i++) M.local_data()[i][i] +=1e-8;
-      DPOTRF(&UPLO, &N, M.local_buffer(), &LDA, &info);
-      if(info>0)
-	nlp->log->printf(hovError, "hiopKKTLinSysLowRank::factorizeMat: dpotrf (Chol fact) detected %d minor being indefinite.\n", info);
-      else
-	if(info<0) 
-	  nlp->log->printf(hovError, "hiopKKTLinSysLowRank::factorizeMat: dpotrf returned error %d\n", info);
-      
-      DPOTRS(&UPLO,&N, &NRHS, M.local_buffer(), &LDA, resid.local_data(), &LDA, &info);
-      if(info<0) 
-	nlp->log->printf(hovError, "hiopKKTLinSysLowRank::solveWithFactors: dpotrs returned error %d\n", info);
-    }
-
-   // //FACT='F'; EQUED='Y'; //reuse the factorization and the equilibration
-   //  M.copyFrom(*Aref);
-   //  A = M.local_buffer();
-   //  dposvx_(&FACT, &UPLO, &N, &NRHS,
-   // 	    A, &LDA,
-   // 	    AF, &LDAF,
-   // 	    &EQUED,
-   // 	    S,
-   // 	    resid.local_data(), &LDB,
-   // 	    X, &LDX,
-   // 	    &RCOND, &FERR, &BERR, 
-   // 	    WORK, IWORK,
-   // 	    &INFO); 
-   //  printf("INFO ===== %d  RCOND=%g  FERR=%g   BERR=%g  EQUED=%c\n", INFO, RCOND, FERR, BERR, EQUED);
-    
-    dx.copyFrom(resid);
-    x->axpy(1., dx);
+    x.axpy(1., resid);
     
     nIterRefin++;
+    nlp->runStats.nIterRefin++;
   }
-
-  rhs.copyFrom(*x);
-  delete[] AF;
-  delete[] S;
-  delete[] X;
-  delete[] WORK;
-  delete[] IWORK;
-  delete Aref;
-  delete rhsref;
-  delete x;
-
-// #ifdef DEEP_CHECKING
-//   hiopVectorPar sol(rhs.get_size());
-//   hiopVectorPar rhss(rhs.get_size());
-//   sol.copyFrom(rhs); rhss.copyFrom(*r);
-//   double relErr=solveError(*Nmat, rhs, *r);
-//   if(relErr>1e-5)  {
-//     nlp->log->printf(hovWarning, "large rel. error (%g) in linear solver occured the Cholesky solve (hiopKKTLinSys)\n", relErr);
-
-//     nlp->log->write("matrix N=", *Nmat, hovError);
-//     nlp->log->write("rhs", rhss, hovError);
-//     nlp->log->write("sol", sol, hovError);
-
-//     assert(false && "large error (%g) in linear solve (hiopKKTLinSys), equilibrating the matrix and/or iterative refinement are needed (see dposvx/x)");
-//   } else 
-//     if(relErr>1e-16) 
-//       nlp->log->printf(hovWarning, "considerable rel. error (%g) in linear solver occured the Cholesky solve (hiopKKTLinSys)\n", relErr);
-
-//   nlp->log->printf(hovLinAlgScalars, "hiopKKTLinSysLowRank::solveCompressed: Cholesky solve: relative error %g\n", relErr);
-//   delete r;
-// #endif
 }
 
 int hiopKKTLinSysLowRank::solve(hiopMatrixDense& M, hiopVectorPar& rhs)
@@ -787,9 +921,9 @@ int hiopKKTLinSysLowRank::solveWithRefin(hiopMatrixDense& M, hiopVectorPar& rhs)
   //M.copyFrom(AF);
   //nlp->log->write("Factoriz ", M, hovSummary);
 
-  printf("INFO ===== %d  RCOND=%g  RPVGRW=%g   BERR=%g  EQUED=%c\n", INFO, RCOND, RPVGRW, BERR, EQUED);
-  printf("               ERR_BNDS_NORM=%g %g %g    ERR_BNDS_COMP=%g %g %g \n", ERR_BNDS_NORM[0], ERR_BNDS_NORM[1], ERR_BNDS_NORM[2], ERR_BNDS_COMP[0], ERR_BNDS_COMP[1], ERR_BNDS_COMP[2]);
-  printf("               PARAMS=%g %g %g \n", PARAMS[0], PARAMS[1], PARAMS[2]);
+  nlp->log->printf(hovLinAlgScalars, "INFO ===== %d  RCOND=%g  RPVGRW=%g   BERR=%g  EQUED=%c\n", INFO, RCOND, RPVGRW, BERR, EQUED);
+  nlp->log->printf(hovLinAlgScalars, "               ERR_BNDS_NORM=%g %g %g    ERR_BNDS_COMP=%g %g %g \n", ERR_BNDS_NORM[0], ERR_BNDS_NORM[1], ERR_BNDS_NORM[2], ERR_BNDS_COMP[0], ERR_BNDS_COMP[1], ERR_BNDS_COMP[2]);
+  nlp->log->printf(hovLinAlgScalars, "               PARAMS=%g %g %g \n", PARAMS[0], PARAMS[1], PARAMS[2]);
 
 
   rhs.copyFrom(X);
@@ -816,5 +950,724 @@ double hiopKKTLinSysLowRank::solveError(const hiopMatrixDense& M,  const hiopVec
   return relError;
 }
 #endif
-};
+/**************************************************************************
+ * hiopKKTLinSysStructured
+ *************************************************************************/
+hiopKKTLinSysStructured::hiopKKTLinSysStructured(hiopNlpFormulation* nlp_)
+  : hiopKKTLinSysLowRank(nlp_), Hv_avail(false), Hv_checked(false), new_x(true), 
+    pcg_iters(0), pcg_solves(0), pcg_negcurv(0)
+{
+  pcg_tol = nlp->options->GetNumeric("hessian_pcg_tol");
+  pcg_max_iter = nlp->options->GetInteger("hessian_pcg_max_iter");
+  _r  = Dx->alloc_clone();
+  _z  = Dx->alloc_clone();
+  _p  = Dx->alloc_clone();
+  _Ap = Dx->alloc_clone();
+  _Dprec = Dx->alloc_clone();
+  _HinvJt = _kxn_mat->alloc_clone();
+}
 
+hiopKKTLinSysStructured::~hiopKKTLinSysStructured()
+{
+  if(_r)  delete _r;
+  if(_z)  delete _z;
+  if(_p)  delete _p;
+  if(_Ap) delete _Ap;
+  if(_Dprec)  delete _Dprec;
+  if(_HinvJt) delete _HinvJt;
+}
+
+bool hiopKKTLinSysStructured::
+update(const hiopIterate* iter_, 
+       const hiopVector* grad_f_, 
+       const hiopMatrix* Jac_c_, const hiopMatrix* Jac_d_, 
+       hiopHessianLowRank* Hess_)
+{
+  if(pcg_solves>0)
+    nlp->log->printf(hovScalars, "hiopKKTLinSysStructured: %d PCG solves, %.1f iterations per solve, %d with negative curvature\n",
+		     pcg_solves, pcg_iters/(double)pcg_solves, pcg_negcurv);
+  pcg_iters=pcg_solves=pcg_negcurv=0;
+
+  bool bret = hiopKKTLinSysLowRank::update(iter_, grad_f_, Jac_c_, Jac_d_, Hess_);
+  const double* x = dynamic_cast<const hiopVectorPar*>(iter->get_x())->local_data_const();
+  new_x=true;
+  if(!Hv_checked) {
+    _p->setToZero();
+    Hv_avail = nlpd->eval_Hess_f_vec(x, new_x, _p->local_data_const(), _Ap->local_data());
+    Hv_checked=true;
+    if(!Hv_avail) {
+      nlp->log->printf(hovWarning, "hiopKKTLinSysStructured: no Hessian-vector products from the user (eval_Hess_f_vec); "
+		       "the quasi-Newton Hessian is used instead\n");
+      Hess->setSecantConstraintsOnly(false);
+    }
+    new_x=false;
+  }
+  if(!Hv_avail) return bret;
+
+  //the diagonal of Hf, when available, improves the preconditioner
+  if(nlpd->eval_Hess_diag(x, new_x, _Dprec->local_data())) {
+    new_x=false;
+    double* d=_Dprec->local_data();
+    for(long long i=0; i<_Dprec->get_local_size(); i++) if(d[i]<0.) d[i]=0.;
+    _Dprec->axpy(1.0, *Dx);
+    Hess->updateLogBarrierDiagonal(*_Dprec);
+  }
+  return bret;
+}
+
+void hiopKKTLinSysStructured::applyHessian(const hiopVectorPar& x, hiopVectorPar& y)
+{
+  const double* xk = dynamic_cast<const hiopVectorPar*>(iter->get_x())->local_data_const();
+  bool bret = nlpd->eval_Hess_f_vec(xk, new_x, x.local_data_const(), y.local_data()); assert(bret);
+  new_x=false;
+  Hess->timesVecSecant(1.0, y, 1.0, x);
+  y.axzpy(1.0, x, *Dx);
+}
+
+/* Preconditioned CG for (Hf+B+Dx)*x=b with the preconditioner (B+Dx)^{-1}, which is also used for the 
+ * starting point. On negative curvature the current iterate is returned.
+ */
+void hiopKKTLinSysStructured::solveWithHessian(const hiopVectorPar& b, hiopVectorPar& x)
+{
+  Hess->solve(b, x);
+  if(!Hv_avail) return;
+
+  hiopVectorPar &r=*_r, &z=*_z, &p=*_p, &Ap=*_Ap;
+  applyHessian(x, Ap);
+  r.copyFrom(b); r.axpy(-1.0, Ap);
+  const double tol = pcg_tol*b.twonorm();
+  double rnrm = r.twonorm();
+  Hess->solve(r, z);
+  p.copyFrom(z);
+  double rz = r.dotProductWith(z);
+  int it=0;
+  while(rnrm>tol && it<pcg_max_iter) {
+    applyHessian(p, Ap);
+    const double pAp = p.dotProductWith(Ap);
+    if(pAp<=0.) {
+      nlp->log->printf(hovLinAlgScalars, "hiopKKTLinSysStructured: negative curvature (%g) at PCG iteration %d\n", pAp, it);
+      pcg_negcurv++;
+      break;
+    }
+    const double alpha = rz/pAp;
+    x.axpy(alpha, p);
+    r.axpy(-alpha, Ap);
+    rnrm = r.twonorm();
+    it++;
+    if(rnrm<=tol) break;
+    Hess->solve(r, z);
+    const double rz_new = r.dotProductWith(z);
+    p.scale(rz_new/rz); p.axpy(1.0, z);
+    rz = rz_new;
+  }
+  if(rnrm>tol && it>=pcg_max_iter)
+    nlp->log->printf(hovLinAlgScalars, "hiopKKTLinSysStructured: PCG reached the max number of iterations, "
+		     "relative residual %g\n", rnrm/b.twonorm());
+  pcg_iters += it; pcg_solves++;
+  nlp->runStats.nPCGSolves++; nlp->runStats.nPCGIter += it;
+}
+
+/* N = J*(H+Dx)^{-1}*J^T, with a PCG solve for each row of J; N is symmetrized since the solves are inexact */
+void hiopKKTLinSysStructured::formReducedMatrix(hiopMatrixDense& N, hiopMatrixDense& J)
+{
+  if(!Hv_avail) { hiopKKTLinSysLowRank::formReducedMatrix(N, J); return; }
+  const int k=J.m();
+  hiopVectorPar *Jrow=Dx->alloc_clone(), *col=Dx->alloc_clone();
+  for(int i=0; i<k; i++) {
+    J.getRow(i, *Jrow);
+    solveWithHessian(*Jrow, *col);
+    _HinvJt->replaceRow(i, *col);
+  }
+  delete Jrow; delete col;
+
+  J.timesMatTrans(0.0, N, 1.0, *_HinvJt);
+  double** Nd=N.local_data();
+  for(int i=0; i<k; i++)
+    for(int j=i+1; j<k; j++)
+      Nd[i][j] = Nd[j][i] = 0.5*(Nd[i][j]+Nd[j][i]);
+}
+
+void hiopKKTLinSysStructured::formReducedMatrix(hiopNodeComm& node, hiopMatrixDense& N, hiopMatrixDense& J)
+{
+  if(!Hv_avail) { hiopKKTLinSysLowRank::formReducedMatrix(node, N, J); return; }
+  const int k=J.m();
+  hiopVectorPar *Jrow=Dx->alloc_clone(), *col=Dx->alloc_clone();
+  for(int i=0; i<k; i++) {
+    J.getRow(i, *Jrow);
+    solveWithHessian(*Jrow, *col);
+    _HinvJt->replaceRow(i, *col);
+  }
+  delete Jrow; delete col;
+
+  node.matTimesDiagTimesMatTrans(N, 1.0, J, NULL, *_HinvJt);
+  if(node.is_leader()) {
+    double** Nd=N.local_data();
+    for(int i=0; i<k; i++)
+      for(int j=i+1; j<k; j++)
+	Nd[i][j] = Nd[j][i] = 0.5*(Nd[i][j]+Nd[j][i]);
+  }
+  node.sync();
+}
+
+void hiopKKTLinSysStructured::formReducedMatrix(hiopMatrixSymBlockCyclic& N, hiopMatrixDense& J)
+{
+  if(!Hv_avail) { hiopKKTLinSysLowRank::formReducedMatrix(N, J); return; }
+  const int k=J.m();
+  hiopVectorPar *Jrow=Dx->alloc_clone(), *col=Dx->alloc_clone();
+  for(int i=0; i<k; i++) {
+    J.getRow(i, *Jrow);
+    solveWithHessian(*Jrow, *col);
+    _HinvJt->replaceRow(i, *col);
+  }
+  delete Jrow; delete col;
+
+  //symmetrized local contributions, summed directly in the block-cyclic layout
+  N.zeroContributions();
+  N.addContribMatTimesMatTrans(0.5, J, *_HinvJt);
+  N.addContribMatTimesMatTrans(0.5, *_HinvJt, J);
+  N.reduceContributions();
+}
+
+/**************************************************************************
+ * hiopKKTLinSysDense
+ *************************************************************************/
+hiopKKTLinSysDense::hiopKKTLinSysDense(hiopNlpFormulation* nlp_)
+  : hiopKKTLinSysLowRank(nlp_), H_avail(false), H_checked(false), K_factorized(false), K_failed(false), 
+    H(NULL), K(NULL), _JdS(NULL), K_ipiv(NULL), _rhs(NULL), _mi_vec(NULL)
+{
+  if(nlp->get_num_ranks()>1) {
+    nlp->log->printf(hovWarning, "hiopKKTLinSysDense: the exact Hessian mode is not available with more than one rank; "
+		     "the quasi-Newton Hessian is used instead\n");
+    H_checked=true;
+    return;
+  }
+  const long long n=nlp->n(), me=nlp->m_eq();
+  H = new hiopMatrixDense(n,n);
+  K = new hiopMatrixDense(n+me,n+me);
+  _JdS = nlpd->alloc_Jac_d();
+  K_ipiv = new int[n+me>0 ? n+me : 1];
+  _rhs = new hiopVectorPar(n+me);
+  _mi_vec = dynamic_cast<hiopVectorPar*>(ryd_tilde->alloc_clone());
+}
+
+hiopKKTLinSysDense::~hiopKKTLinSysDense()
+{
+  if(H)   delete H;
+  if(K)   delete K;
+  if(_JdS) delete _JdS;
+  if(K_ipiv) delete[] K_ipiv;
+  if(_rhs)    delete _rhs;
+  if(_mi_vec) delete _mi_vec;
+}
+
+bool hiopKKTLinSysDense::
+update(const hiopIterate* iter_, 
+       const hiopVector* grad_f_, 
+       const hiopMatrix* Jac_c_, const hiopMatrix* Jac_d_, 
+       hiopHessianLowRank* Hess_)
+{
+  bool bret = hiopKKTLinSysLowRank::update(iter_, grad_f_, Jac_c_, Jac_d_, Hess_);
+  K_factorized=K_failed=false;
+  if(H_checked && !H_avail) return bret;
+
+  const hiopVectorPar &yc=dynamic_cast<const hiopVectorPar&>(*iter->get_yc()), &yd=dynamic_cast<const hiopVectorPar&>(*iter->get_yd());
+  H_avail = nlpd->eval_Hess_Lagr(dynamic_cast<const hiopVectorPar*>(iter->get_x())->local_data_const(), true, yc, yd, H->local_data());
+  if(!H_checked && !H_avail)
+    nlp->log->printf(hovWarning, "hiopKKTLinSysDense: no Hessian of the Lagrangian from the user (eval_Hess_Lagr); "
+		     "the quasi-Newton Hessian is used instead\n");
+  assert(H_avail || !H_checked);
+  H_checked=true;
+  return bret;
+}
+
+int hiopKKTLinSysDense::factorizeK(double delta_w, double delta_c)
+{
+  const int n=H->m(), me=nlp->m_eq(), mi=nlp->m_ineq(), N=n+me;
+  double **Kd=K->local_data(), **Hd=H->local_data(), **Jc=Jac_c->local_data();
+  const double* dx=Dx->local_data_const();
+  for(int i=0; i<n; i++) {
+    memcpy(Kd[i], Hd[i], n*sizeof(double));
+    Kd[i][i] += dx[i]+delta_w;
+  }
+  for(int i=0; i<me; i++) {
+    for(int j=0; j<n; j++) Kd[n+i][j] = Kd[j][n+i] = Jc[i][j];
+    for(int j=0; j<me; j++) Kd[n+i][n+j] = (i==j ? -delta_c : 0.);
+  }
+  //K(1:n,1:n) += (Dd^{1/2}*Jd)^T*(Dd^{1/2}*Jd); in Fortran JdS is the nxmi matrix JdS^T
+  if(mi>0) {
+    char transA='N', transB='T'; double one=1.; int ldk=N, ldj=n, mi_=mi, n_=n;
+    DGEMM(&transA, &transB, &n_, &n_, &mi_, &one, _JdS->local_buffer(), &ldj, _JdS->local_buffer(), &ldj, 
+	  &one, K->local_buffer(), &ldk);
+  }
+
+  char uplo='L'; int lda=N, lwork=-1, info; double work_tmp;
+  int N_=N;
+  DSYTRF(&uplo, &N_, K->local_buffer(), &lda, K_ipiv, &work_tmp, &lwork, &info);
+  lwork=(int)work_tmp;
+  std::vector<double> work(lwork>0 ? lwork : 1);
+  DSYTRF(&uplo, &N_, K->local_buffer(), &lda, K_ipiv, &work[0], &lwork, &info);
+  if(info<0) {
+    nlp->log->printf(hovError, "hiopKKTLinSysDense::factorizeK error: %d argument to dsytrf has an illegal value\n", -info);
+    return -1;
+  }
+  if(info>0) return -1;
+  return hiopHessianLowRank::negEigenvaluesFromFactors(*K, K_ipiv);
+}
+
+/* Solves the compressed system by eliminating dyd, see the class description. */
+bool hiopKKTLinSysDense::solveCompressed(hiopVectorPar& rx, hiopVectorPar& ryc, hiopVectorPar& ryd,
+					 hiopVectorPar& dx, hiopVectorPar& dyc, hiopVectorPar& dyd)
+{
+  if(!H_avail || K_failed)
+    return hiopKKTLinSysLowRank::solveCompressed(rx, ryc, ryd, dx, dyc, dyd);
+
+  hiopTimeScope scope(nlp->runStats.profile, tpNSolve);
+  if(!K_factorized) {
+    //Dd^{1/2}*Jd
+    const int mi=nlp->m_ineq();
+    if(mi>0) {
+      _JdS->copyFrom(*Jac_d);
+      const double* ddinv=Dd_inv->local_data_const();
+      double** J=_JdS->local_data();
+      const long long n_local=_JdS->get_local_size_n();
+      for(int k=0; k<mi; k++) {
+	const double s=1./sqrt(ddinv[k]);
+	for(long long j=0; j<n_local; j++) J[k][j] *= s;
+      }
+    }
+    //the inertia is (n, m_eq, 0); delta_c is needed only when K is singular
+    K_factorized = factorizeWithInertiaCorrection(nlp->m_eq(), false);
+    if(!K_factorized) {
+      nlp->log->printf(hovWarning, "hiopKKTLinSysDense: the quasi-Newton Hessian is used until the next update\n");
+      K_failed=true;
+      return false;
+    }
+  }
+  const int n=H->m(), me=nlp->m_eq();
+
+  //rhs = [rx+Jd^T*Dd*ryd; ryc]
+  hiopVectorPar& Ddryd=*_mi_vec;
+  Ddryd.copyFrom(ryd);
+  Ddryd.componentDiv(*Dd_inv);
+  Jac_d->transTimesVec(1.0, rx, 1.0, Ddryd);
+  hiopVectorPar& rhs=*_rhs;
+  rhs.copyFromStarting(rx, 0);
+  rhs.copyFromStarting(ryc, n);
+
+  char uplo='L'; int N=n+me, lda=N, one=1, info;
+  DSYTRS(&uplo, &N, &one, K->local_buffer(), &lda, K_ipiv, rhs.local_data(), &N, &info);
+  if(info<0) {
+    nlp->log->printf(hovError, "hiopKKTLinSysDense::solveCompressed: dsytrs returned error %d\n", info);
+    return false;
+  }
+
+  rhs.copyToStarting(dx, 0);
+  rhs.copyToStarting(dyc, n);
+  //dyd = Dd*(Jd*dx-ryd)
+  dyd.copyFrom(ryd);
+  Jac_d->timesVec(-1.0, dyd, 1.0, dx);
+  dyd.componentDiv(*Dd_inv);
+  return true;
+}
+
+/**************************************************************************
+ * hiopKKTLinSysSparse
+ *************************************************************************/
+hiopKKTLinSysSparse::hiopKKTLinSysSparse(hiopNlpFormulation* nlp_)
+  : hiopKKTLinSys(nlp_), Jac_c_sp(NULL), Jac_d_sp(NULL), K_factorized(false), K_failed(false)
+{
+  nlps = dynamic_cast<hiopNlpSparse*>(nlp_);
+  assert(nlps!=NULL);
+  H = nlps->alloc_Hess_Lagr();
+  hiopMatrixSparse *Jc=nlps->alloc_Jac_c(), *Jd=nlps->alloc_Jac_d();
+  buildPattern(*Jc, *Jd);
+  delete Jc; delete Jd;
+
+  const int N=nlp->n()+nlp->m_eq()+nlp->m_ineq();
+  linsys = new hiopLinSolverSymSparse();
+  hiopTimer t; t.start();
+  linsys->analyze(N, K_irow, K_jcol);
+  t.stop();
+  nlp->log->printf(hovSummary, "hiopKKTLinSysSparse: KKT of size %d with %d nonzeros (lower triangle); "
+		   "%lld nonzeros in the factors, %d supernodes; analysis took %g sec\n", 
+		   N, K_irow[N], linsys->get_nnz_factors(), linsys->get_num_supernodes(), t.getElapsedTime());
+  _rhs = new hiopVectorPar(N);
+}
+
+hiopKKTLinSysSparse::~hiopKKTLinSysSparse()
+{
+  if(H) delete H;
+  if(linsys) delete linsys;
+  if(K_irow) delete[] K_irow;
+  if(K_jcol) delete[] K_jcol;
+  if(K_vals) delete[] K_vals;
+  if(H_pos)  delete[] H_pos;
+  if(Jc_pos) delete[] Jc_pos;
+  if(Jd_pos) delete[] Jd_pos;
+  if(diag_pos) delete[] diag_pos;
+  if(_rhs) delete _rhs;
+}
+
+/* The rows of K are the rows of H (strictly lower part), Jc, and Jd, each followed by the diagonal entry. 
+ * The column indexes are sorted within each row since the ones of the CSR matrices are. */
+void hiopKKTLinSysSparse::buildPattern(const hiopMatrixSparse& Jc, const hiopMatrixSparse& Jd)
+{
+  const int n=nlp->n(), me=nlp->m_eq(), mi=nlp->m_ineq(), N=n+me+mi;
+  //upper bound: the diagonal entries of H are merged with the ones of K
+  const int nnz=H->nnz()+Jc.nnz()+Jd.nnz()+N;
+  K_irow = new int[N+1]; K_jcol = new int[nnz]; K_vals = new double[nnz];
+  H_pos  = new int[H->nnz()>0 ? H->nnz() : 1];
+  Jc_pos = new int[Jc.nnz()>0 ? Jc.nnz() : 1];
+  Jd_pos = new int[Jd.nnz()>0 ? Jd.nnz() : 1];
+  diag_pos = new int[N>0 ? N : 1];
+
+  const int *hi=H->get_irow(), *hj=H->get_jcol();
+  int pos=0;
+  for(int i=0; i<n; i++) {
+    K_irow[i]=pos;
+    for(int k=hi[i]; k<hi[i+1]; k++) {
+      assert(hj[k]<=i);
+      if(hj[k]<i) { K_jcol[pos]=hj[k]; H_pos[k]=pos++; }
+    }
+    diag_pos[i]=pos; K_jcol[pos++]=i;
+    //the diagonal entries of H are added to the diagonal of K
+    for(int k=hi[i]; k<hi[i+1]; k++) if(hj[k]==i) H_pos[k]=diag_pos[i];
+  }
+  const hiopMatrixSparse* J[2] = {&Jc, &Jd};
+  int* Jpos[2] = {Jc_pos, Jd_pos};
+  int row=n;
+  for(int b=0; b<2; b++) {
+    const int *ji=J[b]->get_irow(), *jj=J[b]->get_jcol();
+    for(int r=0; r<J[b]->m(); r++, row++) {
+      K_irow[row]=pos;
+      for(int k=ji[r]; k<ji[r+1]; k++) { K_jcol[pos]=jj[k]; Jpos[b][k]=pos++; }
+      diag_pos[row]=pos; K_jcol[pos++]=row;
+    }
+  }
+  assert(row==N);
+  K_irow[N]=pos;
+  assert(pos<=nnz);
+}
+
+bool hiopKKTLinSysSparse::
+update(const hiopIterate* iter_, 
+       const hiopVector* grad_f_, 
+       const hiopMatrix* Jac_c_, const hiopMatrix* Jac_d_, 
+       hiopHessianLowRank* Hess_)
+{
+  nlp->runStats.tmSolverInternal.start();
+  iter=iter_;
+  updateDiagonals();
+  nlp->runStats.tmSolverInternal.stop();
+  Jac_c_sp = dynamic_cast<const hiopMatrixSparse*>(Jac_c_);
+  Jac_d_sp = dynamic_cast<const hiopMatrixSparse*>(Jac_d_);
+  assert(Jac_c_sp!=NULL && Jac_d_sp!=NULL);
+  K_factorized=K_failed=false;
+
+  const hiopVectorPar &yc=dynamic_cast<const hiopVectorPar&>(*iter->get_yc()), &yd=dynamic_cast<const hiopVectorPar&>(*iter->get_yd());
+  if(!nlps->eval_Hess_Lagr(dynamic_cast<const hiopVectorPar*>(iter->get_x())->local_data_const(), true, yc, yd, *H)) {
+    nlp->log->printf(hovError, "hiopKKTLinSysSparse: error in the evaluation of the Hessian of the Lagrangian\n");
+    return false;
+  }
+  return true;
+}
+
+int hiopKKTLinSysSparse::factorizeK(double delta_w, double delta_c)
+{
+  const int n=nlp->n(), me=nlp->m_eq(), mi=nlp->m_ineq();
+  memset(K_vals, 0, K_irow[n+me+mi]*sizeof(double));
+
+  const double* hv=H->get_values();
+  for(int k=0; k<H->nnz(); k++) K_vals[H_pos[k]] += hv[k];
+  const double* dx=Dx->local_data_const();
+  for(int i=0; i<n; i++) K_vals[diag_pos[i]] += dx[i]+delta_w;
+
+  const double* jv=Jac_c_sp->get_values();
+  for(int k=0; k<Jac_c_sp->nnz(); k++) K_vals[Jc_pos[k]] = jv[k];
+  for(int i=0; i<me; i++) K_vals[diag_pos[n+i]] = -delta_c;
+
+  jv=Jac_d_sp->get_values();
+  for(int k=0; k<Jac_d_sp->nnz(); k++) K_vals[Jd_pos[k]] = jv[k];
+  const double* ddinv=Dd_inv->local_data_const();
+  for(int i=0; i<mi; i++) K_vals[diag_pos[n+me+i]] = -ddinv[i]-delta_c;
+
+  return linsys->factorize(K_vals);
+}
+
+bool hiopKKTLinSysSparse::solveCompressed(hiopVectorPar& rx, hiopVectorPar& ryc, hiopVectorPar& ryd,
+					  hiopVectorPar& dx, hiopVectorPar& dyc, hiopVectorPar& dyd)
+{
+  if(K_failed) return false;
+  hiopTimeScope scope(nlp->runStats.profile, tpNSolve);
+  if(!K_factorized) {
+    /* the inertia is (n, m_eq+m_ineq, 0); with static pivots, a zero pivot of the constraint block (e.g., of a Jc 
+     * row with no overlap with the factorized columns) would be reported as a singular K, so delta_c>0 is used */
+    K_factorized = factorizeWithInertiaCorrection(nlp->m_eq()+nlp->m_ineq(), true);
+    if(!K_factorized) {
+      K_failed=true;
+      return false;
+    }
+  }
+  const int n=nlp->n(), me=nlp->m_eq();
+  hiopVectorPar& rhs=*_rhs;
+  rhs.copyFromStarting(rx, 0);
+  rhs.copyFromStarting(ryc, n);
+  rhs.copyFromStarting(ryd, n+me);
+
+  linsys->solve(rhs.local_data());
+
+  rhs.copyToStarting(dx, 0);
+  rhs.copyToStarting(dyc, n);
+  rhs.copyToStarting(dyd, n+me);
+  return true;
+}
+
+/**************************************************************************
+ * hiopKKTLinSysBlock
+ *************************************************************************/
+hiopKKTLinSysBlock::hiopKKTLinSysBlock(hiopNlpFormulation* nlp_)
+  : hiopKKTLinSysLowRank(nlp_), Jac_c_b(NULL), Jac_d_b(NULL), factorized(false)
+{
+  nlpb = dynamic_cast<hiopNlpBlockConstraints*>(nlp_);
+  assert(nlpb!=NULL);
+  _R=_RD=_F1=_F2=_A=_Bt=_Zt=_S=NULL;
+  _S_ipiv=NULL;
+  _bc = dynamic_cast<hiopVectorPar*>(nlp->alloc_dual_eq_vec());
+  _bd = dynamic_cast<hiopVectorPar*>(nlp->alloc_dual_ineq_vec());
+  _w=_h=NULL;
+}
+
+hiopKKTLinSysBlock::~hiopKKTLinSysBlock()
+{
+  if(_R)  delete _R;
+  if(_RD) delete _RD;
+  if(_F1) delete _F1;
+  if(_F2) delete _F2;
+  if(_A)  delete _A;
+  if(_Bt) delete _Bt;
+  if(_Zt) delete _Zt;
+  if(_S)  delete _S;
+  if(_S_ipiv) delete[] _S_ipiv;
+  if(_bc) delete _bc;
+  if(_bd) delete _bd;
+  if(_w)  delete _w;
+  if(_h)  delete _h;
+}
+
+bool hiopKKTLinSysBlock::
+update(const hiopIterate* iter_, 
+       const hiopVector* grad_f_, 
+       const hiopMatrix* Jac_c_, const hiopMatrix* Jac_d_, 
+       hiopHessianLowRank* Hess_)
+{
+  bool bret = hiopKKTLinSysLowRank::update(iter_, grad_f_, Jac_c_, Jac_d_, Hess_);
+  Jac_c_b = dynamic_cast<const hiopMatrixDenseLocalRows*>(Jac_c_);
+  Jac_d_b = dynamic_cast<const hiopMatrixDenseLocalRows*>(Jac_d_);
+  assert(Jac_c_b!=NULL && Jac_d_b!=NULL);
+  assert(Hess!=NULL);
+  factorized=false;
+  return bret;
+}
+
+//reallocates M if its size is not mxn
+static void resizeMat(hiopMatrixDense*& M, long long m, long long n)
+{
+  if(M && M->m()==m && M->n()==n) return;
+  if(M) delete M;
+  M = new hiopMatrixDense(m, n);
+}
+
+bool hiopKKTLinSysBlock::factorize()
+{
+  hiopTimeScope scope(nlp->runStats.profile, tpNFactor);
+  const hiopMatrixDense &Jcg=Jac_c_b->get_glob_block(), &Jdg=Jac_d_b->get_glob_block();
+  const hiopMatrixDense &Jcl=Jac_c_b->get_local_block(), &Jdl=Jac_d_b->get_local_block();
+  const int mgc=Jcg.m(), mgd=Jdg.m(), mg=mgc+mgd, mlc=Jcl.m(), mld=Jdl.m(), ml=mlc+mld, mr=mg+ml;
+  const int nloc=Jcg.get_local_size_n(), ld=nloc>0 ? nloc : 1;
+  int rank=0;
+#ifdef WITH_MPI
+  rank=nlp->get_rank();
+#endif
+
+  hiopMatrixDense *Pt=NULL, *V=NULL;
+  Hess->lowRankInverse(Pt, V);
+  const int q=Pt->m(), s=mg+q;
+  const double* dh=Hess->get_DhInv().local_data_const();
+  const double* ddinv=Dd_inv->local_data_const();
+
+  //R=[Jg; Jl] and RD=R*DhInv 
+  resizeMat(_R, mr, nloc); resizeMat(_RD, mr, nloc);
+  double **R=_R->local_data(), **RD=_RD->local_data();
+  const hiopMatrixDense* blocks[] = {&Jcg, &Jdg, &Jcl, &Jdl};
+  for(int b=0, row=0; b<4; row+=blocks[b]->m(), b++) //!opt
+    if(blocks[b]->m()>0 && nloc>0) memcpy(R[row], blocks[b]->local_buffer(), blocks[b]->m()*nloc*sizeof(double));
+  for(int i=0; i<mr; i++)
+    for(int p=0; p<nloc; p++) RD[i][p]=R[i][p]*dh[p];
+
+  //F1=RD*R^T and F2=R*Pt^T (row-major, hence the transposes for dgemm)
+  resizeMat(_F1, mr, mr); resizeMat(_F2, mr, q);
+  char transA='T', transB='N'; double one=1., zero=0., mone=-1.;
+  int mr_=mr, q_=q;
+  if(mr>0) 
+    DGEMM(&transA, &transB, &mr_, &mr_, const_cast<int*>(&nloc), &one, _R->local_buffer(), const_cast<int*>(&ld), 
+	  _RD->local_buffer(), const_cast<int*>(&ld), &zero, _F1->local_buffer(), &mr_);
+  if(mr>0 && q>0)
+    DGEMM(&transA, &transB, &q_, &mr_, const_cast<int*>(&nloc), &one, Pt->local_buffer(), const_cast<int*>(&ld), 
+	  _R->local_buffer(), const_cast<int*>(&ld), &zero, _F2->local_buffer(), &q_);
+  double **F1=_F1->local_data(), **F2=_F2->local_data();
+
+  //A=Jl*DhInv*Jl^T+El, Bt=[Cg Gl]^T, and Zt=Bt
+  resizeMat(_A, ml, ml); resizeMat(_Bt, s, ml); resizeMat(_Zt, s, ml);
+  double **A=_A->local_data(), **Bt=_Bt->local_data();
+  const long long ineq_start=mgd+Jac_d_b->get_row_distrib()[rank];
+  for(int i=0; i<ml; i++) {
+    for(int j=0; j<ml; j++) A[i][j]=F1[mg+i][mg+j];
+    if(i>=mlc) A[i][i] += ddinv[ineq_start+i-mlc];
+    for(int j=0; j<mg; j++) Bt[j][i]=F1[mg+i][j];
+    for(int k=0; k<q; k++)  Bt[mg+k][i]=F2[mg+i][k];
+  }
+  _Zt->copyFrom(*_Bt);
+
+  //Zt = (inv(A)*B)^T
+  int info=0, ml_=ml, s_=s;
+  char uplo='L';
+  int failed=0;
+  if(ml>0) {
+    DPOTRF(&uplo, &ml_, _A->local_buffer(), &ml_, &info);
+    if(info>0) {
+      nlp->log->printf(hovError, "hiopKKTLinSysBlock: the local block is not positive definite (dpotrf minor %d); "
+		       "are the local equality constraints linearly dependent?\n", info);
+      failed=1;
+    } else {
+      assert(info==0);
+      if(s>0) { DPOTRS(&uplo, &ml_, &s_, _A->local_buffer(), &ml_, _Zt->local_buffer(), &ml_, &info); assert(info==0); }
+    }
+  }
+  //all the ranks fail together, before the reduction of S
+#ifdef WITH_MPI
+  int ierr = MPI_Allreduce(MPI_IN_PLACE, &failed, 1, MPI_INT, MPI_MAX, nlp->get_comm()); assert(MPI_SUCCESS==ierr);
+#endif
+  if(failed) return false;
+
+  //S = [Kgg Gg; Gg^T 0] - Bt*Zt^T on each rank, then summed
+  resizeMat(_S, s, s);
+  double** S=_S->local_data();
+  _S->setToZero();
+  for(int i=0; i<mg; i++) {
+    for(int j=0; j<mg; j++) S[i][j]=F1[i][j];
+    for(int k=0; k<q; k++) S[i][mg+k]=S[mg+k][i]=F2[i][k];
+  }
+  if(ml>0 && s>0) 
+    DGEMM(&transA, &transB, &s_, &s_, &ml_, &mone, _Zt->local_buffer(), &ml_, _Bt->local_buffer(), &ml_, 
+	  &one, _S->local_buffer(), &s_);
+#ifdef WITH_MPI
+  if(s>0) {
+    ierr = MPI_Allreduce(MPI_IN_PLACE, _S->local_buffer(), s*s, MPI_DOUBLE, MPI_SUM, nlp->get_comm()); 
+    assert(MPI_SUCCESS==ierr);
+  }
+#endif
+  //the diagonal Eg of the global ineq and the middle matrix V of the Hessian
+  for(int i=mgc; i<mg; i++) S[i][i] += ddinv[i-mgc];
+  double** Vd=V->local_data();
+  for(int k=0; k<q; k++)
+    for(int k2=0; k2<q; k2++) S[mg+k][mg+k2] += Vd[k][k2];
+
+  if(_S_ipiv) delete[] _S_ipiv;
+  _S_ipiv = new int[s>0 ? s : 1];
+  if(s>0) {
+    int lwork=-1; double work_tmp;
+    DSYTRF(&uplo, &s_, _S->local_buffer(), &s_, _S_ipiv, &work_tmp, &lwork, &info);
+    lwork=(int)work_tmp;
+    std::vector<double> work(lwork>0 ? lwork : 1);
+    DSYTRF(&uplo, &s_, _S->local_buffer(), &s_, _S_ipiv, &work[0], &lwork, &info);
+    if(info>0) {
+      nlp->log->printf(hovError, "hiopKKTLinSysBlock: the Schur complement is singular (dsytrf %d)\n", info);
+      return false;
+    }
+    assert(info==0);
+  }
+  if(NULL==_w || _w->get_size()!=ml) { if(_w) delete _w; _w=new hiopVectorPar(ml); }
+  if(NULL==_h || _h->get_size()!=s)  { if(_h) delete _h; _h=new hiopVectorPar(s); }
+  nlp->log->printf(hovLinAlgScalars, "hiopKKTLinSysBlock: local block of size %d, Schur complement of size %d\n", ml, s);
+  return true;
+}
+
+void hiopKKTLinSysBlock::gatherLocal(const double* yl, const hiopMatrixDenseLocalRows& J, hiopVectorPar& y)
+{
+  const long long mg=J.m_glob_rows();
+  const long long* distrib=J.get_row_distrib();
+#ifdef WITH_MPI
+  const int nranks=nlp->get_num_ranks();
+  std::vector<int> counts(nranks), displs(nranks);
+  for(int r=0; r<nranks; r++) { counts[r]=(int)(distrib[r+1]-distrib[r]); displs[r]=(int)distrib[r]; }
+  const int rank=nlp->get_rank();
+  int ierr = MPI_Allgatherv(const_cast<double*>(yl), counts[rank], MPI_DOUBLE, y.local_data()+mg, &counts[0], &displs[0],
+			    MPI_DOUBLE, nlp->get_comm()); 
+  assert(MPI_SUCCESS==ierr);
+#else
+  if(distrib[1]>0) memcpy(y.local_data()+mg, yl, distrib[1]*sizeof(double));
+#endif
+}
+
+/* rhs [bg; bl] = J*(H+Dx)^{-1}*rx - [ryc; ryd] and, with u=[yg; t] and B=[Cg Gl], 
+ *   u  = inv(S)*([bg; 0] - sum over ranks of Bt*inv(A)*bl)
+ *   yl = inv(A)*bl - Zt^T*u
+ * then dx = (H+Dx)^{-1}*(rx - Jc^T*dyc - Jd^T*dyd) */
+bool hiopKKTLinSysBlock::solveCompressed(hiopVectorPar& rx, hiopVectorPar& ryc, hiopVectorPar& ryd,
+					 hiopVectorPar& dx, hiopVectorPar& dyc, hiopVectorPar& dyd)
+{
+  hiopTimeScope scope(nlp->runStats.profile, tpNSolve);
+  if(!factorized) {
+    factorized = factorize();
+    if(!factorized) return false;
+  }
+  const int mgc=Jac_c_b->m_glob_rows(), mgd=Jac_d_b->m_glob_rows();
+  const int mlc=Jac_c_b->get_local_block().m(), mld=Jac_d_b->get_local_block().m(), ml=mlc+mld;
+  const int s=_h->get_size();
+  int rank=0;
+#ifdef WITH_MPI
+  rank=nlp->get_rank();
+#endif
+
+  solveWithHessian(rx, dx);
+  _bc->copyFrom(ryc); Jac_c_b->timesVec(-1.0, *_bc, 1.0, dx);
+  _bd->copyFrom(ryd); Jac_d_b->timesVec(-1.0, *_bd, 1.0, dx);
+  const double *bc=_bc->local_data_const(), *bd=_bd->local_data_const();
+
+  //w = inv(A)*bl
+  double *w=_w->local_data(), *h=_h->local_data();
+  memcpy(w,     bc+mgc+Jac_c_b->get_row_distrib()[rank], mlc*sizeof(double));
+  memcpy(w+mlc, bd+mgd+Jac_d_b->get_row_distrib()[rank], mld*sizeof(double));
+  char uplo='L', trans='T', notrans='N'; 
+  int ml_=ml, s_=s, ione=1, info=0; 
+  double one=1., zero=0., mone=-1.;
+  if(ml>0) { DPOTRS(&uplo, &ml_, &ione, _A->local_buffer(), &ml_, w, &ml_, &info); assert(info==0); }
+
+  //h = [bg; 0] - sum Bt*w
+  if(ml>0 && s>0) DGEMV(&trans, &ml_, &s_, &mone, _Bt->local_buffer(), &ml_, w, &ione, &zero, h, &ione);
+  else _h->setToZero();
+#ifdef WITH_MPI
+  if(s>0) {
+    int ierr = MPI_Allreduce(MPI_IN_PLACE, h, s, MPI_DOUBLE, MPI_SUM, nlp->get_comm()); assert(MPI_SUCCESS==ierr);
+  }
+#endif
+  for(int i=0; i<mgc; i++) h[i] += bc[i];
+  for(int i=0; i<mgd; i++) h[mgc+i] += bd[i];
+
+  //u = inv(S)*h and yl = w - Zt^T*u
+  if(s>0) { DSYTRS(&uplo, &s_, &ione, _S->local_buffer(), &s_, _S_ipiv, h, &s_, &info); assert(info==0); }
+  if(ml>0 && s>0) DGEMV(&notrans, &ml_, &s_, &mone, _Zt->local_buffer(), &ml_, h, &ione, &one, w, &ione);
+
+  memcpy(dyc.local_data(), h,     mgc*sizeof(double));
+  memcpy(dyd.local_data(), h+mgc, mgd*sizeof(double));
+  gatherLocal(w,     *Jac_c_b, dyc);
+  gatherLocal(w+mlc, *Jac_d_b, dyd);
+
+  //dx = (H+Dx)^{-1}*(rx - Jc^T*dyc - Jd^T*dyd)
+  Jac_c_b->transTimesVec(1.0, rx, -1.0, dyc);
+  Jac_d_b->transTimesVec(1.0, rx, -1.0, dyd);
+  solveWithHessian(rx, dx);
+  return true;
+}
+
+};
@@ -52,6 +52,8 @@
 #include "hiopIterate.hpp"
 #include "hiopResidual.hpp"
 #include "hiopHessianLowRank.hpp"
+#include "hiopLinSolverSymSparse.hpp"
+#include "hiopMatrixSymBlockCyclic.hpp"
 
 namespace hiop
 {
@@ -59,15 +61,55 @@ namespace hiop
 class hiopKKTLinSys 
 {
 public:
+  hiopKKTLinSys(hiopNlpFormulation* nlp_);
+  virtual ~hiopKKTLinSys();
   /* updates the parts in KKT system that are dependent on the iterate. 
    * It may trigger a refactorization for direct linear systems, or it may not do 
    * anything, for example, LowRank linear system */
   virtual bool update(const hiopIterate* iter, 
 		      const hiopVector* grad_f, 
-		      const hiopMatrixDense* Jac_c, const hiopMatrixDense* Jac_d, 
+		      const hiopMatrix* Jac_c, const hiopMatrix* Jac_d, 
 		      hiopHessianLowRank* Hess)=0;
-  virtual bool computeDirections(const hiopResidual* resid, hiopIterate* direction)=0;
-  virtual ~hiopKKTLinSys() {}
+  /* reduces the Newton system to the compressed system, which is solved by 'solveCompressed', and computes 
+   * the remaining directions; returns false if the compressed system could not be solved */
+  virtual bool computeDirections(const hiopResidual* resid, hiopIterate* direction);
+  //whether the system uses the exact Hessian of the Lagrangian instead of the quasi-Newton one
+  virtual bool exactHessian() const { return false; }
+
+  /* Solves the system corresponding to directions for x, yc, and yd, namely
+   * [ H + Dx   Jc^T  Jd^T   ] [ dx]   [ rx_tilde ]
+   * [    Jc     0     0     ] [dyc] = [   ryc    ]
+   * [    Jd     0   -Dd^{-1}] [dyd]   [ ryd_tilde]
+   * Returns false if the system could not be solved.
+   */
+  virtual bool solveCompressed(hiopVectorPar& rx, hiopVectorPar& ryc, hiopVectorPar& ryd,
+			       hiopVectorPar& dx, hiopVectorPar& dyc, hiopVectorPar& dyd)=0;
+#ifdef DEEP_CHECKING
+  //errors of the solutions of the Newton and compressed systems; used only for correctness checking
+  virtual double errorKKT(const hiopResidual* resid, const hiopIterate* sol) { return 0.; }
+  virtual double errorCompressedLinsys(const hiopVectorPar& rx, const hiopVectorPar& ryc, const hiopVectorPar& ryd,
+				       const hiopVectorPar& dx, const hiopVectorPar& dyc, const hiopVectorPar& dyd) 
+  { return 0.; }
+#endif
+protected:
+  //computes Dx and Dd^{-1} at 'iter'; called by 'update'
+  void updateDiagonals();
+  /* for the systems with the exact Hessian: assembles and factorizes K with the regularizations delta_w*I of 
+   * the Hessian block and -delta_c*I of the constraints' block; returns the number of negative eigenvalues 
+   * or -1 if K is singular */
+  virtual int factorizeK(double delta_w, double delta_c) { return -1; }
+  /* inertia correction similar to the one of Ipopt: delta_w starts from a fraction of the last correction 
+   * (or from delta_w_0) and is increased geometrically until K has 'nneg' negative eigenvalues. delta_c is
+   * used when K is singular or, if 'quasi_definite', always (when nneg>0). Returns false if no delta_w works */
+  bool factorizeWithInertiaCorrection(int nneg, bool quasi_definite);
+protected:
+  hiopNlpFormulation* nlp;
+  const hiopIterate* iter;
+  hiopVectorPar *Dx, *Dd_inv;
+  //internal buffers
+  hiopVectorPar *rx_tilde, *ryd_tilde;
+private:
+  double delta_w_last;
 };
 
 class hiopKKTLinSysLowRank : public hiopKKTLinSys
@@ -78,16 +120,14 @@ public:
 
   virtual bool update(const hiopIterate* iter, 
 		      const hiopVector* grad_f, 
-		      const hiopMatrixDense* Jac_c, const hiopMatrixDense* Jac_d, 
+		      const hiopMatrix* Jac_c, const hiopMatrix* Jac_d, 
 		      hiopHessianLowRank* Hess);
-  virtual bool computeDirections(const hiopResidual* resid, hiopIterate* direction);
 
-  /* Solves the system corresponding to directions for x, yc, and yd, namely
-   * [ H_BFGS + Dx   Jc^T  Jd^T   ] [ dx]   [ rx_tilde ]
-   * [    Jc          0     0     ] [dyc] = [   ryc    ]
-   * [    Jd          0   -Dd^{-1}] [dyd]   [ ryd_tilde]
+  /* Solves the compressed system with H=H_BFGS. The reduced matrix N is formed and factorized only at the first
+   * call after 'update'; subsequent calls (e.g., second-order correction steps) reuse the factorization with a 
+   * new right-hand side.
    */
-  virtual void solveCompressed(hiopVectorPar& rx, hiopVectorPar& ryc, hiopVectorPar& ryd,
+  virtual bool solveCompressed(hiopVectorPar& rx, hiopVectorPar& ryc, hiopVectorPar& ryd,
 			       hiopVectorPar& dx, hiopVectorPar& dyc, hiopVectorPar& dyd);
 
   //int factorizeMat(hiopMatrixDense& M);
@@ -96,31 +136,227 @@ public:
   //LAPACK wrappers
   int solve(hiopMatrixDense& M, hiopVectorPar& rhs);
   int solveWithRefin(hiopMatrixDense& M, hiopVectorPar& rhs);
+  //solves with N using the Cholesky factors from a previous call, with iterative refinement
+  int solveWithFactors(hiopVectorPar& rhs);
 #ifdef DEEP_CHECKING
   static double solveError(const hiopMatrixDense& M,  const hiopVectorPar& x, hiopVectorPar& rhs);
 
   //computes the solve error for the KKT Linear system; used only for correctness checking
-  double errorKKT(const hiopResidual* resid, const hiopIterate* sol);
-  double errorCompressedLinsys(const hiopVectorPar& rx, const hiopVectorPar& ryc, const hiopVectorPar& ryd,
+  virtual double errorKKT(const hiopResidual* resid, const hiopIterate* sol);
+  virtual double errorCompressedLinsys(const hiopVectorPar& rx, const hiopVectorPar& ryc, const hiopVectorPar& ryd,
 			       const hiopVectorPar& dx, const hiopVectorPar& dyc, const hiopVectorPar& dyd);
 #endif
-private:
-  const hiopIterate* iter;
+protected:
+  /* x = (H+Dx)^{-1}*r and N = J*(H+Dx)^{-1}*J^T; done in closed form by the low-rank Hessian */
+  virtual void solveWithHessian(const hiopVectorPar& r, hiopVectorPar& x) { Hess->solve(r, x); }
+  virtual void formReducedMatrix(hiopMatrixDense& N, hiopMatrixDense& J) 
+  { 
+    Hess->symMatTimesInverseTimesMatTrans(0.0, N, 1.0, J); 
+  }
+  /* same as above, with N distributed (option 'dist_reduced_mat_min_size') */
+  virtual void formReducedMatrix(hiopMatrixSymBlockCyclic& N, hiopMatrixDense& J) 
+  { 
+    Hess->symMatTimesInverseTimesMatTrans(N, 1.0, J); 
+  }
+  /* same as above, with N shared by the ranks of the node (option 'node_shared_reduced_mats') */
+  virtual void formReducedMatrix(hiopNodeComm& node, hiopMatrixDense& N, hiopMatrixDense& J) 
+  { 
+    Hess->symMatTimesInverseTimesMatTrans(node, N, 1.0, J); 
+  }
+protected:
   const hiopVectorPar* grad_f;
   const hiopMatrixDense *Jac_c, *Jac_d;
   hiopHessianLowRank* Hess;
 
-  hiopNlpDenseConstraints* nlp;
+  hiopNlpDenseConstraints* nlpd; //NULL for the block formulation
 
-  hiopMatrixDense* N; //the kxk reduced matrix
+  hiopMatrixDense* N; //the kxk reduced matrix (not allocated for the block formulation)
+  hiopMatrixDense* Nref;  //copy of N, used in the iterative refinement
+  hiopMatrixDense* Nfact; //Cholesky factors of N, computed on demand and reused across solves
+  //the factors computed by dposvx are of diag(Nscale)*N*diag(Nscale) when Nequed is 'Y' (equilibration)
+  double* Nscale;
+  char Nequed;
+  //N and its factors in the 2D block-cyclic layout when N is distributed; N, Nref, and Nfact are then NULL
+  hiopMatrixSymBlockCyclic *Ndist, *Ndist_fact;
+  //with node-shared reduced matrices, N is formed directly in Nref, and Nref and Nfact are over the node-shared 
+  //buffers below; N is then NULL
+  hiopNodeComm* node;
+  double *Nref_buf, *Nfact_buf;
+  bool N_formed, Nfact_valid;
 #ifdef DEEP_CHECKING
   hiopMatrixDense* Nmat; //a copy of the above to compute the residual
 #endif
-  hiopVectorPar *Dx, *Dd_inv;
   //internal buffers
-  hiopVectorPar *rx_tilde, *ryd_tilde;
   hiopMatrixDense* _kxn_mat; //!opt (work directly with the Jacobian)
   hiopVectorPar* _k_vec1;
+private:
+  //factorizes Nref in Nfact; returns the info of dpotrf
+  int factorizeN();
+  //iterative refinement of the solution x of N*x=rhs using the factors in Nfact
+  void iterRefin(const hiopVectorPar& rhs, hiopVectorPar& x);
+  //r = N^{-1}*r with the factors in Nfact (or Ndist_fact); returns the info of dpotrs
+  int solveWithNfact(hiopVectorPar& r);
+};
+
+/* KKT linear system for the structured Hessian mode (option 'hessian_mode'), in which H=Hf+B, where Hf is the 
+ * exact Hessian of the objective, available only through products with vectors (eval_Hess_f_vec), and B is the 
+ * secant approximation of the constraints' part of the Hessian of the Lagrangian.
+ *
+ * The reduction to the compressed system and the solve with N are the ones of hiopKKTLinSysLowRank; the solves 
+ * with H+Dx are done by preconditioned CG, with the inverse of B+Dx from the low-rank representation as the 
+ * preconditioner. When the user provides eval_Hess_diag (the diagonal of Hf in this mode), it is added to Dx 
+ * in the preconditioner. Without eval_Hess_f_vec, the class falls back to the quasi-Newton Hessian.
+ */
+class hiopKKTLinSysStructured : public hiopKKTLinSysLowRank
+{
+public:
+  hiopKKTLinSysStructured(hiopNlpFormulation* nlp_);
+  virtual ~hiopKKTLinSysStructured();
+
+  virtual bool update(const hiopIterate* iter, 
+		      const hiopVector* grad_f, 
+		      const hiopMatrix* Jac_c, const hiopMatrix* Jac_d, 
+		      hiopHessianLowRank* Hess);
+protected:
+  virtual void solveWithHessian(const hiopVectorPar& r, hiopVectorPar& x);
+  virtual void formReducedMatrix(hiopMatrixDense& N, hiopMatrixDense& J);
+  virtual void formReducedMatrix(hiopMatrixSymBlockCyclic& N, hiopMatrixDense& J);
+  virtual void formReducedMatrix(hiopNodeComm& node, hiopMatrixDense& N, hiopMatrixDense& J);
+private:
+  //y = (Hf+B+Dx)*x
+  void applyHessian(const hiopVectorPar& x, hiopVectorPar& y);
+  double pcg_tol;
+  int pcg_max_iter;
+  //whether the user provides the Hessian-vector products; checked at the first update
+  bool Hv_avail, Hv_checked;
+  bool new_x;
+  //PCG statistics since the last update
+  int pcg_iters, pcg_solves, pcg_negcurv;
+  //PCG work vectors and the preconditioner's diagonal
+  hiopVectorPar *_r, *_z, *_p, *_Ap, *_Dprec;
+  hiopMatrixDense* _HinvJt; //rows are (H+Dx)^{-1}*J^T
+};
+
+/* KKT linear system for the exact Hessian mode (option 'hessian_mode'), in which the user provides the dense 
+ * Hessian of the Lagrangian H (eval_Hess_Lagr). The inequalities are eliminated from the compressed system,
+ * dyd = Dd*(Jd*dx-ryd), and the condensed system
+ * [ H+Dx+Jd^T*Dd*Jd+delta_w*I   Jc^T       ] [ dx]   [ rx+Jd^T*Dd*ryd ]
+ * [        Jc                -delta_c*I    ] [dyc] = [      ryc       ]
+ * is factorized by Bunch-Kaufman (dsytrf). The regularizations delta_w and delta_c are increased from zero
+ * until the inertia is (n, m_eq, 0), that is, until H+Dx is positive definite on the null space of Jc.
+ * Intended for moderate n on one rank; otherwise, or without eval_Hess_Lagr, the class falls back to the 
+ * quasi-Newton Hessian of hiopKKTLinSysLowRank.
+ */
+class hiopKKTLinSysDense : public hiopKKTLinSysLowRank
+{
+public:
+  hiopKKTLinSysDense(hiopNlpFormulation* nlp_);
+  virtual ~hiopKKTLinSysDense();
+
+  virtual bool update(const hiopIterate* iter, 
+		      const hiopVector* grad_f, 
+		      const hiopMatrix* Jac_c, const hiopMatrix* Jac_d, 
+		      hiopHessianLowRank* Hess);
+  virtual bool exactHessian() const { return H_avail; }
+  /* Returns false if the inertia correction fails; the subsequent solves until the next 'update' use the
+   * quasi-Newton system of hiopKKTLinSysLowRank instead. */
+  virtual bool solveCompressed(hiopVectorPar& rx, hiopVectorPar& ryc, hiopVectorPar& ryd,
+			       hiopVectorPar& dx, hiopVectorPar& dyc, hiopVectorPar& dyd);
+private:
+  //assembles the condensed matrix in K and factorizes it
+  virtual int factorizeK(double delta_w, double delta_c);
+  //whether the user provides the Hessian; checked at the first update
+  bool H_avail, H_checked;
+  //K_failed: the inertia correction failed since the last 'update'
+  bool K_factorized, K_failed;
+  hiopMatrixDense *H, *K;
+  hiopMatrixDense* _JdS; //Dd^{1/2}*Jd
+  int* K_ipiv;
+  hiopVectorPar *_rhs, *_mi_vec;
+};
+
+/* KKT linear system for the sparse formulation (hiopNlpSparse), with the exact Hessian of the Lagrangian H 
+ * given by the user. The compressed system
+ * [ H+Dx+delta_w*I   Jc^T         Jd^T              ] [ dx]   [ rx ]
+ * [    Jc          -delta_c*I      0                ] [dyc] = [ ryc]
+ * [    Jd             0       -Dd^{-1}-delta_c*I    ] [dyd]   [ ryd]
+ * is factorized by the sparse LDL^T of hiopLinSolverSymSparse; its ordering and symbolic factorization are 
+ * computed once since the pattern does not change. Since the LDL^T uses static 1x1 pivots, delta_c>0 is always
+ * used: K is then quasi-definite once H+Dx+delta_w*I is positive definite. delta_w is increased by
+ * factorizeWithInertiaCorrection until the inertia is (n, m_eq+m_ineq, 0).
+ */
+class hiopKKTLinSysSparse : public hiopKKTLinSys
+{
+public:
+  hiopKKTLinSysSparse(hiopNlpFormulation* nlp_);
+  virtual ~hiopKKTLinSysSparse();
+
+  virtual bool update(const hiopIterate* iter, 
+		      const hiopVector* grad_f, 
+		      const hiopMatrix* Jac_c, const hiopMatrix* Jac_d, 
+		      hiopHessianLowRank* Hess);
+  virtual bool exactHessian() const { return true; }
+  //returns false if the inertia correction fails (then until the next 'update')
+  virtual bool solveCompressed(hiopVectorPar& rx, hiopVectorPar& ryc, hiopVectorPar& ryd,
+			       hiopVectorPar& dx, hiopVectorPar& dyc, hiopVectorPar& dyd);
+private:
+  //builds the pattern of K (lower triangle by rows) and the positions in it of the entries of H, Jc, and Jd
+  void buildPattern(const hiopMatrixSparse& Jc, const hiopMatrixSparse& Jd);
+  //assembles K and factorizes it
+  virtual int factorizeK(double delta_w, double delta_c);
+  hiopNlpSparse* nlps;
+  const hiopMatrixSparse *Jac_c_sp, *Jac_d_sp;
+  hiopMatrixSparse* H;
+  hiopLinSolverSymSparse* linsys;
+  bool K_factorized, K_failed;
+  //K by rows: row starts, column indexes, and values; the positions of the entries of H, Jc, and Jd and
+  //of the diagonal in K_vals
+  int *K_irow, *K_jcol;
+  double* K_vals;
+  int *H_pos, *Jc_pos, *Jd_pos, *diag_pos;
+  hiopVectorPar* _rhs;
+};
+
+/* KKT linear system for the block formulation (hiopNlpBlockConstraints), in which the Jacobians have dense 
+ * global rows and rank-local rows (hiopMatrixDenseLocalRows). With (H+Dx)^{-1}=DhInv-Pt^T*inv(V)*Pt from the
+ * quasi-Newton Hessian (q rows in Pt), the compressed system is solved as
+ * [ Jg*DhInv*Jg^T+Eg   Cg^T   Jg*Pt^T ] [yg]   [bg]
+ * [ Cg                 A      Jl*Pt^T ] [yl] = [bl]
+ * [ Pt*Jg^T          Pt*Jl^T     V    ] [t ]   [0 ]
+ * where g are the global and l the local constraints, Cg=Jl*DhInv*Jg^T, and Eg and El are zero for the eq 
+ * and Dd^{-1} for the ineq constraints. A=Jl*DhInv*Jl^T+El is block diagonal with one block per rank, which 
+ * is factorized (Cholesky) and eliminated by its rank. Only the Schur complement of the global constraints
+ * and of t, of size m_glob+q, is all-reduced and factorized (LDL^T).
+ */
+class hiopKKTLinSysBlock : public hiopKKTLinSysLowRank
+{
+public:
+  hiopKKTLinSysBlock(hiopNlpFormulation* nlp_);
+  virtual ~hiopKKTLinSysBlock();
+
+  virtual bool update(const hiopIterate* iter, 
+		      const hiopVector* grad_f, 
+		      const hiopMatrix* Jac_c, const hiopMatrix* Jac_d, 
+		      hiopHessianLowRank* Hess);
+  virtual bool solveCompressed(hiopVectorPar& rx, hiopVectorPar& ryc, hiopVectorPar& ryd,
+			       hiopVectorPar& dx, hiopVectorPar& dyc, hiopVectorPar& dyd);
+private:
+  /* forms and factorizes the local block A and the Schur complement S; returns false (on all the ranks)
+   * if A is not positive definite on some rank or S is singular */
+  bool factorize();
+  //gathers the local parts of y (this rank's in yl) in the replicated vector y (global rows first)
+  void gatherLocal(const double* yl, const hiopMatrixDenseLocalRows& J, hiopVectorPar& y);
+  hiopNlpBlockConstraints* nlpb;
+  const hiopMatrixDenseLocalRows *Jac_c_b, *Jac_d_b;
+  bool factorized;
+  //[Jg; Jl] on the local columns and the same scaled by DhInv
+  hiopMatrixDense *_R, *_RD;
+  //R*DhInv*R^T and R*Pt^T
+  hiopMatrixDense *_F1, *_F2;
+  //Cholesky factors of A, [Cg Gl]^T, inv(A)*[Cg Gl] (transposed), and the factors of S
+  hiopMatrixDense *_A, *_Bt, *_Zt, *_S;
+  int* _S_ipiv;
+  hiopVectorPar *_bc, *_bd, *_w, *_h;
 };
 
 };
@@ -55,8 +55,8 @@ namespace hiop
 class hiopLogBarProblem
 {
 public:
-  hiopLogBarProblem(hiopNlpDenseConstraints* nlp_) 
-    : kappa_d(1e-5), nlp(nlp_) 
+  hiopLogBarProblem(hiopNlpFormulation* nlp_) 
+    : kappa_d(1e-5), nlp(nlp_), _barrier(0.), _damping(0.)
   {
     _grad_x_logbar = nlp->alloc_primal_vec();
     _grad_d_logbar = nlp->alloc_dual_ineq_vec();
@@ -73,7 +73,7 @@ public: //members
   //just proxies: keeps pointers to the problem's data and updates LogBar func, grad and all that on the fly
   const hiopIterate *iter, *iter_trial;
   const hiopVector *c_nlp,*d_nlp, *c_nlp_trial, *d_nlp_trial;
-  const hiopMatrixDense *Jac_c_nlp, *Jac_d_nlp;
+  const hiopMatrix *Jac_c_nlp, *Jac_d_nlp;
 
     //algorithm's parameters 
   // factor in computing the linear damping terms used to control unboundness in the log-barrier problem (Section 3.7) */
@@ -83,7 +83,7 @@ public:
   inline void 
   updateWithNlpInfo(const hiopIterate& iter_, const double& mu_, 
 		    const double &f, const hiopVector& c_, const hiopVector& d_, 
-		    const hiopVector& gradf_,  const hiopMatrixDense& Jac_c_,  const hiopMatrixDense& Jac_d_) 
+		    const hiopVector& gradf_,  const hiopMatrix& Jac_c_,  const hiopMatrix& Jac_d_) 
   {
     nlp->runStats.tmSolverInternal.start();
 
@@ -91,7 +91,8 @@ public:
     _grad_x_logbar->copyFrom(gradf_);
     _grad_d_logbar->setToZero(); 
     //add log terms to function
-    double aux=-mu * iter->evalLogBarrier();
+    _barrier = iter->evalLogBarrier();
+    double aux=-mu * _barrier;
     f_logbar = f + aux;
 
 #ifdef DEEP_CHECKING
@@ -110,7 +111,8 @@ public:
       iter->addLinearDampingTermToGrad_x(mu,kappa_d,1.0,*_grad_x_logbar);
       iter->addLinearDampingTermToGrad_d(mu,kappa_d,1.0,*_grad_d_logbar);
 
-      f_logbar += iter->linearDampingTerm(mu,kappa_d);
+      _damping = iter->linearDampingTerm(mu,kappa_d)/mu;
+      f_logbar += mu*_damping;
 #ifdef DEEP_CHECKING
       nlp->log->write("gradx_log_bar final, with damping:", *_grad_x_logbar, hovLinesearchVerb);
       nlp->log->write("gradd_log_bar final, with damping:", *_grad_d_logbar, hovLinesearchVerb);
@@ -118,6 +120,26 @@ public:
       nlp->runStats.tmSolverInternal.stop();
     }
   }
+  /* update when only mu changed since the last 'updateWithNlpInfo' (same iterate and NLP data). The 
+   * log-barrier and damping terms are linear in mu and are updated in place, without recomputing the
+   * barrier sums (and their reductions) */
+  inline void updateWithMu(const double& mu_)
+  {
+    nlp->runStats.tmSolverInternal.start();
+
+    const double dmu = mu_-mu;
+    iter->addLogBarGrad_x(dmu, *_grad_x_logbar);
+    iter->addLogBarGrad_d(dmu, *_grad_d_logbar);
+    f_logbar -= dmu * _barrier;
+    if(kappa_d>0.) {
+      iter->addLinearDampingTermToGrad_x(dmu,kappa_d,1.0,*_grad_x_logbar);
+      iter->addLinearDampingTermToGrad_d(dmu,kappa_d,1.0,*_grad_d_logbar);
+      f_logbar += dmu * _damping;
+    }
+    mu=mu_;
+
+    nlp->runStats.tmSolverInternal.stop();
+  }
   inline void 
   updateWithNlpInfo_trial_funcOnly(const hiopIterate& iter_, 
 				   const double &f, const hiopVector& c_, const hiopVector& d_)
@@ -153,7 +175,9 @@ public:
   }
 
 protected:
-  hiopNlpDenseConstraints* nlp;
+  hiopNlpFormulation* nlp;
+  //log-barrier sum and damping term (per unit of mu) at the current iterate, cached for 'updateWithMu'
+  double _barrier, _damping;
 private:
   hiopLogBarProblem() {};
   hiopLogBarProblem(const hiopLogBarProblem&) {};
@@ -0,0 +1,206 @@
+// Copyright (c) 2017, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory (LLNL).
+// Written by Cosmin G. Petra, petra1@llnl.gov.
+// LLNL-CODE-742473. All rights reserved.
+//
+// This file is part of HiOp. For details, see https://github.com/LLNL/hiop. HiOp 
+// is released under the BSD 3-clause license (https://opensource.org/licenses/BSD-3-Clause). 
+// Please also read “Additional BSD Notice” below.
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+// i. Redistributions of source code must retain the above copyright notice, this list 
+// of conditions and the disclaimer below.
+// ii. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the disclaimer (as noted below) in the documentation and/or 
+// other materials provided with the distribution.
+// iii. Neither the name of the LLNS/LLNL nor the names of its contributors may be used to 
+// endorse or promote products derived from this software without specific prior written 
+// permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY 
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES 
+// OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT 
+// SHALL LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR 
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS 
+// OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Additional BSD Notice
+// 1. This notice is required to be provided under our contract with the U.S. Department 
+// of Energy (DOE). This work was produced at Lawrence Livermore National Laboratory under 
+// Contract No. DE-AC52-07NA27344 with the DOE.
+// 2. Neither the United States Government nor Lawrence Livermore National Security, LLC 
+// nor any of their employees, makes any warranty, express or implied, or assumes any 
+// liability or responsibility for the accuracy, completeness, or usefulness of any 
+// information, apparatus, product, or process disclosed, or represents that its use would
+// not infringe privately-owned rights.
+// 3. Also, reference herein to any specific commercial products, process, or services by 
+// trade name, trademark, manufacturer or otherwise does not necessarily constitute or 
+// imply its endorsement, recommendation, or favoring by the United States Government or 
+// Lawrence Livermore National Security, LLC. The views and opinions of authors expressed 
+// herein do not necessarily state or reflect those of the United States Government or 
+// Lawrence Livermore National Security, LLC, and shall not be used for advertising or 
+// product endorsement purposes.
+
+#include "hiopMultiStart.hpp"
+#include "hiopNlpFormulation.hpp"
+#include "hiopAlgFilterIPM.hpp"
+#include "hiopTimer.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <thread>
+#include <algorithm>
+
+namespace hiop
+{
+
+/* stops the solve of a start when it is dominated by the incumbent */
+class hiopMultiStartMonitor : public hiopIterationMonitor
+{
+public:
+  hiopMultiStartMonitor(hiopMultiStart& ms_, int idx_) : ms(ms_), idx(idx_), stopped(false) {};
+  virtual ~hiopMultiStartMonitor() {};
+  virtual bool iterate(int iter, double obj_value, double inf_pr, double inf_du, double mu)
+  {
+    if(ms.check_iterate(idx, iter, obj_value, inf_pr)) return true;
+    stopped=true;
+    return false;
+  }
+  hiopMultiStart& ms;
+  int idx;
+  bool stopped;
+};
+
+hiopMultiStart::hiopMultiStart(hiopBatchProblems& starts_, int num_threads_, const char* options_file_)
+  : starts(starts_), options_file(options_file_), num_threads(std::max(1, num_threads_)),
+    num_threads_used(0), dom_min_iter(10), dom_margin(1e-2), dom_feas_tol(1e-6), next_start(0), best_start(-1), 
+    best_objective(1e+20)
+{
+  num_starts = starts.get_num_problems();
+}
+
+hiopMultiStart::~hiopMultiStart()
+{
+}
+
+void hiopMultiStart::set_dominance(int min_iter, double margin, double feas_tol)
+{
+  dom_min_iter=min_iter; dom_margin=margin; dom_feas_tol=feas_tol;
+}
+
+int hiopMultiStart::run()
+{
+  status.assign(num_starts, NlpSolve_SolveNotCalled);
+  objective.assign(num_starts, 0.);
+  time.assign(num_starts, 0.);
+  iterations.assign(num_starts, 0);
+  dominated.assign(num_starts, 0);
+  best_start=-1; best_objective=1e+20; best_solution.clear();
+  next_start=0;
+
+  int nthreads = std::min(num_threads, num_starts);
+  num_threads_used = 0;
+  if(nthreads<1) return -1;
+#ifdef WITH_MPI
+  int provided=MPI_THREAD_SINGLE;
+  MPI_Query_thread(&provided);
+  //without MPI_THREAD_MULTIPLE the starts are solved by one thread (see get_num_threads_used)
+  if(provided<MPI_THREAD_MULTIPLE) nthreads=1;
+  //the communicators are created by this thread (MPI_Comm_dup is collective)
+  std::vector<MPI_Comm> comms(nthreads);
+  for(int t=0; t<nthreads; t++) {
+    int ierr = MPI_Comm_dup(MPI_COMM_SELF, &comms[t]); assert(MPI_SUCCESS==ierr);
+  }
+#else
+  std::vector<MPI_Comm> comms(nthreads, MPI_COMM_SELF);
+#endif
+  num_threads_used = nthreads;
+  if(1==nthreads) {
+    work(comms[0]);
+  } else {
+    std::vector<std::thread> threads;
+    for(int t=0; t<nthreads; t++)
+      threads.push_back(std::thread(thread_work, this, comms[t]));
+    for(int t=0; t<nthreads; t++)
+      threads[t].join();
+  }
+#ifdef WITH_MPI
+  for(int t=0; t<nthreads; t++)
+    MPI_Comm_free(&comms[t]);
+#endif
+  return best_start;
+}
+
+int hiopMultiStart::get_num_dominated() const
+{
+  int n=0;
+  for(size_t i=0; i<dominated.size(); i++) n += dominated[i];
+  return n;
+}
+
+void hiopMultiStart::thread_work(hiopMultiStart* ms, MPI_Comm comm)
+{
+  ms->work(comm);
+}
+
+void hiopMultiStart::work(MPI_Comm comm)
+{
+  int idx;
+  while((idx=next_start.fetch_add(1)) < num_starts)
+    solve(idx, comm);
+}
+
+bool hiopMultiStart::check_iterate(int idx, int iter, double obj_value, double inf_pr)
+{
+  if(dom_min_iter<0 || iter<dom_min_iter || inf_pr>dom_feas_tol) return true;
+  std::lock_guard<std::mutex> lock(mtx);
+  if(best_start<0) return true;
+  return obj_value <= best_objective + dom_margin*(1+fabs(best_objective));
+}
+
+void hiopMultiStart::solve(int idx, MPI_Comm comm)
+{
+  hiopTimer tm; tm.start();
+  hiopInterfaceDenseConstraints* prob = starts.create_problem(idx, comm);
+  assert(prob);
+  {
+    hiopNlpDenseConstraints nlp(*prob, options_file);
+    starts.set_options(idx, *nlp.options);
+    nlp.log->set_verbosity((hiopOutVerbosity) nlp.options->GetInteger("verbosity_level"));
+
+    hiopMultiStartMonitor monitor(*this, idx);
+    hiopAlgFilterIPM solver(&nlp);
+    solver.setIterationMonitor(&monitor);
+    const hiopSolveStatus st = solver.run();
+
+    status[idx]=st; 
+    objective[idx]=solver.getObjective(); 
+    iterations[idx]=solver.getNumIterations();
+    dominated[idx] = User_Stopped==st && monitor.stopped;
+
+    if(Solve_Success==st || Solve_Acceptable_Level==st) {
+      hiopVectorPar* x_usr = nlp.alloc_usr_primal_vec();
+      std::vector<double> x(x_usr->get_local_size());
+      if(!x.empty()) solver.getSolution(&x[0]);
+      delete x_usr;
+
+      //the incumbent; the lowest start wins the ties so that the result does not depend on the threads
+      std::lock_guard<std::mutex> lock(mtx);
+      const double obj=objective[idx];
+      if(best_start<0 || obj<best_objective || (obj==best_objective && idx<best_start)) {
+	best_start=idx; best_objective=obj;
+	best_solution.swap(x);
+      }
+    }
+  }
+  starts.release_problem(idx, prob);
+  tm.stop();
+  time[idx]=tm.getElapsedTime();
+}
+
+}
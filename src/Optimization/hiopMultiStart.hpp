@@ -0,0 +1,133 @@
+// Copyright (c) 2017, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory (LLNL).
+// Written by Cosmin G. Petra, petra1@llnl.gov.
+// LLNL-CODE-742473. All rights reserved.
+//
+// This file is part of HiOp. For details, see https://github.com/LLNL/hiop. HiOp 
+// is released under the BSD 3-clause license (https://opensource.org/licenses/BSD-3-Clause). 
+// Please also read “Additional BSD Notice” below.
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+// i. Redistributions of source code must retain the above copyright notice, this list 
+// of conditions and the disclaimer below.
+// ii. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the disclaimer (as noted below) in the documentation and/or 
+// other materials provided with the distribution.
+// iii. Neither the name of the LLNS/LLNL nor the names of its contributors may be used to 
+// endorse or promote products derived from this software without specific prior written 
+// permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY 
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES 
+// OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT 
+// SHALL LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR 
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS 
+// OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Additional BSD Notice
+// 1. This notice is required to be provided under our contract with the U.S. Department 
+// of Energy (DOE). This work was produced at Lawrence Livermore National Laboratory under 
+// Contract No. DE-AC52-07NA27344 with the DOE.
+// 2. Neither the United States Government nor Lawrence Livermore National Security, LLC 
+// nor any of their employees, makes any warranty, express or implied, or assumes any 
+// liability or responsibility for the accuracy, completeness, or usefulness of any 
+// information, apparatus, product, or process disclosed, or represents that its use would
+// not infringe privately-owned rights.
+// 3. Also, reference herein to any specific commercial products, process, or services by 
+// trade name, trademark, manufacturer or otherwise does not necessarily constitute or 
+// imply its endorsement, recommendation, or favoring by the United States Government or 
+// Lawrence Livermore National Security, LLC. The views and opinions of authors expressed 
+// herein do not necessarily state or reflect those of the United States Government or 
+// Lawrence Livermore National Security, LLC, and shall not be used for advertising or 
+// product endorsement purposes.
+
+#ifndef HIOP_MULTISTART
+#define HIOP_MULTISTART
+
+#include "hiopBatchSolver.hpp"
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+
+namespace hiop
+{
+
+/* Multi-start solver for nonconvex NLPs: the starts (the problems of a hiopBatchProblems, which usually differ 
+ * only in their starting point) are solved concurrently by a pool of threads of the calling process and the 
+ * best local optimum is kept. 
+ *
+ * The objective of the best converged start (the incumbent) is shared by the solves: a start whose iterate is 
+ * feasible after a minimum number of iterations and whose objective is worse than the incumbent by more than 
+ * a relative margin is cancelled (see set_dominance). Each solve has its own communicator, a duplicate of 
+ * MPI_COMM_SELF, which should be returned by the interface of the problem in get_MPI_comm; more than one thread 
+ * requires MPI to be initialized with MPI_THREAD_MULTIPLE, otherwise the starts are solved one at a time 
+ * (get_num_threads_used returns 1).
+ * The methods of 'starts' are called concurrently and need to be reentrant.
+ */
+class hiopMultiStart
+{
+public:
+  hiopMultiStart(hiopBatchProblems& starts, int num_threads=1, const char* options_file=NULL);
+  virtual ~hiopMultiStart();
+
+  /* a start is cancelled when, after 'min_iter' iterations, its primal infeasibility is at most 'feas_tol' and 
+   * its objective exceeds the incumbent by more than margin*(1+|incumbent|); min_iter<0 disables the 
+   * cancellation. The default is (10, 1e-2, 1e-6) */
+  void set_dominance(int min_iter, double margin, double feas_tol=1e-6);
+
+  /* solves all the starts; returns the best start or -1 when none of them converged */
+  virtual int run();
+
+  inline int get_best_start() const { return best_start; }
+  inline double get_best_objective() const { return best_objective; }
+  /* the primal solution (in the user's space) of the best start */
+  inline const std::vector<double>& get_best_solution() const { return best_solution; }
+  /* number of threads that solved the starts in the last run; less than requested when there are fewer starts 
+   * or when MPI does not provide MPI_THREAD_MULTIPLE */
+  inline int get_num_threads_used() const { return num_threads_used; }
+
+  /* per-start statistics */
+  inline hiopSolveStatus get_status(int idx) const { return status[idx]; }
+  inline double get_objective(int idx) const { return objective[idx]; }
+  inline int get_iterations(int idx) const { return iterations[idx]; }
+  inline double get_time(int idx) const { return time[idx]; }
+  /* whether the start was cancelled because dominated by the incumbent */
+  inline bool is_dominated(int idx) const { return dominated[idx]!=0; }
+  int get_num_dominated() const;
+
+  /* called by the solves: checks the iterate of a start against the incumbent */
+  bool check_iterate(int idx, int iter, double obj_value, double inf_pr);
+private:
+  void work(MPI_Comm comm);
+  void solve(int idx, MPI_Comm comm);
+  static void thread_work(hiopMultiStart* ms, MPI_Comm comm);
+private:
+  hiopBatchProblems& starts;
+  const char* options_file;
+  int num_starts, num_threads, num_threads_used;
+  int dom_min_iter;
+  double dom_margin, dom_feas_tol;
+
+  std::atomic<int> next_start;
+  //guards the incumbent
+  std::mutex mtx;
+  int best_start;
+  double best_objective;
+  std::vector<double> best_solution;
+
+  std::vector<hiopSolveStatus> status;
+  std::vector<double> objective, time;
+  std::vector<int> iterations, dominated;
+private:
+  hiopMultiStart(const hiopMultiStart&);
+  void operator=(const hiopMultiStart&);
+};
+
+}
+#endif
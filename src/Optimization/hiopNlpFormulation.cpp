@@ -49,6 +49,7 @@
 #include "hiopNlpFormulation.hpp"
 
 #include "hiopLogger.hpp"
+#include "blasdefs.hpp"
 
 #ifdef WITH_MPI
 #include "mpi.h"
@@ -57,93 +58,98 @@
 #endif
 
 #include <cassert>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <algorithm>
 namespace hiop
 {
 
-hiopNlpFormulation::hiopNlpFormulation(hiopInterfaceBase& interface)
+hiopNlpFormulation::hiopNlpFormulation(hiopInterfaceBase& interface, const char* options_file)
 {
 #ifdef WITH_MPI
-  assert(interface.get_MPI_comm(comm));
-  assert(MPI_SUCCESS==MPI_Comm_rank(comm, &rank));
-  assert(MPI_SUCCESS==MPI_Comm_size(comm, &num_ranks));
+  //the communicator must be obtained outside of the asserts (which are compiled out with NDEBUG)
+  bool bret = interface.get_MPI_comm(comm); assert(bret);
+  int ierr = MPI_Comm_rank(comm, &rank); assert(MPI_SUCCESS==ierr);
+  ierr = MPI_Comm_size(comm, &num_ranks); assert(MPI_SUCCESS==ierr);
 #else
   //fake communicator (defined by hiop)
-  MPI_Comm comm = MPI_COMM_SELF;
+  comm = MPI_COMM_SELF;
+  rank = 0; num_ranks = 1;
 #endif
 
-  options = new hiopOptions(/*filename=NULL*/);
+  //the logger is needed to report the errors in the options file; its verbosity is set once the file is read
+  log = new hiopLogger(this, hovWarning, stdout);
+  options = new hiopOptions(options_file, log);
 
   hiopOutVerbosity hov = (hiopOutVerbosity) options->GetInteger("verbosity_level");
-  log = new hiopLogger(this, hov, stdout);
+  log->set_verbosity(hov);
 
   options->SetLog(log);
   //log->write(NULL, *options, hovSummary);//! comment this at some point
 
-  runStats = hiopRunStats(comm);
+  runStats.setComm(comm);
+
+  n_vars=n_cons=n_cons_eq=n_cons_ineq=0;
+  n_bnds_low=n_bnds_low_local=n_bnds_upp=n_bnds_upp_local=n_ineq_low=n_ineq_upp=0;
+  n_bnds_lu=n_ineq_lu=0;
+  xl=xu=ixl=ixu=NULL;
+  vars_type=NULL;
+  c_rhs=dl=du=idl=idu=NULL;
+  cons_eq_type=cons_ineq_type=NULL;
+  cons_eq_mapping=cons_ineq_mapping=NULL;
+  node_comm=NULL;
 }
 
 hiopNlpFormulation::~hiopNlpFormulation()
 {
+  if(xl)   delete xl;
+  if(xu)   delete xu;
+  if(ixl)  delete ixl;
+  if(ixu)  delete ixu;
+  if(c_rhs)delete c_rhs;
+  if(dl)   delete dl;
+  if(du)   delete du;
+  if(idl)  delete idl;
+  if(idu)  delete idu;
+
+  if(vars_type)      delete[] vars_type;
+  if(cons_ineq_type) delete[] cons_ineq_type;
+  if(cons_eq_type)   delete[] cons_eq_type;
+
+  if(cons_eq_mapping)   delete[] cons_eq_mapping;
+  if(cons_ineq_mapping) delete[] cons_ineq_mapping;
+
+  if(node_comm) delete node_comm;
+
   delete log;
   delete options;
 }
 
-
-hiopNlpDenseConstraints::hiopNlpDenseConstraints(hiopInterfaceDenseConstraints& interface_)
-  : hiopNlpFormulation(interface_), interface(interface_)
+hiopNodeComm* hiopNlpFormulation::get_node_comm()
 {
-  assert(interface.get_prob_sizes(n_vars, n_cons));
 #ifdef WITH_MPI
-
-  long long* columns_partitioning=new long long[num_ranks+1];
-  if(true==interface.get_vecdistrib_info(n_vars,columns_partitioning)) {
-    xl = new hiopVectorPar(n_vars, columns_partitioning, comm);
-  } else {
-    xl = new hiopVectorPar(n_vars);   
-  }
-  delete[] columns_partitioning;
-#else
-  xl   = new hiopVectorPar(n_vars);
-#endif  
-  xu = xl->alloc_clone();
-
-  int nlocal=xl->get_local_size();
-  double  *xl_vec= xl->local_data(),  *xu_vec= xu->local_data();
-  vars_type = new hiopInterfaceBase::NonlinearityType[nlocal];
-  bool bret=interface.get_vars_info(n_vars,xl_vec,xu_vec,vars_type); assert(bret);
-  //allocate and build ixl(ow) and ix(upp) vectors
-  ixl = xu->alloc_clone(); ixu = xu->alloc_clone();
-  n_bnds_low_local = n_bnds_upp_local = 0;
-  n_bnds_lu = 0;
-  double *ixl_vec=ixl->local_data(), *ixu_vec=ixu->local_data();
-  for(int i=0;i<nlocal; i++) {
-    if(xl_vec[i]>-1e20) { 
-      ixl_vec[i]=1.; n_bnds_low_local++;
-      if(xu_vec[i]< 1e20) n_bnds_lu++;
-    } else ixl_vec[i]=0.;
-
-    if(xu_vec[i]< 1e20) { 
-      ixu_vec[i]=1.; n_bnds_upp_local++;
-    }
-    else ixu_vec[i]=0.;
+  if(NULL==node_comm && num_ranks>1 && options->GetString("node_shared_reduced_mats")=="yes") {
+    node_comm = new hiopNodeComm(comm);
+    log->printf(hovSummary, "the reduced matrices are shared by the ranks of a node: %d node(s), %d rank(s) on the "
+		"first node\n", node_comm->get_num_nodes(), node_comm->get_node_size());
   }
+#endif
+  return node_comm;
+}
 
-  /* split the constraints */
-  hiopVectorPar* gl = new hiopVectorPar(n_cons); 
-  hiopVectorPar* gu = new hiopVectorPar(n_cons);
-  double *gl_vec=gl->local_data(), *gu_vec=gu->local_data();
-  hiopInterfaceBase::NonlinearityType* cons_type = new hiopInterfaceBase::NonlinearityType[n_cons];
-  bret = interface.get_cons_info(n_cons, gl_vec, gu_vec, cons_type); assert(bret);
-
-  assert(gl->get_local_size()==n_cons);
-  assert(gl->get_local_size()==n_cons);
+void hiopNlpFormulation::split_constraints(long long num_cons, const double* gl_vec, const double* gu_vec,
+					   const hiopInterfaceBase::NonlinearityType* cons_type, const bool* removed)
+{
   n_cons_eq=n_cons_ineq=0; 
-  for(int i=0;i<n_cons; i++) {
+  for(long long i=0;i<num_cons; i++) {
+    if(removed && removed[i]) continue;
     if(gl_vec[i]==gu_vec[i]) n_cons_eq++;
     else                     n_cons_ineq++;
   }
+  n_cons = n_cons_eq+n_cons_ineq;
 
-  /* allocate c_rhs, dl, and du (all serial in this formulation) */
+  /* allocate c_rhs, dl, and du (all serial) */
   c_rhs = new hiopVectorPar(n_cons_eq);
   cons_eq_type = new  hiopInterfaceBase::NonlinearityType[n_cons_eq];
   dl    = new hiopVectorPar(n_cons_ineq);
@@ -155,7 +161,8 @@ hiopNlpDenseConstraints::hiopNlpDenseConstraints(hiopInterfaceDenseConstraints&
   /* copy lower and upper bounds - constraints */
   double *dlvec=dl->local_data(), *duvec=du->local_data(), *c_rhsvec=c_rhs->local_data();
   int it_eq=0, it_ineq=0;
-  for(int i=0;i<n_cons; i++) {
+  for(long long i=0;i<num_cons; i++) {
+    if(removed && removed[i]) continue;
     if(gl_vec[i]==gu_vec[i]) {
       cons_eq_type[it_eq]=cons_type[i]; 
       c_rhsvec[it_eq] = gl_vec[i]; 
@@ -169,8 +176,6 @@ hiopNlpDenseConstraints::hiopNlpDenseConstraints(hiopInterfaceDenseConstraints&
     }
   }
   assert(it_eq==n_cons_eq); assert(it_ineq==n_cons_ineq);
-  /* delete the temporary buffers */
-  delete gl; delete gu; delete[] cons_type;
 
   /* iterate over the inequalities and build the idl(ow) and idu(pp) vectors */
   idl = dl->alloc_clone(); idu=du->alloc_clone();
@@ -190,6 +195,169 @@ hiopNlpDenseConstraints::hiopNlpDenseConstraints(hiopInterfaceDenseConstraints&
     //idl_vec[i] = dl_vec[i]<=-1e20?0.:1.;
     //idu_vec[i] = du_vec[i]>= 1e20?0.:1.;
   }
+}
+
+
+hiopNlpDenseConstraints::hiopNlpDenseConstraints(hiopInterfaceDenseConstraints& interface_, const char* options_file)
+  : hiopNlpFormulation(interface_, options_file), interface(interface_)
+{
+  assert(interface.get_prob_sizes(n_vars_usr, n_cons_usr));
+
+  vec_distrib_usr=vec_distrib=NULL;
+#ifdef WITH_MPI
+  vec_distrib_usr=new long long[num_ranks+1];
+  if(false==interface.get_vecdistrib_info(n_vars_usr,vec_distrib_usr)) {
+    delete[] vec_distrib_usr; vec_distrib_usr=NULL;
+  }
+  if(vec_distrib_usr) xl_usr = new hiopVectorPar(n_vars_usr, vec_distrib_usr, comm);
+  else                xl_usr = new hiopVectorPar(n_vars_usr);
+#else
+  xl_usr = new hiopVectorPar(n_vars_usr);
+#endif  
+  xu_usr = xl_usr->alloc_clone();
+
+  int nlocal_usr=xl_usr->get_local_size();
+  vars_type_usr = new hiopInterfaceBase::NonlinearityType[nlocal_usr];
+  bool bret=interface.get_vars_info(n_vars_usr,xl_usr->local_data(),xu_usr->local_data(),vars_type_usr); assert(bret);
+
+  /* presolve: the fixed variables are removed from the working set, i.e., the problem seen by the algorithm */
+  presolve = options->GetString("presolve")=="yes";
+  n_fixed_vars=n_frozen_vars=0; n_cons_removed=0;
+  free_vars=NULL; x_usr=NULL; grad_usr=NULL; v_usr=NULL; Jac_usr=NULL; Hess_usr=NULL; lambda_usr=NULL;
+  bool* is_free = new bool[nlocal_usr];
+  const double *xl_vec=xl_usr->local_data_const(), *xu_vec=xu_usr->local_data_const();
+  for(int i=0; i<nlocal_usr; i++) 
+    is_free[i] = !(presolve && xl_vec[i]==xu_vec[i]);
+  set_free_vars(is_free);
+  delete[] is_free;
+  n_fixed_vars = n_vars_usr-n_vars;
+
+  /* split the constraints */
+  hiopVectorPar* gl = new hiopVectorPar(n_cons_usr); 
+  hiopVectorPar* gu = new hiopVectorPar(n_cons_usr);
+  double *gl_vec=gl->local_data(), *gu_vec=gu->local_data();
+  hiopInterfaceBase::NonlinearityType* cons_type = new hiopInterfaceBase::NonlinearityType[n_cons_usr];
+  bret = interface.get_cons_info(n_cons_usr, gl_vec, gu_vec, cons_type); assert(bret);
+
+  assert(gl->get_local_size()==n_cons_usr);
+  assert(gl->get_local_size()==n_cons_usr);
+  //presolve: empty and duplicated linear constraints are not passed to the algorithm
+  bool* cons_removed = new bool[n_cons_usr];
+  for(int i=0;i<n_cons_usr; i++) cons_removed[i]=false;
+  if(presolve)
+    n_cons_removed = presolve_linear_cons(gl_vec, gu_vec, cons_type, cons_removed);
+  split_constraints(n_cons_usr, gl_vec, gu_vec, cons_type, cons_removed);
+  assert(n_cons==n_cons_usr-n_cons_removed);
+  /* delete the temporary buffers */
+  delete gl; delete gu; delete[] cons_type; delete[] cons_removed;
+
+  if(presolve)
+    log->printf(hovSummary, "Presolve: removed %lld fixed variables and %lld empty or duplicated linear constraints\n",
+		n_fixed_vars, n_cons_removed);
+
+  //scaling factors are computed at the starting point (see get_starting_point)
+  obj_scale=1.; c_scale=d_scale=NULL;
+}
+
+hiopNlpDenseConstraints::~hiopNlpDenseConstraints()
+{
+  if(c_scale) delete c_scale;
+  if(d_scale) delete d_scale;
+
+  if(xl_usr)    delete xl_usr;
+  if(xu_usr)    delete xu_usr;
+  if(vars_type_usr) delete[] vars_type_usr;
+  if(free_vars) delete[] free_vars;
+  if(x_usr)     delete x_usr;
+  if(grad_usr)  delete grad_usr;
+  if(v_usr)     delete v_usr;
+  if(Jac_usr)   delete Jac_usr;
+  if(Hess_usr)  delete Hess_usr;
+  if(lambda_usr) delete lambda_usr;
+  if(vec_distrib!=vec_distrib_usr && vec_distrib) delete[] vec_distrib;
+  if(vec_distrib_usr) delete[] vec_distrib_usr;
+}
+
+/* (Re)builds the working set, i.e., the variables seen by the algorithm, from the mask 'is_free' over the 
+ * local variables of the user's problem. The variables that are not free keep the values stored in x_usr. */
+void hiopNlpDenseConstraints::set_free_vars(const bool* is_free)
+{
+  const int nlocal_usr=xl_usr->get_local_size();
+  int nlocal=0;
+  for(int i=0; i<nlocal_usr; i++) if(is_free[i]) nlocal++;
+
+  if(free_vars) delete[] free_vars; 
+  free_vars=NULL;
+  if(vec_distrib!=vec_distrib_usr && vec_distrib) delete[] vec_distrib;
+  vec_distrib=vec_distrib_usr;
+  n_vars=nlocal;
+#ifdef WITH_MPI
+  //the columns partitioning of the working set: each rank keeps its free variables
+  if(vec_distrib_usr) {
+    long long nlocal_ll=nlocal;
+    long long* counts=new long long[num_ranks];
+    int ierr=MPI_Allgather(&nlocal_ll, 1, MPI_LONG_LONG, counts, 1, MPI_LONG_LONG, comm); assert(MPI_SUCCESS==ierr);
+    n_vars=0;
+    for(int r=0; r<num_ranks; r++) n_vars += counts[r];
+    if(n_vars<n_vars_usr) {
+      vec_distrib=new long long[num_ranks+1]; vec_distrib[0]=0;
+      for(int r=0; r<num_ranks; r++) vec_distrib[r+1]=vec_distrib[r]+counts[r];
+    }
+    delete[] counts;
+  }
+#endif
+  if(n_vars<n_vars_usr) {
+    free_vars = new int[nlocal];
+    for(int i=0, k=0; i<nlocal_usr; i++) 
+      if(is_free[i]) free_vars[k++]=i;
+    if(NULL==x_usr) {
+      //the entries of the variables that are not free are set by the caller
+      x_usr = xl_usr->new_copy();
+      grad_usr = xl_usr->alloc_clone();
+      Jac_usr = alloc_usr_multivector(n_cons_usr);
+    }
+  }
+
+  /* the bounds of the variables in the working set */
+  if(xl) delete xl; 
+  if(xu) delete xu;
+  if(ixl) delete ixl;
+  if(ixu) delete ixu;
+  if(vars_type) delete[] vars_type;
+#ifdef WITH_MPI
+  if(vec_distrib) xl = new hiopVectorPar(n_vars, vec_distrib, comm);
+  else            xl = new hiopVectorPar(n_vars);
+#else
+  xl = new hiopVectorPar(n_vars);
+#endif
+  xu = xl->alloc_clone();
+  vars_type = new hiopInterfaceBase::NonlinearityType[nlocal];
+  if(NULL==free_vars) {
+    xl->copyFrom(*xl_usr); xu->copyFrom(*xu_usr);
+    for(int k=0; k<nlocal; k++) vars_type[k]=vars_type_usr[k];
+  } else {
+    vec_from_usr(xl_usr->local_data_const(), xl->local_data());
+    vec_from_usr(xu_usr->local_data_const(), xu->local_data());
+    for(int k=0; k<nlocal; k++) vars_type[k]=vars_type_usr[free_vars[k]];
+  }
+
+  //allocate and build ixl(ow) and ix(upp) vectors
+  ixl = xu->alloc_clone(); ixu = xu->alloc_clone();
+  n_bnds_low_local = n_bnds_upp_local = 0;
+  n_bnds_lu = 0;
+  double  *xl_vec= xl->local_data(),  *xu_vec= xu->local_data();
+  double *ixl_vec=ixl->local_data(), *ixu_vec=ixu->local_data();
+  for(int i=0;i<nlocal; i++) {
+    if(xl_vec[i]>-1e20) { 
+      ixl_vec[i]=1.; n_bnds_low_local++;
+      if(xu_vec[i]< 1e20) n_bnds_lu++;
+    } else ixl_vec[i]=0.;
+
+    if(xu_vec[i]< 1e20) { 
+      ixu_vec[i]=1.; n_bnds_upp_local++;
+    }
+    else ixu_vec[i]=0.;
+  }
   //compute the overall n_low and n_upp
 #ifdef WITH_MPI
   long long aux[3]={n_bnds_low_local, n_bnds_upp_local, n_bnds_lu}, aux_g[3];
@@ -198,34 +366,276 @@ hiopNlpDenseConstraints::hiopNlpDenseConstraints(hiopInterfaceDenseConstraints&
 #else
   n_bnds_low=n_bnds_low_local; n_bnds_upp=n_bnds_upp_local; //n_bnds_lu is ok
 #endif
+}
+
+/* Active-set freezing: the variables of the working set marked (with 1.) in 'at_low' or 'at_upp' are fixed
+ * at the corresponding bound and removed from the working set. Returns the number of variables frozen. */
+long long hiopNlpDenseConstraints::freeze_vars(const hiopVectorPar& x, const hiopVectorPar& at_low, const hiopVectorPar& at_upp)
+{
+  const int nlocal_usr=xl_usr->get_local_size(), nlocal=xl->get_local_size();
+  const double *lowv=at_low.local_data_const(), *uppv=at_upp.local_data_const();
+  long long n_frozen_local=0;
+  for(int k=0; k<nlocal; k++) 
+    if(lowv[k]==1. || uppv[k]==1.) n_frozen_local++;
+  long long n_frozen_new=n_frozen_local;
+#ifdef WITH_MPI
+  if(vec_distrib_usr) {
+    int ierr=MPI_Allreduce(&n_frozen_local, &n_frozen_new, 1, MPI_LONG_LONG, MPI_SUM, comm); assert(MPI_SUCCESS==ierr);
+  }
+#endif
+  if(0==n_frozen_new) return 0;
 
+  //the current values of the variables of the working set are saved in x_usr
+  if(NULL==x_usr) {
+    x_usr = xl_usr->new_copy();
+    grad_usr = xl_usr->alloc_clone();
+    Jac_usr = alloc_usr_multivector(n_cons_usr);
+  }
+  x_to_usr(x.local_data_const());
+  double* x_usr_vec=x_usr->local_data();
+  bool* is_free = new bool[nlocal_usr];
+  for(int i=0; i<nlocal_usr; i++) is_free[i]=false;
+  for(int k=0; k<nlocal; k++) {
+    const int i = free_vars ? free_vars[k] : k;
+    is_free[i]=true;
+    if(lowv[k]==1.)      { is_free[i]=false; x_usr_vec[i]=xl_usr->local_data_const()[i]; }
+    else if(uppv[k]==1.) { is_free[i]=false; x_usr_vec[i]=xu_usr->local_data_const()[i]; }
+  }
+  set_free_vars(is_free);
+  delete[] is_free;
+  n_frozen_vars += n_frozen_new;
+  log->printf(hovScalars, "Active set: froze %lld variables (%lld frozen, working set of size %lld)\n", 
+	      n_frozen_new, n_frozen_vars, n_vars);
+  return n_frozen_new;
 }
 
-hiopNlpDenseConstraints::~hiopNlpDenseConstraints()
+/* Releases all the frozen variables back into the working set; their values are the bounds at which
+ * they were frozen. */
+void hiopNlpDenseConstraints::release_frozen_vars()
 {
-  if(xl)   delete xl;
-  if(xu)   delete xu;
-  if(ixl)  delete ixl;
-  if(ixu)  delete ixu;
-  if(c_rhs)delete c_rhs;
-  if(dl)   delete dl;
-  if(du)   delete du;
-  if(idl)  delete idl;
-  if(idu)  delete idu;
+  if(0==n_frozen_vars) return;
+  const int nlocal_usr=xl_usr->get_local_size();
+  const double *xl_vec=xl_usr->local_data_const(), *xu_vec=xu_usr->local_data_const();
+  bool* is_free = new bool[nlocal_usr];
+  for(int i=0; i<nlocal_usr; i++) 
+    is_free[i] = !(presolve && xl_vec[i]==xu_vec[i]);
+  set_free_vars(is_free);
+  delete[] is_free;
+  log->printf(hovScalars, "Active set: released %lld frozen variables\n", n_frozen_vars);
+  n_frozen_vars=0;
+}
 
-  if(vars_type)      delete[] vars_type;
-  if(cons_ineq_type) delete[] cons_ineq_type;
-  if(cons_eq_type)   delete[] cons_eq_type;
+/* Load balancing: the user is asked to accept the columns partitioning 'cols'; if accepted, the bounds and
+ * types of the variables are queried again in the new partitioning. Only for distributed variables and when 
+ * the working set contains all the variables (no fixed or frozen variables). */
+bool hiopNlpDenseConstraints::repartition_vars(const long long* cols)
+{
+#ifdef WITH_MPI
+  if(NULL==vec_distrib_usr || NULL!=free_vars) {
+    log->printf(hovWarning, "Repartitioning: only for distributed variables and without fixed or frozen variables\n");
+    return false;
+  }
+  int accepted = interface.repartition_vecdistrib(n_vars_usr, cols) ? 1 : 0, accepted_all;
+  int ierr = MPI_Allreduce(&accepted, &accepted_all, 1, MPI_INT, MPI_MIN, comm); assert(MPI_SUCCESS==ierr);
+  if(!accepted_all) {
+    log->printf(hovSummary, "Repartitioning: the new partitioning of the variables was not accepted by the user\n");
+    return false;
+  }
+  for(int r=0; r<=num_ranks; r++) vec_distrib_usr[r]=cols[r];
 
-  if(cons_eq_mapping)   delete[] cons_eq_mapping;
-  if(cons_ineq_mapping) delete[] cons_ineq_mapping;
+  delete xl_usr; delete xu_usr; delete[] vars_type_usr;
+  xl_usr = new hiopVectorPar(n_vars_usr, vec_distrib_usr, comm);
+  xu_usr = xl_usr->alloc_clone();
+  const int nlocal_usr=xl_usr->get_local_size();
+  vars_type_usr = new hiopInterfaceBase::NonlinearityType[nlocal_usr];
+  bool bret=interface.get_vars_info(n_vars_usr,xl_usr->local_data(),xu_usr->local_data(),vars_type_usr); assert(bret);
+
+  bool* is_free = new bool[nlocal_usr];
+  for(int i=0; i<nlocal_usr; i++) is_free[i]=true;
+  set_free_vars(is_free);
+  delete[] is_free;
+  return true;
+#else
+  return false;
+#endif
+}
+
+/* Returns the largest violation of the sign of the bounds multipliers of the frozen variables. These 
+ * multipliers are obtained from the stationarity condition at (x, yc, yd). */
+double hiopNlpDenseConstraints::frozen_vars_duals_infeas(const hiopVectorPar& x, const hiopVectorPar& yc, const hiopVectorPar& yd)
+{
+  if(0==n_frozen_vars) return 0.;
+  const double* x_usr_vec = x_to_usr(x.local_data_const());
+  if(!eval_grad_Lagr_usr(x_usr_vec, yc, yd)) {
+    log->printf(hovWarning, "Active set: could not evaluate the multipliers of the frozen variables\n");
+    return 0.;
+  }
+  const double *g=grad_usr->local_data_const(), *xl_vec=xl_usr->local_data_const(), *xu_vec=xu_usr->local_data_const();
+  double infeas=0.;
+  for(int j=0, k=0; j<grad_usr->get_local_size(); j++) {
+    if(k<xl->get_local_size() && free_vars[k]==j) { k++; continue; }
+    if(xl_vec[j]==xu_vec[j]) continue; //fixed variable removed by the presolve
+    if(x_usr_vec[j]==xl_vec[j]) infeas = fmax(infeas, -g[j]);
+    else                        infeas = fmax(infeas,  g[j]);
+  }
+#ifdef WITH_MPI
+  if(vec_distrib_usr) {
+    double infeas_g;
+    int ierr=MPI_Allreduce(&infeas, &infeas_g, 1, MPI_DOUBLE, MPI_MAX, comm); assert(MPI_SUCCESS==ierr);
+    infeas=infeas_g;
+  }
+#endif
+  return infeas;
+}
+
+void hiopNlpDenseConstraints::x_to_usr(const hiopVectorPar& x, hiopVectorPar& x_usr_out)
+{
+  x_usr_out.copyFrom(x_to_usr(x.local_data_const()));
+}
+void hiopNlpDenseConstraints::primal_vec_to_usr(const hiopVectorPar& v, hiopVectorPar& v_usr, double fill) const
+{
+  if(NULL==free_vars) {
+    v_usr.copyFrom(v);
+  } else {
+    v_usr.setToConstant(fill);
+    const double* vv=v.local_data_const(); double* vuv=v_usr.local_data();
+    for(long long k=0; k<v.get_local_size(); k++) vuv[free_vars[k]]=vv[k];
+  }
+}
+void hiopNlpDenseConstraints::primal_vec_from_usr(const hiopVectorPar& v_usr, hiopVectorPar& v) const
+{
+  if(NULL==free_vars) v.copyFrom(v_usr);
+  else vec_from_usr(v_usr.local_data_const(), v.local_data());
 }
+hiopVectorPar* hiopNlpDenseConstraints::alloc_usr_primal_vec() const
+{
+  return xl_usr->alloc_clone();
+}
+
+/* hash of the nonzero entry 'value' in the column 'col' of a row (splitmix64 finalizer) */
+static unsigned long long hash_entry(long long col, double value)
+{
+  unsigned long long h;
+  memcpy(&h, &value, sizeof(double));
+  h ^= (unsigned long long)col * 0x9E3779B97F4A7C15ULL;
+  h = (h ^ (h>>30)) * 0xBF58476D1CE4E5B9ULL;
+  h = (h ^ (h>>27)) * 0x94D049BB133111EBULL;
+  return h ^ (h>>31);
+}
+
+/* Finds the linear constraints that are empty (no nonzeros in the free variables) and feasible, or that 
+ * duplicate another linear constraint up to a constant. The former are removed; the latter are removed
+ * after their bounds are intersected with the bounds of the constraint that is kept. 
+ * The linear constraints are evaluated at the projection of the origin onto the bounds of the variables.
+ * The rows of the Jacobian are hashed (the sum of the hashes of their nonzeros, so that the hashes of the 
+ * local columns can be summed across ranks) and only the rows with the same hash are compared.
+ * Returns the number of constraints removed. */
+long long hiopNlpDenseConstraints::presolve_linear_cons(double* gl, double* gu, 
+							const hiopInterfaceBase::NonlinearityType* cons_type,
+							bool* removed)
+{
+  int nlin=0;
+  for(int i=0; i<n_cons_usr; i++) if(cons_type[i]==hiopInterfaceBase::hiopLinear) nlin++;
+  if(0==nlin) return 0;
+  long long* idx = new long long[nlin];
+  for(int i=0, k=0; i<n_cons_usr; i++) if(cons_type[i]==hiopInterfaceBase::hiopLinear) idx[k++]=i;
+
+  hiopVectorPar* x = xl_usr->new_copy();
+  double* x_vec=x->local_data(); const double* xu_vec=xu_usr->local_data_const();
+  for(long long i=0; i<x->get_local_size(); i++) x_vec[i] = fmin(fmax(0., x_vec[i]), xu_vec[i]);
 
+  double* vals = new double[nlin];
+  hiopMatrixDense* J = alloc_usr_multivector(nlin);
+  bool bret = interface.eval_cons(n_vars_usr, n_cons_usr, nlin, idx, x_vec, true, vals);
+  bret = bret && interface.eval_Jac_cons(n_vars_usr, n_cons_usr, nlin, idx, x_vec, false, J->local_data());
+  delete x;
+
+  long long nremoved=0;
+  if(!bret) {
+    log->printf(hovWarning, "Presolve: evaluation of the linear constraints failed; constraints will not be presolved\n");
+  } else {
+    //nnz[a] is the number of nonzeros of row a in the free variables and hash[a] the hash of these nonzeros
+    unsigned long long* hash = new unsigned long long[nlin];
+    long long* nnz = new long long[nlin];
+    double** Jm = J->local_data();
+    const int nfree=xl->get_local_size();
+    const long long col0 = vec_distrib_usr ? vec_distrib_usr[rank] : 0;
+    for(int a=0; a<nlin; a++) {
+      hash[a]=0; nnz[a]=0;
+      for(int k=0; k<nfree; k++) {
+	const int j=free_vars?free_vars[k]:k;
+	if(Jm[a][j]!=0.) { hash[a] += hash_entry(col0+j, Jm[a][j]); nnz[a]++; }
+      }
+    }
+#ifdef WITH_MPI
+    if(vec_distrib_usr) {
+      int ierr=MPI_Allreduce(MPI_IN_PLACE, hash, nlin, MPI_UNSIGNED_LONG_LONG, MPI_SUM, comm); assert(MPI_SUCCESS==ierr);
+      ierr=MPI_Allreduce(MPI_IN_PLACE, nnz, nlin, MPI_LONG_LONG, MPI_SUM, comm); assert(MPI_SUCCESS==ierr);
+    }
+#endif
+    //the rows sorted by hash; each nonempty row is compared with the first row with the same hash and number of nonzeros
+    std::vector<std::pair<unsigned long long, int> > sorted(nlin);
+    for(int a=0; a<nlin; a++) sorted[a] = std::make_pair(hash[a], a);
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<int> pair_first, pair_second;
+    for(int s=1, first=0; s<nlin; s++) {
+      if(sorted[s].first!=sorted[first].first) { first=s; continue; }
+      const int a=sorted[first].second, b=sorted[s].second;
+      if(nnz[a]>0 && nnz[a]==nnz[b]) { pair_first.push_back(a); pair_second.push_back(b); }
+    }
+    const int npairs=pair_first.size();
+    int* same = new int[npairs>0?npairs:1];
+    for(int p=0; p<npairs; p++) {
+      const int a=pair_first[p], b=pair_second[p];
+      same[p]=1;
+      for(int k=0; k<nfree; k++) {
+	const int j=free_vars?free_vars[k]:k;
+	if(Jm[a][j]!=Jm[b][j]) { same[p]=0; break; }
+      }
+    }
+#ifdef WITH_MPI
+    if(vec_distrib_usr && npairs>0) {
+      int ierr=MPI_Allreduce(MPI_IN_PLACE, same, npairs, MPI_INT, MPI_MIN, comm); assert(MPI_SUCCESS==ierr);
+    }
+#endif
+    const double tol=1e-8;
+    for(int a=0; a<nlin; a++) {
+      const long long i=idx[a];
+      if(nnz[a]>0 || removed[i]) continue;
+      //constant constraint
+      if(vals[a]>=gl[i]-tol*fmax(1.,fabs(gl[i])) && vals[a]<=gu[i]+tol*fmax(1.,fabs(gu[i]))) {
+	removed[i]=true; nremoved++;
+      } else {
+	log->printf(hovWarning, "Presolve: constant constraint %lld is infeasible (value %g, bounds [%g,%g])\n", 
+		    i, vals[a], gl[i], gu[i]);
+      }
+    }
+    for(int p=0; p<npairs; p++) {
+      const int a=pair_first[p], b=pair_second[p];
+      const long long i=idx[a], j=idx[b];
+      if(!same[p] || removed[j]) continue;
+      //constraint j is constraint i plus a constant; its bounds are shifted and intersected with the bounds of i
+      const double shift=vals[b]-vals[a];
+      const double lo = fmax(gl[i], gl[j]>-1e20 ? gl[j]-shift : gl[j]);
+      const double up = fmin(gu[i], gu[j]< 1e20 ? gu[j]-shift : gu[j]);
+      if(lo>up) {
+	log->printf(hovWarning, "Presolve: duplicated constraints %lld and %lld have incompatible bounds\n", i, j);
+	continue;
+      }
+      gl[i]=lo; gu[i]=up;
+      removed[j]=true; nremoved++;
+    }
+    delete[] hash; delete[] nnz; delete[] same;
+  }
+  delete J; delete[] vals; delete[] idx;
+  return nremoved;
+}
 
 bool hiopNlpDenseConstraints::eval_f(const double* x, bool new_x, double& f)
 {
   runStats.tmEvalObj.start();
-  bool bret = interface.eval_f(n_vars,x,new_x,f);
+  bool bret = interface.eval_f(n_vars_usr,x_to_usr(x),new_x,f);
+  f *= obj_scale;
   runStats.tmEvalObj.stop(); runStats.nEvalObj++;
   return bret;
 }
@@ -233,7 +643,16 @@ bool hiopNlpDenseConstraints::eval_grad_f(const double* x, bool new_x, double* g
 {
   bool bret; 
   runStats.tmEvalGrad_f.start();
-  bret = interface.eval_grad_f(n_vars,x,new_x,gradf);
+  if(NULL==free_vars) {
+    bret = interface.eval_grad_f(n_vars_usr,x,new_x,gradf);
+  } else {
+    bret = interface.eval_grad_f(n_vars_usr,x_to_usr(x),new_x,grad_usr->local_data());
+    vec_from_usr(grad_usr->local_data_const(), gradf);
+  }
+  if(obj_scale!=1.) {
+    int nloc=xl->get_local_size(), one=1; 
+    DSCAL(&nloc, &obj_scale, gradf, &one);
+  }
   runStats.tmEvalGrad_f.stop(); runStats.nEvalGrad_f++;
   return bret;
 }
@@ -241,7 +660,13 @@ bool hiopNlpDenseConstraints::eval_Jac_c(const double* x, bool new_x, double** J
 {
   bool bret; 
   runStats.tmEvalJac_con.start();
-  bret = interface.eval_Jac_cons(n_vars,n_cons,n_cons_eq,cons_eq_mapping,x,new_x,Jac_c);
+  if(NULL==free_vars) {
+    bret = interface.eval_Jac_cons(n_vars_usr,n_cons_usr,n_cons_eq,cons_eq_mapping,x,new_x,Jac_c);
+  } else {
+    bret = interface.eval_Jac_cons(n_vars_usr,n_cons_usr,n_cons_eq,cons_eq_mapping,x_to_usr(x),new_x,Jac_usr->local_data());
+    Jac_from_usr(n_cons_eq, Jac_c);
+  }
+  if(c_scale) scale_Jac_rows(*c_scale, Jac_c);
   runStats.tmEvalJac_con.stop(); runStats.nEvalJac_con_eq++;
   return bret;
 }
@@ -249,15 +674,94 @@ bool hiopNlpDenseConstraints::eval_Jac_d(const double* x, bool new_x, double** J
 {
   bool bret; 
   runStats.tmEvalJac_con.start();
-  bret = interface.eval_Jac_cons(n_vars,n_cons,n_cons_ineq,cons_ineq_mapping,x,new_x,Jac_d);
+  if(NULL==free_vars) {
+    bret = interface.eval_Jac_cons(n_vars_usr,n_cons_usr,n_cons_ineq,cons_ineq_mapping,x,new_x,Jac_d);
+  } else {
+    bret = interface.eval_Jac_cons(n_vars_usr,n_cons_usr,n_cons_ineq,cons_ineq_mapping,x_to_usr(x),new_x,Jac_usr->local_data());
+    Jac_from_usr(n_cons_ineq, Jac_d);
+  }
+  if(d_scale) scale_Jac_rows(*d_scale, Jac_d);
   runStats.tmEvalJac_con.stop(); runStats.nEvalJac_con_ineq++;
   return bret;
 }
+bool hiopNlpDenseConstraints::eval_Jac_c(const double* x, bool new_x, hiopMatrix& Jac_c)
+{
+  return eval_Jac_c(x, new_x, dynamic_cast<hiopMatrixDense&>(Jac_c).local_data());
+}
+bool hiopNlpDenseConstraints::eval_Jac_d(const double* x, bool new_x, hiopMatrix& Jac_d)
+{
+  return eval_Jac_d(x, new_x, dynamic_cast<hiopMatrixDense&>(Jac_d).local_data());
+}
+bool hiopNlpDenseConstraints::eval_Hess_diag(const double* x, bool new_x, double* diag)
+{
+  bool bret;
+  if(NULL==free_vars) {
+    bret = interface.eval_Hess_diag(n_vars_usr,x,new_x,diag);
+  } else {
+    bret = interface.eval_Hess_diag(n_vars_usr,x_to_usr(x),new_x,grad_usr->local_data());
+    if(bret) vec_from_usr(grad_usr->local_data_const(), diag);
+  }
+  if(bret && obj_scale!=1.) {
+    int nloc=xl->get_local_size(), one=1; 
+    DSCAL(&nloc, &obj_scale, diag, &one);
+  }
+  return bret;
+}
+bool hiopNlpDenseConstraints::eval_Hess_f_vec(const double* x, bool new_x, const double* v, double* Hv)
+{
+  bool bret;
+  if(NULL==free_vars) {
+    bret = interface.eval_Hess_f_vec(n_vars_usr,x,new_x,v,Hv);
+  } else {
+    //the directions of the variables not in the working set are zero
+    if(NULL==v_usr) v_usr = xl_usr->alloc_clone();
+    v_usr->setToZero();
+    double* vu=v_usr->local_data();
+    for(long long k=0; k<xl->get_local_size(); k++) vu[free_vars[k]]=v[k];
+    bret = interface.eval_Hess_f_vec(n_vars_usr,x_to_usr(x),new_x,vu,grad_usr->local_data());
+    if(bret) vec_from_usr(grad_usr->local_data_const(), Hv);
+  }
+  if(bret && obj_scale!=1.) {
+    int nloc=xl->get_local_size(), one=1; 
+    DSCAL(&nloc, &obj_scale, Hv, &one);
+  }
+  return bret;
+}
+bool hiopNlpDenseConstraints::eval_Hess_Lagr(const double* x, bool new_x, const hiopVectorPar& yc, const hiopVectorPar& yd, 
+					     double** Hess)
+{
+  //the multipliers in the user's order of the constraints; the constraints removed by the presolve have zero multipliers
+  if(NULL==lambda_usr) lambda_usr = new hiopVectorPar(n_cons_usr);
+  lambda_usr->setToZero();
+  double* lambda=lambda_usr->local_data();
+  for(long long i=0; i<n_cons_eq; i++)
+    lambda[cons_eq_mapping[i]] = yc.local_data_const()[i] * (c_scale ? c_scale->local_data_const()[i] : 1.);
+  for(long long i=0; i<n_cons_ineq; i++)
+    lambda[cons_ineq_mapping[i]] = yd.local_data_const()[i] * (d_scale ? d_scale->local_data_const()[i] : 1.);
+
+  bool bret;
+  runStats.tmEvalHess.start();
+  if(NULL==free_vars) {
+    bret = interface.eval_Hess_Lagr(n_vars_usr, n_cons_usr, x, new_x, obj_scale, lambda, true, Hess);
+  } else {
+    if(NULL==Hess_usr) Hess_usr = new hiopMatrixDense(n_vars_usr, n_vars_usr);
+    bret = interface.eval_Hess_Lagr(n_vars_usr, n_cons_usr, x_to_usr(x), new_x, obj_scale, lambda, true, Hess_usr->local_data());
+    if(bret) {
+      double** Hu=Hess_usr->local_data();
+      const long long nloc=xl->get_local_size();
+      for(long long i=0; i<nloc; i++)
+	for(long long j=0; j<nloc; j++) Hess[i][j]=Hu[free_vars[i]][free_vars[j]];
+    }
+  }
+  runStats.tmEvalHess.stop(); runStats.nEvalHess++;
+  return bret;
+}
 bool hiopNlpDenseConstraints::eval_c(const double*x, bool new_x, double* c)
 {
   bool bret; 
   runStats.tmEvalCons.start();
-  bret = interface.eval_cons(n_vars,n_cons,n_cons_eq,cons_eq_mapping,x,new_x,c);
+  bret = interface.eval_cons(n_vars_usr,n_cons_usr,n_cons_eq,cons_eq_mapping,x_to_usr(x),new_x,c);
+  if(c_scale) for(int i=0; i<n_cons_eq; i++) c[i] *= c_scale->local_data_const()[i];
   runStats.tmEvalCons.stop(); runStats.nEvalCons_eq++;
   return bret;
 }
@@ -265,7 +769,8 @@ bool hiopNlpDenseConstraints::eval_d(const double*x, bool new_x, double* d)
 {
   bool bret; 
   runStats.tmEvalCons.start();
-  bret = interface.eval_cons(n_vars,n_cons,n_cons_ineq,cons_ineq_mapping,x,new_x,d);
+  bret = interface.eval_cons(n_vars_usr,n_cons_usr,n_cons_ineq,cons_ineq_mapping,x_to_usr(x),new_x,d);
+  if(d_scale) for(int i=0; i<n_cons_ineq; i++) d[i] *= d_scale->local_data_const()[i];
   runStats.tmEvalCons.stop(); runStats.nEvalCons_ineq++;
   return bret;
 }
@@ -275,10 +780,32 @@ bool  hiopNlpDenseConstraints::eval_d(const hiopVector& x_, bool new_x, hiopVect
   hiopVectorPar &d = dynamic_cast<hiopVectorPar&>(d_);
   bool bret; 
   runStats.tmEvalCons.start();
-  bret = interface.eval_cons(n_vars,n_cons,n_cons_ineq,cons_ineq_mapping,x.local_data_const(),new_x,d.local_data());
+  bret = interface.eval_cons(n_vars_usr,n_cons_usr,n_cons_ineq,cons_ineq_mapping,x_to_usr(x.local_data_const()),new_x,d.local_data());
+  if(d_scale) d.componentMult(*d_scale);
   runStats.tmEvalCons.stop(); runStats.nEvalCons_ineq++;
   return bret;
 }
+
+const double* hiopNlpDenseConstraints::x_to_usr(const double* x)
+{
+  if(NULL==free_vars) return x;
+  double* x_usr_vec=x_usr->local_data();
+  for(long long k=0; k<xl->get_local_size(); k++) x_usr_vec[free_vars[k]]=x[k];
+  return x_usr_vec;
+}
+void hiopNlpDenseConstraints::vec_from_usr(const double* v_usr, double* v) const
+{
+  assert(free_vars);
+  for(long long k=0; k<xl->get_local_size(); k++) v[k]=v_usr[free_vars[k]];
+}
+void hiopNlpDenseConstraints::Jac_from_usr(int nrows, double** Jac) const
+{
+  assert(free_vars);
+  double** J=Jac_usr->local_data();
+  long long nloc=xl->get_local_size();
+  for(int i=0; i<nrows; i++) 
+    for(long long k=0; k<nloc; k++) Jac[i][k]=J[i][free_vars[k]];
+}
 hiopVector* hiopNlpDenseConstraints::alloc_primal_vec() const
 {
   return xl->alloc_clone();
@@ -330,9 +857,8 @@ hiopMatrixDense* hiopNlpDenseConstraints::alloc_multivector_primal(int nrows, in
 {
   hiopMatrixDense* M;
 #ifdef WITH_MPI
-  long long* columns_partitioning=new long long[num_ranks+1];
-  if(true==interface.get_vecdistrib_info(n_vars,columns_partitioning)) {
-    M = new hiopMatrixDense(nrows, n_vars, columns_partitioning, comm, maxrows);
+  if(vec_distrib) {
+    M = new hiopMatrixDense(nrows, n_vars, vec_distrib, comm, maxrows);
   } else {
     //the if is not really needed, but let's keep it clear, costs only a comparison
     if(-1==maxrows)
@@ -340,7 +866,6 @@ hiopMatrixDense* hiopNlpDenseConstraints::alloc_multivector_primal(int nrows, in
     else
       M = new hiopMatrixDense(nrows, n_vars, NULL, MPI_COMM_SELF, maxrows);
   }
-  delete[] columns_partitioning;
 #else
   //the if is not really needed, but let's keep it clear, costs only a comparison
   if(-1==maxrows)
@@ -350,36 +875,869 @@ hiopMatrixDense* hiopNlpDenseConstraints::alloc_multivector_primal(int nrows, in
 #endif
   return M;
 }
+hiopMatrixDense* hiopNlpDenseConstraints::alloc_usr_multivector(int nrows) const
+{
+#ifdef WITH_MPI
+  if(vec_distrib_usr) return new hiopMatrixDense(nrows, n_vars_usr, vec_distrib_usr, comm);
+#endif
+  return new hiopMatrixDense(nrows, n_vars_usr);
+}
 
 bool hiopNlpDenseConstraints::get_starting_point(hiopVector& x0_)
 {
   hiopVectorPar &x0 = dynamic_cast<hiopVectorPar&>(x0_);
   bool bret; 
-  bret = interface.get_starting_point(n_vars,x0.local_data());
+  if(NULL==free_vars) {
+    bret = interface.get_starting_point(n_vars_usr,x0.local_data());
+  } else {
+    hiopVectorPar* x0_usr = x_usr->alloc_clone();
+    bret = interface.get_starting_point(n_vars_usr,x0_usr->local_data());
+    vec_from_usr(x0_usr->local_data_const(), x0.local_data());
+    delete x0_usr;
+  }
+  if(bret && NULL==c_scale && options->GetString("scaling_type")=="gradient")
+    bret = compute_scaling(x0.local_data_const());
   return bret;
 }
 
-void hiopNlpDenseConstraints::print(FILE* f, const char* msg, int rank) const
+/* Gradient-based scaling (as in Ipopt): the objective and each constraint are scaled down so that the 
+ * inf-norm of their gradients at the starting point is at most 'scaling_max_grad'. The variables are
+ * not scaled. */
+bool hiopNlpDenseConstraints::compute_scaling(const double* x0)
 {
-   int myrank=0; 
+  const double max_grad = options->GetNumeric("scaling_max_grad");
+  bool bret;
+  assert(obj_scale==1. && NULL==c_scale && NULL==d_scale);
+  //objective
+  hiopVectorPar* grad = xl->alloc_clone();
+  bret = eval_grad_f(x0, true, grad->local_data()); assert(bret);
+  double nrm = grad->infnorm();
+  obj_scale = nrm>max_grad ? max_grad/nrm : 1.;
+  delete grad;
+
+  //constraints: the inf-norms of the rows of the Jacobians
+  hiopVectorPar *cs = c_rhs->alloc_clone(), *ds = dl->alloc_clone();
+  cs->setToConstant(1.); ds->setToConstant(1.);
+  double cmin=1., dmin=1.;
+  if(n_cons>0) {
+    hiopMatrixDense *Jc = alloc_Jac_c(), *Jd = alloc_Jac_d();
+    bret = eval_Jac_c(x0, false, Jc->local_data()); assert(bret);
+    bret = eval_Jac_d(x0, false, Jd->local_data()); assert(bret);
+
+    double* nrms = new double[n_cons];
+    long long nloc=xl->get_local_size();
+    for(int i=0; i<n_cons; i++) {
+      const double* row = i<n_cons_eq ? Jc->local_data()[i] : Jd->local_data()[i-n_cons_eq];
+      nrms[i]=0.;
+      for(long long j=0; j<nloc; j++) nrms[i] = fmax(nrms[i], fabs(row[j]));
+    }
 #ifdef WITH_MPI
-  if(rank>=0) assert(MPI_Comm_rank(comm, &myrank)==MPI_SUCCESS);
+    double* nrms_g = new double[n_cons];
+    int ierr=MPI_Allreduce(nrms, nrms_g, n_cons, MPI_DOUBLE, MPI_MAX, comm); assert(MPI_SUCCESS==ierr);
+    memcpy(nrms, nrms_g, n_cons*sizeof(double));
+    delete[] nrms_g;
 #endif
-  if(myrank==rank || rank==-1) {
-    if(NULL==f) f=stdout;
-
-    if(msg) {
-      fprintf(f, "%s\n", msg);
-    } else { 
-      fprintf(f, "NLP summary\n");
+    double* csv=cs->local_data(), *dsv=ds->local_data();
+    for(int i=0; i<n_cons_eq; i++) {
+      nrm = nrms[i];
+      if(nrm>max_grad) csv[i] = max_grad/nrm;
+      cmin = fmin(cmin, csv[i]);
     }
-    fprintf(f, "Total number of variables: %d\n", n_vars);
-    fprintf(f, "     lower/upper/lower_and_upper bounds: %d / %d / %d\n", n_bnds_low, n_bnds_upp, n_bnds_lu);
-    fprintf(f, "Total number of equality constraints: %d\n", n_cons_eq);
-    fprintf(f, "Total number of inequality constraints: %d\n", n_cons_ineq );
-    fprintf(f, "     lower/upper/lower_and_upper bounds: %d / %d / %d\n", n_ineq_low, n_ineq_upp, n_ineq_lu);
-  } 
+    for(int i=0; i<n_cons_ineq; i++) {
+      nrm = nrms[n_cons_eq+i];
+      if(nrm>max_grad) dsv[i] = max_grad/nrm;
+      dmin = fmin(dmin, dsv[i]);
+    }
+    delete[] nrms;
+    delete Jc; delete Jd;
+  }
+  c_scale=cs; d_scale=ds;
+
+  //scale the bounds of the constraints (infinite bounds are not touched)
+  c_rhs->componentMult(*c_scale);
+  double *dlv=dl->local_data(), *duv=du->local_data();
+  const double *idlv=idl->local_data_const(), *iduv=idu->local_data_const(), *dsv=d_scale->local_data_const();
+  for(int i=0; i<n_cons_ineq; i++) {
+    if(idlv[i]==1.) dlv[i] *= dsv[i];
+    if(iduv[i]==1.) duv[i] *= dsv[i];
+  }
+
+  log->printf(hovSummary, "NLP scaling: objective factor %g; smallest factor for eq. constraints %g, for ineq. constraints %g\n",
+	      obj_scale, cmin, dmin);
+  return true;
 }
 
+void hiopNlpDenseConstraints::scale_Jac_rows(const hiopVectorPar& scale, double** Jac) const
+{
+  int nloc=xl->get_local_size(), one=1;
+  const double* sv = scale.local_data_const();
+  for(long long i=0; i<scale.get_local_size(); i++) {
+    double s=sv[i];
+    if(s!=1.) DSCAL(&nloc, &s, Jac[i], &one);
+  }
+}
+
+/* Maps the bounds multipliers to the user's space: they are unscaled and, when presolve removed fixed 
+ * variables, the multipliers of these variables are set to zero. */
+void hiopNlpDenseConstraints::duals_bnds_to_usr(const hiopVectorPar& z, hiopVectorPar& z_usr) const
+{
+  if(NULL==free_vars) {
+    z_usr.copyFrom(z);
+  } else {
+    z_usr.setToZero();
+    const double* zv=z.local_data_const(); double* zuv=z_usr.local_data();
+    for(long long k=0; k<z.get_local_size(); k++) zuv[free_vars[k]]=zv[k];
+  }
+  if(obj_scale!=1.) z_usr.scale(1./obj_scale);
+}
+
+/* Evaluates in grad_usr the gradient of the Lagrangian of the (scaled) problem in the user's space, namely, 
+ * grad_f + Jc^T yc + Jd^T yd, which is equal to zl-zu at a stationary point. */
+bool hiopNlpDenseConstraints::eval_grad_Lagr_usr(const double* x_usr_vec, const hiopVectorPar& yc, const hiopVectorPar& yd)
+{
+  double* g=grad_usr->local_data();
+  int nloc=grad_usr->get_local_size(), one=1;
+  bool bret = interface.eval_grad_f(n_vars_usr, x_usr_vec, true, g);
+  if(bret && obj_scale!=1.) DSCAL(&nloc, &obj_scale, g, &one);
+  double** J=Jac_usr->local_data();
+  if(bret && n_cons_eq>0) {
+    bret = interface.eval_Jac_cons(n_vars_usr, n_cons_usr, n_cons_eq, cons_eq_mapping, x_usr_vec, false, J);
+    for(int i=0; bret && i<n_cons_eq; i++) {
+      double y = yc.local_data_const()[i] * (c_scale ? c_scale->local_data_const()[i] : 1.);
+      DAXPY(&nloc, &y, J[i], &one, g, &one);
+    }
+  }
+  if(bret && n_cons_ineq>0) {
+    bret = interface.eval_Jac_cons(n_vars_usr, n_cons_usr, n_cons_ineq, cons_ineq_mapping, x_usr_vec, false, J);
+    for(int i=0; bret && i<n_cons_ineq; i++) {
+      double y = yd.local_data_const()[i] * (d_scale ? d_scale->local_data_const()[i] : 1.);
+      DAXPY(&nloc, &y, J[i], &one, g, &one);
+    }
+  }
+  return bret;
+}
+
+/* The multipliers of the variables that are not in the working set are recovered from the stationarity 
+ * condition, namely, zl-zu = grad_f + Jc^T yc + Jd^T yd, in the user's (unscaled) space. */
+void hiopNlpDenseConstraints::duals_fixed_vars(const double* x_usr_vec, const hiopVectorPar& yc, const hiopVectorPar& yd,
+					       hiopVectorPar& zl_usr, hiopVectorPar& zu_usr)
+{
+  assert(free_vars);
+  if(!eval_grad_Lagr_usr(x_usr_vec, yc, yd)) {
+    log->printf(hovWarning, "Presolve: could not evaluate the multipliers of the fixed variables\n");
+    return;
+  }
+  const double* g=grad_usr->local_data_const();
+  double *zlv=zl_usr.local_data(), *zuv=zu_usr.local_data();
+  for(int j=0, k=0; j<grad_usr->get_local_size(); j++) {
+    if(k<xl->get_local_size() && free_vars[k]==j) { k++; continue; }
+    zlv[j]=fmax(g[j], 0.)/obj_scale; zuv[j]=fmax(-g[j], 0.)/obj_scale;
+  }
+}
+
+void hiopNlpDenseConstraints::user_callback_solution(hiopSolveStatus status,
+						     const hiopVector& x,
+						     const hiopVector& z_L,
+						     const hiopVector& z_U,
+						     const hiopVector& c, const hiopVector& d,
+						     const hiopVector& yc, const hiopVector& yd,
+						     double obj_value) 
+{
+  const hiopVectorPar& xp = dynamic_cast<const hiopVectorPar&>(x);
+  const hiopVectorPar& zl = dynamic_cast<const hiopVectorPar&>(z_L);
+  const hiopVectorPar& zu = dynamic_cast<const hiopVectorPar&>(z_U);
+  assert(xp.get_size()==n_vars);
+  assert(c.get_size()+d.get_size()==n_cons);
+  const double *x_usr_vec=x_to_usr(xp.local_data_const()), *zl_usr_vec=zl.local_data_const(), *zu_usr_vec=zu.local_data_const();
+  //the bounds multipliers are unscaled and mapped to the user's space
+  hiopVectorPar *zl_usr=NULL, *zu_usr=NULL;
+  if(obj_scale!=1. || free_vars) {
+    zl_usr=(x_usr ? x_usr : xl)->alloc_clone(); duals_bnds_to_usr(zl, *zl_usr);
+    zu_usr=(x_usr ? x_usr : xl)->alloc_clone(); duals_bnds_to_usr(zu, *zu_usr);
+    if(free_vars)
+      duals_fixed_vars(x_usr_vec, dynamic_cast<const hiopVectorPar&>(yc), dynamic_cast<const hiopVectorPar&>(yd), 
+		       *zl_usr, *zu_usr);
+    zl_usr_vec=zl_usr->local_data_const(); zu_usr_vec=zu_usr->local_data_const();
+  }
+  //!petra: to do: assemble (c,d) into cons and (yc,yd) into lambda based on cons_eq_mapping and cons_ineq_mapping
+  interface.solution_callback(status, 
+			      (int)n_vars_usr, x_usr_vec, zl_usr_vec, zu_usr_vec,
+			      (int)n_cons_usr, NULL, //cons, 
+			      NULL, //lambda,
+			      user_obj_value(obj_value));
+  if(zl_usr) delete zl_usr;
+  if(zu_usr) delete zu_usr;
+}
+
+bool hiopNlpDenseConstraints::user_callback_iterate(int iter, double obj_value,
+						    const hiopVector& x, const hiopVector& z_L, const hiopVector& z_U,
+						    const hiopVector& c, const hiopVector& d, const hiopVector& yc, const hiopVector& yd,
+						    double inf_pr, double inf_du, double mu, double alpha_du, double alpha_pr, int ls_trials)
+{
+  const hiopVectorPar& xp = dynamic_cast<const hiopVectorPar&>(x);
+  const hiopVectorPar& zl = dynamic_cast<const hiopVectorPar&>(z_L);
+  const hiopVectorPar& zu = dynamic_cast<const hiopVectorPar&>(z_U);
+  assert(xp.get_size()==n_vars);
+  assert(c.get_size()+d.get_size()==n_cons);
+  const double *x_usr_vec=x_to_usr(xp.local_data_const()), *zl_usr_vec=zl.local_data_const(), *zu_usr_vec=zu.local_data_const();
+  //to avoid extra evaluations, the multipliers of the fixed variables are zero at intermediate iterates
+  hiopVectorPar *zl_usr=NULL, *zu_usr=NULL;
+  if(obj_scale!=1. || free_vars) {
+    zl_usr=(x_usr ? x_usr : xl)->alloc_clone(); duals_bnds_to_usr(zl, *zl_usr);
+    zu_usr=(x_usr ? x_usr : xl)->alloc_clone(); duals_bnds_to_usr(zu, *zu_usr);
+    zl_usr_vec=zl_usr->local_data_const(); zu_usr_vec=zu_usr->local_data_const();
+  }
+  //!petra: to do: assemble (c,d) into cons and (yc,yd) into lambda based on cons_eq_mapping and cons_ineq_mapping
+  hiopTimeScope scope(runStats.profile, tpIterCallback);
+  bool bret = interface.iterate_callback(iter, user_obj_value(obj_value), 
+					 (int)n_vars_usr, x_usr_vec, zl_usr_vec, zu_usr_vec,
+					 (int)n_cons_usr, NULL, //cons, 
+					 NULL, //lambda,
+					 inf_pr, inf_du, mu, alpha_du, alpha_pr,  ls_trials);
+  if(zl_usr) delete zl_usr;
+  if(zu_usr) delete zu_usr;
+  return bret;
+}
+
+void hiopNlpDenseConstraints::print(FILE* f, const char* msg, int rank) const
+{
+   int myrank=0; 
+#ifdef WITH_MPI
+  if(rank>=0) assert(MPI_Comm_rank(comm, &myrank)==MPI_SUCCESS);
+#endif
+  if(myrank==rank || rank==-1) {
+    if(NULL==f) f=stdout;
+
+    if(msg) {
+      fprintf(f, "%s\n", msg);
+    } else { 
+      fprintf(f, "NLP summary\n");
+    }
+    if(n_fixed_vars>0 || n_cons_removed>0)
+      fprintf(f, "Presolve removed %lld fixed variables and %lld linear constraints\n", n_fixed_vars, n_cons_removed);
+    fprintf(f, "Total number of variables: %d\n", n_vars);
+    fprintf(f, "     lower/upper/lower_and_upper bounds: %d / %d / %d\n", n_bnds_low, n_bnds_upp, n_bnds_lu);
+    fprintf(f, "Total number of equality constraints: %d\n", n_cons_eq);
+    fprintf(f, "Total number of inequality constraints: %d\n", n_cons_ineq );
+    fprintf(f, "     lower/upper/lower_and_upper bounds: %d / %d / %d\n", n_ineq_low, n_ineq_upp, n_ineq_lu);
+  } 
+}
+
+
+/**************************************************************************
+ * hiopNlpSparse
+ *************************************************************************/
+hiopNlpSparse::hiopNlpSparse(hiopInterfaceSparse& interface_, const char* options_file)
+  : hiopNlpFormulation(interface_, options_file), interface(interface_)
+{
+#ifdef WITH_MPI
+  //the problem is solved on every rank; the output is printed by the rank 0 of the user's communicator
+  if(num_ranks>1)
+    log->printf(hovWarning, "hiopNlpSparse: the sparse formulation is not distributed; the problem is solved on each of the %d ranks\n", 
+		num_ranks);
+  comm=MPI_COMM_SELF; num_ranks=1;
+  runStats.setComm(comm);
+#endif
+  bool bret = interface.get_prob_sizes(n_vars, n_cons); assert(bret);
+  const long long n_cons_usr=n_cons;
+
+  xl = new hiopVectorPar(n_vars);
+  xu = xl->alloc_clone();
+  vars_type = new hiopInterfaceBase::NonlinearityType[n_vars];
+  bret=interface.get_vars_info(n_vars,xl->local_data(),xu->local_data(),vars_type); assert(bret);
+
+  //ixl(ow) and ix(upp) vectors
+  ixl = xu->alloc_clone(); ixu = xu->alloc_clone();
+  double  *xl_vec= xl->local_data(),  *xu_vec= xu->local_data();
+  double *ixl_vec=ixl->local_data(), *ixu_vec=ixu->local_data();
+  for(int i=0;i<n_vars; i++) {
+    if(xl_vec[i]>-1e20) { 
+      ixl_vec[i]=1.; n_bnds_low_local++;
+      if(xu_vec[i]< 1e20) n_bnds_lu++;
+    } else ixl_vec[i]=0.;
+
+    if(xu_vec[i]< 1e20) { 
+      ixu_vec[i]=1.; n_bnds_upp_local++;
+    }
+    else ixu_vec[i]=0.;
+  }
+  n_bnds_low=n_bnds_low_local; n_bnds_upp=n_bnds_upp_local;
+
+  /* split the constraints */
+  double *gl = new double[n_cons_usr], *gu = new double[n_cons_usr];
+  hiopInterfaceBase::NonlinearityType* cons_type = new hiopInterfaceBase::NonlinearityType[n_cons_usr];
+  bret = interface.get_cons_info(n_cons_usr, gl, gu, cons_type); assert(bret);
+  split_constraints(n_cons_usr, gl, gu, cons_type, NULL);
+  delete[] gl; delete[] gu; delete[] cons_type;
+
+  /* the patterns of the Jacobian, split in Jac_c and Jac_d, and of the Hessian (lower triangle) */
+  bret = interface.get_sparse_blocks_info(nnz_jac, nnz_hess); assert(bret);
+  int *irow = new int[nnz_jac>0?nnz_jac:1], *jcol = new int[nnz_jac>0?nnz_jac:1];
+  bret = interface.eval_Jac_cons(n_vars, n_cons, NULL, false, nnz_jac, irow, jcol, NULL); assert(bret);
+  //the block and the row in the block of each constraint of the user
+  int *cons_block = new int[n_cons_usr>0?n_cons_usr:1];
+  long long* cons_row = new long long[n_cons_usr>0?n_cons_usr:1];
+  for(long long i=0; i<n_cons_eq; i++)   { cons_block[cons_eq_mapping[i]]=0;   cons_row[cons_eq_mapping[i]]=i; }
+  for(long long i=0; i<n_cons_ineq; i++) { cons_block[cons_ineq_mapping[i]]=1; cons_row[cons_ineq_mapping[i]]=i; }
+  jac_block = new int[nnz_jac>0?nnz_jac:1];
+  jac_map   = new int[nnz_jac>0?nnz_jac:1];
+  int nnz_c=0, nnz_d=0;
+  for(long long k=0; k<nnz_jac; k++) {
+    assert(irow[k]>=0 && irow[k]<n_cons_usr);
+    jac_block[k] = cons_block[irow[k]];
+    if(0==jac_block[k]) nnz_c++; else nnz_d++;
+  }
+  int *ic = new int[nnz_c>0?nnz_c:1], *jc = new int[nnz_c>0?nnz_c:1], *mapc = new int[nnz_c>0?nnz_c:1];
+  int *id = new int[nnz_d>0?nnz_d:1], *jd = new int[nnz_d>0?nnz_d:1], *mapd = new int[nnz_d>0?nnz_d:1];
+  for(long long k=0, kc=0, kd=0; k<nnz_jac; k++) {
+    if(0==jac_block[k]) { ic[kc]=cons_row[irow[k]]; jc[kc]=jcol[k]; kc++; }
+    else                { id[kd]=cons_row[irow[k]]; jd[kd]=jcol[k]; kd++; }
+  }
+  Jac_c_pattern = new hiopMatrixSparse(n_cons_eq,   n_vars, nnz_c, ic, jc, mapc);
+  Jac_d_pattern = new hiopMatrixSparse(n_cons_ineq, n_vars, nnz_d, id, jd, mapd);
+  for(long long k=0, kc=0, kd=0; k<nnz_jac; k++) 
+    jac_map[k] = 0==jac_block[k] ? mapc[kc++] : mapd[kd++];
+  delete[] ic; delete[] jc; delete[] mapc;
+  delete[] id; delete[] jd; delete[] mapd;
+  delete[] irow; delete[] jcol; delete[] cons_row; delete[] cons_block;
+
+  irow = new int[nnz_hess>0?nnz_hess:1]; jcol = new int[nnz_hess>0?nnz_hess:1];
+  bret = interface.eval_Hess_Lagr(n_vars, n_cons, NULL, false, 1.0, NULL, false, nnz_hess, irow, jcol, NULL); assert(bret);
+  for(long long k=0; k<nnz_hess; k++) 
+    if(irow[k]<jcol[k]) { const int aux=irow[k]; irow[k]=jcol[k]; jcol[k]=aux; }
+  hess_map = new int[nnz_hess>0?nnz_hess:1];
+  Hess_pattern = new hiopMatrixSparse(n_vars, n_vars, nnz_hess, irow, jcol, hess_map);
+  delete[] irow; delete[] jcol;
+
+  jac_vals = new double[nnz_jac>0?nnz_jac:1];
+  hess_vals = new double[nnz_hess>0?nnz_hess:1];
+  x_jac = xl->alloc_clone();
+  jac_vals_valid=false;
+  lambda_usr = new hiopVectorPar(n_cons);
+}
+
+hiopNlpSparse::~hiopNlpSparse()
+{
+  if(jac_block) delete[] jac_block;
+  if(jac_map)   delete[] jac_map;
+  if(hess_map)  delete[] hess_map;
+  if(Jac_c_pattern) delete Jac_c_pattern;
+  if(Jac_d_pattern) delete Jac_d_pattern;
+  if(Hess_pattern)  delete Hess_pattern;
+  if(jac_vals)  delete[] jac_vals;
+  if(hess_vals) delete[] hess_vals;
+  if(x_jac)     delete x_jac;
+  if(lambda_usr) delete lambda_usr;
+}
+
+bool hiopNlpSparse::eval_f(const double* x, bool new_x, double& f)
+{
+  runStats.tmEvalObj.start();
+  bool bret = interface.eval_f(n_vars,x,new_x,f);
+  runStats.tmEvalObj.stop(); runStats.nEvalObj++;
+  return bret;
+}
+bool hiopNlpSparse::eval_grad_f(const double* x, bool new_x, double* gradf)
+{
+  runStats.tmEvalGrad_f.start();
+  bool bret = interface.eval_grad_f(n_vars,x,new_x,gradf);
+  runStats.tmEvalGrad_f.stop(); runStats.nEvalGrad_f++;
+  return bret;
+}
+bool hiopNlpSparse::eval_c(const double*x, bool new_x, double* c)
+{
+  runStats.tmEvalCons.start();
+  bool bret = interface.eval_cons(n_vars,n_cons,n_cons_eq,cons_eq_mapping,x,new_x,c);
+  runStats.tmEvalCons.stop(); runStats.nEvalCons_eq++;
+  return bret;
+}
+bool hiopNlpSparse::eval_d(const double*x, bool new_x, double* d)
+{
+  runStats.tmEvalCons.start();
+  bool bret = interface.eval_cons(n_vars,n_cons,n_cons_ineq,cons_ineq_mapping,x,new_x,d);
+  runStats.tmEvalCons.stop(); runStats.nEvalCons_ineq++;
+  return bret;
+}
+
+/* The user evaluates the Jacobian of all the constraints at once; the values are kept for the evaluation 
+ * of the other block at the same x. */
+bool hiopNlpSparse::eval_Jac_cons(const double* x, bool new_x)
+{
+  double* xj=x_jac->local_data();
+  if(jac_vals_valid && 0==memcmp(xj, x, n_vars*sizeof(double))) return true;
+  jac_vals_valid = interface.eval_Jac_cons(n_vars, n_cons, x, new_x, nnz_jac, NULL, NULL, jac_vals);
+  memcpy(xj, x, n_vars*sizeof(double));
+  return jac_vals_valid;
+}
+bool hiopNlpSparse::eval_Jac_c(const double* x, bool new_x, hiopMatrix& Jac_c_)
+{
+  hiopMatrixSparse& Jac_c = dynamic_cast<hiopMatrixSparse&>(Jac_c_);
+  runStats.tmEvalJac_con.start();
+  bool bret = eval_Jac_cons(x, new_x);
+  Jac_c.setToZero();
+  double* vals=Jac_c.get_values();
+  for(long long k=0; k<nnz_jac; k++) 
+    if(0==jac_block[k]) vals[jac_map[k]] += jac_vals[k];
+  runStats.tmEvalJac_con.stop(); runStats.nEvalJac_con_eq++;
+  return bret;
+}
+bool hiopNlpSparse::eval_Jac_d(const double* x, bool new_x, hiopMatrix& Jac_d_)
+{
+  hiopMatrixSparse& Jac_d = dynamic_cast<hiopMatrixSparse&>(Jac_d_);
+  runStats.tmEvalJac_con.start();
+  bool bret = eval_Jac_cons(x, new_x);
+  Jac_d.setToZero();
+  double* vals=Jac_d.get_values();
+  for(long long k=0; k<nnz_jac; k++) 
+    if(1==jac_block[k]) vals[jac_map[k]] += jac_vals[k];
+  runStats.tmEvalJac_con.stop(); runStats.nEvalJac_con_ineq++;
+  return bret;
+}
+bool hiopNlpSparse::eval_Hess_Lagr(const double* x, bool new_x, const hiopVectorPar& yc, const hiopVectorPar& yd, 
+				   hiopMatrixSparse& Hess)
+{
+  double* lambda=lambda_usr->local_data();
+  for(long long i=0; i<n_cons_eq; i++)   lambda[cons_eq_mapping[i]]   = yc.local_data_const()[i];
+  for(long long i=0; i<n_cons_ineq; i++) lambda[cons_ineq_mapping[i]] = yd.local_data_const()[i];
+  runStats.tmEvalHess.start();
+  bool bret = interface.eval_Hess_Lagr(n_vars, n_cons, x, new_x, 1.0, lambda, true, nnz_hess, NULL, NULL, hess_vals);
+  if(bret) Hess.setFromTriplets(hess_vals, hess_map, nnz_hess);
+  runStats.tmEvalHess.stop(); runStats.nEvalHess++;
+  return bret;
+}
+bool hiopNlpSparse::get_starting_point(hiopVector& x0_)
+{
+  hiopVectorPar &x0 = dynamic_cast<hiopVectorPar&>(x0_);
+  return interface.get_starting_point(n_vars,x0.local_data());
+}
+
+hiopVector* hiopNlpSparse::alloc_primal_vec() const
+{
+  return xl->alloc_clone();
+}
+hiopVector* hiopNlpSparse::alloc_dual_eq_vec() const
+{
+  return c_rhs->alloc_clone();
+}
+hiopVector* hiopNlpSparse::alloc_dual_ineq_vec() const
+{
+  return dl->alloc_clone();
+}
+hiopVector* hiopNlpSparse::alloc_dual_vec() const
+{
+  return new hiopVectorPar(n_cons);
+}
+hiopMatrixSparse* hiopNlpSparse::alloc_Jac_c() const
+{
+  return Jac_c_pattern->alloc_clone();
+}
+hiopMatrixSparse* hiopNlpSparse::alloc_Jac_d() const
+{
+  return Jac_d_pattern->alloc_clone();
+}
+hiopMatrixSparse* hiopNlpSparse::alloc_Hess_Lagr() const
+{
+  return Hess_pattern->alloc_clone();
+}
+hiopMatrixDense* hiopNlpSparse::alloc_multivector_primal(int nrows, int maxrows/*=-1*/) const
+{
+  return new hiopMatrixDense(nrows, n_vars, NULL, MPI_COMM_SELF, maxrows);
+}
+
+void hiopNlpSparse::user_callback_solution(hiopSolveStatus status,
+					   const hiopVector& x,
+					   const hiopVector& z_L,
+					   const hiopVector& z_U,
+					   const hiopVector& c, const hiopVector& d,
+					   const hiopVector& yc, const hiopVector& yd,
+					   double obj_value) 
+{
+  const hiopVectorPar& xp = dynamic_cast<const hiopVectorPar&>(x);
+  const hiopVectorPar& zl = dynamic_cast<const hiopVectorPar&>(z_L);
+  const hiopVectorPar& zu = dynamic_cast<const hiopVectorPar&>(z_U);
+  assert(xp.get_size()==n_vars);
+  assert(c.get_size()+d.get_size()==n_cons);
+  //the constraints and their multipliers in the user's order
+  hiopVectorPar cons(n_cons);
+  double *consv=cons.local_data(), *lambda=lambda_usr->local_data();
+  const double *cv=dynamic_cast<const hiopVectorPar&>(c).local_data_const(), *dv=dynamic_cast<const hiopVectorPar&>(d).local_data_const();
+  const double *ycv=dynamic_cast<const hiopVectorPar&>(yc).local_data_const(), *ydv=dynamic_cast<const hiopVectorPar&>(yd).local_data_const();
+  for(long long i=0; i<n_cons_eq; i++)   { consv[cons_eq_mapping[i]]=cv[i];   lambda[cons_eq_mapping[i]]=ycv[i]; }
+  for(long long i=0; i<n_cons_ineq; i++) { consv[cons_ineq_mapping[i]]=dv[i]; lambda[cons_ineq_mapping[i]]=ydv[i]; }
+  interface.solution_callback(status, 
+			      (int)n_vars, xp.local_data_const(), zl.local_data_const(), zu.local_data_const(),
+			      (int)n_cons, consv, lambda,
+			      obj_value);
+}
+
+bool hiopNlpSparse::user_callback_iterate(int iter, double obj_value,
+					  const hiopVector& x, const hiopVector& z_L, const hiopVector& z_U,
+					  const hiopVector& c, const hiopVector& d, const hiopVector& yc, const hiopVector& yd,
+					  double inf_pr, double inf_du, double mu, double alpha_du, double alpha_pr, int ls_trials)
+{
+  const hiopVectorPar& xp = dynamic_cast<const hiopVectorPar&>(x);
+  const hiopVectorPar& zl = dynamic_cast<const hiopVectorPar&>(z_L);
+  const hiopVectorPar& zu = dynamic_cast<const hiopVectorPar&>(z_U);
+  assert(xp.get_size()==n_vars);
+  //!petra: to do: assemble (c,d) into cons and (yc,yd) into lambda based on cons_eq_mapping and cons_ineq_mapping
+  hiopTimeScope scope(runStats.profile, tpIterCallback);
+  return interface.iterate_callback(iter, obj_value, 
+				    (int)n_vars, xp.local_data_const(), zl.local_data_const(), zu.local_data_const(),
+				    (int)n_cons, NULL, //cons, 
+				    NULL, //lambda,
+				    inf_pr, inf_du, mu, alpha_du, alpha_pr,  ls_trials);
+}
+
+void hiopNlpSparse::print(FILE* f, const char* msg, int rank) const
+{
+  if(rank>=0 && rank!=this->rank) return;
+  if(NULL==f) f=stdout;
+  if(msg) {
+    fprintf(f, "%s\n", msg);
+  } else { 
+    fprintf(f, "NLP summary\n");
+  }
+  fprintf(f, "Total number of variables: %lld\n", n_vars);
+  fprintf(f, "     lower/upper/lower_and_upper bounds: %lld / %lld / %lld\n", n_bnds_low, n_bnds_upp, n_bnds_lu);
+  fprintf(f, "Total number of equality constraints: %lld\n", n_cons_eq);
+  fprintf(f, "Total number of inequality constraints: %lld\n", n_cons_ineq );
+  fprintf(f, "     lower/upper/lower_and_upper bounds: %lld / %lld / %lld\n", n_ineq_low, n_ineq_upp, n_ineq_lu);
+  fprintf(f, "Nonzeros in the Jacobian / Hessian of the Lagrangian: %lld / %lld\n", nnz_jac, nnz_hess);
+}
+
+hiopNlpBlockConstraints::hiopNlpBlockConstraints(hiopInterfaceBlockConstraints& interface_, const char* options_file)
+  : hiopNlpFormulation(interface_, options_file), interface(interface_)
+{
+  int nranks=1, myrank=0;
+#ifdef WITH_MPI
+  nranks=num_ranks; myrank=rank;
+#endif
+  bool bret = interface.get_prob_sizes(n_vars, m_glob); assert(bret);
+
+  vec_distrib=NULL;
+#ifdef WITH_MPI
+  vec_distrib=new long long[num_ranks+1];
+  if(false==interface.get_vecdistrib_info(n_vars,vec_distrib)) {
+    delete[] vec_distrib; vec_distrib=NULL;
+    //the local constraints of a rank involve the variables it owns
+    if(num_ranks>1)
+      log->printf(hovError, "hiopNlpBlockConstraints: the variables need to be distributed (get_vecdistrib_info)\n");
+    assert(num_ranks==1);
+  }
+  if(vec_distrib) xl = new hiopVectorPar(n_vars, vec_distrib, comm);
+  else            xl = new hiopVectorPar(n_vars);
+#else
+  xl = new hiopVectorPar(n_vars);
+#endif
+  xu = xl->alloc_clone();
+  const long long nlocal=xl->get_local_size();
+  vars_type = new hiopInterfaceBase::NonlinearityType[nlocal];
+  bret=interface.get_vars_info(n_vars,xl->local_data(),xu->local_data(),vars_type); assert(bret);
+
+  //ixl(ow) and ix(upp) vectors
+  ixl = xu->alloc_clone(); ixu = xu->alloc_clone();
+  double  *xl_vec= xl->local_data(),  *xu_vec= xu->local_data();
+  double *ixl_vec=ixl->local_data(), *ixu_vec=ixu->local_data();
+  for(long long i=0;i<nlocal; i++) {
+    if(xl_vec[i]>-1e20) { 
+      ixl_vec[i]=1.; n_bnds_low_local++;
+      if(xu_vec[i]< 1e20) n_bnds_lu++;
+    } else ixl_vec[i]=0.;
+
+    if(xu_vec[i]< 1e20) { 
+      ixu_vec[i]=1.; n_bnds_upp_local++;
+    }
+    else ixu_vec[i]=0.;
+  }
+#ifdef WITH_MPI
+  long long aux[3]={n_bnds_low_local, n_bnds_upp_local, n_bnds_lu}, aux_g[3];
+  int ierr=MPI_Allreduce(aux, aux_g, 3, MPI_LONG_LONG, MPI_SUM, comm); assert(MPI_SUCCESS==ierr);
+  n_bnds_low=aux_g[0]; n_bnds_upp=aux_g[1]; n_bnds_lu=aux_g[2];
+#else
+  n_bnds_low=n_bnds_low_local; n_bnds_upp=n_bnds_upp_local;
+#endif
+
+  /* the bounds of the global constraints followed by the ones of the local constraints of all ranks */
+  bret = interface.get_local_cons_sizes(m_loc); assert(bret);
+  std::vector<long long> loc_distrib(nranks+1, 0);
+#ifdef WITH_MPI
+  ierr = MPI_Allgather(&m_loc, 1, MPI_LONG_LONG, &loc_distrib[1], 1, MPI_LONG_LONG, comm); assert(MPI_SUCCESS==ierr);
+#else
+  loc_distrib[1]=m_loc;
+#endif
+  for(int r=0; r<nranks; r++) loc_distrib[r+1] += loc_distrib[r];
+  const long long m_all=m_glob+loc_distrib[nranks];
+
+  std::vector<double> gl(m_all+1), gu(m_all+1), gl_loc(m_loc+1), gu_loc(m_loc+1);
+  std::vector<hiopInterfaceBase::NonlinearityType> cons_type(m_all+1), type_loc(m_loc+1);
+  bret = interface.get_cons_info(m_glob, &gl[0], &gu[0], &cons_type[0]); assert(bret);
+  bret = interface.get_local_cons_info(m_loc, &gl_loc[0], &gu_loc[0], &type_loc[0]); assert(bret);
+#ifdef WITH_MPI
+  std::vector<int> counts(nranks), displs(nranks), itype_loc(m_loc+1), itype(m_all+1);
+  for(int r=0; r<nranks; r++) { counts[r]=(int)(loc_distrib[r+1]-loc_distrib[r]); displs[r]=(int)(m_glob+loc_distrib[r]); }
+  for(long long k=0; k<m_loc; k++) itype_loc[k]=(int)type_loc[k];
+  ierr = MPI_Allgatherv(&gl_loc[0], (int)m_loc, MPI_DOUBLE, &gl[0], &counts[0], &displs[0], MPI_DOUBLE, comm);
+  assert(MPI_SUCCESS==ierr);
+  ierr = MPI_Allgatherv(&gu_loc[0], (int)m_loc, MPI_DOUBLE, &gu[0], &counts[0], &displs[0], MPI_DOUBLE, comm);
+  assert(MPI_SUCCESS==ierr);
+  ierr = MPI_Allgatherv(&itype_loc[0], (int)m_loc, MPI_INT, &itype[0], &counts[0], &displs[0], MPI_INT, comm);
+  assert(MPI_SUCCESS==ierr);
+  for(long long k=m_glob; k<m_all; k++) cons_type[k]=(hiopInterfaceBase::NonlinearityType)itype[k];
+#else
+  for(long long k=0; k<m_loc; k++) { gl[m_glob+k]=gl_loc[k]; gu[m_glob+k]=gu_loc[k]; cons_type[m_glob+k]=type_loc[k]; }
+#endif
+  split_constraints(m_all, &gl[0], &gu[0], &cons_type[0], NULL);
+
+  //the eq and ineq constraints of each rank
+  m_eq_glob_=0;
+  for(long long i=0; i<m_glob; i++) if(gl[i]==gu[i]) m_eq_glob_++;
+  m_ineq_glob_=m_glob-m_eq_glob_;
+  loc_eq_distrib = new long long[nranks+1]; loc_ineq_distrib = new long long[nranks+1];
+  loc_eq_distrib[0]=loc_ineq_distrib[0]=0;
+  for(int r=0; r<nranks; r++) {
+    long long n_eq=0;
+    for(long long i=m_glob+loc_distrib[r]; i<m_glob+loc_distrib[r+1]; i++) if(gl[i]==gu[i]) n_eq++;
+    loc_eq_distrib[r+1] = loc_eq_distrib[r]+n_eq;
+    loc_ineq_distrib[r+1] = loc_ineq_distrib[r]+(loc_distrib[r+1]-loc_distrib[r]-n_eq);
+  }
+  for(long long k=0; k<m_loc; k++) {
+    if(gl_loc[k]==gu_loc[k]) loc_eq_idx.push_back((int)k);
+    else                     loc_ineq_idx.push_back((int)k);
+  }
+  assert(m_loc==loc_distrib[myrank+1]-loc_distrib[myrank]);
+
+  cons_loc = new hiopVectorPar(m_loc);
+  Jac_loc = new hiopMatrixDense(m_loc, nlocal);
+  x_cons = xl->alloc_clone(); x_jac = xl->alloc_clone();
+  cons_valid = jac_valid = false;
+  gather_buff.resize(m_loc+1);
+  cons_usr = new hiopVectorPar(n_cons); lambda_usr = new hiopVectorPar(n_cons);
+
+  log->printf(hovSummary, "hiopNlpBlockConstraints: %lld global and %lld local constraints (%lld on this rank)\n", 
+	      m_glob, loc_distrib[nranks], m_loc);
+}
+
+hiopNlpBlockConstraints::~hiopNlpBlockConstraints()
+{
+  if(vec_distrib) delete[] vec_distrib;
+  delete[] loc_eq_distrib;
+  delete[] loc_ineq_distrib;
+  delete cons_loc;
+  delete Jac_loc;
+  delete x_cons;
+  delete x_jac;
+  delete cons_usr;
+  delete lambda_usr;
+}
+
+bool hiopNlpBlockConstraints::eval_f(const double* x, bool new_x, double& f)
+{
+  runStats.tmEvalObj.start();
+  bool bret = interface.eval_f(n_vars,x,new_x,f);
+  runStats.tmEvalObj.stop(); runStats.nEvalObj++;
+  return bret;
+}
+bool hiopNlpBlockConstraints::eval_grad_f(const double* x, bool new_x, double* gradf)
+{
+  runStats.tmEvalGrad_f.start();
+  bool bret = interface.eval_grad_f(n_vars,x,new_x,gradf);
+  runStats.tmEvalGrad_f.stop(); runStats.nEvalGrad_f++;
+  return bret;
+}
+
+/* The user evaluates all the local constraints at once; the values are kept for the evaluation of the 
+ * other block at the same x. */
+bool hiopNlpBlockConstraints::eval_local_cons(const double* x, bool new_x)
+{
+  double* xc=x_cons->local_data(); const long long nlocal=x_cons->get_local_size();
+  if(cons_valid && 0==memcmp(xc, x, nlocal*sizeof(double))) return true;
+  cons_valid = interface.eval_local_cons(nlocal, m_loc, x, new_x, cons_loc->local_data());
+  memcpy(xc, x, nlocal*sizeof(double));
+  return cons_valid;
+}
+bool hiopNlpBlockConstraints::eval_local_Jac(const double* x, bool new_x)
+{
+  double* xj=x_jac->local_data(); const long long nlocal=x_jac->get_local_size();
+  if(jac_valid && 0==memcmp(xj, x, nlocal*sizeof(double))) return true;
+  jac_valid = interface.eval_local_Jac_cons(nlocal, m_loc, x, new_x, Jac_loc->local_data());
+  memcpy(xj, x, nlocal*sizeof(double));
+  return jac_valid;
+}
+
+void hiopNlpBlockConstraints::gather_local(const std::vector<int>& idx, const long long* distrib, double* v, long long start)
+{
+  const double* cl=cons_loc->local_data_const();
+  for(size_t j=0; j<idx.size(); j++) gather_buff[j]=cl[idx[j]];
+#ifdef WITH_MPI
+  std::vector<int> counts(num_ranks), displs(num_ranks);
+  for(int r=0; r<num_ranks; r++) { counts[r]=(int)(distrib[r+1]-distrib[r]); displs[r]=(int)distrib[r]; }
+  int ierr = MPI_Allgatherv(&gather_buff[0], (int)idx.size(), MPI_DOUBLE, v+start, &counts[0], &displs[0], 
+			    MPI_DOUBLE, comm); assert(MPI_SUCCESS==ierr);
+#else
+  if(idx.size()>0) memcpy(v+start, &gather_buff[0], idx.size()*sizeof(double));
+#endif
+}
+
+bool hiopNlpBlockConstraints::eval_c(const double*x, bool new_x, double* c)
+{
+  runStats.tmEvalCons.start();
+  bool bret = interface.eval_cons(n_vars,m_glob,m_eq_glob_,cons_eq_mapping,x,new_x,c);
+  bret = eval_local_cons(x, new_x) && bret;
+  gather_local(loc_eq_idx, loc_eq_distrib, c, m_eq_glob_);
+  runStats.tmEvalCons.stop(); runStats.nEvalCons_eq++;
+  return bret;
+}
+bool hiopNlpBlockConstraints::eval_d(const double*x, bool new_x, double* d)
+{
+  runStats.tmEvalCons.start();
+  bool bret = interface.eval_cons(n_vars,m_glob,m_ineq_glob_,cons_ineq_mapping,x,new_x,d);
+  bret = eval_local_cons(x, new_x) && bret;
+  gather_local(loc_ineq_idx, loc_ineq_distrib, d, m_ineq_glob_);
+  runStats.tmEvalCons.stop(); runStats.nEvalCons_ineq++;
+  return bret;
+}
+
+bool hiopNlpBlockConstraints::eval_Jac_c(const double* x, bool new_x, hiopMatrix& Jac_c_)
+{
+  hiopMatrixDenseLocalRows& Jac_c = dynamic_cast<hiopMatrixDenseLocalRows&>(Jac_c_);
+  runStats.tmEvalJac_con.start();
+  bool bret = interface.eval_Jac_cons(n_vars,m_glob,m_eq_glob_,cons_eq_mapping,x,new_x,
+				      Jac_c.get_glob_block().local_data());
+  bret = eval_local_Jac(x, new_x) && bret;
+  double **Jl=Jac_c.get_local_block().local_data(), **Ju=Jac_loc->local_data();
+  const size_t nbytes=Jac_loc->get_local_size_n()*sizeof(double);
+  for(size_t j=0; j<loc_eq_idx.size(); j++) memcpy(Jl[j], Ju[loc_eq_idx[j]], nbytes);
+  runStats.tmEvalJac_con.stop(); runStats.nEvalJac_con_eq++;
+  return bret;
+}
+bool hiopNlpBlockConstraints::eval_Jac_d(const double* x, bool new_x, hiopMatrix& Jac_d_)
+{
+  hiopMatrixDenseLocalRows& Jac_d = dynamic_cast<hiopMatrixDenseLocalRows&>(Jac_d_);
+  runStats.tmEvalJac_con.start();
+  bool bret = interface.eval_Jac_cons(n_vars,m_glob,m_ineq_glob_,cons_ineq_mapping,x,new_x,
+				      Jac_d.get_glob_block().local_data());
+  bret = eval_local_Jac(x, new_x) && bret;
+  double **Jl=Jac_d.get_local_block().local_data(), **Ju=Jac_loc->local_data();
+  const size_t nbytes=Jac_loc->get_local_size_n()*sizeof(double);
+  for(size_t j=0; j<loc_ineq_idx.size(); j++) memcpy(Jl[j], Ju[loc_ineq_idx[j]], nbytes);
+  runStats.tmEvalJac_con.stop(); runStats.nEvalJac_con_ineq++;
+  return bret;
+}
+bool hiopNlpBlockConstraints::eval_Hess_diag(const double* x, bool new_x, double* diag)
+{
+  return interface.eval_Hess_diag(n_vars, x, new_x, diag);
+}
+bool hiopNlpBlockConstraints::get_starting_point(hiopVector& x0_)
+{
+  hiopVectorPar &x0 = dynamic_cast<hiopVectorPar&>(x0_);
+  return interface.get_starting_point(n_vars,x0.local_data());
+}
+
+hiopVector* hiopNlpBlockConstraints::alloc_primal_vec() const
+{
+  return xl->alloc_clone();
+}
+hiopVector* hiopNlpBlockConstraints::alloc_dual_eq_vec() const
+{
+  return c_rhs->alloc_clone();
+}
+hiopVector* hiopNlpBlockConstraints::alloc_dual_ineq_vec() const
+{
+  return dl->alloc_clone();
+}
+hiopVector* hiopNlpBlockConstraints::alloc_dual_vec() const
+{
+  return new hiopVectorPar(n_cons);
+}
+hiopMatrixDenseLocalRows* hiopNlpBlockConstraints::alloc_Jac_c() const
+{
+#ifdef WITH_MPI
+  return new hiopMatrixDenseLocalRows(m_eq_glob_, loc_eq_distrib, n_vars, vec_distrib, comm);
+#else
+  return new hiopMatrixDenseLocalRows(m_eq_glob_, loc_eq_distrib, n_vars);
+#endif
+}
+hiopMatrixDenseLocalRows* hiopNlpBlockConstraints::alloc_Jac_d() const
+{
+#ifdef WITH_MPI
+  return new hiopMatrixDenseLocalRows(m_ineq_glob_, loc_ineq_distrib, n_vars, vec_distrib, comm);
+#else
+  return new hiopMatrixDenseLocalRows(m_ineq_glob_, loc_ineq_distrib, n_vars);
+#endif
+}
+hiopMatrixDense* hiopNlpBlockConstraints::alloc_multivector_primal(int nrows, int maxrows/*=-1*/) const
+{
+#ifdef WITH_MPI
+  if(vec_distrib) return new hiopMatrixDense(nrows, n_vars, vec_distrib, comm, maxrows);
+#endif
+  return new hiopMatrixDense(nrows, n_vars, NULL, MPI_COMM_SELF, maxrows);
+}
+
+void hiopNlpBlockConstraints::cons_to_usr(const hiopVector& c, const hiopVector& d, 
+					  const hiopVector& yc, const hiopVector& yd)
+{
+  double *consv=cons_usr->local_data(), *lambda=lambda_usr->local_data();
+  const double *cv=dynamic_cast<const hiopVectorPar&>(c).local_data_const(), *dv=dynamic_cast<const hiopVectorPar&>(d).local_data_const();
+  const double *ycv=dynamic_cast<const hiopVectorPar&>(yc).local_data_const(), *ydv=dynamic_cast<const hiopVectorPar&>(yd).local_data_const();
+  for(long long i=0; i<n_cons_eq; i++)   { consv[cons_eq_mapping[i]]=cv[i];   lambda[cons_eq_mapping[i]]=ycv[i]; }
+  for(long long i=0; i<n_cons_ineq; i++) { consv[cons_ineq_mapping[i]]=dv[i]; lambda[cons_ineq_mapping[i]]=ydv[i]; }
+}
+
+void hiopNlpBlockConstraints::user_callback_solution(hiopSolveStatus status,
+						     const hiopVector& x,
+						     const hiopVector& z_L,
+						     const hiopVector& z_U,
+						     const hiopVector& c, const hiopVector& d,
+						     const hiopVector& yc, const hiopVector& yd,
+						     double obj_value) 
+{
+  const hiopVectorPar& xp = dynamic_cast<const hiopVectorPar&>(x);
+  const hiopVectorPar& zl = dynamic_cast<const hiopVectorPar&>(z_L);
+  const hiopVectorPar& zu = dynamic_cast<const hiopVectorPar&>(z_U);
+  assert(xp.get_size()==n_vars);
+  assert(c.get_size()+d.get_size()==n_cons);
+  cons_to_usr(c, d, yc, yd);
+  interface.solution_callback(status, 
+			      (int)n_vars, xp.local_data_const(), zl.local_data_const(), zu.local_data_const(),
+			      (int)n_cons, cons_usr->local_data_const(), lambda_usr->local_data_const(),
+			      obj_value);
+}
+
+bool hiopNlpBlockConstraints::user_callback_iterate(int iter, double obj_value,
+						    const hiopVector& x, const hiopVector& z_L, const hiopVector& z_U,
+						    const hiopVector& c, const hiopVector& d, const hiopVector& yc, const hiopVector& yd,
+						    double inf_pr, double inf_du, double mu, double alpha_du, double alpha_pr, int ls_trials)
+{
+  const hiopVectorPar& xp = dynamic_cast<const hiopVectorPar&>(x);
+  const hiopVectorPar& zl = dynamic_cast<const hiopVectorPar&>(z_L);
+  const hiopVectorPar& zu = dynamic_cast<const hiopVectorPar&>(z_U);
+  assert(xp.get_size()==n_vars);
+  hiopTimeScope scope(runStats.profile, tpIterCallback);
+  cons_to_usr(c, d, yc, yd);
+  return interface.iterate_callback(iter, obj_value, 
+				    (int)n_vars, xp.local_data_const(), zl.local_data_const(), zu.local_data_const(),
+				    (int)n_cons, cons_usr->local_data_const(), lambda_usr->local_data_const(),
+				    inf_pr, inf_du, mu, alpha_du, alpha_pr,  ls_trials);
+}
+
+void hiopNlpBlockConstraints::print(FILE* f, const char* msg, int rank_) const
+{
+  int myrank=0;
+#ifdef WITH_MPI
+  myrank=rank;
+#endif
+  if(rank_>=0 && rank_!=myrank) return;
+  if(NULL==f) f=stdout;
+  if(msg) {
+    fprintf(f, "%s\n", msg);
+  } else { 
+    fprintf(f, "NLP summary\n");
+  }
+  fprintf(f, "Total number of variables: %lld\n", n_vars);
+  fprintf(f, "     lower/upper/lower_and_upper bounds: %lld / %lld / %lld\n", n_bnds_low, n_bnds_upp, n_bnds_lu);
+  fprintf(f, "Total number of equality constraints: %lld (%lld global)\n", n_cons_eq, m_eq_glob_);
+  fprintf(f, "Total number of inequality constraints: %lld (%lld global)\n", n_cons_ineq, m_ineq_glob_);
+  fprintf(f, "     lower/upper/lower_and_upper bounds: %lld / %lld / %lld\n", n_ineq_low, n_ineq_upp, n_ineq_lu);
+}
 
 };
@@ -52,6 +52,11 @@
 #include "hiopInterface.hpp"
 #include "hiopVector.hpp"
 #include "hiopMatrix.hpp"
+#include "hiopMatrixSparse.hpp"
+#include "hiopMatrixDenseLocalRows.hpp"
+#include "hiopNodeComm.hpp"
+
+#include <vector>
 
 #ifdef WITH_MPI
 #include "mpi.h"  
@@ -67,9 +72,21 @@ namespace hiop
 class hiopNlpFormulation
 {
 public:
-  hiopNlpFormulation(hiopInterfaceBase& interface);
+  /* the options are read from 'options_file' (NULL means hiop.options in the current directory); each instance
+   * has its own options, logger, and statistics, so that several instances can be solved in one process, e.g., 
+   * on different communicators (get_MPI_comm of the interface) */
+  hiopNlpFormulation(hiopInterfaceBase& interface, const char* options_file=NULL);
   virtual ~hiopNlpFormulation();
 
+  /* wrappers for the interface calls */
+  virtual bool eval_f(const double* x, bool new_x, double& f)=0;
+  virtual bool eval_grad_f(const double* x, bool new_x, double* gradf)=0;
+  virtual bool eval_c(const double*x, bool new_x, double* c)=0;
+  virtual bool eval_d(const double*x, bool new_x, double* d)=0;
+  virtual bool eval_Jac_c(const double* x, bool new_x, hiopMatrix& Jac_c)=0;
+  virtual bool eval_Jac_d(const double* x, bool new_x, hiopMatrix& Jac_d)=0;
+  /* diagonal estimate of the Hessian from the user; returns false if not provided (the default) */
+  virtual bool eval_Hess_diag(const double* x, bool new_x, double* diag) { return false; }
   /* starting point */
   virtual bool get_starting_point(hiopVector& x0)=0;
   /** linear algebra factory */
@@ -77,6 +94,34 @@ public:
   virtual hiopVector* alloc_dual_eq_vec() const=0;
   virtual hiopVector* alloc_dual_ineq_vec() const=0;
   virtual hiopVector* alloc_dual_vec() const=0;
+  virtual hiopMatrix* alloc_Jac_c() const=0;
+  virtual hiopMatrix* alloc_Jac_d() const=0;
+  /* dense matrix with n_vars columns and 'nrows' rows, with memory for 'max_rows' rows */
+  virtual hiopMatrixDense* alloc_multivector_primal(int nrows, int max_rows=-1) const=0;
+  /* objective value in the user's formulation */
+  virtual double user_obj_value(const double& f) const { return f; }
+  /** const accessors */
+  inline const hiopVectorPar& get_xl ()  const { return *xl;   }
+  inline const hiopVectorPar& get_xu ()  const { return *xu;   }
+  inline const hiopVectorPar& get_ixl()  const { return *ixl;  }
+  inline const hiopVectorPar& get_ixu()  const { return *ixu;  }
+  inline const hiopVectorPar& get_dl ()  const { return *dl;   }
+  inline const hiopVectorPar& get_du ()  const { return *du;   }
+  inline const hiopVectorPar& get_idl()  const { return *idl;  }
+  inline const hiopVectorPar& get_idu()  const { return *idu;  }
+  inline const hiopVectorPar& get_crhs() const { return *c_rhs;}
+  inline long long n() const      {return n_vars;}
+  inline long long m() const      {return n_cons;}
+  inline long long m_eq() const   {return n_cons_eq;}
+  inline long long m_ineq() const {return n_cons_ineq;}
+  inline long long n_low() const  {return n_bnds_low;}
+  inline long long n_upp() const  {return n_bnds_upp_local;;}
+  inline long long n_low_local() const {return n_bnds_low_local;}
+  inline long long n_upp_local() const {return n_bnds_upp_local;}
+  inline long long m_ineq_low() const {return n_ineq_low;}
+  inline long long m_ineq_upp() const {return n_ineq_upp;}
+  inline long long n_complem()  const {return m_ineq_low()+m_ineq_upp()+n_low()+n_upp();}
+  //inline long long n_complem_local()  const {return m_ineq_low()+m_ineq_upp()+n_low_local()+n_upp_local();}
 
   virtual void user_callback_solution(hiopSolveStatus status,
 				      const hiopVector& x,
@@ -102,16 +147,38 @@ public:
   hiopOptions* options;
   //prints a summary of the problem
   virtual void print(FILE* f=NULL, const char* msg=NULL, int rank=-1) const = 0;
-#ifdef WITH_MPI
+  //without MPI the communicator is a placeholder and the NLP lives on a single rank
   inline MPI_Comm get_comm() const { return comm; }
   inline int      get_rank() const { return rank; }
   inline int      get_num_ranks() const { return num_ranks; }
-#endif
+  /* node-aware communicator for the reduced matrices shared by the ranks of a node; created at the first call 
+   * when the option 'node_shared_reduced_mats' is 'yes' and there is more than one rank, NULL otherwise */
+  hiopNodeComm* get_node_comm();
+
 protected:
-#ifdef WITH_MPI
   MPI_Comm comm;
   int rank, num_ranks;
-#endif
+  hiopNodeComm* node_comm;
+  /* problem data */
+  //various sizes
+  long long n_vars, n_cons, n_cons_eq, n_cons_ineq;
+  long long n_bnds_low, n_bnds_low_local, n_bnds_upp, n_bnds_upp_local, n_ineq_low, n_ineq_upp;
+  long long n_bnds_lu, n_ineq_lu;
+  hiopVectorPar *xl, *xu, *ixu, *ixl; //these will be global, memory distributed
+  hiopInterfaceBase::NonlinearityType* vars_type; //C array containing the types for local vars
+
+  hiopVectorPar *c_rhs; //local
+  hiopInterfaceBase::NonlinearityType* cons_eq_type;
+
+  hiopVectorPar *dl, *du,  *idl, *idu; //these will be local
+  hiopInterfaceBase::NonlinearityType* cons_ineq_type;
+  // keep track of the constraints indexes in the original, user's formulation
+  long long *cons_eq_mapping, *cons_ineq_mapping; 
+
+  /* splits the 'num_cons' constraints of the user in equalities and inequalities, skipping the ones marked
+   * in 'removed' (can be NULL), and builds c_rhs, dl, du, idl, idu, and the mappings */
+  void split_constraints(long long num_cons, const double* gl, const double* gu,
+			 const hiopInterfaceBase::NonlinearityType* cons_type, const bool* removed);
 private:
   hiopNlpFormulation(const hiopNlpFormulation&) {};
 };
@@ -122,7 +189,7 @@ private:
 class hiopNlpDenseConstraints : public hiopNlpFormulation
 {
 public:
-  hiopNlpDenseConstraints(hiopInterfaceDenseConstraints& interface);
+  hiopNlpDenseConstraints(hiopInterfaceDenseConstraints& interface, const char* options_file=NULL);
   virtual ~hiopNlpDenseConstraints();
 
   /* wrappers for the interface calls. Can be overridden for specialized formulations required by the algorithm */
@@ -133,6 +200,14 @@ public:
   virtual bool eval_d(const hiopVector& x, bool new_x, hiopVector& d);
   virtual bool eval_Jac_c(const double* x, bool new_x, double** Jac_c);
   virtual bool eval_Jac_d(const double* x, bool new_x, double** Jac_d);
+  virtual bool eval_Jac_c(const double* x, bool new_x, hiopMatrix& Jac_c);
+  virtual bool eval_Jac_d(const double* x, bool new_x, hiopMatrix& Jac_d);
+  /* diagonal estimate of the Hessian from the user; returns false if the user does not provide it */
+  virtual bool eval_Hess_diag(const double* x, bool new_x, double* diag);
+  /* product of the Hessian of the objective with v; returns false if the user does not provide it */
+  virtual bool eval_Hess_f_vec(const double* x, bool new_x, const double* v, double* Hv);
+  /* dense Hessian of the Lagrangian with the multipliers yc and yd; returns false if the user does not provide it */
+  virtual bool eval_Hess_Lagr(const double* x, bool new_x, const hiopVectorPar& yc, const hiopVectorPar& yd, double** Hess);
   virtual bool get_starting_point(hiopVector& x0);
 
   /* linear algebra factory */
@@ -148,87 +223,229 @@ public:
    */
   virtual hiopMatrixDense* alloc_multivector_primal(int nrows, int max_rows=-1) const;
 
-  virtual inline 
-  void user_callback_solution(hiopSolveStatus status,
-			      const hiopVector& x,
-			      const hiopVector& z_L,
-			      const hiopVector& z_U,
-			      const hiopVector& c, const hiopVector& d,
-			      const hiopVector& yc, const hiopVector& yd,
-			      double obj_value) {
-    const hiopVectorPar& xp = dynamic_cast<const hiopVectorPar&>(x);
-    const hiopVectorPar& zl = dynamic_cast<const hiopVectorPar&>(z_L);
-    const hiopVectorPar& zu = dynamic_cast<const hiopVectorPar&>(z_U);
-    assert(xp.get_size()==n_vars);
-    assert(c.get_size()+d.get_size()==n_cons);
-    //!petra: to do: assemble (c,d) into cons and (yc,yd) into lambda based on cons_eq_mapping and cons_ineq_mapping
-    interface.solution_callback(status, 
-				(int)n_vars, xp.local_data_const(), zl.local_data_const(), zu.local_data_const(),
-				(int)n_cons, NULL, //cons, 
-				NULL, //lambda,
-				obj_value);
-  };
-  virtual inline 
-  bool user_callback_iterate(int iter, double obj_value,
-			     const hiopVector& x, const hiopVector& z_L, const hiopVector& z_U,
-			     const hiopVector& c, const hiopVector& d, const hiopVector& yc, const hiopVector& yd,
-			     double inf_pr, double inf_du, double mu, double alpha_du, double alpha_pr, int ls_trials){
-    const hiopVectorPar& xp = dynamic_cast<const hiopVectorPar&>(x);
-    const hiopVectorPar& zl = dynamic_cast<const hiopVectorPar&>(z_L);
-    const hiopVectorPar& zu = dynamic_cast<const hiopVectorPar&>(z_U);
-    assert(xp.get_size()==n_vars);
-    assert(c.get_size()+d.get_size()==n_cons);
-    //!petra: to do: assemble (c,d) into cons and (yc,yd) into lambda based on cons_eq_mapping and cons_ineq_mapping
-    return interface.iterate_callback(iter, obj_value, 
-				      (int)n_vars, xp.local_data_const(), zl.local_data_const(), zu.local_data_const(),
-				      (int)n_cons, NULL, //cons, 
-				      NULL, //lambda,
-				      inf_pr, inf_du, mu, alpha_du, alpha_pr,  ls_trials);
-      }
-  /** const accessors */
-  inline const hiopVectorPar& get_xl ()  const { return *xl;   }
-  inline const hiopVectorPar& get_xu ()  const { return *xu;   }
-  inline const hiopVectorPar& get_ixl()  const { return *ixl;  }
-  inline const hiopVectorPar& get_ixu()  const { return *ixu;  }
-  inline const hiopVectorPar& get_dl ()  const { return *dl;   }
-  inline const hiopVectorPar& get_du ()  const { return *du;   }
-  inline const hiopVectorPar& get_idl()  const { return *idl;  }
-  inline const hiopVectorPar& get_idu()  const { return *idu;  }
-  inline const hiopVectorPar& get_crhs() const { return *c_rhs;}
-  inline long long n() const      {return n_vars;}
-  inline long long m() const      {return n_cons;}
-  inline long long m_eq() const   {return n_cons_eq;}
-  inline long long m_ineq() const {return n_cons_ineq;}
-  inline long long n_low() const  {return n_bnds_low;}
-  inline long long n_upp() const  {return n_bnds_upp_local;;}
-  inline long long n_low_local() const {return n_bnds_low_local;}
-  inline long long n_upp_local() const {return n_bnds_upp_local;}
-  inline long long m_ineq_low() const {return n_ineq_low;}
-  inline long long m_ineq_upp() const {return n_ineq_upp;}
-  inline long long n_complem()  const {return m_ineq_low()+m_ineq_upp()+n_low()+n_upp();}
-  //inline long long n_complem_local()  const {return m_ineq_low()+m_ineq_upp()+n_low_local()+n_upp_local();}
+  virtual void user_callback_solution(hiopSolveStatus status,
+				      const hiopVector& x,
+				      const hiopVector& z_L,
+				      const hiopVector& z_U,
+				      const hiopVector& c, const hiopVector& d,
+				      const hiopVector& yc, const hiopVector& yd,
+				      double obj_value);
+  virtual bool user_callback_iterate(int iter, double obj_value,
+				     const hiopVector& x, const hiopVector& z_L, const hiopVector& z_U,
+				     const hiopVector& c, const hiopVector& d, const hiopVector& yc, const hiopVector& yd,
+				     double inf_pr, double inf_du, double mu, double alpha_du, double alpha_pr, int ls_trials);
+
+  /* problem scaling: the eval_XXX wrappers return the scaled f, c, d, and derivatives and the bounds 
+   * of the constraints are scaled; the objective returned to the user needs to be unscaled */
+  inline double get_obj_scale() const { return obj_scale; }
+  virtual double user_obj_value(const double& f_scaled) const { return f_scaled/obj_scale; }
+
+  /* presolve: number of fixed variables and of empty or duplicated linear constraints removed */
+  inline long long n_presolved_vars() const { return n_fixed_vars; }
+  inline long long n_presolved_cons() const { return n_cons_removed; }
+
+  /* active-set freezing: variables at their bounds are temporarily removed from the working set */
+  long long freeze_vars(const hiopVectorPar& x, const hiopVectorPar& at_low, const hiopVectorPar& at_upp);
+  void release_frozen_vars();
+  inline long long n_frozen() const { return n_frozen_vars; }
+  double frozen_vars_duals_infeas(const hiopVectorPar& x, const hiopVectorPar& yc, const hiopVectorPar& yd);
+  /* load balancing: moves the variables to the columns partitioning 'cols' if the user accepts it 
+   * (repartition_vecdistrib); returns false if the partitioning did not change */
+  bool repartition_vars(const long long* cols);
+  inline const long long* get_vec_distrib() const { return vec_distrib; }
+  /* maps primal vectors between the working set and the user's space (used when the working set changes);
+   * the entries of the variables not in the working set are set to 'fill' (the fixed values for x) */
+  hiopVectorPar* alloc_usr_primal_vec() const;
+  void x_to_usr(const hiopVectorPar& x, hiopVectorPar& x_usr_out);
+  void primal_vec_to_usr(const hiopVectorPar& v, hiopVectorPar& v_usr, double fill) const;
+  void primal_vec_from_usr(const hiopVectorPar& v_usr, hiopVectorPar& v) const;
+
   virtual void print(FILE* f=NULL, const char* msg=NULL, int rank=-1) const;
 private:
-  /* problem data */
-  //various sizes
-  long long n_vars, n_cons, n_cons_eq, n_cons_ineq;
-  long long n_bnds_low, n_bnds_low_local, n_bnds_upp, n_bnds_upp_local, n_ineq_low, n_ineq_upp;
-  long long n_bnds_lu, n_ineq_lu;
-  hiopVectorPar *xl, *xu, *ixu, *ixl; //these will be global, memory distributed
-  hiopInterfaceBase::NonlinearityType* vars_type; //C array containing the types for local vars
+  long long n_vars_usr, n_cons_usr; //sizes of the user's problem (before presolve)
 
-  hiopVectorPar *c_rhs; //local
-  hiopInterfaceBase::NonlinearityType* cons_eq_type;
+  //scaling factors: objective, equality, and inequality constraints (NULL when the scaling is not used)
+  double obj_scale;
+  hiopVectorPar *c_scale, *d_scale;
+  //computes the gradient-based scaling factors at x0 and scales the constraints' bounds
+  bool compute_scaling(const double* x0);
+  //scales the rows of a Jacobian given as a double** buffer
+  void scale_Jac_rows(const hiopVectorPar& scale, double** Jac) const;
 
-  hiopVectorPar *dl, *du,  *idl, *idu; //these will be local
-  hiopInterfaceBase::NonlinearityType* cons_ineq_type;
-  // keep track of the constraints indexes in the original, user's formulation
-  long long *cons_eq_mapping, *cons_ineq_mapping; 
+  //columns partitioning of the vectors in the algorithm's and user's spaces (NULL when not distributed)
+  long long *vec_distrib, *vec_distrib_usr;
+
+  //bounds and types of the variables of the user's problem
+  hiopVectorPar *xl_usr, *xu_usr;
+  hiopInterfaceBase::NonlinearityType* vars_type_usr;
+
+  //presolve: fixed variables and empty or duplicated linear constraints are removed
+  bool presolve;
+  long long n_fixed_vars, n_cons_removed;
+  //variables frozen at their bounds (active-set freezing)
+  long long n_frozen_vars;
+  int* free_vars; //local indexes (in the user's space) of the variables in the working set; NULL if all are
+  hiopVectorPar *x_usr, *grad_usr, *v_usr; //buffers in the user's space; x_usr keeps the values of the fixed/frozen variables
+  hiopMatrixDense* Jac_usr;
+  hiopMatrixDense* Hess_usr; //the Hessian of the Lagrangian in the user's space (exact Hessian mode with a working set)
+  hiopVectorPar* lambda_usr;
+  void set_free_vars(const bool* is_free);
+  long long presolve_linear_cons(double* gl, double* gu, 
+				 const hiopInterfaceBase::NonlinearityType* cons_type,
+				 bool* removed);
+  //maps between the algorithm's and user's spaces
+  const double* x_to_usr(const double* x);
+  void vec_from_usr(const double* v_usr, double* v) const;
+  void Jac_from_usr(int nrows, double** Jac) const;
+  void duals_bnds_to_usr(const hiopVectorPar& z, hiopVectorPar& z_usr) const;
+  bool eval_grad_Lagr_usr(const double* x_usr_vec, const hiopVectorPar& yc, const hiopVectorPar& yd);
+  void duals_fixed_vars(const double* x_usr_vec, const hiopVectorPar& yc, const hiopVectorPar& yd,
+			hiopVectorPar& zl_usr, hiopVectorPar& zu_usr);
+  hiopMatrixDense* alloc_usr_multivector(int nrows) const;
 private:
 
   /* interface implemented and provided by the user */
   hiopInterfaceDenseConstraints& interface;
 };
 
+/* Class for NLPs with sparse Jacobian and Hessian (see hiopInterfaceSparse), solved with the exact 
+ * Hessian of the Lagrangian and a sparse KKT solver. Splits the constraints in ineq and eq.
+ * The vectors and matrices are not distributed. 
+ */
+class hiopNlpSparse : public hiopNlpFormulation
+{
+public:
+  hiopNlpSparse(hiopInterfaceSparse& interface, const char* options_file=NULL);
+  virtual ~hiopNlpSparse();
+
+  virtual bool eval_f(const double* x, bool new_x, double& f);
+  virtual bool eval_grad_f(const double* x, bool new_x, double* gradf);
+  virtual bool eval_c(const double*x, bool new_x, double* c);
+  virtual bool eval_d(const double*x, bool new_x, double* d);
+  virtual bool eval_Jac_c(const double* x, bool new_x, hiopMatrix& Jac_c);
+  virtual bool eval_Jac_d(const double* x, bool new_x, hiopMatrix& Jac_d);
+  /* lower triangle of the Hessian of the Lagrangian with the multipliers yc and yd */
+  virtual bool eval_Hess_Lagr(const double* x, bool new_x, const hiopVectorPar& yc, const hiopVectorPar& yd, 
+			      hiopMatrixSparse& Hess);
+  virtual bool get_starting_point(hiopVector& x0);
+
+  /* linear algebra factory */
+  virtual hiopVector* alloc_primal_vec() const;
+  virtual hiopVector* alloc_dual_eq_vec() const;
+  virtual hiopVector* alloc_dual_ineq_vec() const;
+  virtual hiopVector* alloc_dual_vec() const;
+  virtual hiopMatrixSparse* alloc_Jac_c() const;
+  virtual hiopMatrixSparse* alloc_Jac_d() const;
+  virtual hiopMatrixSparse* alloc_Hess_Lagr() const;
+  virtual hiopMatrixDense* alloc_multivector_primal(int nrows, int max_rows=-1) const;
+
+  virtual void user_callback_solution(hiopSolveStatus status,
+				      const hiopVector& x,
+				      const hiopVector& z_L,
+				      const hiopVector& z_U,
+				      const hiopVector& c, const hiopVector& d,
+				      const hiopVector& yc, const hiopVector& yd,
+				      double obj_value);
+  virtual bool user_callback_iterate(int iter, double obj_value,
+				     const hiopVector& x, const hiopVector& z_L, const hiopVector& z_U,
+				     const hiopVector& c, const hiopVector& d, const hiopVector& yc, const hiopVector& yd,
+				     double inf_pr, double inf_du, double mu, double alpha_du, double alpha_pr, int ls_trials);
+
+  virtual void print(FILE* f=NULL, const char* msg=NULL, int rank=-1) const;
+private:
+  //evaluates the Jacobian of all the constraints in jac_vals, unless already done at x
+  bool eval_Jac_cons(const double* x, bool new_x);
+private:
+  long long nnz_jac, nnz_hess;
+  //the blocks (0 for Jac_c and 1 for Jac_d) and the positions in the blocks of the Jacobian entries of the user
+  int *jac_block, *jac_map;
+  int* hess_map;
+  //the patterns of Jac_c, Jac_d, and of the Hessian of the Lagrangian; cloned by the alloc_XXX methods
+  hiopMatrixSparse *Jac_c_pattern, *Jac_d_pattern, *Hess_pattern;
+  //buffers for the values of the user
+  double *jac_vals, *hess_vals;
+  hiopVectorPar* x_jac; //the point at which jac_vals were evaluated
+  bool jac_vals_valid;
+  hiopVectorPar* lambda_usr;
+
+  /* interface implemented and provided by the user */
+  hiopInterfaceSparse& interface;
+};
+
+/* Class for NLPs with a small number of global constraints and with local constraints that involve only the
+ * variables of one rank (see hiopInterfaceBlockConstraints). The constraints are ordered as the global ones
+ * followed by the local constraints of each rank, in the order of the ranks, and are split in ineq and eq;
+ * hence the eq (and ineq) global constraints come first. The values of the constraints and the multipliers 
+ * are replicated as for hiopNlpDenseConstraints, but the Jacobians (hiopMatrixDenseLocalRows) keep the local 
+ * rows only on their rank. Presolve, scaling, and active-set freezing are not available.
+ */
+class hiopNlpBlockConstraints : public hiopNlpFormulation
+{
+public:
+  hiopNlpBlockConstraints(hiopInterfaceBlockConstraints& interface, const char* options_file=NULL);
+  virtual ~hiopNlpBlockConstraints();
+
+  virtual bool eval_f(const double* x, bool new_x, double& f);
+  virtual bool eval_grad_f(const double* x, bool new_x, double* gradf);
+  virtual bool eval_c(const double*x, bool new_x, double* c);
+  virtual bool eval_d(const double*x, bool new_x, double* d);
+  virtual bool eval_Jac_c(const double* x, bool new_x, hiopMatrix& Jac_c);
+  virtual bool eval_Jac_d(const double* x, bool new_x, hiopMatrix& Jac_d);
+  virtual bool eval_Hess_diag(const double* x, bool new_x, double* diag);
+  virtual bool get_starting_point(hiopVector& x0);
+
+  /* linear algebra factory */
+  virtual hiopVector* alloc_primal_vec() const;
+  virtual hiopVector* alloc_dual_eq_vec() const;
+  virtual hiopVector* alloc_dual_ineq_vec() const;
+  virtual hiopVector* alloc_dual_vec() const;
+  virtual hiopMatrixDenseLocalRows* alloc_Jac_c() const;
+  virtual hiopMatrixDenseLocalRows* alloc_Jac_d() const;
+  virtual hiopMatrixDense* alloc_multivector_primal(int nrows, int max_rows=-1) const;
+
+  virtual void user_callback_solution(hiopSolveStatus status,
+				      const hiopVector& x,
+				      const hiopVector& z_L,
+				      const hiopVector& z_U,
+				      const hiopVector& c, const hiopVector& d,
+				      const hiopVector& yc, const hiopVector& yd,
+				      double obj_value);
+  virtual bool user_callback_iterate(int iter, double obj_value,
+				     const hiopVector& x, const hiopVector& z_L, const hiopVector& z_U,
+				     const hiopVector& c, const hiopVector& d, const hiopVector& yc, const hiopVector& yd,
+				     double inf_pr, double inf_du, double mu, double alpha_du, double alpha_pr, int ls_trials);
+
+  /* number of global eq and ineq constraints */
+  inline long long m_eq_glob() const { return m_eq_glob_; }
+  inline long long m_ineq_glob() const { return m_ineq_glob_; }
+
+  virtual void print(FILE* f=NULL, const char* msg=NULL, int rank=-1) const;
+private:
+  //evaluates the local constraints in cons_loc unless already done at x (same for the Jacobian)
+  bool eval_local_cons(const double* x, bool new_x);
+  bool eval_local_Jac(const double* x, bool new_x);
+  //gathers the entries 'idx' of cons_loc of all the ranks in 'v', in which they start at 'start'
+  void gather_local(const std::vector<int>& idx, const long long* distrib, double* v, long long start);
+  //the constraints and the multipliers in the user's order (for the callbacks)
+  void cons_to_usr(const hiopVector& c, const hiopVector& d, const hiopVector& yc, const hiopVector& yd);
+private:
+  long long m_glob, m_loc; //the number of global and of local (of this rank) constraints
+  long long m_eq_glob_, m_ineq_glob_;
+  long long* vec_distrib;
+  //the partitioning of the local eq and ineq constraints over the ranks (num_ranks+1 entries)
+  long long *loc_eq_distrib, *loc_ineq_distrib;
+  //the indexes in cons_loc of the local eq and ineq constraints of this rank
+  std::vector<int> loc_eq_idx, loc_ineq_idx;
+  //the local constraints and their Jacobian, and the points at which they were evaluated
+  hiopVectorPar *cons_loc, *x_cons, *x_jac;
+  hiopMatrixDense* Jac_loc;
+  bool cons_valid, jac_valid;
+  std::vector<double> gather_buff;
+  hiopVectorPar *cons_usr, *lambda_usr;
+
+  /* interface implemented and provided by the user */
+  hiopInterfaceBlockConstraints& interface;
+};
+
 }
 #endif
@@ -54,7 +54,7 @@
 namespace hiop
 {
 
-hiopResidual::hiopResidual(hiopNlpDenseConstraints* nlp_)
+hiopResidual::hiopResidual(hiopNlpFormulation* nlp_)
 {
   nlp = nlp_;
   rx = dynamic_cast<hiopVectorPar*>(nlp->alloc_primal_vec());
@@ -73,6 +73,7 @@ hiopResidual::hiopResidual(hiopNlpDenseConstraints* nlp_)
   rsvu = rd->alloc_clone();
   nrmInf_nlp_optim = nrmInf_nlp_feasib = nrmInf_nlp_complem = 1e6;
   nrmInf_bar_optim = nrmInf_bar_feasib = nrmInf_bar_complem = 1e6;
+  mu = 0.;
 }
 
 hiopResidual::~hiopResidual()
@@ -91,6 +92,38 @@ hiopResidual::~hiopResidual()
   if(rsvu) delete rsvu;
 }
 
+void hiopResidual::copyFrom(const hiopResidual& o)
+{
+  rx->copyFrom(*o.rx);
+  rd->copyFrom(*o.rd);
+  rxl->copyFrom(*o.rxl);
+  rxu->copyFrom(*o.rxu);
+  rdl->copyFrom(*o.rdl);
+  rdu->copyFrom(*o.rdu);
+  ryc->copyFrom(*o.ryc);
+  ryd->copyFrom(*o.ryd);
+  rszl->copyFrom(*o.rszl);
+  rszu->copyFrom(*o.rszu);
+  rsvl->copyFrom(*o.rsvl);
+  rsvu->copyFrom(*o.rsvu);
+}
+
+void hiopResidual::updateSOC(const double& alpha, const hiopResidual& trial)
+{
+  //ryc = alpha*ryc + ryc_trial
+  ryc->scale(alpha);
+  ryc->axpy(1.0, *trial.ryc);
+  //ryd = alpha*ryd + ryd_trial
+  ryd->scale(alpha);
+  ryd->axpy(1.0, *trial.ryd);
+}
+
+void hiopResidual::setOptimalityToZero()
+{
+  rx->setToZero();
+  rd->setToZero();
+}
+
 double hiopResidual::computeNlpInfeasInfNorm(const hiopIterate& it, 
 			       const hiopVector& c, 
 			       const hiopVector& d)
@@ -159,7 +192,7 @@ int hiopResidual::update(const hiopIterate& it,
   nrmInf_bar_optim = nrmInf_bar_feasib = nrmInf_bar_complem = 0;
 
   long long nx_loc=rx->get_local_size();
-  const double&  mu=logprob.mu;
+  mu=logprob.mu;
 #ifdef DEEP_CHECKING
   assert(it.zl->matchesPattern(nlp->get_ixl()));
   assert(it.zu->matchesPattern(nlp->get_ixu()));
@@ -298,6 +331,49 @@ int hiopResidual::update(const hiopIterate& it,
   return true;
 }
 
+int hiopResidual::updateMu(const hiopIterate& it, const hiopLogBarProblem& logprob)
+{
+  nlp->runStats.tmSolverInternal.start();
+
+  const double dmu = logprob.mu - mu;
+  mu = logprob.mu;
+  nrmInf_bar_optim = nrmInf_bar_complem = 0.;
+
+  //rx and rd contain the linear damping terms with the opposite sign
+  if(logprob.kappa_d>0.) {
+    it.addLinearDampingTermToGrad_x(dmu, logprob.kappa_d, -1.0, *rx);
+    it.addLinearDampingTermToGrad_d(dmu, logprob.kappa_d, -1.0, *rd);
+  }
+  nrmInf_bar_optim = fmax(rx->infnorm_local(), rd->infnorm_local());
+
+  //rszl, rszu, rsvl, rsvu are shifted by the change in mu
+  if(nlp->n_low_local()>0) {
+    rszl->addConstant_w_patternSelect(dmu,nlp->get_ixl());
+    nrmInf_bar_complem = fmax(nrmInf_bar_complem, rszl->infnorm_local());
+  }
+  if(nlp->n_upp_local()>0) {
+    rszu->addConstant_w_patternSelect(dmu,nlp->get_ixu());
+    nrmInf_bar_complem = fmax(nrmInf_bar_complem, rszu->infnorm_local());
+  }
+  if(nlp->m_ineq_low()>0) {
+    rsvl->addConstant_w_patternSelect(dmu,nlp->get_idl());
+    nrmInf_bar_complem = fmax(nrmInf_bar_complem, rsvl->infnorm_local());
+  }
+  if(nlp->m_ineq_upp()>0) {
+    rsvu->addConstant_w_patternSelect(dmu,nlp->get_idu());
+    nrmInf_bar_complem = fmax(nrmInf_bar_complem, rsvu->infnorm_local());
+  }
+
+#ifdef WITH_MPI
+  //the nlp norms and the barrier feasibility did not change; only the two barrier norms are reduced
+  double aux[2]={nrmInf_bar_optim,nrmInf_bar_complem}, aux_g[2];
+  int ierr = MPI_Allreduce(aux, aux_g, 2, MPI_DOUBLE, MPI_MAX, nlp->get_comm()); assert(MPI_SUCCESS==ierr);
+  nrmInf_bar_optim=aux_g[0]; nrmInf_bar_complem=aux_g[1];
+#endif
+  nlp->runStats.tmSolverInternal.stop();
+  return true;
+}
+
 void hiopResidual::print(FILE* f, const char* msg/*=NULL*/, int max_elems/*=-1*/, int rank/*=-1*/) const
 {
   if(NULL==msg) fprintf(f, "hiopResidual print\n");
@@ -315,10 +391,10 @@ void hiopResidual::print(FILE* f, const char* msg/*=NULL*/, int max_elems/*=-1*/
   rxu->print( f, "   rxu:", max_elems, rank); 
   rdl->print( f, "   rdl:", max_elems, rank); 
   rdu->print( f, "   rdu:", max_elems, rank); 
-  printf(" errors (optim/feasib/complem) nlp    : %26.16e %25.16e %25.16e\n", 
-	 nrmInf_nlp_optim, nrmInf_nlp_feasib, nrmInf_nlp_complem);
-  printf(" errors (optim/feasib/complem) barrier: %25.16e %25.16e %25.16e\n", 
-	 nrmInf_bar_optim, nrmInf_bar_feasib, nrmInf_bar_complem);
+  fprintf(f, " errors (optim/feasib/complem) nlp    : %26.16e %25.16e %25.16e\n", 
+	    nrmInf_nlp_optim, nrmInf_nlp_feasib, nrmInf_nlp_complem);
+  fprintf(f, " errors (optim/feasib/complem) barrier: %25.16e %25.16e %25.16e\n", 
+	    nrmInf_bar_optim, nrmInf_bar_feasib, nrmInf_bar_complem);
 }
 
 };
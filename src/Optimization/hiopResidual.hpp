@@ -61,7 +61,7 @@ namespace hiop
 class hiopResidual
 {
 public:
-  hiopResidual(hiopNlpDenseConstraints* nlp);
+  hiopResidual(hiopNlpFormulation* nlp);
   virtual ~hiopResidual();
 
   virtual int update(const hiopIterate& it, 
@@ -69,6 +69,11 @@ public:
 		     const hiopVector& gradf, const hiopMatrix& jac_c, const hiopMatrix& jac_d, 
 		     const hiopLogBarProblem& logbar);
 
+  /* partial update for when only mu changed since the last 'update' (same iterate and NLP data):
+   * only the damping terms in rx and rd and the complementarity residuals are updated, and the 
+   * norms of the barrier problem are recomputed with a single reduction */
+  virtual int updateMu(const hiopIterate& it, const hiopLogBarProblem& logbar);
+
   /* Return the Nlp and Log-bar errors computed at the previous update call. */ 
   inline void getNlpErrors(double& optim, double& feas, double& comple) const
   { optim=nrmInf_nlp_optim; feas=nrmInf_nlp_feasib; comple=nrmInf_nlp_complem;};
@@ -86,6 +91,18 @@ public:
 				 const hiopVector& c_eval, 
 				 const hiopVector& d_eval);
 
+  /* copies all the residual components (but not the cached norms) from 'other' */
+  void copyFrom(const hiopResidual& other);
+
+  /* updates the right-hand side of a second-order correction (SOC) step: ryc and ryd are set to
+   * alpha*ryc+ryc_trial and alpha*ryd+ryd_trial, where ryc_trial and ryd_trial are the infeasibilities
+   * computed in 'trial' by 'computeNlpInfeasInfNorm'. The other components are not modified. */
+  void updateSOC(const double& alpha, const hiopResidual& trial);
+
+  /* sets the optimality residuals rx and rd to zero; the search direction computed with such a residual
+   * only reduces the infeasibility (used by the feasibility restoration phase) */
+  void setOptimalityToZero();
+
   /* residual printing function - calls hiopVector::print 
    * prints up to max_elems (by default all), on rank 'rank' (by default on all) */
   virtual void print(FILE*, const char* msg=NULL, int max_elems=-1, int rank=-1) const;
@@ -109,12 +126,15 @@ private:
    *  for the barrier subproblem
    */
   double nrmInf_bar_optim, nrmInf_bar_feasib, nrmInf_bar_complem; 
+  //the value of mu used in the last update
+  double mu;
   // and associated info from problem formulation
-  hiopNlpDenseConstraints * nlp;
+  hiopNlpFormulation * nlp;
 private:
   hiopResidual() {};
   hiopResidual(const hiopResidual&) {};
   hiopResidual& operator=(const hiopResidual& o) {return *this;};
+  friend class hiopKKTLinSys;
   friend class hiopKKTLinSysLowRank;
 };
 
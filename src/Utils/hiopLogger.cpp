@@ -52,6 +52,8 @@
 #include "hiopResidual.hpp"
 #include "hiopHessianLowRank.hpp"
 
+#include <vector>
+
 namespace hiop
 {
 
@@ -133,13 +135,24 @@ void hiopLogger::write(const char* msg, const hiopNlpFormulation& nlp,  hiopOutV
 void hiopLogger::printf(hiopOutVerbosity v, const char* format, ...)
 {
 #ifdef WITH_MPI
-  if(_master_rank != _nlp->get_rank()) return;
+  //a logger without NLP writes on the calling rank
+  if(_nlp && _master_rank != _nlp->get_rank()) return;
 #endif
   if(v>_verb) return;
-  va_list args;
+  va_list args, args2;
   va_start (args, format);
-  vsprintf (_buff,format, args);
-  fprintf(_f,_buff);
+  va_copy(args2, args);
+  //the message is written with one call so that the lines of the loggers of concurrent solves sharing the 
+  //same FILE* do not interleave; the messages longer than the buffer (e.g., the summaries) are formatted again
+  int len = vsnprintf(_buff, sizeof(_buff), format, args);
+  if(len>=(int)sizeof(_buff)) {
+    std::vector<char> buff(len+1);
+    vsnprintf(&buff[0], buff.size(), format, args2);
+    fputs(&buff[0], _f);
+  } else if(len>=0) {
+    fputs(_buff, _f);
+  }
+  va_end (args2);
   va_end (args);
 
 }
@@ -100,6 +100,11 @@ public:
 
   //only for loggerid=0 for now
   void printf(hiopOutVerbosity v, const char* format, ...); 
+
+  inline void set_verbosity(hiopOutVerbosity v) { _verb=v; }
+  /* redirects the output of this logger, e.g., to a file per NLP when several solves run concurrently in 
+   * the same process; the FILE* is owned by the caller */
+  inline void set_output(FILE* f) { _f=f; }
   
 protected:
   FILE* _f;
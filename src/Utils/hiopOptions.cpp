@@ -62,8 +62,8 @@ namespace hiop
 using namespace std;
 const char* szDefaultFilename = "hiop.options";
 
-  hiopOptions::hiopOptions(const char* szOptionsFilename/*=NULL*/)
-  : log(NULL)
+  hiopOptions::hiopOptions(const char* szOptionsFilename/*=NULL*/, hiopLogger* log_/*=NULL*/)
+  : log(log_)
 {
   registerOptions();
   loadFromFile(szOptionsFilename==NULL?szDefaultFilename:szOptionsFilename);
@@ -128,12 +128,87 @@ void hiopOptions::registerOptions()
   }
 
   registerIntOption("max_iter", 3000, 1, 1e6, "Max number of iterations (default 3000)");
+  registerNumOption("max_wall_time", 1e+20, 0., 1e+20, "Max wall-clock time in seconds; on timeout the best feasible iterate found is returned (default 1e+20, i.e., no limit)");
+
+  registerIntOption("checkpoint_interval", 0, 0, 1e6, "Write a checkpoint of the solver state every this many iterations; 0 disables checkpointing (default 0)");
+  registerStrOption("checkpoint_file", "hiop_checkpoint", vector<string>(), "Prefix of the checkpoint files; each MPI rank appends its rank (default hiop_checkpoint)");
+  {
+    vector<string> range(2); range[0]="no"; range[1]="yes";
+    registerStrOption("checkpoint_restart", "no", range, "Restart from the checkpoint files, if valid ones are found (default no)");
+  }
+
+  {
+    vector<string> range(2); range[0]="no"; range[1]="yes";
+    registerStrOption("time_profile", "no", range, "Hierarchical timing of the phases of the solve (Hessian update, KKT assembly and solves, line search, callbacks, etc.), printed with the summary (default no)");
+  }
+  {
+    vector<string> range(2); range[0]="no"; range[1]="yes";
+    registerStrOption("time_profile_counters", "no", range, "Hardware counters (cycles, instructions, last level cache references and misses) per phase of the time profile, read with perf_event_open on Linux; enables the profile (default no)");
+  }
+  registerStrOption("time_profile_trace", "none", vector<string>(), "File of the Chrome trace (JSON) of the time profile, written by rank 0 at the end of the solve; enables the profile (default none)");
+
+  registerStrOption("metrics_file", "none", vector<string>(), "File in which rank 0 writes a record of metrics per iteration (objective, infeasibilities, mu, step lengths, line search, Hessian updates, refinements, times, and callback counts) (default none)");
+  {
+    vector<string> range(2); range[0]="csv"; range[1]="binary";
+    registerStrOption("metrics_format", "csv", range, "Format of the metrics file: CSV with a header line or binary records (see hiopIterationMetrics.hpp) (default csv)");
+  }
 
   registerNumOption("acceptable_tolerance", 1e-6, 1e-14, 1e-1, "HiOp will terminate if the NLP residuals are below for 'acceptable_iterations' many consecutive iterations (default 1e-6)");   
   registerIntOption("acceptable_iterations", 10, 1, 1e6, "Number of iterations of acceptable tolerance after which HiOp terminates (default 10)");
 
+  registerIntOption("max_resto_iter", 100, 0, 1e6, "Max number of iterations of the feasibility restoration phase entered when the line search fails; 0 disables the restoration (default 100)");
+  registerIntOption("watchdog_shortened_iter_trigger", 10, 0, 1e6, "Number of consecutive iterations with shortened (backtracked) steps that activate the watchdog procedure; 0 disables the watchdog (default 10)");
+  registerIntOption("watchdog_trial_iter_max", 3, 1, 1e6, "Max number of tentative full steps taken by the watchdog before returning to the stored iterate (default 3)");
+  registerIntOption("max_soc_iter", 4, 0, 1000, "Max number of second-order correction steps attempted when the first trial point of the line search increases the infeasibility; 0 disables the correction (default 4)");
+
+
+  {
+    vector<string> range(2); range[0]="none"; range[1]="gradient";
+    registerStrOption("scaling_type", "none", range, "Scaling of the objective and constraints: 'none' (default) or 'gradient' (gradient-based scaling at the starting point)");
+  }
+  registerNumOption("scaling_max_grad", 100., 1e-8, 1e+20, "The objective and constraints are scaled so that their gradients' inf-norm at the starting point is at most this value (default 100.)");
+
+  {
+    vector<string> range(2); range[0]="no"; range[1]="yes";
+    registerStrOption("presolve", "no", range, "Remove fixed variables and empty or duplicated linear constraints before the solve (default no)");
+  }
+  {
+    vector<string> range(2); range[0]="no"; range[1]="yes";
+    registerStrOption("freeze_active_vars", "no", range, "Remove the variables that are strongly active at their bounds from the working set near convergence (default no)");
+  }
+  registerNumOption("freeze_active_ratio", 1e4, 1., 1e20, "A variable is strongly active when its bound multiplier is larger than this value times its slack (default 1e4)");
+  registerNumOption("freeze_active_mu", 1e-4, 0., 1., "Active variables are frozen only when mu is below this value (default 1e-4)");
 
   registerIntOption("secant_memory_len", 6, 0, 256, "Size of the memory of the Hessian secant approximation");
+  {
+    vector<string> range(2); range[0]="bfgs"; range[1]="sr1";
+    registerStrOption("secant_update_type", "bfgs", range, "Quasi-Newton update of the Hessian secant approximation: BFGS or SR1 with inertia safeguarding (default bfgs)");
+  }
+  {
+    vector<string> range(2); range[0]="no"; range[1]="yes";
+    registerStrOption("secant_B0_user_diag", "yes", range, "Use the diagonal Hessian estimate provided by the user (eval_Hess_diag), if any, as the initial matrix B0 of the secant approximation (default yes)");
+  }
+  {
+    vector<string> range(2); range[0]="no"; range[1]="yes";
+    registerStrOption("secant_memory_adaptive", "no", range, "Adapt the size of the secant memory to the observed progress, starting from 'secant_memory_len' (default no)");
+  }
+  registerIntOption("secant_memory_max_len", 20, 1, 256, "Max size of the secant memory when it is adaptive (default 20)");
+  registerNumOption("secant_memory_budget", 1e+20, 0., 1e+20, "Memory budget in MB per rank for the secant pairs; caps the size of the secant memory (default 1e+20, i.e., no limit)");
+  {
+    vector<string> range(3); range[0]="quasi_newton"; range[1]="structured"; range[2]="exact";
+    registerStrOption("hessian_mode", "quasi_newton", range, "Secant approximation of the Hessian of the Lagrangian (quasi_newton), exact Hessian-vector products of the objective provided by the user (eval_Hess_f_vec) plus a secant approximation of the constraints' part (structured), or the dense Hessian of the Lagrangian provided by the user (eval_Hess_Lagr) with a dense factorization of the KKT system (exact); structured solves with the Hessian by preconditioned CG (default quasi_newton)");
+  }
+  registerNumOption("hessian_pcg_tol", 1e-10, 1e-16, 1e-1, "Relative tolerance of the preconditioned CG used to solve with the Hessian when 'hessian_mode' is 'structured' (default 1e-10)");
+  registerIntOption("hessian_pcg_max_iter", 200, 1, 100000, "Max number of iterations of the preconditioned CG used when 'hessian_mode' is 'structured' (default 200)");
+
+  registerIntOption("dist_reduced_mat_min_size", 4000, 1, 1e9, "With more than one MPI rank, the m x m reduced matrices (KKT and lsq duals update) are distributed in a 2D block-cyclic layout and factorized in parallel when the number of constraints m is at least this value (default 4000)");
+  registerIntOption("dist_reduced_mat_block_size", 64, 1, 4096, "Block size of the 2D block-cyclic layout of the distributed reduced matrices (default 64)");
+  {
+    vector<string> range(2); range[0]="no"; range[1]="yes";
+    registerStrOption("node_shared_reduced_mats", "no", range, "With more than one MPI rank, the replicated reduced matrices (KKT and lsq duals update) are stored once per node in MPI-3 shared memory and their local contributions are reduced in blocks of rows; ignored when the reduced matrices are distributed, see 'dist_reduced_mat_min_size' (default no)");
+  }
+  registerIntOption("repartition_iter", 0, 0, 1e6, "With more than one MPI rank, the iteration at which the variables are repartitioned across the ranks to balance the time spent in the evaluations; the user accepts the new partitioning in repartition_vecdistrib; 0 disables the repartitioning (default 0)");
+  registerNumOption("repartition_imbalance", 0.2, 0., 1e6, "The variables are repartitioned only when the max evaluation time over the ranks exceeds the mean by more than this fraction of the mean (default 0.2)");
 
   registerIntOption("verbosity_level", 3, 0, 12, "Verbosity level: 0 no output (only errors), 1=0+warnings, 2=1 (reserved), 3=2+optimization output, 4=3+scalars; larger values explained in hiopLogger.hpp"); 
 }
@@ -305,6 +380,8 @@ bool hiopOptions::SetStringValue (const char* name,  const char* value)
       //see if it is in the range (of supported values)
       bool inrange=false;
       for(int it=0; it<option->range.size() && !inrange; it++) inrange = (option->range[it]==strValue);
+      //an empty range means that any value is accepted (e.g., file names)
+      if(option->range.size()==0) inrange=true;
 
       if(!inrange) {
 	stringstream ssRange; ssRange << " ";
@@ -352,7 +429,10 @@ void hiopOptions::_OStr::print(FILE* f) const
 {
   stringstream ssRange; ssRange << " ";
   for(int i=0; i<range.size(); i++) ssRange << range[i] << " ";
-  fprintf(f, "%s     \t # (string) one of [%s]   [%s]", val.c_str(), ssRange.str().c_str(), descr.c_str());
+  if(range.size()==0)
+    fprintf(f, "%s     \t # (string)   [%s]", val.c_str(), descr.c_str());
+  else
+    fprintf(f, "%s     \t # (string) one of [%s]   [%s]", val.c_str(), ssRange.str().c_str(), descr.c_str());
 }
 
 
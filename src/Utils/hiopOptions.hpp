@@ -62,7 +62,8 @@ class hiopLogger;
 class hiopOptions
 {
 public:
-  hiopOptions(const char* szOptionsFilename=NULL);
+  /* 'log' is used to report the errors in the options file; SetLog should be called if NULL */
+  hiopOptions(const char* szOptionsFilename=NULL, hiopLogger* log_=NULL);
   virtual ~hiopOptions();
 
   virtual bool SetNumericValue (const char* name, const double& value);
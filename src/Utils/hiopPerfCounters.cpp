@@ -0,0 +1,169 @@
+// Copyright (c) 2017, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory (LLNL).
+// Written by Cosmin G. Petra, petra1@llnl.gov.
+// LLNL-CODE-742473. All rights reserved.
+//
+// This file is part of HiOp. For details, see https://github.com/LLNL/hiop. HiOp 
+// is released under the BSD 3-clause license (https://opensource.org/licenses/BSD-3-Clause). 
+// Please also read “Additional BSD Notice” below.
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+// i. Redistributions of source code must retain the above copyright notice, this list 
+// of conditions and the disclaimer below.
+// ii. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the disclaimer (as noted below) in the documentation and/or 
+// other materials provided with the distribution.
+// iii. Neither the name of the LLNS/LLNL nor the names of its contributors may be used to 
+// endorse or promote products derived from this software without specific prior written 
+// permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY 
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES 
+// OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT 
+// SHALL LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR 
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS 
+// OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Additional BSD Notice
+// 1. This notice is required to be provided under our contract with the U.S. Department 
+// of Energy (DOE). This work was produced at Lawrence Livermore National Laboratory under 
+// Contract No. DE-AC52-07NA27344 with the DOE.
+// 2. Neither the United States Government nor Lawrence Livermore National Security, LLC 
+// nor any of their employees, makes any warranty, express or implied, or assumes any 
+// liability or responsibility for the accuracy, completeness, or usefulness of any 
+// information, apparatus, product, or process disclosed, or represents that its use would
+// not infringe privately-owned rights.
+// 3. Also, reference herein to any specific commercial products, process, or services by 
+// trade name, trademark, manufacturer or otherwise does not necessarily constitute or 
+// imply its endorsement, recommendation, or favoring by the United States Government or 
+// Lawrence Livermore National Security, LLC. The views and opinions of authors expressed 
+// herein do not necessarily state or reflect those of the United States Government or 
+// Lawrence Livermore National Security, LLC, and shall not be used for advertising or 
+// product endorsement purposes.
+#include "hiopPerfCounters.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+#endif
+
+namespace hiop
+{
+
+static const char* counter_names[pcNumCounters] = {"cycles", "instructions", "LLC references", "LLC misses"};
+
+const char* hiopPerfCounters::counter_name(int counter)
+{
+  return counter>=0 && counter<pcNumCounters ? counter_names[counter] : "unknown";
+}
+
+hiopPerfCounters::hiopPerfCounters()
+{
+  for(int k=0; k<pcNumCounters; k++) fd[k]=-1;
+}
+
+hiopPerfCounters::~hiopPerfCounters()
+{
+  close();
+}
+
+#ifdef __linux__
+
+static int perf_event_open_counter(int counter, int group_fd)
+{
+  static const unsigned long long configs[pcNumCounters] = 
+    {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_REFERENCES, PERF_COUNT_HW_CACHE_MISSES};
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = configs[counter];
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  //the group starts when the leader is enabled
+  attr.disabled = group_fd<0 ? 1 : 0;
+  //calling thread, any cpu
+  return (int)syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+bool hiopPerfCounters::open()
+{
+  close();
+  fd[0] = perf_event_open_counter(pcCycles, -1);
+  if(fd[0]<0) {
+    error = std::string("perf_event_open failed for the cycles counter: ") + strerror(errno);
+    if(EACCES==errno || EPERM==errno) error += " (see /proc/sys/kernel/perf_event_paranoid)";
+    return false;
+  }
+  for(int k=1; k<pcNumCounters; k++)
+    fd[k] = perf_event_open_counter(k, fd[0]);
+  if(ioctl(fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP)<0 || 
+     ioctl(fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP)<0) {
+    error = std::string("the counters cannot be started: ") + strerror(errno);
+    close();
+    return false;
+  }
+  error.clear();
+  return true;
+}
+
+void hiopPerfCounters::close()
+{
+  //the members first, then the leader
+  for(int k=pcNumCounters-1; k>=0; k--) {
+    if(fd[k]>=0) ::close(fd[k]);
+    fd[k]=-1;
+  }
+}
+
+bool hiopPerfCounters::read(long long values[pcNumCounters]) const
+{
+  for(int k=0; k<pcNumCounters; k++) values[k]=-1;
+  if(fd[0]<0) return false;
+  //layout of PERF_FORMAT_GROUP: nr, time enabled, time running, and the values of the opened counters in the
+  //order they joined the group
+  unsigned long long buf[3+pcNumCounters];
+  const ssize_t bytes = ::read(fd[0], buf, sizeof(buf));
+  if(bytes < (ssize_t)(3*sizeof(unsigned long long))) return false;
+  const unsigned long long nr=buf[0], enabled=buf[1], running=buf[2];
+  if(nr>pcNumCounters || bytes < (ssize_t)((3+nr)*sizeof(unsigned long long))) return false;
+  //the group was scheduled only part of the time when the kernel multiplexes the counters
+  const double scale = running>0 && running<enabled ? (double)enabled/running : 1.;
+  unsigned long long idx=0;
+  for(int k=0; k<pcNumCounters && idx<nr; k++) {
+    if(fd[k]<0) continue;
+    values[k] = (long long)(scale*buf[3+idx]);
+    idx++;
+  }
+  return true;
+}
+
+#else
+
+bool hiopPerfCounters::open()
+{
+  error = "the hardware counters are read with perf_event_open, which is available on Linux only";
+  return false;
+}
+
+void hiopPerfCounters::close() {}
+
+bool hiopPerfCounters::read(long long values[pcNumCounters]) const
+{
+  for(int k=0; k<pcNumCounters; k++) values[k]=-1;
+  return false;
+}
+
+#endif
+
+}
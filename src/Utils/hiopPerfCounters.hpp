@@ -0,0 +1,98 @@
+// Copyright (c) 2017, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory (LLNL).
+// Written by Cosmin G. Petra, petra1@llnl.gov.
+// LLNL-CODE-742473. All rights reserved.
+//
+// This file is part of HiOp. For details, see https://github.com/LLNL/hiop. HiOp 
+// is released under the BSD 3-clause license (https://opensource.org/licenses/BSD-3-Clause). 
+// Please also read “Additional BSD Notice” below.
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+// i. Redistributions of source code must retain the above copyright notice, this list 
+// of conditions and the disclaimer below.
+// ii. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the disclaimer (as noted below) in the documentation and/or 
+// other materials provided with the distribution.
+// iii. Neither the name of the LLNS/LLNL nor the names of its contributors may be used to 
+// endorse or promote products derived from this software without specific prior written 
+// permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY 
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES 
+// OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT 
+// SHALL LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR 
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS 
+// OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Additional BSD Notice
+// 1. This notice is required to be provided under our contract with the U.S. Department 
+// of Energy (DOE). This work was produced at Lawrence Livermore National Laboratory under 
+// Contract No. DE-AC52-07NA27344 with the DOE.
+// 2. Neither the United States Government nor Lawrence Livermore National Security, LLC 
+// nor any of their employees, makes any warranty, express or implied, or assumes any 
+// liability or responsibility for the accuracy, completeness, or usefulness of any 
+// information, apparatus, product, or process disclosed, or represents that its use would
+// not infringe privately-owned rights.
+// 3. Also, reference herein to any specific commercial products, process, or services by 
+// trade name, trademark, manufacturer or otherwise does not necessarily constitute or 
+// imply its endorsement, recommendation, or favoring by the United States Government or 
+// Lawrence Livermore National Security, LLC. The views and opinions of authors expressed 
+// herein do not necessarily state or reflect those of the United States Government or 
+// Lawrence Livermore National Security, LLC, and shall not be used for advertising or 
+// product endorsement purposes.
+#ifndef HIOP_PERF_COUNTERS
+#define HIOP_PERF_COUNTERS
+
+#include <string>
+
+namespace hiop
+{
+
+/* hardware counters read by hiopPerfCounters */
+enum hiopPerfCounter {
+  pcCycles=0,
+  pcInstructions,
+  pcLLCRefs,       //last level cache references
+  pcLLCMisses,     //last level cache misses
+  pcNumCounters
+};
+
+/* Hardware performance counters of the calling thread, read through the Linux perf_event_open interface.
+ * The counters are opened as one group so that a read returns values measured over the same interval; 
+ * they count user space only, which is allowed with the default kernel.perf_event_paranoid=2.
+ * The counters are not available on other systems, in most virtual machines and containers, or when the
+ * paranoid level forbids them; open then returns false and 'get_error' says why. A counter of the group
+ * that cannot be opened (e.g., the LLC events on some processors) reads -1. */
+class hiopPerfCounters
+{
+public:
+  hiopPerfCounters();
+  ~hiopPerfCounters();
+
+  /* opens and starts the counters for the calling thread; returns false when none is available */
+  bool open();
+  void close();
+  inline bool is_open() const { return fd[0]>=0; }
+  inline const std::string& get_error() const { return error; }
+
+  /* the current values, scaled when the kernel multiplexed the group; returns false when the read fails */
+  bool read(long long values[pcNumCounters]) const;
+
+  static const char* counter_name(int counter);
+  /* bytes moved from or to memory per last level cache miss, used to estimate the memory bandwidth */
+  static const int cache_line_bytes=64;
+private:
+  int fd[pcNumCounters];
+  std::string error;
+
+  hiopPerfCounters(const hiopPerfCounters&);
+  hiopPerfCounters& operator=(const hiopPerfCounters&);
+};
+
+}
+#endif
@@ -50,6 +50,7 @@
 #define HIOP_RUNSTATS
 
 #include "hiopTimer.hpp"
+#include "hiopTimeProfile.hpp"
 
 #include <sstream>
 #include <iomanip>
@@ -64,27 +65,79 @@ class hiopRunStats
 {
 public:
   hiopRunStats(MPI_Comm comm_=MPI_COMM_WORLD)
-    : comm(comm_)
+    : tmOptimizTotal(profile, tpSolve), 
+      tmSearchDir(profile, tpSearchDir), tmStartingPoint(profile, tpStartingPoint), tmMultUpdate(profile, tpDualUpdate),
+      tmEvalObj(profile, tpEvalObj), tmEvalGrad_f(profile, tpEvalGrad), tmEvalCons(profile, tpEvalCons), 
+      tmEvalJac_con(profile, tpEvalJac), tmEvalHess(profile, tpEvalHess),
+      comm(comm_)
   { 
     initialize();
   };
 
   virtual ~hiopRunStats() {};
 
-  hiopTimer tmOptimizTotal;
+  inline void setComm(MPI_Comm comm_) { comm=comm_; }
 
-  hiopTimer tmSolverInternal, tmSearchDir, tmStartingPoint, tmMultUpdate, tmComm;
+  //hierarchical timing of the phases of the solve (off unless the option 'time_profile' is 'yes'); the timers 
+  //below that are hiopPhaseTimer(s) also time their phase in the profile
+  hiopTimeProfile profile;
+
+  hiopPhaseTimer tmOptimizTotal;
+
+  hiopTimer tmSolverInternal;
+  hiopPhaseTimer tmSearchDir, tmStartingPoint, tmMultUpdate;
   hiopTimer tmInit;
 
-  hiopTimer tmEvalObj, tmEvalGrad_f, tmEvalCons, tmEvalJac_con;
+  hiopPhaseTimer tmEvalObj, tmEvalGrad_f, tmEvalCons, tmEvalJac_con, tmEvalHess;
 
-  int nEvalObj, nEvalGrad_f, nEvalCons_eq, nEvalCons_ineq, nEvalJac_con_eq, nEvalJac_con_ineq;
+  int nEvalObj, nEvalGrad_f, nEvalCons_eq, nEvalCons_ineq, nEvalJac_con_eq, nEvalJac_con_ineq, nEvalHess;
   int nIter;
+  //number of reductions of the barrier parameter mu, each with an incremental update of the residuals
+  int nMuReductions;
+  //number of second-order correction steps and of the ones accepted by the line search
+  int nSOCSteps, nSOCAccepted;
+  //number of feasibility restoration phases and of iterations spent in these phases
+  int nRestorationPhases, nRestorationIter;
+  //number of watchdog activations and of those that returned to the stored iterate
+  int nWatchdogActivations, nWatchdogFailures;
+  //number of times variables were frozen at their bounds and of times the frozen variables were released
+  int nActiveSetFreezes, nActiveSetReleases;
+  //number of load-balancing repartitionings of the variables across the ranks
+  int nRepartitions;
+  //number of secant updates of the quasi-Newton Hessian and of the ones skipped (e.g., because of poor curvature)
+  int nHessUpdates, nHessSkips;
+  //number of SR1 updates with s^T*y<=0 and of SR1 inertia corrections
+  int nHessUpdatesNegCurv, nSR1InertiaCorr;
+  //number of evaluations of the diagonal of the Hessian used as the initial secant matrix B0
+  int nEvalHessDiag;
+  //number of changes of the length of the adaptive secant memory
+  int nSecantMemChanges;
+  //number of PCG solves with the structured Hessian and of PCG iterations
+  int nPCGSolves, nPCGIter;
+  //number of failed solves for the search direction, which is then recomputed with the fallback KKT system
+  int nDirFailures;
+  //number of steps of the iterative refinement of the solves with the reduced KKT matrix
+  int nIterRefin;
   inline virtual void initialize() {
-    tmOptimizTotal = tmSolverInternal = tmSearchDir = tmStartingPoint = tmMultUpdate = tmComm = tmInit = 0.;
-    tmEvalObj = tmEvalGrad_f = tmEvalCons = tmEvalJac_con = 0.;    
-    nEvalObj = nEvalGrad_f = nEvalCons_eq = nEvalCons_ineq =  nEvalJac_con_eq = nEvalJac_con_ineq = 0;
+    tmOptimizTotal = 0.;
+    tmSolverInternal = tmInit = 0.;
+    tmSearchDir = 0.; tmStartingPoint = 0.; tmMultUpdate = 0.;
+    tmEvalObj = 0.; tmEvalGrad_f = 0.; tmEvalCons = 0.; tmEvalJac_con = 0.; tmEvalHess = 0.;
+    nEvalObj = nEvalGrad_f = nEvalCons_eq = nEvalCons_ineq =  nEvalJac_con_eq = nEvalJac_con_ineq = nEvalHess = 0;
     nIter = 0; 
+    nMuReductions = 0;
+    nSOCSteps = nSOCAccepted = 0;
+    nRestorationPhases = nRestorationIter = 0;
+    nWatchdogActivations = nWatchdogFailures = 0;
+    nActiveSetFreezes = nActiveSetReleases = 0;
+    nRepartitions = 0;
+    nHessUpdates = nHessSkips = 0;
+    nHessUpdatesNegCurv = nSR1InertiaCorr = 0;
+    nEvalHessDiag = 0;
+    nSecantMemChanges = 0;
+    nPCGSolves = nPCGIter = 0;
+    nDirFailures = 0;
+    nIterRefin = 0;
   }
 
   inline std::string getSummary(int masterRank=0) {
@@ -110,9 +163,11 @@ public:
 #endif
 
     ss << "Fcn/deriv time:     total=" << std::setprecision(3) 
-       << (tmEvalObj.getElapsedTime() + tmEvalGrad_f.getElapsedTime() + tmEvalCons.getElapsedTime() + tmEvalJac_con.getElapsedTime()) 
+       << (tmEvalObj.getElapsedTime() + tmEvalGrad_f.getElapsedTime() + tmEvalCons.getElapsedTime() + tmEvalJac_con.getElapsedTime()
+	   + tmEvalHess.getElapsedTime()) 
        << " sec  ( obj=" << tmEvalObj.getElapsedTime() << " grad=" << tmEvalGrad_f.getElapsedTime() 
-       << " cons=" << tmEvalCons.getElapsedTime() << " Jac=" << tmEvalJac_con.getElapsedTime() << " ) " << std::endl;
+       << " cons=" << tmEvalCons.getElapsedTime() << " Jac=" << tmEvalJac_con.getElapsedTime() 
+       << " Hess=" << tmEvalHess.getElapsedTime() << " ) " << std::endl;
 #ifdef WITH_MPI
     loc=tmEvalObj.getElapsedTime() + tmEvalGrad_f.getElapsedTime() + tmEvalCons.getElapsedTime() + tmEvalJac_con.getElapsedTime();
 
@@ -129,13 +184,30 @@ public:
 #endif
     ss << "Fcn/deriv #: obj=" << nEvalObj <<  " grad=" << nEvalGrad_f 
        << " eq cons=" << nEvalCons_eq << " ineq cons=" << nEvalCons_ineq 
-       << " eq Jac=" << nEvalJac_con_eq << " ineq Jac=" << nEvalJac_con_ineq << std::endl;
+       << " eq Jac=" << nEvalJac_con_eq << " ineq Jac=" << nEvalJac_con_ineq << " Hess=" << nEvalHess << std::endl;
+    ss << "Barrier reductions #: " << nMuReductions << std::endl;
+    ss << "Second-order corrections #: steps=" << nSOCSteps << " accepted=" << nSOCAccepted << std::endl;
+    ss << "Restoration #: phases=" << nRestorationPhases << " iterations=" << nRestorationIter << std::endl;
+    ss << "Watchdog #: activations=" << nWatchdogActivations << " failures=" << nWatchdogFailures << std::endl;
+    ss << "Active set #: freezes=" << nActiveSetFreezes << " releases=" << nActiveSetReleases << std::endl;
+    ss << "Repartitions #: " << nRepartitions << std::endl;
+    ss << "Hessian updates #: done=" << nHessUpdates << " skipped=" << nHessSkips 
+       << "  Iterative refinement #: steps=" << nIterRefin << std::endl;
+    ss << "SR1 #: negative curvature updates=" << nHessUpdatesNegCurv << " inertia corrections=" << nSR1InertiaCorr 
+       << "  Hessian diagonal evaluations #: " << nEvalHessDiag << std::endl;
+    ss << "Secant memory #: length changes=" << nSecantMemChanges << std::endl;
+    ss << "PCG #: solves=" << nPCGSolves << " iterations=" << nPCGIter << std::endl;
+    ss << "Search direction failures #: " << nDirFailures << std::endl;
+    if(profile.is_enabled()) ss << profile.getSummary(comm, nIter);
 
     return ss.str();
   }
 private:
   MPI_Comm comm;
 
+  //the phase timers refer to the profile of this object
+  hiopRunStats(const hiopRunStats&);
+  hiopRunStats& operator=(const hiopRunStats&);
 };
 }
 #endif
@@ -0,0 +1,347 @@
+// Copyright (c) 2017, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory (LLNL).
+// Written by Cosmin G. Petra, petra1@llnl.gov.
+// LLNL-CODE-742473. All rights reserved.
+//
+// This file is part of HiOp. For details, see https://github.com/LLNL/hiop. HiOp 
+// is released under the BSD 3-clause license (https://opensource.org/licenses/BSD-3-Clause). 
+// Please also read “Additional BSD Notice” below.
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+// i. Redistributions of source code must retain the above copyright notice, this list 
+// of conditions and the disclaimer below.
+// ii. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the disclaimer (as noted below) in the documentation and/or 
+// other materials provided with the distribution.
+// iii. Neither the name of the LLNS/LLNL nor the names of its contributors may be used to 
+// endorse or promote products derived from this software without specific prior written 
+// permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY 
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES 
+// OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT 
+// SHALL LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR 
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS 
+// OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Additional BSD Notice
+// 1. This notice is required to be provided under our contract with the U.S. Department 
+// of Energy (DOE). This work was produced at Lawrence Livermore National Laboratory under 
+// Contract No. DE-AC52-07NA27344 with the DOE.
+// 2. Neither the United States Government nor Lawrence Livermore National Security, LLC 
+// nor any of their employees, makes any warranty, express or implied, or assumes any 
+// liability or responsibility for the accuracy, completeness, or usefulness of any 
+// information, apparatus, product, or process disclosed, or represents that its use would
+// not infringe privately-owned rights.
+// 3. Also, reference herein to any specific commercial products, process, or services by 
+// trade name, trademark, manufacturer or otherwise does not necessarily constitute or 
+// imply its endorsement, recommendation, or favoring by the United States Government or 
+// Lawrence Livermore National Security, LLC. The views and opinions of authors expressed 
+// herein do not necessarily state or reflect those of the United States Government or 
+// Lawrence Livermore National Security, LLC, and shall not be used for advertising or 
+// product endorsement purposes.
+
+#include "hiopTimeProfile.hpp"
+
+#include <cstdio>
+#include <cassert>
+
+namespace hiop
+{
+
+static const char* phase_names[tpNumPhases] = {
+  "solve", "starting point", "iteration", "Hessian update", "V factorization", "search direction", 
+  "N assembly", "N solve", "N factorization", "line search", "dual update", 
+  "eval objective", "eval gradient", "eval constraints", "eval Jacobian", "eval Hessian", "iterate callback"
+};
+
+hiopTimeProfile::hiopTimeProfile()
+  : enabled(false), record_events(false), iter(0), t_origin(0.), counters_requested(false), counters_used(false)
+{
+  for(int k=0; k<pcNumCounters; k++) counter_valid[k]=false;
+  reset();
+}
+
+const char* hiopTimeProfile::phase_name(int phase)
+{
+  return phase>=0 && phase<tpNumPhases ? phase_names[phase] : "root";
+}
+
+void hiopTimeProfile::enable(bool on, bool record_events_, bool hw_counters)
+{
+  enabled=on; record_events=on && record_events_;
+  counters_requested=on && hw_counters;
+  counters_used=counters_requested && counters.open();
+  if(!counters_used) counters.close();
+  //the counters that could not be opened read -1
+  long long hw[pcNumCounters];
+  counters.read(hw);
+  for(int k=0; k<pcNumCounters; k++) counter_valid[k]=counters_used && hw[k]>=0;
+  reset();
+}
+
+void hiopTimeProfile::reset()
+{
+  nodes.assign(1, Node());
+  nodes[0].phase=-1; nodes[0].parent=-1; nodes[0].time=0.; nodes[0].count=0;
+  for(int k=0; k<pcNumCounters; k++) nodes[0].hw[k]=0;
+  open.assign(1, 0); open_start.assign(1, 0.); open_event.assign(1, -1);
+  open_hw.assign(pcNumCounters, 0);
+  events.clear();
+  iter=0;
+  t_origin=hiopTimer::now();
+}
+
+void hiopTimeProfile::push(hiopTimePhase phase)
+{
+  const int parent=open.back();
+  int node=-1;
+  for(size_t c=0; c<nodes[parent].children.size(); c++)
+    if(nodes[nodes[parent].children[c]].phase==phase) { node=nodes[parent].children[c]; break; }
+  if(node<0) {
+    node=(int)nodes.size();
+    Node n; n.phase=phase; n.parent=parent; n.time=0.; n.count=0;
+    for(int k=0; k<pcNumCounters; k++) n.hw[k]=0;
+    nodes.push_back(n);
+    nodes[parent].children.push_back(node);
+  }
+  const double t=hiopTimer::now();
+  int ev=-1;
+  if(record_events && events.size()<max_events) {
+    Event e; e.phase=phase; e.depth=(int)open.size()-1; e.iter=iter; e.start=t-t_origin; e.end=e.start;
+    ev=(int)events.size();
+    events.push_back(e);
+  }
+  open.push_back(node); open_start.push_back(t); open_event.push_back(ev);
+  if(counters_used) {
+    long long hw[pcNumCounters];
+    counters.read(hw);
+    open_hw.insert(open_hw.end(), hw, hw+pcNumCounters);
+  }
+}
+
+void hiopTimeProfile::pop(hiopTimePhase phase)
+{
+  //the phases nest; a phase that is not open is ignored and the ones opened after it are closed with it
+  int k=(int)open.size()-1;
+  while(k>0 && nodes[open[k]].phase!=phase) k--;
+  if(k==0) return;
+  const double t=hiopTimer::now();
+  long long hw[pcNumCounters];
+  if(counters_used) counters.read(hw);
+  while((int)open.size()>k) {
+    Node& n=nodes[open.back()];
+    n.time += t-open_start.back(); n.count++;
+    if(open_event.back()>=0) events[open_event.back()].end=t-t_origin;
+    open.pop_back(); open_start.pop_back(); open_event.pop_back();
+    if(counters_used) {
+      const long long* hw0=&open_hw[open_hw.size()-pcNumCounters];
+      for(int c=0; c<pcNumCounters; c++)
+	if(hw[c]>=0 && hw0[c]>=0) n.hw[c] += hw[c]-hw0[c];
+      open_hw.resize(open_hw.size()-pcNumCounters);
+    }
+  }
+}
+
+void hiopTimeProfile::close_all()
+{
+  if(open.size()>1) pop((hiopTimePhase)nodes[open[1]].phase);
+}
+
+double hiopTimeProfile::get_phase_time(hiopTimePhase phase) const
+{
+  double t=0.;
+  for(size_t i=1; i<nodes.size(); i++) {
+    if(nodes[i].phase!=phase) continue;
+    //a phase nested in itself is counted once
+    int p=nodes[i].parent;
+    while(p>0 && nodes[p].phase!=phase) p=nodes[p].parent;
+    if(p<=0) t+=nodes[i].time;
+  }
+  return t;
+}
+
+long long hiopTimeProfile::get_phase_count(hiopTimePhase phase) const
+{
+  long long c=0;
+  for(size_t i=1; i<nodes.size(); i++)
+    if(nodes[i].phase==phase) c+=nodes[i].count;
+  return c;
+}
+
+long long hiopTimeProfile::get_phase_counter(hiopTimePhase phase, hiopPerfCounter counter) const
+{
+  if(!counter_valid[counter]) return -1;
+  long long c=0;
+  for(size_t i=1; i<nodes.size(); i++) {
+    if(nodes[i].phase!=phase) continue;
+    int p=nodes[i].parent;
+    while(p>0 && nodes[p].phase!=phase) p=nodes[p].parent;
+    if(p<=0) c+=nodes[i].hw[counter];
+  }
+  return c;
+}
+
+std::string hiopTimeProfile::getSummary(MPI_Comm comm, int num_iter) const
+{
+  double tloc[tpNumPhases], tmin[tpNumPhases], tmax[tpNumPhases], tavg[tpNumPhases];
+  for(int p=0; p<tpNumPhases; p++) tloc[p]=tmin[p]=tmax[p]=tavg[p]=get_phase_time((hiopTimePhase)p);
+#ifdef WITH_MPI
+  int nranks=1, ierr;
+  ierr = MPI_Comm_size(comm, &nranks); assert(MPI_SUCCESS==ierr);
+  if(nranks>1) {
+    ierr = MPI_Allreduce(tloc, tmin, tpNumPhases, MPI_DOUBLE, MPI_MIN, comm); assert(MPI_SUCCESS==ierr);
+    ierr = MPI_Allreduce(tloc, tmax, tpNumPhases, MPI_DOUBLE, MPI_MAX, comm); assert(MPI_SUCCESS==ierr);
+    ierr = MPI_Allreduce(tloc, tavg, tpNumPhases, MPI_DOUBLE, MPI_SUM, comm); assert(MPI_SUCCESS==ierr);
+    for(int p=0; p<tpNumPhases; p++) tavg[p] /= nranks;
+  }
+#endif
+  char buf[256];
+  snprintf(buf, sizeof(buf), "Time profile (sec):%*s %8s %10s %10s %10s %10s %10s\n", 21, "", "count", "total", 
+	   "per iter", "rank min", "rank avg", "rank max");
+  std::string out(buf);
+  for(size_t c=0; c<nodes[0].children.size(); c++)
+    print_node(out, nodes[0].children[c], 0, num_iter, tmin, tavg, tmax);
+
+  if(counters_failed())
+    out += "Hardware counters not available: " + counters.get_error() + "\n";
+  if(!counters_requested) return out;
+
+  //the counters of the phases summed over the ranks; a counter that is not read on some rank is dropped
+  double hw[tpNumPhases*pcNumCounters];
+  int valid[pcNumCounters];
+  for(int k=0; k<pcNumCounters; k++) valid[k]=counter_valid[k] ? 1 : 0;
+  for(int p=0; p<tpNumPhases; p++)
+    for(int k=0; k<pcNumCounters; k++)
+      hw[p*pcNumCounters+k] = counter_valid[k] ? (double)get_phase_counter((hiopTimePhase)p, (hiopPerfCounter)k) : 0.;
+  int nranks_hw=1;
+#ifdef WITH_MPI
+  //the reductions are done on all ranks, also on the ones without counters
+  ierr = MPI_Allreduce(MPI_IN_PLACE, hw, tpNumPhases*pcNumCounters, MPI_DOUBLE, MPI_SUM, comm); 
+  assert(MPI_SUCCESS==ierr);
+  ierr = MPI_Allreduce(MPI_IN_PLACE, valid, pcNumCounters, MPI_INT, MPI_MIN, comm); assert(MPI_SUCCESS==ierr);
+  nranks_hw=nranks;
+#endif
+  if(!counters_used) return out;
+
+  snprintf(buf, sizeof(buf), "Hardware counters:%*s %10s %8s %10s %10s\n", 22, "", "Gcycles", "IPC", "LLC miss%", 
+	   "est. GB/s");
+  out += buf;
+  for(size_t c=0; c<nodes[0].children.size(); c++)
+    print_node_counters(out, nodes[0].children[c], 0);
+
+  snprintf(buf, sizeof(buf), "Hardware counters, sum over %d rank(s):\n", nranks_hw);
+  out += buf;
+  for(int p=0; p<tpNumPhases; p++) {
+    if(tmax[p]<=0.) continue;
+    double hwp[pcNumCounters];
+    for(int k=0; k<pcNumCounters; k++) hwp[k] = valid[k] ? hw[p*pcNumCounters+k] : -1.;
+    snprintf(buf, sizeof(buf), "  %-38s", phase_name(p));
+    out += buf;
+    //the bandwidth of all the ranks, over the time of the slowest one
+    print_counters(out, hwp, tmax[p]);
+  }
+  return out;
+}
+
+void hiopTimeProfile::print_node_counters(std::string& out, int node, int depth) const
+{
+  const Node& n=nodes[node];
+  double hw[pcNumCounters];
+  for(int k=0; k<pcNumCounters; k++) hw[k] = counter_valid[k] ? (double)n.hw[k] : -1.;
+  char buf[256];
+  snprintf(buf, sizeof(buf), "  %*s%-*s", 2*depth, "", 38-2*depth, phase_name(n.phase));
+  out += buf;
+  print_counters(out, hw, n.time);
+  for(size_t c=0; c<n.children.size(); c++)
+    print_node_counters(out, n.children[c], depth+1);
+}
+
+void hiopTimeProfile::print_counters(std::string& out, const double hw[pcNumCounters], double time)
+{
+  //cycles, instructions per cycle, LLC misses per LLC reference, and the memory traffic estimated from the 
+  //LLC misses; the values that cannot be computed are shown as '-'
+  char buf[128];
+  if(hw[pcCycles]>=0) snprintf(buf, sizeof(buf), " %10.4f", 1e-9*hw[pcCycles]);
+  else snprintf(buf, sizeof(buf), " %10s", "-");
+  out += buf;
+  if(hw[pcCycles]>0 && hw[pcInstructions]>=0) snprintf(buf, sizeof(buf), " %8.2f", hw[pcInstructions]/hw[pcCycles]);
+  else snprintf(buf, sizeof(buf), " %8s", "-");
+  out += buf;
+  if(hw[pcLLCRefs]>0 && hw[pcLLCMisses]>=0) snprintf(buf, sizeof(buf), " %10.2f", 100.*hw[pcLLCMisses]/hw[pcLLCRefs]);
+  else snprintf(buf, sizeof(buf), " %10s", "-");
+  out += buf;
+  if(time>0 && hw[pcLLCMisses]>=0) 
+    snprintf(buf, sizeof(buf), " %10.3f\n", 1e-9*hiopPerfCounters::cache_line_bytes*hw[pcLLCMisses]/time);
+  else snprintf(buf, sizeof(buf), " %10s\n", "-");
+  out += buf;
+}
+
+void hiopTimeProfile::print_node(std::string& out, int node, int depth, int num_iter, 
+				 const double* tmin, const double* tavg, const double* tmax) const
+{
+  const Node& n=nodes[node];
+  char buf[256];
+  snprintf(buf, sizeof(buf), "  %*s%-*s %8lld %10.4f %10.6f %10.4f %10.4f %10.4f\n", 2*depth, "", 38-2*depth, 
+	   phase_name(n.phase), n.count, n.time, num_iter>0 ? n.time/num_iter : 0., 
+	   tmin[n.phase], tavg[n.phase], tmax[n.phase]);
+  out += buf;
+  for(size_t c=0; c<n.children.size(); c++)
+    print_node(out, n.children[c], depth+1, num_iter, tmin, tavg, tmax);
+}
+
+bool hiopTimeProfile::writeChromeTrace(const char* filename, MPI_Comm comm) const
+{
+  //the events are packed as (phase, depth, iter, start, end)
+  const int nloc=5*(int)events.size();
+  std::vector<double> loc(nloc);
+  for(size_t i=0; i<events.size(); i++) {
+    loc[5*i]=events[i].phase; loc[5*i+1]=events[i].depth; loc[5*i+2]=events[i].iter;
+    loc[5*i+3]=events[i].start; loc[5*i+4]=events[i].end;
+  }
+  int rank=0, nranks=1;
+  std::vector<int> counts(1, nloc), displs(1, 0);
+  std::vector<double> all;
+#ifdef WITH_MPI
+  int ierr;
+  ierr = MPI_Comm_rank(comm, &rank); assert(MPI_SUCCESS==ierr);
+  ierr = MPI_Comm_size(comm, &nranks); assert(MPI_SUCCESS==ierr);
+  counts.resize(nranks); displs.assign(nranks, 0);
+  ierr = MPI_Gather(&nloc, 1, MPI_INT, &counts[0], 1, MPI_INT, 0, comm); assert(MPI_SUCCESS==ierr);
+  if(0==rank) {
+    for(int r=1; r<nranks; r++) displs[r]=displs[r-1]+counts[r-1];
+    all.resize(displs[nranks-1]+counts[nranks-1]+1);
+  }
+  ierr = MPI_Gatherv(loc.empty() ? NULL : &loc[0], nloc, MPI_DOUBLE, 0==rank ? &all[0] : NULL, &counts[0], &displs[0], 
+		     MPI_DOUBLE, 0, comm); assert(MPI_SUCCESS==ierr);
+#else
+  all.swap(loc);
+#endif
+  if(rank!=0) return true;
+
+  FILE* f=fopen(filename, "w");
+  if(NULL==f) return false;
+  fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  bool first=true;
+  for(int r=0; r<nranks; r++) {
+    fprintf(f, "%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":0,\"args\":{\"name\":\"rank %d\"}}", 
+	    first ? "" : ",\n", r, r);
+    first=false;
+    for(int i=displs[r]; i<displs[r]+counts[r]; i+=5) {
+      //complete events, in microseconds
+      fprintf(f, ",\n{\"name\":\"%s\",\"cat\":\"hiop\",\"ph\":\"X\",\"pid\":%d,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f,"
+	      "\"args\":{\"iter\":%d,\"depth\":%d}}", phase_name((int)all[i]), r, 1e6*all[i+3], 1e6*(all[i+4]-all[i+3]), 
+	      (int)all[i+2], (int)all[i+1]);
+    }
+  }
+  fprintf(f, "\n]}\n");
+  fclose(f);
+  return true;
+}
+
+}
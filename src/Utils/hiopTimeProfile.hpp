@@ -0,0 +1,206 @@
+// Copyright (c) 2017, Lawrence Livermore National Security, LLC.
+// Produced at the Lawrence Livermore National Laboratory (LLNL).
+// Written by Cosmin G. Petra, petra1@llnl.gov.
+// LLNL-CODE-742473. All rights reserved.
+//
+// This file is part of HiOp. For details, see https://github.com/LLNL/hiop. HiOp 
+// is released under the BSD 3-clause license (https://opensource.org/licenses/BSD-3-Clause). 
+// Please also read “Additional BSD Notice” below.
+//
+// Redistribution and use in source and binary forms, with or without modification, 
+// are permitted provided that the following conditions are met:
+// i. Redistributions of source code must retain the above copyright notice, this list 
+// of conditions and the disclaimer below.
+// ii. Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the disclaimer (as noted below) in the documentation and/or 
+// other materials provided with the distribution.
+// iii. Neither the name of the LLNS/LLNL nor the names of its contributors may be used to 
+// endorse or promote products derived from this software without specific prior written 
+// permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY 
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES 
+// OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT 
+// SHALL LAWRENCE LIVERMORE NATIONAL SECURITY, LLC, THE U.S. DEPARTMENT OF ENERGY OR 
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS 
+// OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Additional BSD Notice
+// 1. This notice is required to be provided under our contract with the U.S. Department 
+// of Energy (DOE). This work was produced at Lawrence Livermore National Laboratory under 
+// Contract No. DE-AC52-07NA27344 with the DOE.
+// 2. Neither the United States Government nor Lawrence Livermore National Security, LLC 
+// nor any of their employees, makes any warranty, express or implied, or assumes any 
+// liability or responsibility for the accuracy, completeness, or usefulness of any 
+// information, apparatus, product, or process disclosed, or represents that its use would
+// not infringe privately-owned rights.
+// 3. Also, reference herein to any specific commercial products, process, or services by 
+// trade name, trademark, manufacturer or otherwise does not necessarily constitute or 
+// imply its endorsement, recommendation, or favoring by the United States Government or 
+// Lawrence Livermore National Security, LLC. The views and opinions of authors expressed 
+// herein do not necessarily state or reflect those of the United States Government or 
+// Lawrence Livermore National Security, LLC, and shall not be used for advertising or 
+// product endorsement purposes.
+
+#ifndef HIOP_TIME_PROFILE
+#define HIOP_TIME_PROFILE
+
+#include "hiopTimer.hpp"
+#include "hiopPerfCounters.hpp"
+
+#ifdef WITH_MPI
+#include "mpi.h"
+#else
+#define MPI_Comm int
+#endif
+
+#include <vector>
+#include <string>
+
+namespace hiop
+{
+
+/* phases of the solver measured by the time profile */
+enum hiopTimePhase {
+  tpSolve=0,
+  tpStartingPoint,
+  tpIteration,
+  tpHessUpdate,    //update of the secant approximation
+  tpHessFactorV,   //factorization of the middle matrix V of the secant approximation
+  tpSearchDir,     //KKT update and solve
+  tpNAssembly,     //assembly of the reduced matrix N of the KKT system
+  tpNSolve,        //solve with N (or with the KKT matrix of the exact, sparse, and block modes), including
+  tpNFactor,       //its factorization
+  tpLineSearch,
+  tpDualUpdate,
+  tpEvalObj,       //user callbacks
+  tpEvalGrad,
+  tpEvalCons,
+  tpEvalJac,
+  tpEvalHess,
+  tpIterCallback,
+  tpNumPhases
+};
+
+/* Hierarchical timing of the phases of a solve, based on the monotonic clock of hiopTimer. The phases are 
+ * opened and closed by begin/end (or by hiopTimeScope) and nest into a tree: the same phase in different 
+ * parents (e.g., the objective evaluations in the line search and in the starting procedure) is accumulated 
+ * separately. Optionally, each occurrence of a phase is recorded as an event and the events of all the ranks 
+ * are exported in the Chrome trace format (chrome://tracing or Perfetto), one process per rank.
+ * Optionally, the hardware counters of hiopPerfCounters are also accumulated per phase; they count the thread 
+ * that enabled the profile (threads spawned by the BLAS or by the user's evaluations are not counted).
+ * The profile is disabled by default and then begin/end return immediately. */
+class hiopTimeProfile
+{
+public:
+  hiopTimeProfile();
+  ~hiopTimeProfile() {};
+
+  /* turns the profile on or off; the events are recorded when 'record_events' is true and the hardware 
+   * counters are read when 'hw_counters' is true and they are available. Resets the profile */
+  void enable(bool on, bool record_events=false, bool hw_counters=false);
+  inline bool is_enabled() const { return enabled; }
+  /* drops all the timings and events; the time origin of the events is set to the current time */
+  void reset();
+
+  inline void begin(hiopTimePhase phase) { if(enabled) push(phase); }
+  inline void end(hiopTimePhase phase) { if(enabled) pop(phase); }
+  /* closes the phases left open (e.g., by an early return) */
+  void close_all();
+  /* the iteration attached to the events */
+  inline void set_iteration(int iter_) { iter=iter_; }
+
+  /* true when the hardware counters were requested but cannot be read; 'get_counters_error' says why */
+  inline bool counters_failed() const { return counters_requested && !counters_used; }
+  inline const std::string& get_counters_error() const { return counters.get_error(); }
+  /* stops reading the hardware counters and releases them; the counts of the phases are kept */
+  inline void close_counters() { counters.close(); }
+
+  /* total time and number of occurrences of a phase over all its parents */
+  double get_phase_time(hiopTimePhase phase) const;
+  long long get_phase_count(hiopTimePhase phase) const;
+  /* total of a hardware counter over all the parents of a phase; -1 when the counter was not read */
+  long long get_phase_counter(hiopTimePhase phase, hiopPerfCounter counter) const;
+
+  /* the tree of the phases with the time on this rank, the time per iteration, and the min/avg/max of the 
+   * phase totals over the ranks of 'comm'. With the hardware counters, also the counters of the phases on 
+   * this rank and their totals over the ranks; collective */
+  std::string getSummary(MPI_Comm comm, int num_iter) const;
+  /* the events of all the ranks of 'comm' are gathered and written by rank 0 in 'filename'; collective.
+   * Returns false (on rank 0) when the file cannot be written */
+  bool writeChromeTrace(const char* filename, MPI_Comm comm) const;
+
+  static const char* phase_name(int phase);
+private:
+  void push(hiopTimePhase phase);
+  void pop(hiopTimePhase phase);
+  void print_node(std::string& out, int node, int depth, int num_iter, 
+		  const double* tmin, const double* tavg, const double* tmax) const;
+  void print_node_counters(std::string& out, int node, int depth) const;
+  static void print_counters(std::string& out, const double hw[pcNumCounters], double time);
+private:
+  struct Node
+  {
+    int phase, parent;
+    double time;
+    long long count;
+    long long hw[pcNumCounters];
+    std::vector<int> children;
+  };
+  struct Event
+  {
+    int phase, depth, iter;
+    double start, end;
+  };
+  bool enabled, record_events;
+  int iter;
+  double t_origin;
+  //node 0 is the root of the tree; 'open' holds the open nodes and their start times
+  std::vector<Node> nodes;
+  std::vector<int> open;
+  std::vector<double> open_start;
+  std::vector<int> open_event;
+  //the hardware counters when the open nodes started, pcNumCounters per node
+  bool counters_requested, counters_used;
+  bool counter_valid[pcNumCounters];
+  hiopPerfCounters counters;
+  std::vector<long long> open_hw;
+  std::vector<Event> events;
+  //the recording stops at this many events
+  static const size_t max_events=1000000;
+};
+
+/* opens a phase of the profile for the lifetime of the object */
+class hiopTimeScope
+{
+public:
+  hiopTimeScope(hiopTimeProfile& prof_, hiopTimePhase phase_) : prof(prof_), phase(phase_) { prof.begin(phase); }
+  ~hiopTimeScope() { prof.end(phase); }
+private:
+  hiopTimeProfile& prof;
+  hiopTimePhase phase;
+
+  hiopTimeScope(const hiopTimeScope&);
+  hiopTimeScope& operator=(const hiopTimeScope&);
+};
+
+/* a timer of hiopRunStats that also opens and closes a phase of the time profile */
+class hiopPhaseTimer : public hiopTimer
+{
+public:
+  hiopPhaseTimer(hiopTimeProfile& prof_, hiopTimePhase phase_) : prof(prof_), phase(phase_) {};
+
+  inline void start() { hiopTimer::start(); prof.begin(phase); }
+  inline void stop() { prof.end(phase); hiopTimer::stop(); }
+  inline hiopPhaseTimer& operator=(const double& zero) { hiopTimer::operator=(zero); return *this; }
+private:
+  hiopTimeProfile& prof;
+  hiopTimePhase phase;
+};
+
+}
+#endif
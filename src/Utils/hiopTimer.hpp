@@ -49,12 +49,7 @@
 #ifndef  HIOP_TIMER
 #define HIOP_TIMER
 
-#ifdef WITH_MPI
-#include "mpi.h"
-#else
-#include <sys/time.h>
-#endif
-
+#include <chrono>
 #include <cassert>
 
 //to do: sys time: getrusage(RUSAGE_SELF,&usage);
@@ -70,25 +65,12 @@ public:
   //returns the elapsed time (accumulated between start/stop) in seconds
   inline double getElapsedTime() const { return tmElapsed; }
 
-  inline void start() 
-  {
-#ifdef WITH_MPI 
-    tmStart = MPI_Wtime();
-#else
-    gettimeofday(&tv, NULL);
-    tmStart = ( static_cast<double>(tv.tv_sec) + static_cast<double>(tv.tv_usec)/1000000.0 );
-#endif
-  }
+  //returns the time since the last 'start' in seconds; the timer is not stopped
+  inline double getElapsedTimeSinceStart() const { return now()-tmStart; }
 
-  inline void stop()
-  {
-#ifdef WITH_MPI
-    tmElapsed += ( MPI_Wtime()-tmStart );
-#else
-    gettimeofday(&tv, NULL);
-    tmElapsed += ( static_cast<double>(tv.tv_sec) + static_cast<double>(tv.tv_usec)/1000000.0  - tmStart );
-#endif
-  }
+  inline void start() { tmStart = now(); }
+
+  inline void stop() { tmElapsed += ( now()-tmStart ); }
 
   inline void reset() {
     tmElapsed=0.0; tmStart=0.0;
@@ -99,14 +81,15 @@ public:
     this->reset(); 
     return *this;
   }
+
+  //time in seconds from the monotonic clock (not affected by the changes of the system time)
+  static inline double now()
+  {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
 private:
   double tmElapsed; //in seconds
   double tmStart;
-
-#ifdef WITH_MPI
-#else
-  struct timeval tv;
-#endif
 };
 }
 #endif